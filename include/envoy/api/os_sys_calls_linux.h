@@ -20,6 +20,21 @@ public:
    * @see sched_getaffinity (man 2 sched_getaffinity)
    */
   virtual SysCallIntResult sched_getaffinity(pid_t pid, size_t cpusetsize, cpu_set_t* mask) PURE;
+
+  /**
+   * @see pipe2 (man 2 pipe2)
+   */
+  virtual SysCallIntResult pipe2(int pipefd[2], int flags) PURE;
+
+  /**
+   * @see fcntl (man 2 fcntl), for the commands taking an integer argument.
+   */
+  virtual SysCallIntResult fcntl(int fd, int cmd, int arg) PURE;
+
+  /**
+   * @see splice (man 2 splice). Neither descriptor may be seekable, so there are no offsets.
+   */
+  virtual SysCallSizeResult splice(int fd_in, int fd_out, size_t len, unsigned int flags) PURE;
 };
 
 using LinuxOsSysCallsPtr = std::unique_ptr<LinuxOsSysCalls>;
@@ -72,6 +72,22 @@ public:
 
 using SliceDataPtr = std::unique_ptr<SliceData>;
 
+/**
+ * Owns the memory of data drained from a buffer with Instance::drainRetaining(). The memory is
+ * released when the object is destroyed.
+ */
+class RetainedData {
+public:
+  virtual ~RetainedData() = default;
+
+  /**
+   * @return uint64_t the number of bytes retained.
+   */
+  virtual uint64_t length() const PURE;
+};
+
+using RetainedDataPtr = std::unique_ptr<RetainedData>;
+
 /**
  * A basic buffer abstraction.
  */
@@ -153,6 +169,15 @@ public:
    */
   virtual void drain(uint64_t size) PURE;
 
+  /**
+   * Drain data from the buffer without releasing the memory backing it. This is meant for data
+   * which is still referenced once it has been consumed, such as data handed to the kernel by a
+   * zero copy send. Drain trackers are called as they would be by drain().
+   * @param size supplies the length of data to drain.
+   * @return RetainedDataPtr owning the memory of the drained data.
+   */
+  virtual RetainedDataPtr drainRetaining(uint64_t size) PURE;
+
   /**
    * Fetch the raw buffer slices.
    * @param max_slices supplies an optional limit on the number of slices to fetch, for performance.
@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 
+#include "envoy/common/callback.h"
 #include "envoy/common/scope_tracker.h"
 #include "envoy/common/time.h"
 #include "envoy/event/file_event.h"
@@ -182,6 +183,15 @@ public:
    */
   virtual void deferredDelete(DeferredDeletablePtr&& to_delete) PURE;
 
+  /**
+   * Adds a callback which is run when the dispatcher is destroyed, before the events it owns are,
+   * to release state which is shared by the users of the dispatcher and may otherwise outlive it.
+   * @param callback supplies the callback.
+   * @return Common::CallbackHandle* a handle that can be used to remove the callback before the
+   *         dispatcher is destroyed.
+   */
+  virtual Common::CallbackHandle* addOnDestroyCallback(std::function<void()> callback) PURE;
+
   /**
    * Exits the event loop.
    */
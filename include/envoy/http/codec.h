@@ -386,6 +386,25 @@ struct Http1Settings {
 
   // How header keys should be formatted when serializing HTTP/1.1 headers.
   HeaderKeyFormat header_key_format_{HeaderKeyFormat::Default};
+
+  enum class ParserType {
+    // The nodejs http_parser library.
+    HttpParser,
+    // A parser which scans and validates input with SIMD instructions where available.
+    Simd,
+  };
+
+  // Which parser the codec uses to parse HTTP/1.1 messages.
+  ParserType parser_type_{ParserType::HttpParser};
+
+  // Whether header values which are not split across the slices of the input reference the input
+  // rather than copying it. The input is then retained for as long as the header map is.
+  bool borrow_header_values_{false};
+
+  // Whether the lines of the headers whose values borrow the input are recorded, so that the
+  // headers which are forwarded unmodified to HTTP/1 connections are written out as they were
+  // received. Only takes effect along with borrow_header_values_.
+  bool reuse_raw_header_lines_{false};
 };
 
 /**
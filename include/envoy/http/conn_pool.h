@@ -80,6 +80,13 @@ public:
    */
   virtual Cancellable* newStream(Http::ResponseDecoder& response_decoder,
                                  Callbacks& callbacks) PURE;
+
+  /**
+   * Establish connections ahead of streams, e.g. to warm up a newly added host. No connections are
+   * established past the connection circuit breaker.
+   * @param connections supplies the number of connections to establish.
+   */
+  virtual void prefetchConnections(uint32_t connections) PURE;
 };
 
 using InstancePtr = std::unique_ptr<Instance>;
@@ -80,18 +80,36 @@ using LowerCaseStrPairVector =
  */
 using InlineHeaderVector = absl::InlinedVector<char, 128>;
 
+/**
+ * Keeps alive the memory viewed by a borrowed HeaderString, such as the slices of the buffer a
+ * codec parsed the header from.
+ */
+using HeaderStringStorageSharedPtr = std::shared_ptr<const void>;
+
+/**
+ * A view of memory kept alive by a reference to its storage, used by HeaderString.
+ */
+struct BorrowedHeaderView {
+  absl::string_view view_;
+  HeaderStringStorageSharedPtr storage_;
+  // The encoded header the view was parsed from, if known. It is also kept alive by storage_.
+  absl::string_view raw_header_;
+};
+
 /**
  * Convenient type for the underlying type of HeaderString that allows a variant
- * between string_view and the InlinedVector.
+ * between string_view, the InlinedVector and a borrowed view.
  */
-using VariantHeader = absl::variant<absl::string_view, InlineHeaderVector>;
+using VariantHeader = absl::variant<absl::string_view, InlineHeaderVector, BorrowedHeaderView>;
 
 /**
  * This is a string implementation for use in header processing. It is heavily optimized for
- * performance. It supports 2 different types of storage and can switch between them:
+ * performance. It supports 3 different types of storage and can switch between them:
  * 1) A reference.
  * 2) An InlinedVector (an optimized interned string for small strings, but allows heap
  * allocation if needed).
+ * 3) A borrowed view of memory whose storage is shared with its other users. The view is copied
+ * into an InlinedVector when the string is modified.
  */
 class HeaderString {
 public:
@@ -136,8 +154,8 @@ public:
   }
 
   /**
-   * Trim trailing whitespaces from the HeaderString. Only supported by the "Inline" HeaderString
-   * representation.
+   * Trim trailing whitespaces from the HeaderString. Only supported by the "Inline" and "Borrowed"
+   * HeaderString representations.
    */
   void rtrim();
 
@@ -150,7 +168,7 @@ public:
 
   /**
    * Return the string to a default state. Reference strings are not touched. Both inline/dynamic
-   * strings are reset to zero size.
+   * strings are reset to zero size, and borrowed strings release their storage.
    */
   void clear();
 
@@ -183,11 +201,39 @@ public:
    */
   void setReference(absl::string_view ref_value);
 
+  /**
+   * Set the value of the string to a view of borrowed memory, without copying it.
+   * @param view supplies the value, which MUST point into memory kept alive by storage.
+   * @param storage supplies the reference keeping the viewed memory alive for as long as the
+   *        string is not modified.
+   */
+  void setBorrowed(absl::string_view view, HeaderStringStorageSharedPtr storage);
+
+  /**
+   * Record the encoded header a borrowed string was parsed from, such as an HTTP/1 header line,
+   * so that a codec of the same protocol can write the header out without encoding it again for as
+   * long as the string is not modified.
+   * @param raw_header supplies the encoded header, which MUST point into the memory kept alive by
+   *        the storage of the string.
+   */
+  void setBorrowedRawHeader(absl::string_view raw_header);
+
+  /**
+   * @return the encoded header a borrowed string was parsed from, or an empty view if the string is
+   *         not borrowed or the encoded header is not known.
+   */
+  absl::string_view borrowedRawHeader() const;
+
   /**
    * @return whether the string is a reference or an InlinedVector.
    */
   bool isReference() const { return type() == Type::Reference; }
 
+  /**
+   * @return whether the string is a view of borrowed memory.
+   */
+  bool isBorrowed() const { return type() == Type::Borrowed; }
+
   /**
    * @return the size of the string, not including the null terminator.
    */
@@ -203,7 +249,7 @@ public:
   bool operator!=(absl::string_view rhs) const { return getStringView() != rhs; }
 
 private:
-  enum class Type { Reference, Inline };
+  enum class Type { Reference, Inline, Borrowed };
 
   VariantHeader buffer_;
 
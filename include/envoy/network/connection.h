@@ -301,6 +301,21 @@ public:
    *         occurred an empty string is returned.
    */
   virtual absl::string_view transportFailureReason() const PURE;
+
+  /**
+   * Forwards the data received on this connection and on a peer connection to each other inside
+   * the kernel, with splice(2), instead of handing it to the read filters, which still see the end
+   * of stream. Data already written to either connection is sent ahead of the forwarded data. The
+   * forwarded data counts as read from one connection and written to the other in their stats and
+   * stream info, and runs the bytes sent callbacks. Neither connection may be written to afterwards
+   * other than to end the stream.
+   * @param peer supplies the connection to forward data to and from.
+   * @return bool whether forwarding started. It is not supported by connections whose transport
+   *         socket transforms the data, which have write filters or more than one read filter, so
+   *         that no filter which inspects the data is bypassed, or which are not owned by the same
+   *         dispatcher.
+   */
+  virtual bool startSplice(Connection& peer) PURE;
 };
 
 using ConnectionPtr = std::unique_ptr<Connection>;
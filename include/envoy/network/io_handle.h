@@ -5,6 +5,7 @@
 #include "envoy/api/io_error.h"
 #include "envoy/common/platform.h"
 #include "envoy/common/pure.h"
+#include "envoy/event/file_event.h"
 #include "envoy/network/address.h"
 
 #include "absl/container/fixed_array.h"
@@ -13,8 +14,13 @@
 namespace Envoy {
 namespace Buffer {
 struct RawSlice;
+class Instance;
 } // namespace Buffer
 
+namespace Event {
+class Dispatcher;
+} // namespace Event
+
 using RawSliceArrays = absl::FixedArray<absl::FixedArray<Buffer::RawSlice>>;
 
 namespace Network {
@@ -55,6 +61,16 @@ public:
   virtual Api::IoCallUint64Result readv(uint64_t max_length, Buffer::RawSlice* slices,
                                         uint64_t num_slice) PURE;
 
+  /**
+   * Read data and append it to the buffer. Unlike readv(), this lets the handle hand over memory
+   * it has already read into rather than copy it.
+   * @param buffer supplies the buffer to append to.
+   * @param max_length supplies the maximum length to read.
+   * @return a Api::IoCallUint64Result with err_ = an Api::IoError instance or
+   * err_ = nullptr and rc_ = the bytes read for success.
+   */
+  virtual Api::IoCallUint64Result read(Buffer::Instance& buffer, uint64_t max_length) PURE;
+
   /**
    * Write the data in slices out.
    * @param slices points to the location of data to be written.
@@ -64,6 +80,16 @@ public:
    */
   virtual Api::IoCallUint64Result writev(const Buffer::RawSlice* slices, uint64_t num_slice) PURE;
 
+  /**
+   * Write as much of the buffer out as possible and drain what was written. Unlike writev(), this
+   * hands the buffer itself to the handle, which may hold on to the memory of written data until
+   * the kernel is done with it.
+   * @param buffer supplies the data to write.
+   * @return a Api::IoCallUint64Result with err_ = an Api::IoError instance or
+   * err_ = nullptr and rc_ = the bytes written for success.
+   */
+  virtual Api::IoCallUint64Result write(Buffer::Instance& buffer) PURE;
+
   /**
    * Send a message to the address.
    * @param slices points to the location of data to be sent.
@@ -223,6 +249,33 @@ public:
    * @return peer's address as @ref Address::InstanceConstSharedPtr
    */
   virtual Address::InstanceConstSharedPtr peerAddress() PURE;
+
+  /**
+   * Shut down part of a full-duplex connection (see man 2 shutdown)
+   * @param how the type of shutdown, e.g. ENVOY_SHUT_WR.
+   * @return a Api::SysCallIntResult with rc_ = 0 for success and rc_ = -1 for failure. If the call
+   * is successful, errno_ shouldn't be used.
+   */
+  virtual Api::SysCallIntResult shutdown(int how) PURE;
+
+  /**
+   * Creates a file event that fires when this handle is ready for the given events. Handles which
+   * complete I/O asynchronously (rather than reporting readiness of the underlying descriptor) use
+   * this to deliver their own notifications.
+   * @param dispatcher supplies the dispatcher whose thread will run the callbacks.
+   * @param cb supplies the callback to fire when the handle is ready.
+   * @param trigger specifies whether to edge or level trigger.
+   * @param events supplies a logical OR of FileReadyType events that the file event should
+   *               initially listen on.
+   */
+  virtual Event::FileEventPtr createFileEvent(Event::Dispatcher& dispatcher, Event::FileReadyCb cb,
+                                              Event::FileTriggerType trigger, uint32_t events) PURE;
+
+  /**
+   * @return whether data may be read from or written to the descriptor returned by fd() directly,
+   *         bypassing the handle, e.g. with splice(2) or by a TLS library.
+   */
+  virtual bool allowsDescriptorIo() const PURE;
 };
 
 using IoHandlePtr = std::unique_ptr<IoHandle>;
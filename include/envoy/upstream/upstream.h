@@ -203,6 +203,19 @@ public:
    * @param new_used supplies the new value of host being in use to be stored.
    */
   virtual void used(bool new_used) PURE;
+
+  /**
+   * @return the number of requests outstanding on the host across all workers, i.e. the requests
+   *         queued in or attached to its connection pools. Unlike rq_active, requests count as
+   *         soon as they are handed to a pool, including while connections are established.
+   */
+  virtual uint64_t outstandingRequests() const PURE;
+
+  /**
+   * Adjusts the count returned by outstandingRequests(). Called by connection pools.
+   * @param delta supplies the number of requests queued or attached, negative for completions.
+   */
+  virtual void addOutstandingRequests(int64_t delta) const PURE;
 };
 
 using HostConstSharedPtr = std::shared_ptr<const Host>;
@@ -520,6 +533,7 @@ public:
   COUNTER(assignment_timeout_received)                                                             \
   COUNTER(bind_errors)                                                                             \
   COUNTER(lb_healthy_panic)                                                                        \
+  COUNTER(lb_least_request_above_mean)                                                             \
   COUNTER(lb_local_cluster_not_ok)                                                                 \
   COUNTER(lb_recalculate_zone_structures)                                                          \
   COUNTER(lb_subsets_created)                                                                      \
@@ -558,6 +572,9 @@ public:
   COUNTER(upstream_cx_none_healthy)                                                                \
   COUNTER(upstream_cx_overflow)                                                                    \
   COUNTER(upstream_cx_pool_overflow)                                                               \
+  COUNTER(upstream_cx_prefetch_hit)                                                                \
+  COUNTER(upstream_cx_prefetch_total)                                                              \
+  COUNTER(upstream_cx_prefetch_wasted)                                                             \
   COUNTER(upstream_cx_protocol_error)                                                              \
   COUNTER(upstream_cx_rx_bytes_total)                                                              \
   COUNTER(upstream_cx_total)                                                                       \
@@ -737,6 +754,29 @@ public:
    */
   virtual float prefetchRatio() const PURE;
 
+  /**
+   * @return the maximum number of unused connections per host which connection pools establish
+   *         for predicted demand, or zero if connections are not established for predicted demand.
+   */
+  virtual uint32_t maxPredictedConnections() const PURE;
+
+  /**
+   * @return the half life of the rate of streams from which connection pools predict demand.
+   */
+  virtual std::chrono::milliseconds predictedRateHalfLife() const PURE;
+
+  /**
+   * @return the number of connections per host which connection pools establish when hosts are
+   *         added to the cluster.
+   */
+  virtual uint32_t warmUpConnections() const PURE;
+
+  /**
+   * @return the number of workers which share each HTTP/2 connection pool of the cluster. Values
+   *         of 0 and 1 disable sharing.
+   */
+  virtual uint32_t http2PoolSharingWorkers() const PURE;
+
   /**
    * @return soft limit on size of the cluster's connections read and write buffers.
    */
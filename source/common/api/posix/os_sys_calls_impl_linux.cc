@@ -2,7 +2,9 @@
 #error "Linux platform file is part of non-Linux build."
 #endif
 
+#include <fcntl.h>
 #include <sched.h>
+#include <unistd.h>
 
 #include <cerrno>
 
@@ -17,5 +19,21 @@ SysCallIntResult LinuxOsSysCallsImpl::sched_getaffinity(pid_t pid, size_t cpuset
   return {rc, errno};
 }
 
+SysCallIntResult LinuxOsSysCallsImpl::pipe2(int pipefd[2], int flags) {
+  const int rc = ::pipe2(pipefd, flags);
+  return {rc, errno};
+}
+
+SysCallIntResult LinuxOsSysCallsImpl::fcntl(int fd, int cmd, int arg) {
+  const int rc = ::fcntl(fd, cmd, arg);
+  return {rc, errno};
+}
+
+SysCallSizeResult LinuxOsSysCallsImpl::splice(int fd_in, int fd_out, size_t len,
+                                              unsigned int flags) {
+  const ssize_t rc = ::splice(fd_in, nullptr, fd_out, nullptr, len, flags);
+  return {rc, errno};
+}
+
 } // namespace Api
 } // namespace Envoy
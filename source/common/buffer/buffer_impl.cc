@@ -4,6 +4,7 @@
 #include <string>
 
 #include "common/common/assert.h"
+#include "common/runtime/runtime_features.h"
 
 #include "absl/container/fixed_array.h"
 #include "event2/buffer.h"
@@ -16,6 +17,16 @@ namespace {
 // TODO(yanavlasov): This may not be optimal for all hardware configurations or traffic patterns and
 // may need to be configurable in the future.
 constexpr uint64_t CopyThreshold = 512;
+
+// A part of a slice moved to another buffer shares the storage of the slice only if it is at least
+// 1/MinSharedSliceFraction of the storage, as the shared part keeps all of it alive once the rest
+// has been drained. Smaller parts are copied.
+constexpr uint64_t MinSharedSliceFraction = 4;
+
+bool sharePartialSlice(uint64_t part_size, const Slice& slice) {
+  return part_size >= CopyThreshold && part_size * MinSharedSliceFraction >= slice.storageSize() &&
+         Runtime::runtimeFeatureEnabled("envoy.reloadable_features.buffer_share_partial_slices");
+}
 } // namespace
 
 void OwnedImpl::addImpl(const void* data, uint64_t size) {
@@ -173,6 +184,54 @@ void OwnedImpl::drainImpl(uint64_t size) {
   }
 }
 
+namespace {
+
+class RetainedSlices : public RetainedData {
+public:
+  void add(std::shared_ptr<Slice> slice, uint64_t length) {
+    slices_.emplace_back(std::move(slice));
+    length_ += length;
+  }
+
+  // Buffer::RetainedData
+  uint64_t length() const override { return length_; }
+
+private:
+  std::vector<std::shared_ptr<Slice>> slices_;
+  uint64_t length_{0};
+};
+
+} // namespace
+
+RetainedDataPtr OwnedImpl::drainRetaining(uint64_t size) {
+  auto retained = std::make_unique<RetainedSlices>();
+  while (size != 0 && !slices_.empty()) {
+    const uint64_t slice_size = slices_.front()->dataSize();
+    std::shared_ptr<Slice> slice = std::move(slices_.front());
+    slices_.pop_front();
+    if (slice_size <= size) {
+      // The data is consumed now, even though its memory is released later.
+      slice->callAndClearDrainTrackers();
+      length_ -= slice_size;
+      size -= slice_size;
+      retained->add(std::move(slice), slice_size);
+    } else {
+      // The rest of the slice stays in the buffer, sharing the memory of the retained part.
+      slice->drain(size);
+      auto rest = std::make_unique<SharedSlice>(slice);
+      slice->transferDrainTrackersTo(*rest);
+      slices_.emplace_front(std::move(rest));
+      length_ -= size;
+      retained->add(std::move(slice), size);
+      size = 0;
+    }
+  }
+  while (!slices_.empty() && slices_.front()->dataSize() == 0) {
+    slices_.pop_front();
+  }
+  return retained;
+}
+
 RawSliceVector OwnedImpl::getRawSlices(absl::optional<uint64_t> max_slices) const {
   uint64_t max_out = slices_.size();
   if (max_slices.has_value()) {
@@ -311,12 +370,22 @@ void OwnedImpl::move(Instance& rhs, uint64_t length) {
     const uint64_t copy_size = std::min(slice_size, length);
     if (copy_size == 0) {
       other.slices_.pop_front();
-    } else if (copy_size < slice_size) {
-      // TODO(brian-pane) add reference-counting to allow slices to share their storage
-      // and eliminate the copy for this partial-slice case?
+    } else if (copy_size < slice_size && !sharePartialSlice(copy_size, *other.slices_.front())) {
       add(other.slices_.front()->data(), copy_size);
       other.slices_.front()->drain(copy_size);
       other.length_ -= copy_size;
+    } else if (copy_size < slice_size) {
+      // Rather than copying the moved part of the slice, both buffers share its storage. The drain
+      // trackers stay with the part left in the other buffer, like they would for a copy.
+      std::shared_ptr<Slice> slice = std::move(other.slices_.front());
+      other.slices_.pop_front();
+      auto moved = std::make_unique<SharedSlice>(slice, copy_size);
+      slice->drain(copy_size);
+      auto rest = std::make_unique<SharedSlice>(slice);
+      slice->transferDrainTrackersTo(*rest);
+      other.slices_.emplace_front(std::move(rest));
+      other.length_ -= copy_size;
+      coalesceOrAddSlice(std::move(moved));
     } else {
       coalesceOrAddSlice(std::move(other.slices_.front()));
       other.slices_.pop_front();
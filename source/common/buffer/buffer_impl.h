@@ -8,6 +8,7 @@
 #include "envoy/buffer/buffer.h"
 #include "envoy/network/io_handle.h"
 
+#include "common/buffer/slice_pool.h"
 #include "common/common/assert.h"
 #include "common/common/non_copyable.h"
 #include "common/common/utility.h"
@@ -78,6 +79,11 @@ public:
     }
   }
 
+  /**
+   * @return the size in bytes of the memory kept alive by the slice.
+   */
+  virtual uint64_t storageSize() const { return capacity_; }
+
   /**
    * @return the number of bytes available to be reserve()d.
    * @note Read-only implementations of Slice should return zero from this method.
@@ -257,6 +263,9 @@ using SlicePtr = std::unique_ptr<Slice>;
 // OwnedSlice can not be derived from as it has variable sized array as member.
 class OwnedSlice final : public Slice, public InlineStorage {
 public:
+  // The storage is recycled through the SlicePool.
+  static void operator delete(void* address) { SlicePool::release(address); }
+
   /**
    * Create an empty OwnedSlice.
    * @param capacity number of bytes of space the slice should have.
@@ -283,6 +292,10 @@ public:
   }
 
 private:
+  static void* operator new(size_t object_size, size_t data_size_bytes) {
+    return SlicePool::allocate(object_size + data_size_bytes);
+  }
+
   OwnedSlice(uint64_t size) : Slice(0, 0, size) { base_ = storage_; }
 
   bool isMutable() const override { return true; }
@@ -475,6 +488,32 @@ private:
   BufferFragment& fragment_;
 };
 
+/**
+ * Slice referencing part of the data of another slice, whose memory is shared with the
+ * RetainedData returned by OwnedImpl::drainRetaining() or with the other parts of the slice moved
+ * by OwnedImpl::move().
+ */
+class SharedSlice : public Slice {
+public:
+  SharedSlice(std::shared_ptr<Slice> slice) : SharedSlice(slice, slice->dataSize()) {}
+
+  /**
+   * @param slice supplies the slice whose memory is shared.
+   * @param length supplies the length of the data of slice referenced, from its start.
+   */
+  SharedSlice(std::shared_ptr<Slice> slice, uint64_t length)
+      : Slice(0, length, length), slice_(std::move(slice)) {
+    ASSERT(length <= slice_->dataSize());
+    base_ = slice_->data();
+  }
+
+  // Slice
+  uint64_t storageSize() const override { return slice_->storageSize(); }
+
+private:
+  const std::shared_ptr<Slice> slice_;
+};
+
 /**
  * An implementation of BufferFragment where a releasor callback is called when the data is
  * no longer needed.
@@ -564,6 +603,7 @@ public:
   void commit(RawSlice* iovecs, uint64_t num_iovecs) override;
   void copyOut(size_t start, uint64_t size, void* data) const override;
   void drain(uint64_t size) override;
+  RetainedDataPtr drainRetaining(uint64_t size) override;
   RawSliceVector getRawSlices(absl::optional<uint64_t> max_slices = absl::nullopt) const override;
   SliceDataPtr extractMutableFrontSlice() override;
   uint64_t length() const override;
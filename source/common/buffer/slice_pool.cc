@@ -0,0 +1,222 @@
+#include "common/buffer/slice_pool.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/macros.h"
+#include "common/common/thread.h"
+
+#include "absl/container/flat_hash_set.h"
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer)
+#define ENVOY_SLICE_POOL_SANITIZED
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define ENVOY_SLICE_POOL_SANITIZED
+#endif
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+#ifdef ENVOY_SLICE_POOL_SANITIZED
+// Recycled blocks would hide use after free errors from the sanitizers.
+constexpr uint64_t DefaultMaxRetainedBytesPerThread = 0;
+#else
+constexpr uint64_t DefaultMaxRetainedBytesPerThread = 1024 * 1024;
+#endif
+
+// Precedes every block, so that release() knows which freelist the block belongs to.
+struct alignas(alignof(std::max_align_t)) BlockHeader {
+  // The size of the block in pages, or zero if it is not poolable.
+  uint64_t pages_;
+};
+
+// Overlays a block while it is in a freelist.
+struct FreeBlock {
+  FreeBlock* next_;
+};
+
+std::atomic<uint64_t> max_retained_bytes_per_thread{DefaultMaxRetainedBytesPerThread};
+// Bumped to have every thread empty its freelists.
+std::atomic<uint64_t> release_generation{0};
+
+// Only the owning thread writes the statistics, so they are atomic only to be read by stats().
+void addToStat(std::atomic<uint64_t>& stat, uint64_t delta) {
+  stat.store(stat.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+void subtractFromStat(std::atomic<uint64_t>& stat, uint64_t delta) {
+  stat.store(stat.load(std::memory_order_relaxed) - delta, std::memory_order_relaxed);
+}
+
+class ThreadCache;
+
+// Tracks the caches of all threads for stats().
+struct Registry {
+  Thread::MutexBasicLockable mutex_;
+  absl::flat_hash_set<const ThreadCache*> caches_ ABSL_GUARDED_BY(mutex_);
+  // The statistics of the threads which have exited.
+  uint64_t exited_hits_ ABSL_GUARDED_BY(mutex_){0};
+  uint64_t exited_misses_ ABSL_GUARDED_BY(mutex_){0};
+};
+
+// Leaked, as threads may exit after static destruction.
+Registry& registry() { MUTABLE_CONSTRUCT_ON_FIRST_USE(Registry); }
+
+class ThreadCache {
+public:
+  ThreadCache() : generation_(release_generation.load(std::memory_order_relaxed)) {
+    Registry& registry = Buffer::registry();
+    Thread::LockGuard lock(registry.mutex_);
+    registry.caches_.insert(this);
+  }
+
+  ~ThreadCache();
+
+  void* allocate(uint64_t pages) {
+    checkGeneration();
+    FreeBlock*& head = freelists_[pages];
+    if (head == nullptr) {
+      addToStat(misses_, 1);
+      return nullptr;
+    }
+    FreeBlock* block = head;
+    head = block->next_;
+    addToStat(hits_, 1);
+    subtractFromStat(retained_bytes_, pages * SlicePool::PageSize);
+    return block;
+  }
+
+  bool release(BlockHeader* header) {
+    checkGeneration();
+    const uint64_t pages = header->pages_;
+    const uint64_t bytes = pages * SlicePool::PageSize;
+    if (retained_bytes_.load(std::memory_order_relaxed) + bytes >
+        max_retained_bytes_per_thread.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    FreeBlock* block = new (header) FreeBlock{freelists_[pages]};
+    freelists_[pages] = block;
+    addToStat(retained_bytes_, bytes);
+    return true;
+  }
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> retained_bytes_{0};
+
+private:
+  void checkGeneration() {
+    const uint64_t generation = release_generation.load(std::memory_order_relaxed);
+    if (generation != generation_) {
+      generation_ = generation;
+      freeAll();
+    }
+  }
+
+  void freeAll() {
+    for (FreeBlock*& head : freelists_) {
+      while (head != nullptr) {
+        FreeBlock* block = head;
+        head = block->next_;
+        ::operator delete(block);
+      }
+    }
+    retained_bytes_.store(0, std::memory_order_relaxed);
+  }
+
+  std::array<FreeBlock*, SlicePool::MaxPooledPages + 1> freelists_{};
+  uint64_t generation_;
+};
+
+// Slices may be freed by other thread local objects after the cache is destroyed, in which case
+// they go back to the heap.
+thread_local bool thread_cache_destroyed = false;
+
+ThreadCache::~ThreadCache() {
+  freeAll();
+  thread_cache_destroyed = true;
+  Registry& registry = Buffer::registry();
+  Thread::LockGuard lock(registry.mutex_);
+  registry.exited_hits_ += hits_.load(std::memory_order_relaxed);
+  registry.exited_misses_ += misses_.load(std::memory_order_relaxed);
+  registry.caches_.erase(this);
+}
+
+ThreadCache* threadCache() {
+  if (thread_cache_destroyed) {
+    return nullptr;
+  }
+  thread_local ThreadCache cache;
+  return &cache;
+}
+
+// @return the size of a block in pages if it is poolable, or zero.
+uint64_t poolablePages(uint64_t size) {
+  if (size % SlicePool::PageSize != 0 || size > SlicePool::MaxPooledPages * SlicePool::PageSize) {
+    return 0;
+  }
+  return size / SlicePool::PageSize;
+}
+
+} // namespace
+
+void* SlicePool::allocate(uint64_t size) {
+  const uint64_t pages = poolablePages(size);
+  void* block = nullptr;
+  if (pages != 0) {
+    ThreadCache* cache = threadCache();
+    if (cache != nullptr) {
+      block = cache->allocate(pages);
+    }
+  }
+  if (block == nullptr) {
+    block = ::operator new(sizeof(BlockHeader) + size);
+  }
+  BlockHeader* header = new (block) BlockHeader{pages};
+  return header + 1;
+}
+
+void SlicePool::release(void* address) {
+  BlockHeader* header = static_cast<BlockHeader*>(address) - 1;
+  if (header->pages_ != 0) {
+    ThreadCache* cache = threadCache();
+    if (cache != nullptr && cache->release(header)) {
+      return;
+    }
+  }
+  ::operator delete(header);
+}
+
+void SlicePool::releaseRetained() { release_generation.fetch_add(1, std::memory_order_relaxed); }
+
+void SlicePool::setMaxRetainedBytesPerThread(uint64_t bytes) {
+  max_retained_bytes_per_thread.store(bytes, std::memory_order_relaxed);
+  releaseRetained();
+}
+
+uint64_t SlicePool::maxRetainedBytesPerThread() {
+  return max_retained_bytes_per_thread.load(std::memory_order_relaxed);
+}
+
+SlicePool::Stats SlicePool::stats() {
+  Registry& registry = Buffer::registry();
+  Thread::LockGuard lock(registry.mutex_);
+  Stats stats{registry.exited_hits_, registry.exited_misses_, 0};
+  for (const ThreadCache* cache : registry.caches_) {
+    stats.hits_ += cache->hits_.load(std::memory_order_relaxed);
+    stats.misses_ += cache->misses_.load(std::memory_order_relaxed);
+    stats.retained_bytes_ += cache->retained_bytes_.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+} // namespace Buffer
+} // namespace Envoy
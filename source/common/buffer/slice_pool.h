@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * Per-thread freelists for the page sized blocks which back OwnedSlice, so that the slices created
+ * and freed for every read and write of a connection are recycled instead of going through the
+ * heap each time. There is a freelist for every block size up to MaxPooledPages pages; larger
+ * blocks, and blocks freed once a thread retains maxRetainedBytesPerThread() bytes, go back to the
+ * heap. Blocks may be freed on a different thread than the one which allocated them.
+ */
+class SlicePool {
+public:
+  static constexpr uint64_t PageSize = 4096;
+  // Covers the slices created for reads of 16KiB (5 pages) and for copies of up to 64KiB.
+  static constexpr uint64_t MaxPooledPages = 17;
+
+  struct Stats {
+    // Allocations of a poolable size which were served by a freelist.
+    uint64_t hits_;
+    // Allocations of a poolable size which went to the heap, including while pooling is disabled.
+    uint64_t misses_;
+    // Bytes held by the freelists of all threads.
+    uint64_t retained_bytes_;
+  };
+
+  /**
+   * @param size supplies the number of bytes to allocate.
+   * @return memory aligned for any object, which must be freed with release().
+   */
+  static void* allocate(uint64_t size);
+
+  /**
+   * Returns memory obtained from allocate() to the freelists of the calling thread, or to the heap.
+   * @param address supplies the memory to free.
+   */
+  static void release(void* address);
+
+  /**
+   * Frees the blocks retained by all threads, e.g. when the server is running out of memory. Each
+   * thread empties its freelists the next time it allocates or frees a slice.
+   */
+  static void releaseRetained();
+
+  /**
+   * Bounds the number of bytes each thread retains. Zero disables pooling. Freelists above the new
+   * bound are emptied as with releaseRetained().
+   */
+  static void setMaxRetainedBytesPerThread(uint64_t bytes);
+  static uint64_t maxRetainedBytesPerThread();
+
+  /**
+   * @return the statistics of the freelists of all threads, including the threads which have
+   *         exited.
+   */
+  static Stats stats();
+};
+
+} // namespace Buffer
+} // namespace Envoy
@@ -41,6 +41,12 @@ void WatermarkBuffer::drain(uint64_t size) {
   checkLowWatermark();
 }
 
+RetainedDataPtr WatermarkBuffer::drainRetaining(uint64_t size) {
+  RetainedDataPtr retained = OwnedImpl::drainRetaining(size);
+  checkLowWatermark();
+  return retained;
+}
+
 void WatermarkBuffer::move(Instance& rhs) {
   OwnedImpl::move(rhs);
   checkHighAndOverflowWatermarks();
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#include "common/common/assert.h"
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+
+/**
+ * A fixed capacity bump allocator. Memory is handed out by advancing a cursor through a single
+ * block which is obtained lazily on the first allocation and released in one shot when the arena
+ * is destroyed. Individual allocations are never freed. When the block is exhausted allocate()
+ * returns nullptr and the caller is expected to fall back to the heap; such events are counted so
+ * that the capacity can be tuned.
+ *
+ * An arena with a capacity of zero is disabled and never allocates.
+ */
+class Arena : NonCopyable {
+public:
+  explicit Arena(uint64_t capacity) : capacity_(capacity) {}
+
+  /**
+   * Allocates storage aligned to alignof(std::max_align_t).
+   * @param size supplies the size of the request in bytes.
+   * @return void* the storage, or nullptr if the arena does not have room for the request.
+   */
+  void* allocate(size_t size) {
+    if (capacity_ == 0) {
+      return nullptr;
+    }
+
+    size = roundUp(size);
+    if (size > capacity_ - used_) {
+      overflows_++;
+      return nullptr;
+    }
+    if (block_ == nullptr) {
+      // Array new of char is suitably aligned for any fundamental type that fits in the block.
+      block_.reset(new char[capacity_]);
+    }
+    void* storage = block_.get() + used_;
+    used_ += size;
+    return storage;
+  }
+
+  /**
+   * @return uint64_t the capacity of the arena in bytes.
+   */
+  uint64_t capacity() const { return capacity_; }
+
+  /**
+   * @return uint64_t the number of bytes handed out by the arena.
+   */
+  uint64_t bytesUsed() const { return used_; }
+
+  /**
+   * @return uint64_t the number of allocations that did not fit in the arena.
+   */
+  uint64_t overflows() const { return overflows_; }
+
+  static constexpr size_t roundUp(size_t size) {
+    return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+  }
+
+private:
+  const uint64_t capacity_;
+  uint64_t used_{};
+  uint64_t overflows_{};
+  std::unique_ptr<char[]> block_;
+};
+
+/**
+ * Mixin for objects which may be placed in an Arena while still being owned and destroyed through
+ * a plain std::unique_ptr. Each allocation is prefixed with a small header recording whether the
+ * object lives in an arena; deleting an arena resident object runs its destructor but leaves the
+ * memory to be reclaimed with the arena, while objects which overflowed the arena (or were created
+ * without one) are returned to the heap as usual.
+ *
+ * Objects placed in an arena must be destroyed before the arena itself.
+ */
+class ArenaAllocated {
+public:
+  static void* operator new(size_t size, Arena* arena) {
+    void* storage = arena != nullptr ? arena->allocate(HeaderSize + size) : nullptr;
+    const bool in_arena = storage != nullptr;
+    if (!in_arena) {
+      storage = ::operator new(HeaderSize + size);
+    }
+    *static_cast<bool*>(storage) = in_arena;
+    return static_cast<char*>(storage) + HeaderSize;
+  }
+  static void* operator new(size_t size) { return operator new(size, nullptr); }
+
+  static void operator delete(void* p) {
+    void* storage = static_cast<char*>(p) - HeaderSize;
+    if (!*static_cast<bool*>(storage)) {
+      ::operator delete(storage);
+    }
+  }
+  // Called if the constructor of an arena placed object throws.
+  static void operator delete(void* p, Arena*) { operator delete(p); }
+
+  /**
+   * @param object supplies the address of an object allocated by these operators, which for
+   *        objects with several bases is that of the most derived object, e.g. as obtained by
+   *        dynamic_cast<const void*>.
+   * @return bool whether the object was placed in an arena rather than on the heap.
+   */
+  static bool inArena(const void* object) {
+    return *reinterpret_cast<const bool*>(static_cast<const char*>(object) - HeaderSize);
+  }
+
+private:
+  static constexpr size_t HeaderSize = Arena::roundUp(sizeof(bool));
+};
+
+} // namespace Envoy
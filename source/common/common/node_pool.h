@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "common/common/assert.h"
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+
+/**
+ * A slab pool for fixed size nodes, intended to back node based STL containers (e.g. std::list)
+ * that are built and torn down at high rates. Rather than paying one heap allocation per node,
+ * nodes are carved out of contiguous blocks which grow geometrically, and released nodes are
+ * recycled through an intrusive free list. All blocks are returned to the heap in one shot when
+ * the pool is destroyed, so the pool must outlive every container that allocates from it.
+ *
+ * The node size is latched by the first allocation. Requests of any other size (or for more than
+ * one node) are passed through to the global heap, which keeps the pool correct for containers
+ * that allocate auxiliary structures of a different type.
+ *
+ * The pool is not thread safe; it is meant to be owned by a single container instance.
+ */
+class NodePool : NonCopyable {
+public:
+  /**
+   * @param initial_block_nodes supplies the number of nodes in the first block. Each subsequent
+   *        block doubles in size up to max_block_nodes.
+   * @param max_block_nodes supplies the maximum number of nodes in a single block.
+   */
+  explicit NodePool(uint32_t initial_block_nodes = 4, uint32_t max_block_nodes = 64)
+      : next_block_nodes_(initial_block_nodes), max_block_nodes_(max_block_nodes) {
+    ASSERT(initial_block_nodes > 0 && initial_block_nodes <= max_block_nodes);
+  }
+
+  ~NodePool() {
+    while (blocks_ != nullptr) {
+      Block* next = blocks_->next_;
+      ::operator delete(blocks_);
+      blocks_ = next;
+    }
+  }
+
+  /**
+   * Allocates storage for a single node of the given size.
+   * @param size supplies the size of the request in bytes.
+   * @return void* storage aligned to alignof(std::max_align_t).
+   */
+  void* allocate(size_t size) {
+    if (node_size_ == 0) {
+      node_size_ = roundUp(std::max(size, sizeof(FreeNode)));
+    }
+    if (!pooled(size)) {
+      return ::operator new(size);
+    }
+
+    if (free_list_ != nullptr) {
+      FreeNode* node = free_list_;
+      free_list_ = node->next_;
+      return node;
+    }
+
+    if (cursor_ == end_) {
+      newBlock();
+    }
+    void* node = cursor_;
+    cursor_ += node_size_;
+    return node;
+  }
+
+  /**
+   * Returns storage previously obtained from allocate() with the same size.
+   */
+  void deallocate(void* p, size_t size) {
+    if (!pooled(size)) {
+      ::operator delete(p);
+      return;
+    }
+
+    FreeNode* node = static_cast<FreeNode*>(p);
+    node->next_ = free_list_;
+    free_list_ = node;
+  }
+
+  /**
+   * @return uint64_t the number of blocks that have been obtained from the heap.
+   */
+  uint64_t blocks() const { return num_blocks_; }
+
+  /**
+   * @return uint64_t the number of bytes held in blocks, whether in use or free.
+   */
+  uint64_t reservedBytes() const { return reserved_bytes_; }
+
+private:
+  struct FreeNode {
+    FreeNode* next_;
+  };
+
+  struct Block {
+    Block* next_;
+  };
+
+  static constexpr size_t roundUp(size_t size) {
+    return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+  }
+
+  bool pooled(size_t size) const { return roundUp(std::max(size, sizeof(FreeNode))) == node_size_; }
+
+  void newBlock() {
+    const size_t header_size = roundUp(sizeof(Block));
+    const size_t bytes = header_size + next_block_nodes_ * node_size_;
+    Block* block = static_cast<Block*>(::operator new(bytes));
+    block->next_ = blocks_;
+    blocks_ = block;
+    cursor_ = reinterpret_cast<char*>(block) + header_size;
+    end_ = cursor_ + next_block_nodes_ * node_size_;
+
+    num_blocks_++;
+    reserved_bytes_ += bytes;
+    next_block_nodes_ = std::min(next_block_nodes_ * 2, max_block_nodes_);
+  }
+
+  size_t node_size_{};
+  uint32_t next_block_nodes_;
+  const uint32_t max_block_nodes_;
+  Block* blocks_{};
+  FreeNode* free_list_{};
+  char* cursor_{};
+  char* end_{};
+  uint64_t num_blocks_{};
+  uint64_t reserved_bytes_{};
+};
+
+/**
+ * STL allocator adapter that allocates from a NodePool. Copies (including rebound copies) share
+ * the same pool, so a container using this allocator must not outlive the pool.
+ */
+template <class T> class NodePoolAllocator {
+public:
+  using value_type = T;
+
+  explicit NodePoolAllocator(NodePool& pool) : pool_(&pool) {}
+  template <class U> NodePoolAllocator(const NodePoolAllocator<U>& other) : pool_(other.pool_) {}
+
+  T* allocate(size_t n) {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+    return static_cast<T*>(pool_->allocate(n * sizeof(T)));
+  }
+  void deallocate(T* p, size_t n) { pool_->deallocate(p, n * sizeof(T)); }
+
+  template <class U> bool operator==(const NodePoolAllocator<U>& other) const {
+    return pool_ == other.pool_;
+  }
+  template <class U> bool operator!=(const NodePoolAllocator<U>& other) const {
+    return pool_ != other.pool_;
+  }
+
+private:
+  template <class U> friend class NodePoolAllocator;
+
+  NodePool* pool_;
+};
+
+} // namespace Envoy
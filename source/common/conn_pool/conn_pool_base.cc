@@ -1,5 +1,7 @@
 #include "common/conn_pool/conn_pool_base.h"
 
+#include <cmath>
+
 #include "common/common/assert.h"
 #include "common/network/transport_socket_options_impl.h"
 #include "common/runtime/runtime_features.h"
@@ -9,6 +11,12 @@
 namespace Envoy {
 namespace ConnectionPool {
 
+namespace {
+// The number of released pending streams each pool keeps for reuse, which bounds the memory held
+// after bursts of pending streams.
+constexpr size_t MaxReleasedPendingRequests = 128;
+} // namespace
+
 ConnPoolImplBase::ConnPoolImplBase(
     Upstream::HostConstSharedPtr host, Upstream::ResourcePriority priority,
     Event::Dispatcher& dispatcher, const Network::ConnectionSocket::OptionsSharedPtr& options,
@@ -83,18 +91,95 @@ bool ConnPoolImplBase::tryCreateNewConnection() {
   // prevent pending streams being queued to this upstream with no way to be processed.
   if (can_create_connection ||
       (ready_clients_.empty() && busy_clients_.empty() && connecting_clients_.empty())) {
-    ENVOY_LOG(debug, "creating a new connection");
-    ActiveClientPtr client = instantiateActiveClient();
-    ASSERT(client->state_ == ActiveClient::State::CONNECTING);
-    ASSERT(std::numeric_limits<uint64_t>::max() - connecting_stream_capacity_ >=
-           client->effectiveConcurrentRequestLimit());
-    ASSERT(client->real_host_description_);
-    connecting_stream_capacity_ += client->effectiveConcurrentRequestLimit();
-    LinkedList::moveIntoList(std::move(client), owningList(client->state_));
+    createNewConnection(false);
   }
   return can_create_connection;
 }
 
+void ConnPoolImplBase::createNewConnection(bool prefetched) {
+  ENVOY_LOG(debug, "creating a new connection");
+  ActiveClientPtr client = instantiateActiveClient();
+  ASSERT(client->state_ == ActiveClient::State::CONNECTING);
+  ASSERT(std::numeric_limits<uint64_t>::max() - connecting_stream_capacity_ >=
+         client->effectiveConcurrentRequestLimit());
+  ASSERT(client->real_host_description_);
+  connecting_stream_capacity_ += client->effectiveConcurrentRequestLimit();
+  if (prefetched) {
+    client->prefetched_ = true;
+    unused_prefetched_connections_++;
+    host_->cluster().stats().upstream_cx_prefetch_total_.inc();
+  }
+  LinkedList::moveIntoList(std::move(client), owningList(client->state_));
+}
+
+void ConnPoolImplBase::prefetchConnectionsImpl(uint32_t connections) {
+  // Unlike connections for pending streams, prefetched connections are never created past the
+  // circuit breakers.
+  for (uint32_t i = 0; i < connections; ++i) {
+    if (!host_->cluster().resourceManager(priority_).connections().canCreate()) {
+      host_->cluster().stats().upstream_cx_overflow_.inc();
+      return;
+    }
+    createNewConnection(true);
+  }
+}
+
+void ConnPoolImplBase::tryCreatePredictedConnections() {
+  const uint32_t max_connections = host_->cluster().maxPredictedConnections();
+  // Draining pools should not get new connections.
+  if (max_connections == 0 || !drained_callbacks_.empty()) {
+    return;
+  }
+
+  const uint64_t predicted_streams = std::ceil(predictedStreams());
+  while (unused_prefetched_connections_ < max_connections &&
+         spareStreamCapacity(predicted_streams) < predicted_streams) {
+    if (!host_->cluster().resourceManager(priority_).connections().canCreate()) {
+      return;
+    }
+    createNewConnection(true);
+  }
+}
+
+void ConnPoolImplBase::recordStreamForPrediction() {
+  if (host_->cluster().maxPredictedConnections() == 0) {
+    return;
+  }
+  const MonotonicTime now = dispatcher_.timeSource().monotonicTime();
+  recent_streams_ = recentStreams(now) + 1;
+  recent_streams_time_ = now;
+}
+
+double ConnPoolImplBase::recentStreams(MonotonicTime now) const {
+  const double half_life_ms = host_->cluster().predictedRateHalfLife().count();
+  const double elapsed_ms =
+      std::chrono::duration<double, std::milli>(now - recent_streams_time_).count();
+  return recent_streams_ * std::exp2(-elapsed_ms / half_life_ms);
+}
+
+double ConnPoolImplBase::predictedStreams() const {
+  if (!connect_time_ms_.has_value()) {
+    return 0;
+  }
+  // With a count of events decayed by half every half life, the rate of the events is the count
+  // times ln(2) / half life.
+  const double half_life_ms = host_->cluster().predictedRateHalfLife().count();
+  const double rate_per_ms =
+      recentStreams(dispatcher_.timeSource().monotonicTime()) * std::log(2.0) / half_life_ms;
+  return rate_per_ms * connect_time_ms_.value();
+}
+
+uint64_t ConnPoolImplBase::spareStreamCapacity(uint64_t limit) const {
+  uint64_t spare = connecting_stream_capacity_ > pending_streams_.size()
+                       ? connecting_stream_capacity_ - pending_streams_.size()
+                       : 0;
+  for (auto it = ready_clients_.begin(); it != ready_clients_.end() && spare < limit; ++it) {
+    const ActiveClient& client = **it;
+    spare += std::min(limit, client.effectiveConcurrentRequestLimit() - client.numActiveRequests());
+  }
+  return std::min(spare, limit);
+}
+
 void ConnPoolImplBase::attachRequestToClient(Envoy::ConnectionPool::ActiveClient& client,
                                              AttachContext& context) {
   ASSERT(client.state_ == Envoy::ConnectionPool::ActiveClient::State::READY);
@@ -117,9 +202,16 @@ void ConnPoolImplBase::attachRequestToClient(Envoy::ConnectionPool::ActiveClient
       transitionActiveClientState(client, Envoy::ConnectionPool::ActiveClient::State::BUSY);
     }
 
+    if (client.prefetched_) {
+      client.prefetched_ = false;
+      unused_prefetched_connections_--;
+      host_->cluster().stats().upstream_cx_prefetch_hit_.inc();
+    }
+
     num_active_streams_++;
     host_->stats().rq_total_.inc();
     host_->stats().rq_active_.inc();
+    host_->addOutstandingRequests(1);
     host_->cluster().stats().upstream_rq_total_.inc();
     host_->cluster().stats().upstream_rq_active_.inc();
     host_->cluster().resourceManager(priority_).requests().inc();
@@ -134,6 +226,7 @@ void ConnPoolImplBase::onRequestClosed(Envoy::ConnectionPool::ActiveClient& clie
   ASSERT(num_active_streams_ > 0);
   num_active_streams_--;
   host_->stats().rq_active_.dec();
+  host_->addOutstandingRequests(-1);
   host_->cluster().stats().upstream_rq_active_.dec();
   host_->cluster().resourceManager(priority_).requests().dec();
   if (client.state_ == ActiveClient::State::DRAINING && client.numActiveRequests() == 0) {
@@ -151,6 +244,8 @@ void ConnPoolImplBase::onRequestClosed(Envoy::ConnectionPool::ActiveClient& clie
 }
 
 ConnectionPool::Cancellable* ConnPoolImplBase::newStream(AttachContext& context) {
+  recordStreamForPrediction();
+
   if (!ready_clients_.empty()) {
     ActiveClient& client = *ready_clients_.front();
     ENVOY_CONN_LOG(debug, "using existing connection", client);
@@ -158,6 +253,7 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStream(AttachContext& context)
     // Even if there's a ready client, we may want to prefetch a new connection
     // to handle the next incoming stream.
     tryCreateNewConnections();
+    tryCreatePredictedConnections();
     return nullptr;
   }
 
@@ -167,6 +263,7 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStream(AttachContext& context)
     // This must come after newPendingRequest() because this function uses the
     // length of pending_streams_ to determine if a new connection is needed.
     tryCreateNewConnections();
+    tryCreatePredictedConnections();
 
     return pending;
   } else {
@@ -183,8 +280,9 @@ void ConnPoolImplBase::onUpstreamReady() {
     ActiveClientPtr& client = ready_clients_.front();
     ENVOY_CONN_LOG(debug, "attaching to next stream", *client);
     // Pending streams are pushed onto the front, so pull from the back.
-    attachRequestToClient(*client, pending_streams_.back()->context());
-    pending_streams_.pop_back();
+    PendingRequest& stream = *pending_streams_.back();
+    attachRequestToClient(*client, stream.context());
+    releasePendingRequest(stream, pending_streams_);
   }
 }
 
@@ -292,6 +390,12 @@ void ConnPoolImplBase::onConnectionEvent(ActiveClient& client, absl::string_view
     // The client died.
     ENVOY_CONN_LOG(debug, "client disconnected, failure reason: {}", client, failure_reason);
 
+    if (client.prefetched_) {
+      client.prefetched_ = false;
+      unused_prefetched_connections_--;
+      host_->cluster().stats().upstream_cx_prefetch_wasted_.inc();
+    }
+
     Envoy::Upstream::reportUpstreamCxDestroy(host_, event);
     const bool incomplete_stream = client.closingWithIncompleteRequest();
     if (incomplete_stream) {
@@ -341,6 +445,10 @@ void ConnPoolImplBase::onConnectionEvent(ActiveClient& client, absl::string_view
       tryCreateNewConnections();
     }
   } else if (event == Network::ConnectionEvent::Connected) {
+    const double connect_time_ms = client.conn_connect_ms_->elapsed().count();
+    connect_time_ms_ = connect_time_ms_.has_value()
+                           ? 0.8 * connect_time_ms_.value() + 0.2 * connect_time_ms
+                           : connect_time_ms;
     client.conn_connect_ms_->complete();
     client.conn_connect_ms_.reset();
 
@@ -357,15 +465,29 @@ void ConnPoolImplBase::onConnectionEvent(ActiveClient& client, absl::string_view
   }
 }
 
-PendingRequest::PendingRequest(ConnPoolImplBase& parent) : parent_(parent) {
+PendingRequest::PendingRequest(ConnPoolImplBase& parent) : parent_(parent) { onQueued(); }
+
+PendingRequest::~PendingRequest() {
+  if (queued_) {
+    onDequeued();
+  }
+}
+
+void PendingRequest::onQueued() {
+  ASSERT(!queued_);
+  queued_ = true;
   parent_.host()->cluster().stats().upstream_rq_pending_total_.inc();
   parent_.host()->cluster().stats().upstream_rq_pending_active_.inc();
   parent_.host()->cluster().resourceManager(parent_.priority()).pendingRequests().inc();
+  parent_.host()->addOutstandingRequests(1);
 }
 
-PendingRequest::~PendingRequest() {
+void PendingRequest::onDequeued() {
+  ASSERT(queued_);
+  queued_ = false;
   parent_.host()->cluster().stats().upstream_rq_pending_active_.dec();
   parent_.host()->cluster().resourceManager(parent_.priority()).pendingRequests().dec();
+  parent_.host()->addOutstandingRequests(-1);
 }
 
 void PendingRequest::cancel(Envoy::ConnectionPool::CancelPolicy policy) {
@@ -386,6 +508,26 @@ void ConnPoolImplBase::purgePendingRequests(
   }
 }
 
+PendingRequest* ConnPoolImplBase::reusePendingRequest() {
+  if (released_pending_streams_.empty()) {
+    return nullptr;
+  }
+  PendingRequest& stream = *released_pending_streams_.front();
+  stream.moveBetweenLists(released_pending_streams_, pending_streams_);
+  stream.onQueued();
+  return &stream;
+}
+
+void ConnPoolImplBase::releasePendingRequest(PendingRequest& stream,
+                                             std::list<PendingRequestPtr>& list) {
+  stream.onDequeued();
+  if (released_pending_streams_.size() < MaxReleasedPendingRequests) {
+    stream.moveBetweenLists(list, released_pending_streams_);
+  } else {
+    stream.removeFromList(list);
+  }
+}
+
 bool ConnPoolImplBase::connectingConnectionIsExcess() const {
   ASSERT(connecting_stream_capacity_ >=
          connecting_clients_.front()->effectiveConcurrentRequestLimit());
@@ -409,9 +551,9 @@ void ConnPoolImplBase::onPendingRequestCancel(PendingRequest& stream,
     // with-in a onPoolFailure callback invoked in purgePendingRequests (i.e. purgePendingRequests
     // is down in the call stack). Remove this stream from the list as it is cancelled,
     // and there is no need to call its onPoolFailure callback.
-    stream.removeFromList(pending_streams_to_purge_);
+    releasePendingRequest(stream, pending_streams_to_purge_);
   } else {
-    stream.removeFromList(pending_streams_);
+    releasePendingRequest(stream, pending_streams_);
   }
   if (policy == Envoy::ConnectionPool::CancelPolicy::CloseExcess && !connecting_clients_.empty() &&
       connectingConnectionIsExcess()) {
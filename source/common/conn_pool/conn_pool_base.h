@@ -8,6 +8,7 @@
 #include "common/common/linked_object.h"
 
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace ConnectionPool {
@@ -76,6 +77,8 @@ public:
   Event::TimerPtr connect_timer_;
   bool resources_released_{false};
   bool timed_out_{false};
+  // Set for connections established ahead of streams until they serve a stream.
+  bool prefetched_{false};
 };
 
 // TODO(alyssawilk) renames for Request classes and functions -> Stream classes and functions.
@@ -92,7 +95,15 @@ public:
   // which will be passed back to the parent in onPoolReady or onPoolFailure.
   virtual AttachContext& context() PURE;
 
+  // Accounts for the stream in the pending stream stats and resources of the pool. This is done on
+  // construction, and again each time the stream is reused.
+  void onQueued();
+  // Releases the stats and resources accounted for by onQueued(), once the stream is attached,
+  // failed or cancelled.
+  void onDequeued();
+
   ConnPoolImplBase& parent_;
+  bool queued_{false};
 };
 
 using PendingRequestPtr = std::unique_ptr<PendingRequest>;
@@ -116,6 +127,7 @@ public:
 
   void addDrainedCallbackImpl(Instance::DrainedCb cb);
   void drainConnectionsImpl();
+  void prefetchConnectionsImpl(uint32_t connections);
 
   // Closes and destroys all connections. This must be called in the destructor of
   // derived classes because the derived ActiveClient will downcast parent_ to a more
@@ -129,6 +141,14 @@ public:
   // Gets a pointer to the list that currently owns this client.
   std::list<ActiveClientPtr>& owningList(ActiveClient::State state);
 
+  // Moves a released PendingRequest onto the front of pending_streams_ for reuse, or returns
+  // nullptr if there is none. The caller sets the context of the stream.
+  PendingRequest* reusePendingRequest();
+
+  // Removes the PendingRequest from list, keeping it and its list node for reuse by a later
+  // pending stream unless enough are kept already.
+  void releasePendingRequest(PendingRequest& stream, std::list<PendingRequestPtr>& list);
+
   // Removes the PendingRequest from the list of streams. Called when the PendingRequest is
   // cancelled, e.g. when the stream is reset before a connection has been established.
   void onPendingRequestCancel(PendingRequest& stream, Envoy::ConnectionPool::CancelPolicy policy);
@@ -188,6 +208,26 @@ protected:
 
   float prefetchRatio() const;
 
+  // Creates connections for the streams predicted from the recent rate of streams, if the cluster
+  // configures predictive prefetching. Connections are only created while there is not enough spare
+  // capacity for the streams expected while a connection is established.
+  void tryCreatePredictedConnections();
+
+  // Updates the decaying count of recent streams on which predictions are based.
+  void recordStreamForPrediction();
+
+  // Returns the decaying count of recent streams as of now.
+  double recentStreams(MonotonicTime now) const;
+
+  // Returns the number of streams expected to arrive while a connection is established.
+  double predictedStreams() const;
+
+  // Returns the number of streams which can be served without new connections, up to limit.
+  uint64_t spareStreamCapacity(uint64_t limit) const;
+
+  // Creates a new connection, which is marked as prefetched if it is not created for a stream.
+  void createNewConnection(bool prefetched);
+
   const Upstream::HostConstSharedPtr host_;
   const Upstream::ResourcePriority priority_;
 
@@ -202,6 +242,11 @@ protected:
   // to purge. We need this if one cancelled streams cancels a different pending stream
   std::list<PendingRequestPtr> pending_streams_to_purge_;
 
+  // Pending streams which are done, kept with their list nodes so that queueing streams and
+  // attaching them to clients allocates nothing in steady state. Clients are moved between the
+  // lists below by splicing, which does not allocate either.
+  std::list<PendingRequestPtr> released_pending_streams_;
+
   // Clients that are ready to handle additional streams.
   // All entries are in state READY.
   std::list<ActiveClientPtr> ready_clients_;
@@ -218,6 +263,17 @@ protected:
   // The number of streams that can be immediately dispatched
   // if all CONNECTING connections become connected.
   uint64_t connecting_stream_capacity_{0};
+
+  // The number of prefetched connections which have yet to serve a stream.
+  uint32_t unused_prefetched_connections_{0};
+
+  // The count of streams, decayed with the cluster's predicted rate half life, as of
+  // recent_streams_time_.
+  double recent_streams_{0};
+  MonotonicTime recent_streams_time_;
+
+  // Moving average of the time taken to establish connections, if any connection was established.
+  absl::optional<double> connect_time_ms_;
 };
 
 } // namespace ConnectionPool
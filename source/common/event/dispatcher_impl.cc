@@ -51,7 +51,10 @@ DispatcherImpl::DispatcherImpl(const std::string& name, Buffer::WatermarkFactory
       std::bind(&DispatcherImpl::updateApproximateMonotonicTime, this));
 }
 
-DispatcherImpl::~DispatcherImpl() { FatalErrorHandler::removeFatalErrorHandler(*this); }
+DispatcherImpl::~DispatcherImpl() {
+  on_destroy_callbacks_.runCallbacks();
+  FatalErrorHandler::removeFatalErrorHandler(*this);
+}
 
 void DispatcherImpl::initializeStats(Stats::Scope& scope,
                                      const absl::optional<std::string>& prefix) {
@@ -173,6 +176,11 @@ void DispatcherImpl::deferredDelete(DeferredDeletablePtr&& to_delete) {
   }
 }
 
+Common::CallbackHandle* DispatcherImpl::addOnDestroyCallback(std::function<void()> callback) {
+  ASSERT(isThreadSafe());
+  return on_destroy_callbacks_.add(callback);
+}
+
 void DispatcherImpl::exit() { base_scheduler_.loopExit(); }
 
 SignalEventPtr DispatcherImpl::listenForSignal(int signal_num, SignalCb cb) {
@@ -14,6 +14,7 @@
 #include "envoy/network/connection_handler.h"
 #include "envoy/stats/scope.h"
 
+#include "common/common/callback_impl.h"
 #include "common/common/logger.h"
 #include "common/common/thread.h"
 #include "common/event/libevent.h"
@@ -67,6 +68,7 @@ public:
   TimerPtr createTimer(TimerCb cb) override;
   Event::SchedulableCallbackPtr createSchedulableCallback(std::function<void()> cb) override;
   void deferredDelete(DeferredDeletablePtr&& to_delete) override;
+  Common::CallbackHandle* addOnDestroyCallback(std::function<void()> callback) override;
   void exit() override;
   SignalEventPtr listenForSignal(int signal_num, SignalCb cb) override;
   void post(std::function<void()> callback) override;
@@ -120,6 +122,7 @@ private:
   std::list<std::function<void()>> post_callbacks_ ABSL_GUARDED_BY(post_lock_);
   const ScopeTrackedObject* current_object_{};
   bool deferred_deleting_{};
+  Common::CallbackManager<> on_destroy_callbacks_;
   MonotonicTime approximate_monotonic_time_;
 };
 
@@ -1,5 +1,6 @@
 #include "common/http/conn_manager_impl.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <list>
@@ -53,6 +54,14 @@ namespace Http {
 
 namespace {
 
+// Runtime key for the capacity in bytes of the per-stream arena holding the filter wrappers. Zero
+// (the default) disables the arena.
+constexpr absl::string_view FilterWrapperArenaBytesRuntimeKey =
+    "http_connection_manager.filter_wrapper_arena_bytes";
+// The arena is allocated for every stream, so its capacity is capped well above what the filter
+// chain wrappers of a long chain use.
+constexpr uint64_t MaxFilterWrapperArenaBytes = 64 * 1024;
+
 template <class T> using FilterList = std::list<std::unique_ptr<T>>;
 
 // Shared helper for recording the latest filter used.
@@ -519,6 +528,9 @@ void ConnectionManagerImpl::RdsRouteConfigUpdateRequester::requestRouteConfigUpd
 ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connection_manager,
                                                   uint32_t buffer_limit)
     : connection_manager_(connection_manager),
+      arena_(std::min(
+          connection_manager_.runtime_.snapshot().getInteger(FilterWrapperArenaBytesRuntimeKey, 0),
+          MaxFilterWrapperArenaBytes)),
       filter_manager_(*this, *this, buffer_limit, connection_manager_.config_.filterFactory(),
                       connection_manager_.config_.localReply(),
                       connection_manager_.codec_->protocol(), connection_manager_.timeSource(),
@@ -641,6 +653,12 @@ ConnectionManagerImpl::ActiveStream::~ActiveStream() {
   }
 
   connection_manager_.stats_.named_.downstream_rq_active_.dec();
+  if (arena_.capacity() > 0) {
+    connection_manager_.stats_.named_.downstream_rq_filter_wrapper_arena_bytes_.recordValue(
+        arena_.bytesUsed());
+    connection_manager_.stats_.named_.downstream_rq_filter_wrapper_arena_overflow_.add(
+        arena_.overflows());
+  }
   if (filter_manager_.streamInfo().healthCheck()) {
     connection_manager_.config_.tracingStats().health_check_.inc();
   }
@@ -709,7 +727,8 @@ void ConnectionManagerImpl::ActiveStream::onStreamMaxDurationReached() {
 
 void ConnectionManagerImpl::FilterManager::addStreamDecoderFilterWorker(
     StreamDecoderFilterSharedPtr filter, bool dual_filter) {
-  ActiveStreamDecoderFilterPtr wrapper(new ActiveStreamDecoderFilter(*this, filter, dual_filter));
+  ActiveStreamDecoderFilterPtr wrapper(
+      new (&active_stream_.arena_) ActiveStreamDecoderFilter(*this, filter, dual_filter));
   filter->setDecoderFilterCallbacks(*wrapper);
   // Note: configured decoder filters are appended to decoder_filters_.
   // This means that if filters are configured in the following order (assume all three filters are
@@ -724,7 +743,8 @@ void ConnectionManagerImpl::FilterManager::addStreamDecoderFilterWorker(
 
 void ConnectionManagerImpl::FilterManager::addStreamEncoderFilterWorker(
     StreamEncoderFilterSharedPtr filter, bool dual_filter) {
-  ActiveStreamEncoderFilterPtr wrapper(new ActiveStreamEncoderFilter(*this, filter, dual_filter));
+  ActiveStreamEncoderFilterPtr wrapper(
+      new (&active_stream_.arena_) ActiveStreamEncoderFilter(*this, filter, dual_filter));
   filter->setEncoderFilterCallbacks(*wrapper);
   // Note: configured encoder filters are prepended to encoder_filters_.
   // This means that if filters are configured in the following order (assume all three filters are
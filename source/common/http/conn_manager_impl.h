@@ -34,6 +34,7 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/buffer/watermark_buffer.h"
+#include "common/common/arena.h"
 #include "common/common/dump_state_utils.h"
 #include "common/common/linked_object.h"
 #include "common/grpc/common.h"
@@ -114,7 +115,7 @@ private:
   /**
    * Base class wrapper for both stream encoder and decoder filters.
    */
-  struct ActiveStreamFilterBase : public virtual StreamFilterCallbacks {
+  struct ActiveStreamFilterBase : public ArenaAllocated, public virtual StreamFilterCallbacks {
     ActiveStreamFilterBase(FilterManager& parent, bool dual_filter)
         : parent_(parent), iteration_state_(IterationState::Continue),
           iterate_from_current_filter_(false), headers_continued_(false),
@@ -963,6 +964,9 @@ private:
     }
 
     ConnectionManagerImpl& connection_manager_;
+    // Per-stream arena for the filter chain wrappers. This must be declared before (and thus
+    // destroyed after) the filter manager which owns the objects placed in it.
+    Arena arena_;
     FilterManager filter_manager_;
     Router::ConfigConstSharedPtr snapped_route_config_;
     Router::ScopedConfigConstSharedPtr snapped_scoped_routes_config_;
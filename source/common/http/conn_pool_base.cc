@@ -69,6 +69,11 @@ HttpConnPoolImplBase::newPendingRequest(Envoy::ConnectionPool::AttachContext& co
   Http::ResponseDecoder& decoder = *typedContext<HttpAttachContext>(context).decoder_;
   Http::ConnectionPool::Callbacks& callbacks = *typedContext<HttpAttachContext>(context).callbacks_;
   ENVOY_LOG(debug, "queueing stream due to no available connections");
+  auto* reused = static_cast<HttpPendingRequest*>(reusePendingRequest());
+  if (reused != nullptr) {
+    reused->context_ = HttpAttachContext(&decoder, &callbacks);
+    return reused;
+  }
   Envoy::ConnectionPool::PendingRequestPtr pending_stream(
       new HttpPendingRequest(*this, decoder, callbacks));
   LinkedList::moveIntoList(std::move(pending_stream), pending_streams_);
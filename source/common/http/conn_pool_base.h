@@ -52,6 +52,9 @@ public:
   ConnectionPool::Cancellable* newStream(Http::ResponseDecoder& response_decoder,
                                          Http::ConnectionPool::Callbacks& callbacks) override;
   bool hasActiveConnections() const override;
+  void prefetchConnections(uint32_t connections) override {
+    prefetchConnectionsImpl(connections);
+  }
 
   // Creates a new PendingRequest and enqueues it into the request queue.
   ConnectionPool::Cancellable*
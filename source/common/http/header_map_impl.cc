@@ -39,6 +39,23 @@ InlineHeaderVector& getInVec(VariantHeader& buffer) {
 const InlineHeaderVector& getInVec(const VariantHeader& buffer) {
   return absl::get<InlineHeaderVector>(buffer);
 }
+
+BorrowedHeaderView& getBorrowed(VariantHeader& buffer) {
+  return absl::get<BorrowedHeaderView>(buffer);
+}
+
+const BorrowedHeaderView& getBorrowed(const VariantHeader& buffer) {
+  return absl::get<BorrowedHeaderView>(buffer);
+}
+
+// Takes the storage of a borrowed string, so that the memory it views outlives switching the
+// string to another representation.
+HeaderStringStorageSharedPtr takeBorrowedStorage(VariantHeader& buffer) {
+  if (!absl::holds_alternative<BorrowedHeaderView>(buffer)) {
+    return nullptr;
+  }
+  return std::move(getBorrowed(buffer).storage_);
+}
 } // namespace
 
 // Initialize as a Type::Inline
@@ -71,10 +88,12 @@ void HeaderString::append(const char* data, uint32_t data_size) {
   ASSERT(validHeaderString(absl::string_view(data, data_size)));
 
   switch (type()) {
-  case Type::Reference: {
+  case Type::Reference:
+  case Type::Borrowed: {
     // Rather than be too clever and optimize this uncommon case, we switch to
     // Inline mode and copy.
-    const absl::string_view prev = getStrView(buffer_);
+    const absl::string_view prev = getStringView();
+    const HeaderStringStorageSharedPtr storage = takeBorrowedStorage(buffer_);
     buffer_ = InlineHeaderVector();
     // Assigning new_capacity to avoid resizing when appending the new data
     getInVec(buffer_).reserve(new_capacity);
@@ -90,11 +109,17 @@ void HeaderString::append(const char* data, uint32_t data_size) {
 }
 
 void HeaderString::rtrim() {
-  ASSERT(type() == Type::Inline);
+  ASSERT(type() == Type::Inline || type() == Type::Borrowed);
   absl::string_view original = getStringView();
   absl::string_view rtrimmed = StringUtil::rtrim(original);
   if (original.size() != rtrimmed.size()) {
-    getInVec(buffer_).resize(rtrimmed.size());
+    if (type() == Type::Borrowed) {
+      getBorrowed(buffer_).view_ = rtrimmed;
+      // The encoded header includes the trimmed whitespace.
+      getBorrowed(buffer_).raw_header_ = {};
+    } else {
+      getInVec(buffer_).resize(rtrimmed.size());
+    }
   }
 }
 
@@ -102,6 +127,9 @@ absl::string_view HeaderString::getStringView() const {
   if (type() == Type::Reference) {
     return getStrView(buffer_);
   }
+  if (type() == Type::Borrowed) {
+    return getBorrowed(buffer_).view_;
+  }
   ASSERT(type() == Type::Inline);
   return {getInVec(buffer_).data(), getInVec(buffer_).size()};
 }
@@ -109,14 +137,18 @@ absl::string_view HeaderString::getStringView() const {
 void HeaderString::clear() {
   if (type() == Type::Inline) {
     getInVec(buffer_).clear();
+  } else if (type() == Type::Borrowed) {
+    buffer_ = InlineHeaderVector();
   }
 }
 
 void HeaderString::setCopy(const char* data, uint32_t size) {
   ASSERT(validHeaderString(absl::string_view(data, size)));
 
+  // The data may point into the memory of a borrowed string.
+  const HeaderStringStorageSharedPtr storage = takeBorrowedStorage(buffer_);
   if (!absl::holds_alternative<InlineHeaderVector>(buffer_)) {
-    // Switching from Type::Reference to Type::Inline
+    // Switching from Type::Reference or Type::Borrowed to Type::Inline
     buffer_ = InlineHeaderVector();
   }
 
@@ -139,8 +171,8 @@ void HeaderString::setInteger(uint64_t value) {
   char inner_buffer[MaxIntegerLength];
   const uint32_t int_length = StringUtil::itoa(inner_buffer, MaxIntegerLength, value);
 
-  if (type() == Type::Reference) {
-    // Switching from Type::Reference to Type::Inline
+  if (type() != Type::Inline) {
+    // Switching from Type::Reference or Type::Borrowed to Type::Inline
     buffer_ = InlineHeaderVector();
   }
   ASSERT((getInVec(buffer_).capacity()) > MaxIntegerLength);
@@ -152,22 +184,45 @@ void HeaderString::setReference(absl::string_view ref_value) {
   ASSERT(valid());
 }
 
+void HeaderString::setBorrowed(absl::string_view view, HeaderStringStorageSharedPtr storage) {
+  ASSERT(storage != nullptr);
+  buffer_ = BorrowedHeaderView{view, std::move(storage), {}};
+  ASSERT(valid());
+}
+
+void HeaderString::setBorrowedRawHeader(absl::string_view raw_header) {
+  ASSERT(type() == Type::Borrowed);
+  getBorrowed(buffer_).raw_header_ = raw_header;
+}
+
+absl::string_view HeaderString::borrowedRawHeader() const {
+  if (type() == Type::Borrowed) {
+    return getBorrowed(buffer_).raw_header_;
+  }
+  return {};
+}
+
 uint32_t HeaderString::size() const {
   if (type() == Type::Reference) {
     return getStrView(buffer_).size();
   }
+  if (type() == Type::Borrowed) {
+    return getBorrowed(buffer_).view_.size();
+  }
   ASSERT(type() == Type::Inline);
   return getInVec(buffer_).size();
 }
 
 HeaderString::Type HeaderString::type() const {
-  // buffer_.index() is correlated with the order of Reference and Inline in the
+  // buffer_.index() is correlated with the order of Reference, Inline and Borrowed in the
   // enum.
-  ASSERT(buffer_.index() == 0 || buffer_.index() == 1);
+  ASSERT(buffer_.index() <= 2);
   ASSERT((buffer_.index() == 0 && absl::holds_alternative<absl::string_view>(buffer_)) ||
          (buffer_.index() != 0));
   ASSERT((buffer_.index() == 1 && absl::holds_alternative<InlineHeaderVector>(buffer_)) ||
          (buffer_.index() != 1));
+  ASSERT((buffer_.index() == 2 && absl::holds_alternative<BorrowedHeaderView>(buffer_)) ||
+         (buffer_.index() != 2));
   return Type(buffer_.index());
 }
 
@@ -326,7 +381,7 @@ void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
     }
   } else {
     addSize(key.size() + value.size());
-    std::list<HeaderEntryImpl>::iterator i = headers_.insert(std::move(key), std::move(value));
+    HeaderNode i = headers_.insert(std::move(key), std::move(value));
     i->entry_ = i;
   }
 }
@@ -543,7 +598,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
   }
 
   addSize(key.get().size());
-  std::list<HeaderEntryImpl>::iterator i = headers_.insert(key);
+  HeaderNode i = headers_.insert(key);
   i->entry_ = i;
   *entry = &(*i);
   return **entry;
@@ -558,7 +613,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
   }
 
   addSize(key.get().size() + value.size());
-  std::list<HeaderEntryImpl>::iterator i = headers_.insert(key, std::move(value));
+  HeaderNode i = headers_.insert(key, std::move(value));
   i->entry_ = i;
   *entry = &(*i);
   return **entry;
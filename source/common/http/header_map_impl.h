@@ -9,6 +9,7 @@
 
 #include "envoy/http/header_map.h"
 
+#include "common/common/node_pool.h"
 #include "common/common/non_copyable.h"
 #include "common/common/utility.h"
 #include "common/http/headers.h"
@@ -97,6 +98,10 @@ public:
   void dumpState(std::ostream& os, int indent_level = 0) const;
 
 protected:
+  struct HeaderEntryImpl;
+  using HeaderEntryList = std::list<HeaderEntryImpl, NodePoolAllocator<HeaderEntryImpl>>;
+  using HeaderNode = HeaderEntryList::iterator;
+
   struct HeaderEntryImpl : public HeaderEntry, NonCopyable {
     HeaderEntryImpl(const LowerCaseString& key);
     HeaderEntryImpl(const LowerCaseString& key, HeaderString&& value);
@@ -112,7 +117,7 @@ protected:
 
     HeaderString key_;
     HeaderString value_;
-    std::list<HeaderEntryImpl>::iterator entry_;
+    HeaderNode entry_;
   };
 
   /**
@@ -171,6 +176,12 @@ protected:
    * List of HeaderEntryImpl that keeps the pseudo headers (key starting with ':') in the front
    * of the list (as required by nghttp2) and otherwise maintains insertion order.
    *
+   * List nodes are carved out of a per-map NodePool rather than allocated individually. A typical
+   * 20-40 header request therefore costs a handful of contiguous block allocations instead of one
+   * heap allocation per header, while node addresses (and thus the inline header pointers and the
+   * entry_ iterators used for O(1) removal) remain stable. Nodes freed by remove() or clear() are
+   * recycled by subsequent inserts into the same map.
+   *
    * Note: the internal iterators held in fields make this unsafe to copy and move, since the
    * reference to end() is not preserved across a move (see Notes in
    * https://en.cppreference.com/w/cpp/container/list/list). The NonCopyable will suppress both copy
@@ -180,16 +191,17 @@ protected:
    */
   class HeaderList : NonCopyable {
   public:
-    HeaderList() : pseudo_headers_end_(headers_.end()) {}
+    HeaderList()
+        : headers_(NodePoolAllocator<HeaderEntryImpl>(pool_)), pseudo_headers_end_(headers_.end()) {
+    }
 
     template <class Key> bool isPseudoHeader(const Key& key) {
       return !key.getStringView().empty() && key.getStringView()[0] == ':';
     }
 
-    template <class Key, class... Value>
-    std::list<HeaderEntryImpl>::iterator insert(Key&& key, Value&&... value) {
+    template <class Key, class... Value> HeaderNode insert(Key&& key, Value&&... value) {
       const bool is_pseudo_header = isPseudoHeader(key);
-      std::list<HeaderEntryImpl>::iterator i =
+      HeaderNode i =
           headers_.emplace(is_pseudo_header ? pseudo_headers_end_ : headers_.end(),
                            std::forward<Key>(key), std::forward<Value>(value)...);
       if (!is_pseudo_header && pseudo_headers_end_ == headers_.end()) {
@@ -198,7 +210,7 @@ protected:
       return i;
     }
 
-    std::list<HeaderEntryImpl>::iterator erase(std::list<HeaderEntryImpl>::iterator i) {
+    HeaderNode erase(HeaderNode i) {
       if (pseudo_headers_end_ == i) {
         pseudo_headers_end_++;
       }
@@ -217,12 +229,12 @@ protected:
       });
     }
 
-    std::list<HeaderEntryImpl>::iterator begin() { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::iterator end() { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_iterator begin() const { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::const_iterator end() const { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rend() const { return headers_.rend(); }
+    HeaderNode begin() { return headers_.begin(); }
+    HeaderNode end() { return headers_.end(); }
+    HeaderEntryList::const_iterator begin() const { return headers_.begin(); }
+    HeaderEntryList::const_iterator end() const { return headers_.end(); }
+    HeaderEntryList::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
+    HeaderEntryList::const_reverse_iterator rend() const { return headers_.rend(); }
     size_t size() const { return headers_.size(); }
     bool empty() const { return headers_.empty(); }
     void clear() {
@@ -231,8 +243,10 @@ protected:
     }
 
   private:
-    std::list<HeaderEntryImpl> headers_;
-    std::list<HeaderEntryImpl>::iterator pseudo_headers_end_;
+    // The pool must be declared before (and thus destroyed after) the list that allocates from it.
+    NodePool pool_;
+    HeaderEntryList headers_;
+    HeaderNode pseudo_headers_end_;
   };
 
   void insertByKey(HeaderString&& key, HeaderString&& value);
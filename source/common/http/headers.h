@@ -60,6 +60,9 @@ public:
   const LowerCaseString AccessControlMaxAge{"access-control-max-age"};
   const LowerCaseString AccessControlAllowCredentials{"access-control-allow-credentials"};
   const LowerCaseString Authorization{"authorization"};
+  const LowerCaseString B3ParentSpanId{"x-b3-parentspanid"};
+  const LowerCaseString B3SpanId{"x-b3-spanid"};
+  const LowerCaseString B3TraceId{"x-b3-traceid"};
   const LowerCaseString CacheControl{"cache-control"};
   const LowerCaseString ContentEncoding{"content-encoding"};
   const LowerCaseString Etag{"etag"};
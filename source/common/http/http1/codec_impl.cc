@@ -18,12 +18,15 @@
 #include "common/http/header_utility.h"
 #include "common/http/headers.h"
 #include "common/http/http1/header_formatter.h"
+#include "common/http/http1/legacy_parser_impl.h"
+#include "common/http/http1/simd_parser_impl.h"
 #include "common/http/url_utility.h"
 #include "common/http/utility.h"
 #include "common/runtime/runtime_features.h"
 
 #include "absl/container/fixed_array.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 
 namespace Envoy {
 namespace Http {
@@ -113,7 +116,16 @@ void ResponseEncoderImpl::encode100ContinueHeaders(const ResponseHeaderMap& head
 void StreamEncoderImpl::encodeHeadersBase(const RequestOrResponseHeaderMap& headers,
                                           absl::optional<uint64_t> status, bool end_stream) {
   bool saw_content_length = false;
-  headers.iterate([this](const HeaderEntry& header) -> HeaderMap::Iterate {
+  // The lines of the headers received over HTTP/1 and not modified since, which are written out as
+  // they were received. Lines which were contiguous in the input are written out at once.
+  absl::string_view raw_lines;
+  const auto write_raw_lines = [this, &raw_lines]() {
+    if (!raw_lines.empty()) {
+      connection_.copyToBuffer(raw_lines.data(), raw_lines.size());
+      raw_lines = {};
+    }
+  };
+  headers.iterate([&](const HeaderEntry& header) -> HeaderMap::Iterate {
     absl::string_view key_to_use = header.key().getStringView();
     uint32_t key_size_to_use = header.key().size();
     // Translate :authority -> host so that upper layers do not need to deal with this.
@@ -127,10 +139,28 @@ void StreamEncoderImpl::encodeHeadersBase(const RequestOrResponseHeaderMap& head
       return HeaderMap::Iterate::Continue;
     }
 
-    encodeFormattedHeader(key_to_use, header.value().getStringView());
+    const absl::string_view value = header.value().getStringView();
+    if (header_key_formatter_ == nullptr) {
+      const absl::string_view raw_line = header.value().borrowedRawHeader();
+      if (raw_line.size() == key_size_to_use + value.size() + 4 &&
+          raw_line.data() + key_size_to_use + 2 == value.data() &&
+          absl::StartsWith(raw_line, key_to_use)) {
+        if (!raw_lines.empty() && raw_lines.data() + raw_lines.size() == raw_line.data()) {
+          raw_lines = absl::string_view(raw_lines.data(), raw_lines.size() + raw_line.size());
+        } else {
+          write_raw_lines();
+          raw_lines = raw_line;
+        }
+        return HeaderMap::Iterate::Continue;
+      }
+    }
+
+    write_raw_lines();
+    encodeFormattedHeader(key_to_use, value);
 
     return HeaderMap::Iterate::Continue;
   });
+  write_raw_lines();
 
   if (headers.ContentLength()) {
     saw_content_length = true;
@@ -406,88 +436,90 @@ void RequestEncoderImpl::encodeHeaders(const RequestHeaderMap& headers, bool end
   encodeHeadersBase(headers, absl::nullopt, end_stream);
 }
 
-int ConnectionImpl::setAndCheckCallbackStatus(Status&& status) {
+CallbackResult ConnectionImpl::setAndCheckCallbackStatus(Status&& status) {
   ASSERT(codec_status_.ok());
   codec_status_ = std::move(status);
-  return codec_status_.ok() ? enumToInt(HttpParserCode::Success) : enumToInt(HttpParserCode::Error);
+  return codec_status_.ok() ? CallbackResult::Success : CallbackResult::Error;
 }
 
-int ConnectionImpl::setAndCheckCallbackStatusOr(Envoy::StatusOr<int>&& statusor) {
+CallbackResult
+ConnectionImpl::setAndCheckCallbackStatusOr(Envoy::StatusOr<CallbackResult>&& statusor) {
   ASSERT(codec_status_.ok());
   if (statusor.ok()) {
     return statusor.value();
   } else {
     codec_status_ = std::move(statusor.status());
-    return enumToInt(HttpParserCode::Error);
-  }
-}
-
-http_parser_settings ConnectionImpl::settings_{
-    [](http_parser* parser) -> int {
-      auto* conn_impl = static_cast<ConnectionImpl*>(parser->data);
-      auto status = conn_impl->onMessageBeginBase();
-      return conn_impl->setAndCheckCallbackStatus(std::move(status));
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      auto* conn_impl = static_cast<ConnectionImpl*>(parser->data);
-      auto status = conn_impl->onUrl(at, length);
-      return conn_impl->setAndCheckCallbackStatus(std::move(status));
-    },
-    nullptr, // on_status
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      auto* conn_impl = static_cast<ConnectionImpl*>(parser->data);
-      auto status = conn_impl->onHeaderField(at, length);
-      return conn_impl->setAndCheckCallbackStatus(std::move(status));
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      auto* conn_impl = static_cast<ConnectionImpl*>(parser->data);
-      auto status = conn_impl->onHeaderValue(at, length);
-      return conn_impl->setAndCheckCallbackStatus(std::move(status));
-    },
-    [](http_parser* parser) -> int {
-      auto* conn_impl = static_cast<ConnectionImpl*>(parser->data);
-      auto statusor = conn_impl->onHeadersCompleteBase();
-      return conn_impl->setAndCheckCallbackStatusOr(std::move(statusor));
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->bufferBody(at, length);
-      return 0;
-    },
-    [](http_parser* parser) -> int {
-      auto* conn_impl = static_cast<ConnectionImpl*>(parser->data);
-      auto status = conn_impl->onMessageCompleteBase();
-      return conn_impl->setAndCheckCallbackStatus(std::move(status));
-    },
-    [](http_parser* parser) -> int {
-      // A 0-byte chunk header is used to signal the end of the chunked body.
-      // When this function is called, http-parser holds the size of the chunk in
-      // parser->content_length. See
-      // https://github.com/nodejs/http-parser/blob/v2.9.3/http_parser.h#L336
-      const bool is_final_chunk = (parser->content_length == 0);
-      static_cast<ConnectionImpl*>(parser->data)->onChunkHeader(is_final_chunk);
-      return 0;
-    },
-    nullptr // on_chunk_complete
-};
+    return CallbackResult::Error;
+  }
+}
+
+CallbackResult ConnectionImpl::ParserCallbacksImpl::onMessageBegin() {
+  auto status = connection_.onMessageBeginBase();
+  return connection_.setAndCheckCallbackStatus(std::move(status));
+}
+
+CallbackResult ConnectionImpl::ParserCallbacksImpl::onUrl(const char* data, size_t length) {
+  auto status = connection_.onUrl(data, length);
+  return connection_.setAndCheckCallbackStatus(std::move(status));
+}
+
+CallbackResult ConnectionImpl::ParserCallbacksImpl::onHeaderField(const char* data,
+                                                                  size_t length) {
+  auto status = connection_.onHeaderField(data, length);
+  return connection_.setAndCheckCallbackStatus(std::move(status));
+}
+
+CallbackResult ConnectionImpl::ParserCallbacksImpl::onHeaderValue(const char* data,
+                                                                  size_t length) {
+  auto status = connection_.onHeaderValue(data, length);
+  return connection_.setAndCheckCallbackStatus(std::move(status));
+}
+
+CallbackResult ConnectionImpl::ParserCallbacksImpl::onHeadersComplete() {
+  auto statusor = connection_.onHeadersCompleteBase();
+  return connection_.setAndCheckCallbackStatusOr(std::move(statusor));
+}
+
+void ConnectionImpl::ParserCallbacksImpl::bufferBody(const char* data, size_t length) {
+  connection_.bufferBody(data, length);
+}
+
+CallbackResult ConnectionImpl::ParserCallbacksImpl::onMessageComplete() {
+  auto status = connection_.onMessageCompleteBase();
+  return connection_.setAndCheckCallbackStatus(std::move(status));
+}
+
+void ConnectionImpl::ParserCallbacksImpl::onChunkHeader(bool is_final_chunk) {
+  connection_.onChunkHeader(is_final_chunk);
+}
 
 ConnectionImpl::ConnectionImpl(Network::Connection& connection, CodecStats& stats,
-                               http_parser_type type, uint32_t max_headers_kb,
-                               const uint32_t max_headers_count,
-                               HeaderKeyFormatterPtr&& header_key_formatter, bool enable_trailers)
+                               const Http1Settings& settings, MessageType type,
+                               uint32_t max_headers_kb, const uint32_t max_headers_count,
+                               HeaderKeyFormatterPtr&& header_key_formatter)
     : connection_(connection), stats_(stats),
       header_key_formatter_(std::move(header_key_formatter)), processing_trailers_(false),
       handling_upgrade_(false), reset_stream_called_(false), deferred_end_stream_headers_(false),
-      enable_trailers_(enable_trailers),
+      enable_trailers_(settings.enable_trailers_),
       strict_1xx_and_204_headers_(Runtime::runtimeFeatureEnabled(
           "envoy.reloadable_features.strict_1xx_and_204_response_headers")),
       dispatching_(false),
       output_buffer_([&]() -> void { this->onBelowLowWatermark(); },
                      [&]() -> void { this->onAboveHighWatermark(); },
                      []() -> void { /* TODO(adisuissa): Handle overflow watermark */ }),
-      max_headers_kb_(max_headers_kb), max_headers_count_(max_headers_count) {
+      max_headers_kb_(max_headers_kb), max_headers_count_(max_headers_count),
+      borrow_header_values_(settings.borrow_header_values_),
+      record_raw_header_lines_(settings.borrow_header_values_ &&
+                               settings.reuse_raw_header_lines_) {
   output_buffer_.setWatermarks(connection.bufferLimit());
-  http_parser_init(&parser_, type);
-  parser_.data = this;
+  switch (settings.parser_type_) {
+  case Http1Settings::ParserType::HttpParser:
+    parser_ = std::make_unique<LegacyHttpParserImpl>(type, parser_callbacks_);
+    break;
+  case Http1Settings::ParserType::Simd:
+    parser_ = std::make_unique<SimdHttpParserImpl>(type, parser_callbacks_);
+    break;
+  }
 }
 
 Status ConnectionImpl::completeLastHeader() {
@@ -503,6 +535,7 @@ Status ConnectionImpl::completeLastHeader() {
     // in ConnectionImpl::onHeaderValue. http_parser does not strip leading or trailing whitespace
     // as the spec requires: https://tools.ietf.org/html/rfc7230#section-3.2.4
     current_header_value_.rtrim();
+    maybeSetRawHeaderLine();
     headers_or_trailers.addViaMove(std::move(current_header_field_),
                                    std::move(current_header_value_));
   }
@@ -522,6 +555,26 @@ Status ConnectionImpl::completeLastHeader() {
   return okStatus();
 }
 
+void ConnectionImpl::maybeSetRawHeaderLine() {
+  if (!record_raw_header_lines_ || current_header_line_ == nullptr ||
+      !current_header_value_.isBorrowed()) {
+    return;
+  }
+  // The line can be written out as is if it is "<name>: <value>\r\n", with the name in lower case,
+  // and was parsed from the current slice.
+  const absl::string_view name = current_header_field_.getStringView();
+  const absl::string_view value = current_header_value_.getStringView();
+  const char* line_end = value.data() + value.size() + 2;
+  if (value.data() != current_header_line_ + name.size() + 2 || line_end > current_slice_end_ ||
+      current_header_line_[name.size()] != ':' || current_header_line_[name.size() + 1] != ' ' ||
+      line_end[-2] != '\r' || line_end[-1] != '\n' ||
+      absl::string_view(current_header_line_, name.size()) != name) {
+    return;
+  }
+  current_header_value_.setBorrowedRawHeader(
+      absl::string_view(current_header_line_, line_end - current_header_line_));
+}
+
 uint32_t ConnectionImpl::getHeadersSize() {
   return current_header_field_.size() + current_header_value_.size() +
          headersOrTrailers().byteSize();
@@ -562,8 +615,15 @@ Http::Status ConnectionImpl::dispatch(Buffer::Instance& data) {
 Http::Status ConnectionImpl::innerDispatch(Buffer::Instance& data) {
   ENVOY_CONN_LOG(trace, "parsing {} bytes", connection_, data.length());
   // Make sure that dispatching_ is set to false after dispatching, even when
-  // http_parser exits early with an error code.
-  Cleanup cleanup([this]() { dispatching_ = false; });
+  // the parser exits early with an error code.
+  Cleanup cleanup([this, &data]() {
+    dispatching_ = false;
+    if (retained_input_ != nullptr) {
+      // The connection is closed on errors, so all of the input is retained rather than tracking
+      // how much of it was parsed.
+      drainInput(data, data.length());
+    }
+  });
   ASSERT(!dispatching_);
   ASSERT(codec_status_.ok());
   ASSERT(buffered_body_.length() == 0);
@@ -574,7 +634,7 @@ Http::Status ConnectionImpl::innerDispatch(Buffer::Instance& data) {
   }
 
   // Always unpause before dispatch.
-  http_parser_pause(&parser_, 0);
+  parser_->resume();
 
   ssize_t total_parsed = 0;
   if (data.length() > 0) {
@@ -584,10 +644,10 @@ Http::Status ConnectionImpl::innerDispatch(Buffer::Instance& data) {
         return statusor_parsed.status();
       }
       total_parsed += statusor_parsed.value();
-      if (HTTP_PARSER_ERRNO(&parser_) != HPE_OK) {
+      if (parser_->getStatus() != ParserStatus::Ok) {
         // Parse errors trigger an exception in dispatchSlice so we are guaranteed to be paused at
         // this point.
-        ASSERT(HTTP_PARSER_ERRNO(&parser_) == HPE_PAUSED);
+        ASSERT(parser_->getStatus() == ParserStatus::Paused);
         break;
       }
     }
@@ -601,7 +661,7 @@ Http::Status ConnectionImpl::innerDispatch(Buffer::Instance& data) {
   ASSERT(buffered_body_.length() == 0);
 
   ENVOY_CONN_LOG(trace, "parsed {} bytes", connection_, total_parsed);
-  data.drain(total_parsed);
+  drainInput(data, total_parsed);
 
   // If an upgrade has been handled and there is body data or early upgrade
   // payload to send on, send it on.
@@ -611,22 +671,34 @@ Http::Status ConnectionImpl::innerDispatch(Buffer::Instance& data) {
 
 Envoy::StatusOr<size_t> ConnectionImpl::dispatchSlice(const char* slice, size_t len) {
   ASSERT(codec_status_.ok() && dispatching_);
-  ssize_t rc = http_parser_execute(&parser_, &settings_, slice, len);
+  current_slice_end_ = slice + len;
+  // A header line started in a previous slice is not contiguous with its end.
+  current_header_line_ = nullptr;
+  const size_t rc = parser_->execute(slice, len);
   if (!codec_status_.ok()) {
     return codec_status_;
   }
-  if (HTTP_PARSER_ERRNO(&parser_) != HPE_OK && HTTP_PARSER_ERRNO(&parser_) != HPE_PAUSED) {
+  if (parser_->getStatus() == ParserStatus::Error) {
     RETURN_IF_ERROR(sendProtocolError(Http1ResponseCodeDetails::get().HttpCodecError));
     // Avoid overwriting the codec_status_ set in the callbacks.
     ASSERT(codec_status_.ok());
     codec_status_ = codecProtocolError(
-        absl::StrCat("http/1.1 protocol error: ", http_errno_name(HTTP_PARSER_ERRNO(&parser_))));
+        absl::StrCat("http/1.1 protocol error: ", parser_->errnoName()));
     return codec_status_;
   }
 
   return rc;
 }
 
+void ConnectionImpl::drainInput(Buffer::Instance& data, uint64_t length) {
+  if (retained_input_ == nullptr) {
+    data.drain(length);
+    return;
+  }
+  retained_input_->data_ = data.drainRetaining(length);
+  retained_input_.reset();
+}
+
 Status ConnectionImpl::onHeaderField(const char* data, size_t length) {
   ASSERT(dispatching_);
   // We previously already finished up the headers, these headers are
@@ -644,6 +716,9 @@ Status ConnectionImpl::onHeaderField(const char* data, size_t length) {
     RETURN_IF_ERROR(completeLastHeader());
   }
 
+  if (current_header_field_.empty()) {
+    current_header_line_ = data;
+  }
   current_header_field_.append(data, length);
 
   return checkMaxHeadersSize();
@@ -671,19 +746,27 @@ Status ConnectionImpl::onHeaderValue(const char* data, size_t length) {
     // ConnectionImpl::completeLastHeader. http_parser does not strip leading or trailing whitespace
     // as the spec requires: https://tools.ietf.org/html/rfc7230#section-3.2.4 .
     header_value = StringUtil::ltrim(header_value);
+    if (borrow_header_values_ && !header_value.empty()) {
+      // Values split across slices are copied once the rest of the value is appended.
+      if (retained_input_ == nullptr) {
+        retained_input_ = std::make_shared<RetainedInput>();
+      }
+      current_header_value_.setBorrowed(header_value, retained_input_);
+      return checkMaxHeadersSize();
+    }
   }
   current_header_value_.append(header_value.data(), header_value.length());
 
   return checkMaxHeadersSize();
 }
 
-Envoy::StatusOr<int> ConnectionImpl::onHeadersCompleteBase() {
+Envoy::StatusOr<CallbackResult> ConnectionImpl::onHeadersCompleteBase() {
   ASSERT(!processing_trailers_);
   ASSERT(dispatching_);
   ENVOY_CONN_LOG(trace, "onHeadersCompleteBase", connection_);
   RETURN_IF_ERROR(completeLastHeader());
 
-  if (!(parser_.http_major == 1 && parser_.http_minor == 1)) {
+  if (!(parser_->httpMajor() == 1 && parser_->httpMinor() == 1)) {
     // This is not necessarily true, but it's good enough since higher layers only care if this is
     // HTTP/1.1 or not.
     protocol_ = Protocol::Http10;
@@ -712,7 +795,8 @@ Envoy::StatusOr<int> ConnectionImpl::onHeadersCompleteBase() {
       handling_upgrade_ = true;
     }
   }
-  if (parser_.method == HTTP_CONNECT) {
+  const bool is_connect = parser_->methodName() == Headers::get().MethodValues.Connect;
+  if (is_connect) {
     if (request_or_response_headers.ContentLength()) {
       if (request_or_response_headers.getContentLengthValue() == "0") {
         request_or_response_headers.removeContentLength();
@@ -735,7 +819,7 @@ Envoy::StatusOr<int> ConnectionImpl::onHeadersCompleteBase() {
   if (request_or_response_headers.TransferEncoding()) {
     const absl::string_view encoding = request_or_response_headers.getTransferEncodingValue();
     if (!absl::EqualsIgnoreCase(encoding, Headers::get().TransferEncodingValues.Chunked) ||
-        parser_.method == HTTP_CONNECT) {
+        is_connect) {
       error_code_ = Http::Code::NotImplemented;
       RETURN_IF_ERROR(sendProtocolError(Http1ResponseCodeDetails::get().InvalidTransferEncoding));
       return codecProtocolError("http/1.1 protocol error: unsupported transfer encoding");
@@ -749,8 +833,9 @@ Envoy::StatusOr<int> ConnectionImpl::onHeadersCompleteBase() {
 
   header_parsing_state_ = HeaderParsingState::Done;
 
-  // Returning 2 informs http_parser to not expect a body or further data on this connection.
-  return handling_upgrade_ ? 2 : statusor.value();
+  // Returning NoBodyData informs the parser to not expect a body or further data on this
+  // connection.
+  return handling_upgrade_ ? CallbackResult::NoBodyData : statusor.value();
 }
 
 void ConnectionImpl::bufferBody(const char* data, size_t length) {
@@ -758,7 +843,7 @@ void ConnectionImpl::bufferBody(const char* data, size_t length) {
 }
 
 void ConnectionImpl::dispatchBufferedBody() {
-  ASSERT(HTTP_PARSER_ERRNO(&parser_) == HPE_OK || HTTP_PARSER_ERRNO(&parser_) == HPE_PAUSED);
+  ASSERT(parser_->getStatus() != ParserStatus::Error);
   ASSERT(codec_status_.ok());
   if (buffered_body_.length() > 0) {
     onBody(buffered_body_);
@@ -784,7 +869,7 @@ Status ConnectionImpl::onMessageCompleteBase() {
     // upgrade payload will be treated as stream body.
     ASSERT(!deferred_end_stream_headers_);
     ENVOY_CONN_LOG(trace, "Pausing parser due to upgrade.", connection_);
-    http_parser_pause(&parser_, 1);
+    parser_->pause();
     return okStatus();
   }
 
@@ -822,8 +907,8 @@ ServerConnectionImpl::ServerConnectionImpl(
     const uint32_t max_request_headers_count,
     envoy::config::core::v3::HttpProtocolOptions::HeadersWithUnderscoresAction
         headers_with_underscores_action)
-    : ConnectionImpl(connection, stats, HTTP_REQUEST, max_request_headers_kb,
-                     max_request_headers_count, formatter(settings), settings.enable_trailers_),
+    : ConnectionImpl(connection, stats, settings, MessageType::Request, max_request_headers_kb,
+                     max_request_headers_count, formatter(settings)),
       callbacks_(callbacks), codec_settings_(settings),
       response_buffer_releasor_([this](const Buffer::OwnedBufferFragmentImpl* fragment) {
         releaseOutboundResponse(fragment);
@@ -855,16 +940,17 @@ void ServerConnectionImpl::onEncodeComplete() {
   }
 }
 
-Status ServerConnectionImpl::handlePath(RequestHeaderMap& headers, unsigned int method) {
+Status ServerConnectionImpl::handlePath(RequestHeaderMap& headers, absl::string_view method) {
   HeaderString path(Headers::get().Path);
 
-  bool is_connect = (method == HTTP_CONNECT);
+  bool is_connect = (method == Headers::get().MethodValues.Connect);
 
   // The url is relative or a wildcard when the method is OPTIONS. Nothing to do here.
   auto& active_request = active_request_.value();
   if (!is_connect && !active_request.request_url_.getStringView().empty() &&
       (active_request.request_url_.getStringView()[0] == '/' ||
-       ((method == HTTP_OPTIONS) && active_request.request_url_.getStringView()[0] == '*'))) {
+       ((method == Headers::get().MethodValues.Options) &&
+        active_request.request_url_.getStringView()[0] == '*'))) {
     headers.addViaMove(std::move(path), std::move(active_request.request_url_));
     return okStatus();
   }
@@ -899,7 +985,7 @@ Status ServerConnectionImpl::handlePath(RequestHeaderMap& headers, unsigned int
   return okStatus();
 }
 
-Envoy::StatusOr<int> ServerConnectionImpl::onHeadersComplete() {
+Envoy::StatusOr<CallbackResult> ServerConnectionImpl::onHeadersComplete() {
   // Handle the case where response happens prior to request complete. It's up to upper layer code
   // to disconnect the connection but we shouldn't fire any more events since it doesn't make
   // sense.
@@ -907,7 +993,7 @@ Envoy::StatusOr<int> ServerConnectionImpl::onHeadersComplete() {
     auto& active_request = active_request_.value();
     auto& headers = absl::get<RequestHeaderMapPtr>(headers_or_trailers_);
     ENVOY_CONN_LOG(trace, "Server: onHeadersComplete size={}", connection_, headers->size());
-    const char* method_string = http_method_str(static_cast<http_method>(parser_.method));
+    const absl::string_view method = parser_->methodName();
 
     if (!handling_upgrade_ && headers->Connection()) {
       // If we fail to sanitize the request, return a 400 to the client
@@ -924,13 +1010,15 @@ Envoy::StatusOr<int> ServerConnectionImpl::onHeadersComplete() {
 
     // Inform the response encoder about any HEAD method, so it can set content
     // length and transfer encoding headers correctly.
-    active_request.response_encoder_.setIsResponseToHeadRequest(parser_.method == HTTP_HEAD);
-    active_request.response_encoder_.setIsResponseToConnectRequest(parser_.method == HTTP_CONNECT);
+    active_request.response_encoder_.setIsResponseToHeadRequest(
+        method == Headers::get().MethodValues.Head);
+    active_request.response_encoder_.setIsResponseToConnectRequest(
+        method == Headers::get().MethodValues.Connect);
 
-    RETURN_IF_ERROR(handlePath(*headers, parser_.method));
+    RETURN_IF_ERROR(handlePath(*headers, method));
     ASSERT(active_request.request_url_.empty());
 
-    headers->setMethod(method_string);
+    headers->setReferenceMethod(method);
 
     // Make sure the host is valid.
     auto details = HeaderUtility::requestHeadersValid(*headers);
@@ -946,21 +1034,20 @@ Envoy::StatusOr<int> ServerConnectionImpl::onHeadersComplete() {
     // with message complete. This allows upper layers to behave like HTTP/2 and prevents a proxy
     // scenario where the higher layers stream through and implicitly switch to chunked transfer
     // encoding because end stream with zero body length has not yet been indicated.
-    if (parser_.flags & F_CHUNKED ||
-        (parser_.content_length > 0 && parser_.content_length != ULLONG_MAX) || handling_upgrade_) {
+    if (parser_->isChunked() || parser_->contentLength().value_or(0) > 0 || handling_upgrade_) {
       active_request.request_decoder_->decodeHeaders(std::move(headers), false);
 
       // If the connection has been closed (or is closing) after decoding headers, pause the parser
       // so we return control to the caller.
       if (connection_.state() != Network::Connection::State::Open) {
-        http_parser_pause(&parser_, 1);
+        parser_->pause();
       }
     } else {
       deferred_end_stream_headers_ = true;
     }
   }
 
-  return 0;
+  return CallbackResult::Success;
 }
 
 Status ServerConnectionImpl::onMessageBegin() {
@@ -1026,7 +1113,7 @@ void ServerConnectionImpl::onMessageComplete() {
   // Always pause the parser so that the calling code can process 1 request at a time and apply
   // back pressure. However this means that the calling code needs to detect if there is more data
   // in the buffer and dispatch it again.
-  http_parser_pause(&parser_, 1);
+  parser_->pause();
 }
 
 void ServerConnectionImpl::onResetStream(StreamResetReason reason) {
@@ -1123,15 +1210,15 @@ Status ServerConnectionImpl::checkHeaderNameForUnderscores() {
 ClientConnectionImpl::ClientConnectionImpl(Network::Connection& connection, CodecStats& stats,
                                            ConnectionCallbacks&, const Http1Settings& settings,
                                            const uint32_t max_response_headers_count)
-    : ConnectionImpl(connection, stats, HTTP_RESPONSE, MAX_RESPONSE_HEADERS_KB,
-                     max_response_headers_count, formatter(settings), settings.enable_trailers_) {}
+    : ConnectionImpl(connection, stats, settings, MessageType::Response, MAX_RESPONSE_HEADERS_KB,
+                     max_response_headers_count, formatter(settings)) {}
 
 bool ClientConnectionImpl::cannotHaveBody() {
   if (pending_response_.has_value() && pending_response_.value().encoder_.headRequest()) {
     ASSERT(!pending_response_done_);
     return true;
-  } else if (parser_.status_code == 204 || parser_.status_code == 304 ||
-             (parser_.status_code >= 200 && parser_.content_length == 0)) {
+  } else if (parser_->statusCode() == 204 || parser_->statusCode() == 304 ||
+             (parser_->statusCode() >= 200 && parser_->contentLength() == 0)) {
     return true;
   } else {
     return false;
@@ -1150,21 +1237,21 @@ RequestEncoder& ClientConnectionImpl::newStream(ResponseDecoder& response_decode
   return pending_response_.value().encoder_;
 }
 
-Envoy::StatusOr<int> ClientConnectionImpl::onHeadersComplete() {
-  ENVOY_CONN_LOG(trace, "status_code {}", connection_, parser_.status_code);
+Envoy::StatusOr<CallbackResult> ClientConnectionImpl::onHeadersComplete() {
+  ENVOY_CONN_LOG(trace, "status_code {}", connection_, parser_->statusCode());
 
   // Handle the case where the client is closing a kept alive connection (by sending a 408
   // with a 'Connection: close' header). In this case we just let response flush out followed
   // by the remote close.
   if (!pending_response_.has_value() && !resetStreamCalled()) {
-    return prematureResponseError("", static_cast<Http::Code>(parser_.status_code));
+    return prematureResponseError("", static_cast<Http::Code>(parser_->statusCode()));
   } else if (pending_response_.has_value()) {
     ASSERT(!pending_response_done_);
     auto& headers = absl::get<ResponseHeaderMapPtr>(headers_or_trailers_);
     ENVOY_CONN_LOG(trace, "Client: onHeadersComplete size={}", connection_, headers->size());
-    headers->setStatus(parser_.status_code);
+    headers->setStatus(parser_->statusCode());
 
-    if (parser_.status_code >= 200 && parser_.status_code < 300 &&
+    if (parser_->statusCode() >= 200 && parser_->statusCode() < 300 &&
         pending_response_.value().encoder_.connectRequest()) {
       ENVOY_CONN_LOG(trace, "codec entering upgrade mode for CONNECT response.", connection_);
       handling_upgrade_ = true;
@@ -1179,7 +1266,8 @@ Envoy::StatusOr<int> ClientConnectionImpl::onHeadersComplete() {
       }
     }
 
-    if (strict_1xx_and_204_headers_ && (parser_.status_code < 200 || parser_.status_code == 204)) {
+    if (strict_1xx_and_204_headers_ &&
+        (parser_->statusCode() < 200 || parser_->statusCode() == 204)) {
       if (headers->TransferEncoding()) {
         RETURN_IF_ERROR(
             sendProtocolError(Http1ResponseCodeDetails::get().TransferEncodingNotAllowed));
@@ -1200,7 +1288,7 @@ Envoy::StatusOr<int> ClientConnectionImpl::onHeadersComplete() {
       }
     }
 
-    if (parser_.status_code == enumToInt(Http::Code::Continue)) {
+    if (parser_->statusCode() == enumToInt(Http::Code::Continue)) {
       pending_response_.value().decoder_->decode100ContinueHeaders(std::move(headers));
     } else if (cannotHaveBody() && !handling_upgrade_) {
       deferred_end_stream_headers_ = true;
@@ -1212,17 +1300,17 @@ Envoy::StatusOr<int> ClientConnectionImpl::onHeadersComplete() {
     // onMessageComplete and continue processing for purely informational headers.
     // 101-SwitchingProtocols is exempt as all data after the header is proxied through after
     // upgrading.
-    if (CodeUtility::is1xx(parser_.status_code) &&
-        parser_.status_code != enumToInt(Http::Code::SwitchingProtocols)) {
+    if (CodeUtility::is1xx(parser_->statusCode()) &&
+        parser_->statusCode() != enumToInt(Http::Code::SwitchingProtocols)) {
       ignore_message_complete_for_1xx_ = true;
       // Reset to ensure no information from the 1xx headers is used for the response headers.
       headers_or_trailers_.emplace<ResponseHeaderMapPtr>(nullptr);
     }
   }
 
-  // Here we deal with cases where the response cannot have a body by returning 1, but http_parser
-  // does not deal with it for us.
-  return cannotHaveBody() ? 1 : 0;
+  // Here we deal with cases where the response cannot have a body by returning NoBody, but the
+  // parser does not deal with it for us.
+  return cannotHaveBody() ? CallbackResult::NoBody : CallbackResult::Success;
 }
 
 bool ClientConnectionImpl::upgradeAllowed() const {
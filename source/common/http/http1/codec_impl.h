@@ -1,7 +1,5 @@
 #pragma once
 
-#include <http_parser.h>
-
 #include <array>
 #include <cstdint>
 #include <list>
@@ -20,6 +18,7 @@
 #include "common/http/header_map_impl.h"
 #include "common/http/http1/codec_stats.h"
 #include "common/http/http1/header_formatter.h"
+#include "common/http/http1/parser.h"
 #include "common/http/status.h"
 
 namespace Envoy {
@@ -160,7 +159,7 @@ private:
 
 /**
  * Base class for HTTP/1.1 client and server connections.
- * Handles the callbacks of http_parser with its own base routine and then
+ * Handles the callbacks of the HTTP/1 parser with its own base routine and then
  * virtual dispatches to its subclasses.
  */
 class ConnectionImpl : public virtual Connection, protected Logger::Loggable<Logger::Id::http> {
@@ -217,35 +216,17 @@ public:
 
   bool strict1xxAnd204Headers() { return strict_1xx_and_204_headers_; }
 
-  int setAndCheckCallbackStatus(Status&& status);
-  int setAndCheckCallbackStatusOr(Envoy::StatusOr<int>&& statusor);
+  CallbackResult setAndCheckCallbackStatus(Status&& status);
+  CallbackResult setAndCheckCallbackStatusOr(Envoy::StatusOr<CallbackResult>&& statusor);
 
-  // Codec errors found in callbacks are overridden within the http_parser library. This holds those
-  // errors to propagate them through to dispatch() where we can handle the error.
+  // Codec errors found in callbacks are overridden within the parser. This holds those errors to
+  // propagate them through to dispatch() where we can handle the error.
   Envoy::Http::Status codec_status_;
 
 protected:
-  ConnectionImpl(Network::Connection& connection, CodecStats& stats, http_parser_type type,
-                 uint32_t max_headers_kb, const uint32_t max_headers_count,
-                 HeaderKeyFormatterPtr&& header_key_formatter, bool enable_trailers);
-
-  // The following define special return values for http_parser callbacks. See:
-  // https://github.com/nodejs/http-parser/blob/5c5b3ac62662736de9e71640a8dc16da45b32503/http_parser.h#L72
-  // These codes do not overlap with standard HTTP Status codes. They are only used for user
-  // callbacks.
-  enum class HttpParserCode {
-    // Callbacks other than on_headers_complete should return a non-zero int to indicate an error
-    // and
-    // halt execution.
-    Error = -1,
-    Success = 0,
-    // Returning '1' from on_headers_complete will tell http_parser that it should not expect a
-    // body.
-    NoBody = 1,
-    // Returning '2' from on_headers_complete will tell http_parser that it should not expect a body
-    // nor any further data on the connection.
-    NoBodyData = 2,
-  };
+  ConnectionImpl(Network::Connection& connection, CodecStats& stats, const Http1Settings& settings,
+                 MessageType type, uint32_t max_headers_kb, const uint32_t max_headers_count,
+                 HeaderKeyFormatterPtr&& header_key_formatter);
 
   bool resetStreamCalled() { return reset_stream_called_; }
   Status onMessageBeginBase();
@@ -266,7 +247,7 @@ protected:
 
   Network::Connection& connection_;
   CodecStats& stats_;
-  http_parser parser_;
+  ParserPtr parser_;
   Http::Code error_code_{Http::Code::BadRequest};
   const HeaderKeyFormatterPtr header_key_formatter_;
   HeaderString current_header_field_;
@@ -285,6 +266,35 @@ protected:
 private:
   enum class HeaderParsingState { Field, Value, Done };
 
+  /**
+   * Forwards the parser callbacks to the private methods of the connection.
+   */
+  class ParserCallbacksImpl : public ParserCallbacks {
+  public:
+    explicit ParserCallbacksImpl(ConnectionImpl& connection) : connection_(connection) {}
+
+    // Http1::ParserCallbacks
+    CallbackResult onMessageBegin() override;
+    CallbackResult onUrl(const char* data, size_t length) override;
+    CallbackResult onHeaderField(const char* data, size_t length) override;
+    CallbackResult onHeaderValue(const char* data, size_t length) override;
+    CallbackResult onHeadersComplete() override;
+    void bufferBody(const char* data, size_t length) override;
+    CallbackResult onMessageComplete() override;
+    void onChunkHeader(bool is_final_chunk) override;
+
+  private:
+    ConnectionImpl& connection_;
+  };
+
+  /**
+   * Keeps the input of a dispatch alive for the header values borrowing it. The input is drained
+   * into it once it has been parsed.
+   */
+  struct RetainedInput {
+    Buffer::RetainedDataPtr data_;
+  };
+
   virtual HeaderMap& headersOrTrailers() PURE;
   virtual RequestOrResponseHeaderMap& requestOrResponseHeaders() PURE;
   virtual void allocHeaders() PURE;
@@ -296,6 +306,12 @@ private:
    */
   Status completeLastHeader();
 
+  /**
+   * Record the line of the current header in its borrowed value if the header can be written out
+   * as it was received.
+   */
+  void maybeSetRawHeaderLine();
+
   /**
    * Check if header name contains underscore character.
    * Underscore character is allowed in header names by the RFC-7230 and this check is implemented
@@ -325,7 +341,14 @@ private:
   Envoy::StatusOr<size_t> dispatchSlice(const char* slice, size_t len);
 
   /**
-   * Called by the http_parser when body data is received.
+   * Drain parsed input, retaining it if header values borrow it.
+   * @param data supplies the input.
+   * @param length supplies the length of the parsed input.
+   */
+  void drainInput(Buffer::Instance& data, uint64_t length);
+
+  /**
+   * Called by the parser when body data is received.
    * @param data supplies the start address.
    * @param length supplies the length.
    */
@@ -369,10 +392,10 @@ private:
    * Called when headers are complete. A base routine happens first then a virtual dispatch is
    * invoked. Note that this only applies to headers and NOT trailers. End of
    * trailers are signaled via onMessageCompleteBase().
-   * @return An error status or an integer representing 0 if no error, 1 if there should be no body.
+   * @return An error status or a CallbackResult representing whether there should be a body.
    */
-  Envoy::StatusOr<int> onHeadersCompleteBase();
-  virtual Envoy::StatusOr<int> onHeadersComplete() PURE;
+  Envoy::StatusOr<CallbackResult> onHeadersCompleteBase();
+  virtual Envoy::StatusOr<CallbackResult> onHeadersComplete() PURE;
 
   /**
    * Called to see if upgrade transition is allowed.
@@ -432,8 +455,7 @@ private:
    */
   virtual Status checkHeaderNameForUnderscores() { return okStatus(); }
 
-  static http_parser_settings settings_;
-
+  ParserCallbacksImpl parser_callbacks_{*this};
   HeaderParsingState header_parsing_state_{HeaderParsingState::Field};
   // Used to accumulate the HTTP message body during the current dispatch call. The accumulated body
   // is pushed through the filter pipeline either at the end of the current dispatch call, or when
@@ -443,6 +465,15 @@ private:
   Protocol protocol_{Protocol::Http11};
   const uint32_t max_headers_kb_;
   const uint32_t max_headers_count_;
+  const bool borrow_header_values_;
+  // Whether the lines of headers with borrowed values are recorded, see maybeSetRawHeaderLine().
+  const bool record_raw_header_lines_;
+  // The input of the current dispatch, once a header value borrows it.
+  std::shared_ptr<RetainedInput> retained_input_;
+  // The end of the slice being parsed, and the start of the header line being parsed if it starts
+  // in that slice. Used to find the lines of the headers which can be written out verbatim.
+  const char* current_slice_end_{};
+  const char* current_header_line_{};
 };
 
 /**
@@ -486,13 +517,13 @@ private:
    * @return Status representing success or failure. This will fail if there is an invalid url in
    * the request line.
    */
-  Status handlePath(RequestHeaderMap& headers, unsigned int method);
+  Status handlePath(RequestHeaderMap& headers, absl::string_view method);
 
   // ConnectionImpl
   void onEncodeComplete() override;
   Status onMessageBegin() override;
   Status onUrl(const char* data, size_t length) override;
-  Envoy::StatusOr<int> onHeadersComplete() override;
+  Envoy::StatusOr<CallbackResult> onHeadersComplete() override;
   // If upgrade behavior is not allowed, the HCM will have sanitized the headers out.
   bool upgradeAllowed() const override { return true; }
   void onBody(Buffer::Instance& data) override;
@@ -578,7 +609,7 @@ private:
   void onEncodeComplete() override {}
   Status onMessageBegin() override { return okStatus(); }
   Status onUrl(const char*, size_t) override { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
-  Envoy::StatusOr<int> onHeadersComplete() override;
+  Envoy::StatusOr<CallbackResult> onHeadersComplete() override;
   bool upgradeAllowed() const override;
   void onBody(Buffer::Instance& data) override;
   void onMessageComplete() override;
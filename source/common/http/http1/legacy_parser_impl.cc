@@ -0,0 +1,114 @@
+#include "common/http/http1/legacy_parser_impl.h"
+
+#include <http_parser.h>
+
+#include <climits>
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+ParserCallbacks& callbacks(http_parser* parser) {
+  return *static_cast<ParserCallbacks*>(parser->data);
+}
+
+int toInt(CallbackResult result) { return static_cast<int>(result); }
+
+} // namespace
+
+class LegacyHttpParserImpl::Impl {
+public:
+  Impl(http_parser_type type, ParserCallbacks& callbacks) {
+    http_parser_init(&parser_, type);
+    parser_.data = &callbacks;
+  }
+
+  static http_parser_settings settings_;
+  http_parser parser_;
+};
+
+http_parser_settings LegacyHttpParserImpl::Impl::settings_{
+    [](http_parser* parser) -> int { return toInt(callbacks(parser).onMessageBegin()); },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      return toInt(callbacks(parser).onUrl(at, length));
+    },
+    nullptr, // on_status
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      return toInt(callbacks(parser).onHeaderField(at, length));
+    },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      return toInt(callbacks(parser).onHeaderValue(at, length));
+    },
+    [](http_parser* parser) -> int { return toInt(callbacks(parser).onHeadersComplete()); },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      callbacks(parser).bufferBody(at, length);
+      return 0;
+    },
+    [](http_parser* parser) -> int { return toInt(callbacks(parser).onMessageComplete()); },
+    [](http_parser* parser) -> int {
+      // A 0-byte chunk header is used to signal the end of the chunked body.
+      // When this function is called, http-parser holds the size of the chunk in
+      // parser->content_length. See
+      // https://github.com/nodejs/http-parser/blob/v2.9.3/http_parser.h#L336
+      callbacks(parser).onChunkHeader(parser->content_length == 0);
+      return 0;
+    },
+    nullptr // on_chunk_complete
+};
+
+LegacyHttpParserImpl::LegacyHttpParserImpl(MessageType type, ParserCallbacks& callbacks)
+    : impl_(std::make_unique<Impl>(type == MessageType::Request ? HTTP_REQUEST : HTTP_RESPONSE,
+                                   callbacks)) {}
+
+LegacyHttpParserImpl::~LegacyHttpParserImpl() = default;
+
+size_t LegacyHttpParserImpl::execute(const char* slice, size_t len) {
+  return http_parser_execute(&impl_->parser_, &Impl::settings_, slice, len);
+}
+
+void LegacyHttpParserImpl::resume() { http_parser_pause(&impl_->parser_, 0); }
+
+CallbackResult LegacyHttpParserImpl::pause() {
+  http_parser_pause(&impl_->parser_, 1);
+  return CallbackResult::Success;
+}
+
+ParserStatus LegacyHttpParserImpl::getStatus() const {
+  switch (HTTP_PARSER_ERRNO(&impl_->parser_)) {
+  case HPE_OK:
+    return ParserStatus::Ok;
+  case HPE_PAUSED:
+    return ParserStatus::Paused;
+  default:
+    return ParserStatus::Error;
+  }
+}
+
+uint16_t LegacyHttpParserImpl::statusCode() const { return impl_->parser_.status_code; }
+
+int LegacyHttpParserImpl::httpMajor() const { return impl_->parser_.http_major; }
+
+int LegacyHttpParserImpl::httpMinor() const { return impl_->parser_.http_minor; }
+
+absl::optional<uint64_t> LegacyHttpParserImpl::contentLength() const {
+  // http_parser uses ULLONG_MAX to signal that there is no content-length header.
+  if (impl_->parser_.content_length == ULLONG_MAX) {
+    return absl::nullopt;
+  }
+  return impl_->parser_.content_length;
+}
+
+bool LegacyHttpParserImpl::isChunked() const { return impl_->parser_.flags & F_CHUNKED; }
+
+absl::string_view LegacyHttpParserImpl::methodName() const {
+  return http_method_str(static_cast<http_method>(impl_->parser_.method));
+}
+
+absl::string_view LegacyHttpParserImpl::errnoName() const {
+  return http_errno_name(HTTP_PARSER_ERRNO(&impl_->parser_));
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+
+#include "common/http/http1/parser.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * A Parser driving the nodejs http_parser library.
+ */
+class LegacyHttpParserImpl : public Parser {
+public:
+  LegacyHttpParserImpl(MessageType type, ParserCallbacks& callbacks);
+  ~LegacyHttpParserImpl() override;
+
+  // Http1::Parser
+  size_t execute(const char* slice, size_t len) override;
+  void resume() override;
+  CallbackResult pause() override;
+  ParserStatus getStatus() const override;
+  uint16_t statusCode() const override;
+  int httpMajor() const override;
+  int httpMinor() const override;
+  absl::optional<uint64_t> contentLength() const override;
+  bool isChunked() const override;
+  absl::string_view methodName() const override;
+  absl::string_view errnoName() const override;
+
+private:
+  // Holds the http_parser state, so that http_parser.h is only included by the implementation.
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
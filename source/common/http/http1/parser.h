@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * The type of message a parser parses.
+ */
+enum class MessageType { Request, Response };
+
+/**
+ * Return values of the parser callbacks. These mirror the return values of http_parser callbacks,
+ * see https://github.com/nodejs/http-parser/blob/v2.9.3/http_parser.h#L72.
+ */
+enum class CallbackResult {
+  // Stops parsing, and sets the status of the parser to Error.
+  Error = -1,
+  Success = 0,
+  // Returned by onHeadersComplete() to tell the parser that the message has no body.
+  NoBody = 1,
+  // Returned by onHeadersComplete() to tell the parser that the message has no body, and that
+  // there is no further HTTP/1.1 data on the connection.
+  NoBodyData = 2,
+};
+
+/**
+ * The status of a parser.
+ */
+enum class ParserStatus {
+  Ok,
+  // The parser was paused by pause(). It parses no further data until resume() is called.
+  Paused,
+  // The parser found a protocol error or a callback returned CallbackResult::Error. It parses no
+  // further data.
+  Error,
+};
+
+/**
+ * Callbacks of a parser. Data passed to the callbacks points into the slice passed to
+ * Parser::execute(), and is only valid for the duration of the callback. A URL, header field or
+ * header value split across slices is passed in several calls, which are to be concatenated.
+ */
+class ParserCallbacks {
+public:
+  virtual ~ParserCallbacks() = default;
+
+  /**
+   * Called when a request or response is beginning.
+   */
+  virtual CallbackResult onMessageBegin() PURE;
+
+  /**
+   * Called with URL data of a request.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual CallbackResult onUrl(const char* data, size_t length) PURE;
+
+  /**
+   * Called with header field data.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual CallbackResult onHeaderField(const char* data, size_t length) PURE;
+
+  /**
+   * Called with header value data. An empty value is passed as a call of length 0.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual CallbackResult onHeaderValue(const char* data, size_t length) PURE;
+
+  /**
+   * Called when the headers of a message are complete. This is not called for trailers.
+   * @return CallbackResult::NoBody or CallbackResult::NoBodyData to skip the body.
+   */
+  virtual CallbackResult onHeadersComplete() PURE;
+
+  /**
+   * Called with body data.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void bufferBody(const char* data, size_t length) PURE;
+
+  /**
+   * Called when a request or response is complete, after its body and trailers.
+   */
+  virtual CallbackResult onMessageComplete() PURE;
+
+  /**
+   * Called when a chunk header of a chunked body has been parsed.
+   * @param is_final_chunk supplies whether the chunk is the 0-sized last chunk.
+   */
+  virtual void onChunkHeader(bool is_final_chunk) PURE;
+};
+
+/**
+ * A parser of HTTP/1.x requests or responses, which drives ParserCallbacks.
+ */
+class Parser {
+public:
+  virtual ~Parser() = default;
+
+  /**
+   * Parses a slice of data. A slice of length 0 signals the end of the connection.
+   * @param slice supplies the start address.
+   * @param len supplies the length.
+   * @return the number of bytes parsed. Parsing stops early when the parser is paused or finds an
+   * error, see getStatus().
+   */
+  virtual size_t execute(const char* slice, size_t len) PURE;
+
+  /**
+   * Resumes a paused parser.
+   */
+  virtual void resume() PURE;
+
+  /**
+   * Pauses the parser. May be called from within callbacks.
+   * @return CallbackResult::Success, for callbacks to return.
+   */
+  virtual CallbackResult pause() PURE;
+
+  /**
+   * @return the status of the parser.
+   */
+  virtual ParserStatus getStatus() const PURE;
+
+  /**
+   * @return the status code of a response.
+   */
+  virtual uint16_t statusCode() const PURE;
+
+  /**
+   * @return the major and minor HTTP version of the message.
+   */
+  virtual int httpMajor() const PURE;
+  virtual int httpMinor() const PURE;
+
+  /**
+   * @return the value of the content-length header of the message, if any.
+   */
+  virtual absl::optional<uint64_t> contentLength() const PURE;
+
+  /**
+   * @return whether the body of the message uses chunked transfer encoding.
+   */
+  virtual bool isChunked() const PURE;
+
+  /**
+   * @return the method of a request. The returned view points to static storage.
+   */
+  virtual absl::string_view methodName() const PURE;
+
+  /**
+   * @return the name of the error found by the parser, in the form of http_parser error names,
+   * e.g. "HPE_INVALID_CHUNK_SIZE".
+   */
+  virtual absl::string_view errnoName() const PURE;
+};
+
+using ParserPtr = std::unique_ptr<Parser>;
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
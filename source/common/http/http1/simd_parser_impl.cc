@@ -0,0 +1,1165 @@
+#include "common/http/http1/simd_parser_impl.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_split.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+// Error names, as reported by http_parser for the same errors.
+constexpr char ErrorCbMessageBegin[] = "HPE_CB_message_begin";
+constexpr char ErrorCbUrl[] = "HPE_CB_url";
+constexpr char ErrorCbHeaderField[] = "HPE_CB_header_field";
+constexpr char ErrorCbHeaderValue[] = "HPE_CB_header_value";
+constexpr char ErrorCbHeadersComplete[] = "HPE_CB_headers_complete";
+constexpr char ErrorCbMessageComplete[] = "HPE_CB_message_complete";
+constexpr char ErrorInvalidEofState[] = "HPE_INVALID_EOF_STATE";
+constexpr char ErrorClosedConnection[] = "HPE_CLOSED_CONNECTION";
+constexpr char ErrorInvalidVersion[] = "HPE_INVALID_VERSION";
+constexpr char ErrorInvalidStatus[] = "HPE_INVALID_STATUS";
+constexpr char ErrorInvalidMethod[] = "HPE_INVALID_METHOD";
+constexpr char ErrorInvalidUrl[] = "HPE_INVALID_URL";
+constexpr char ErrorInvalidHeaderToken[] = "HPE_INVALID_HEADER_TOKEN";
+constexpr char ErrorInvalidContentLength[] = "HPE_INVALID_CONTENT_LENGTH";
+constexpr char ErrorUnexpectedContentLength[] = "HPE_UNEXPECTED_CONTENT_LENGTH";
+constexpr char ErrorInvalidChunkSize[] = "HPE_INVALID_CHUNK_SIZE";
+constexpr char ErrorInvalidConstant[] = "HPE_INVALID_CONSTANT";
+constexpr char ErrorInvalidTransferEncoding[] = "HPE_INVALID_TRANSFER_ENCODING";
+constexpr char ErrorLfExpected[] = "HPE_LF_EXPECTED";
+constexpr char ErrorStrict[] = "HPE_STRICT";
+
+// The methods accepted by http_parser, most frequent first.
+constexpr absl::string_view Methods[] = {
+    "GET",       "POST",     "PUT",        "DELETE",   "HEAD",     "OPTIONS",     "CONNECT",
+    "PATCH",     "TRACE",    "COPY",       "LOCK",     "MKCOL",    "MOVE",        "PROPFIND",
+    "PROPPATCH", "SEARCH",   "UNLOCK",     "BIND",     "REBIND",   "UNBIND",      "ACL",
+    "REPORT",    "CHECKOUT", "MKACTIVITY", "MERGE",    "M-SEARCH", "NOTIFY",      "SUBSCRIBE",
+    "PURGE",     "LINK",     "UNLINK",     "SOURCE",   "MKCALENDAR", "UNSUBSCRIBE"};
+constexpr absl::string_view ConnectMethod = Methods[6];
+
+absl::string_view findMethod(absl::string_view method) {
+  for (const absl::string_view candidate : Methods) {
+    if (candidate == method) {
+      return candidate;
+    }
+  }
+  return {};
+}
+
+bool isMethodPrefix(absl::string_view prefix) {
+  for (const absl::string_view candidate : Methods) {
+    if (absl::StartsWith(candidate, prefix)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+using CharTable = std::array<bool, 256>;
+
+template <class Predicate> constexpr CharTable makeCharTable(Predicate predicate) {
+  CharTable table{};
+  for (size_t c = 0; c < table.size(); ++c) {
+    table[c] = predicate(static_cast<uint8_t>(c));
+  }
+  return table;
+}
+
+constexpr bool isDigit(uint8_t c) { return c >= '0' && c <= '9'; }
+constexpr bool isAlpha(uint8_t c) { return (c | 0x20) >= 'a' && (c | 0x20) <= 'z'; }
+
+// The token characters of https://tools.ietf.org/html/rfc7230#section-3.2.6.
+constexpr bool isTokenChar(uint8_t c) {
+  switch (c) {
+  case '!':
+  case '#':
+  case '$':
+  case '%':
+  case '&':
+  case '\'':
+  case '*':
+  case '+':
+  case '-':
+  case '.':
+  case '^':
+  case '_':
+  case '`':
+  case '|':
+  case '~':
+    return true;
+  default:
+    return isDigit(c) || isAlpha(c);
+  }
+}
+
+constexpr CharTable MethodStartChars = makeCharTable([](uint8_t c) {
+  for (const absl::string_view method : Methods) {
+    if (static_cast<uint8_t>(method[0]) == c) {
+      return true;
+    }
+  }
+  return false;
+});
+constexpr CharTable MethodChars =
+    makeCharTable([](uint8_t c) { return (c >= 'A' && c <= 'Z') || c == '-'; });
+constexpr CharTable TokenChars = makeCharTable(isTokenChar);
+// The URL characters accepted by http_parser in its non-strict mode, other than '?' and '#'.
+constexpr CharTable UrlChars = makeCharTable([](uint8_t c) {
+  return (c > ' ' && c < 0x7f && c != '?' && c != '#') || c == '\t' || c == '\f' || c >= 0x80;
+});
+constexpr CharTable UserinfoChars = makeCharTable([](uint8_t c) {
+  switch (c) {
+  case '-':
+  case '_':
+  case '.':
+  case '!':
+  case '~':
+  case '*':
+  case '\'':
+  case '(':
+  case ')':
+  case '%':
+  case ';':
+  case ':':
+  case '&':
+  case '=':
+  case '+':
+  case '$':
+  case ',':
+    return true;
+  default:
+    return isDigit(c) || isAlpha(c);
+  }
+});
+
+// The characters at which the scans below stop.
+constexpr CharTable NonTokenChars = makeCharTable([](uint8_t c) { return !isTokenChar(c); });
+constexpr CharTable HeaderValueDelimiters =
+    makeCharTable([](uint8_t c) { return (c < ' ' && c != '\t') || c == 0x7f; });
+constexpr CharTable UrlPathDelimiters =
+    makeCharTable([](uint8_t c) { return c <= ' ' || c == 0x7f || c == '?' || c == '#'; });
+constexpr CharTable UrlQueryDelimiters =
+    makeCharTable([](uint8_t c) { return c <= ' ' || c == 0x7f || c == '#'; });
+constexpr CharTable UrlFragmentDelimiters =
+    makeCharTable([](uint8_t c) { return c <= ' ' || c == 0x7f; });
+constexpr CharTable LineDelimiters =
+    makeCharTable([](uint8_t c) { return c == '\r' || c == '\n'; });
+
+constexpr std::array<int8_t, 256> HexDigits = [] {
+  std::array<int8_t, 256> digits{};
+  for (size_t c = 0; c < digits.size(); ++c) {
+    digits[c] = -1;
+  }
+  for (int i = 0; i < 10; ++i) {
+    digits['0' + i] = i;
+  }
+  for (int i = 0; i < 6; ++i) {
+    digits['a' + i] = 10 + i;
+    digits['A' + i] = 10 + i;
+  }
+  return digits;
+}();
+
+#if defined(__SSE2__)
+// Each of the following returns a mask of the bytes of a block which satisfy a condition. Bytes are
+// compared as unsigned bytes.
+__m128i lessOrEqual(__m128i block, uint8_t max) {
+  const __m128i limit = _mm_set1_epi8(static_cast<char>(max));
+  return _mm_cmpeq_epi8(_mm_max_epu8(block, limit), limit);
+}
+__m128i greaterOrEqual(__m128i block, uint8_t min) {
+  return _mm_cmpeq_epi8(_mm_max_epu8(block, _mm_set1_epi8(static_cast<char>(min))), block);
+}
+__m128i inRange(__m128i block, uint8_t min, uint8_t max) {
+  return lessOrEqual(_mm_sub_epi8(block, _mm_set1_epi8(static_cast<char>(min))), max - min);
+}
+__m128i equal(__m128i block, char c) { return _mm_cmpeq_epi8(block, _mm_set1_epi8(c)); }
+#endif
+
+/**
+ * Returns the first character in [begin, end) at which delimiters is true, or end. Blocks of 16
+ * bytes are matched with sse2_delimiters where SSE2 is available, which must compute a mask of the
+ * bytes at which delimiters is true.
+ */
+template <class Sse2Delimiters>
+const char* find(const char* begin, const char* end, const CharTable& delimiters,
+                 Sse2Delimiters sse2_delimiters) {
+#if defined(__SSE2__)
+  while (end - begin >= 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const int mask = _mm_movemask_epi8(sse2_delimiters(block));
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+    begin += 16;
+  }
+#else
+  UNREFERENCED_PARAMETER(sse2_delimiters);
+#endif
+  while (begin < end && !delimiters[static_cast<uint8_t>(*begin)]) {
+    ++begin;
+  }
+  return begin;
+}
+
+#if defined(__SSE2__)
+#define SSE2_DELIMITERS(expression) [](__m128i block) { return expression; }
+#else
+#define SSE2_DELIMITERS(expression) nullptr
+#endif
+
+const char* findNonTokenChar(const char* begin, const char* end) {
+  return find(
+      begin, end, NonTokenChars,
+      SSE2_DELIMITERS(_mm_or_si128(
+          _mm_or_si128(_mm_or_si128(lessOrEqual(block, ' '), greaterOrEqual(block, 0x7f)),
+                       _mm_or_si128(inRange(block, ':', '@'), inRange(block, '[', ']'))),
+          _mm_or_si128(
+              _mm_or_si128(_mm_or_si128(equal(block, '"'), inRange(block, '(', ')')),
+                           _mm_or_si128(equal(block, ','), equal(block, '/'))),
+              _mm_or_si128(equal(block, '{'), equal(block, '}'))))));
+}
+
+const char* findHeaderValueDelimiter(const char* begin, const char* end) {
+  return find(begin, end, HeaderValueDelimiters,
+              SSE2_DELIMITERS(_mm_or_si128(
+                  _mm_andnot_si128(equal(block, '\t'), lessOrEqual(block, ' ' - 1)),
+                  equal(block, 0x7f))));
+}
+
+const char* findUrlPathDelimiter(const char* begin, const char* end) {
+  return find(begin, end, UrlPathDelimiters,
+              SSE2_DELIMITERS(_mm_or_si128(
+                  _mm_or_si128(lessOrEqual(block, ' '), equal(block, 0x7f)),
+                  _mm_or_si128(equal(block, '?'), equal(block, '#')))));
+}
+
+const char* findUrlQueryDelimiter(const char* begin, const char* end) {
+  return find(begin, end, UrlQueryDelimiters,
+              SSE2_DELIMITERS(_mm_or_si128(
+                  _mm_or_si128(lessOrEqual(block, ' '), equal(block, 0x7f)), equal(block, '#'))));
+}
+
+const char* findUrlFragmentDelimiter(const char* begin, const char* end) {
+  return find(begin, end, UrlFragmentDelimiters,
+              SSE2_DELIMITERS(_mm_or_si128(lessOrEqual(block, ' '), equal(block, 0x7f))));
+}
+
+const char* findLineDelimiter(const char* begin, const char* end) {
+  return find(begin, end, LineDelimiters,
+              SSE2_DELIMITERS(_mm_or_si128(equal(block, '\r'), equal(block, '\n'))));
+}
+
+#undef SSE2_DELIMITERS
+
+} // namespace
+
+SimdHttpParserImpl::SimdHttpParserImpl(MessageType type, ParserCallbacks& callbacks)
+    : type_(type), callbacks_(callbacks) {}
+
+size_t SimdHttpParserImpl::execute(const char* slice, size_t len) {
+  if (status_ != ParserStatus::Ok) {
+    return 0;
+  }
+  if (len == 0) {
+    onEof();
+    return 0;
+  }
+
+  stopped_ = false;
+  const char* p = slice;
+  const char* const end = slice + len;
+  while (p < end && status_ == ParserStatus::Ok && !stopped_) {
+    switch (state_) {
+    case State::MessageStart:
+      p = parseMessageStart(p, end);
+      break;
+    case State::Method:
+      p = parseMethod(p, end);
+      break;
+    case State::SpacesBeforeUrl:
+      p = parseSpacesBeforeUrl(p, end);
+      break;
+    case State::Url:
+      p = parseUrl(p, end);
+      break;
+    case State::RequestVersion:
+      p = parseRequestVersion(p, end);
+      break;
+    case State::ResponseVersion:
+      p = parseResponseVersion(p, end);
+      break;
+    case State::StatusCodeStart:
+      p = parseStatusCodeStart(p);
+      break;
+    case State::StatusCode:
+      p = parseStatusCode(p, end);
+      break;
+    case State::ReasonPhrase:
+      p = parseReasonPhrase(p, end);
+      break;
+    case State::StartLineAlmostDone:
+      p = expectLf(p, State::HeaderFieldStart, ErrorLfExpected);
+      break;
+    case State::HeaderFieldStart:
+      p = parseHeaderFieldStart(p, end);
+      break;
+    case State::HeaderField:
+      p = parseHeaderField(p, end);
+      break;
+    case State::HeaderValueDiscardWs:
+      p = parseHeaderValueDiscardWs(p, end);
+      break;
+    case State::HeaderValueDiscardWsAlmostDone:
+      p = expectLf(p, State::HeaderValueDiscardLws, ErrorLfExpected);
+      break;
+    case State::HeaderValueDiscardLws:
+      p = parseHeaderValueDiscardLws(p);
+      break;
+    case State::HeaderValue:
+      p = parseHeaderValue(p, p, end);
+      break;
+    case State::HeaderAlmostDone:
+      p = expectLf(p, State::HeaderValueLws, ErrorLfExpected);
+      break;
+    case State::HeaderValueLws:
+      p = parseHeaderValueLws(p);
+      break;
+    case State::HeadersAlmostDone:
+      p = *p == '\n' ? onHeadersEnd(p) : setError(ErrorLfExpected, p);
+      break;
+    case State::HeadersDone:
+      p = startBody(p);
+      break;
+    case State::BodyIdentity:
+    case State::BodyIdentityEof:
+    case State::ChunkData:
+      p = parseBody(p, end);
+      break;
+    case State::ChunkSizeStart:
+    case State::ChunkSize:
+      p = parseChunkSize(p, end);
+      break;
+    case State::ChunkParameters: {
+      // Chunk extensions are ignored.
+      const char* cr = static_cast<const char*>(memchr(p, '\r', end - p));
+      if (cr == nullptr) {
+        p = end;
+      } else {
+        state_ = State::ChunkSizeAlmostDone;
+        p = cr + 1;
+      }
+      break;
+    }
+    case State::ChunkSizeAlmostDone:
+      p = parseChunkSizeAlmostDone(p);
+      break;
+    case State::ChunkDataAlmostDone:
+      if (*p == '\r') {
+        state_ = State::ChunkDataDone;
+        ++p;
+      } else {
+        p = setError(ErrorStrict, p);
+      }
+      break;
+    case State::ChunkDataDone:
+      p = expectLf(p, State::ChunkSizeStart, ErrorStrict);
+      break;
+    case State::Dead:
+      // Only empty lines may follow a message after which the connection is closed.
+      p = (*p == '\r' || *p == '\n') ? p + 1 : setError(ErrorClosedConnection, p);
+      break;
+    }
+  }
+  return p - slice;
+}
+
+void SimdHttpParserImpl::resume() {
+  if (status_ == ParserStatus::Paused) {
+    status_ = ParserStatus::Ok;
+  }
+}
+
+CallbackResult SimdHttpParserImpl::pause() {
+  if (status_ == ParserStatus::Ok) {
+    status_ = ParserStatus::Paused;
+  }
+  return CallbackResult::Success;
+}
+
+absl::string_view SimdHttpParserImpl::errnoName() const {
+  switch (status_) {
+  case ParserStatus::Ok:
+    return "HPE_OK";
+  case ParserStatus::Paused:
+    return "HPE_PAUSED";
+  case ParserStatus::Error:
+    return error_name_;
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+const char* SimdHttpParserImpl::parseMessageStart(const char* p, const char* end) {
+  // Empty lines before a message are ignored.
+  while (p < end && (*p == '\r' || *p == '\n')) {
+    ++p;
+  }
+  if (p == end) {
+    return p;
+  }
+  if (type_ == MessageType::Request) {
+    if (!MethodStartChars[static_cast<uint8_t>(*p)]) {
+      return setError(ErrorInvalidMethod, p);
+    }
+    state_ = State::Method;
+  } else {
+    if (*p != 'H') {
+      return setError(ErrorInvalidConstant, p);
+    }
+    state_ = State::ResponseVersion;
+  }
+
+  method_ = {};
+  method_length_ = 0;
+  version_index_ = 0;
+  http_major_ = 0;
+  http_minor_ = 0;
+  status_code_ = 0;
+  content_length_.reset();
+  remaining_ = 0;
+  chunked_ = false;
+  has_transfer_encoding_ = false;
+  has_upgrade_ = false;
+  connection_close_ = false;
+  connection_keep_alive_ = false;
+  connection_upgrade_ = false;
+  upgrade_ = false;
+  skip_body_ = false;
+  trailing_ = false;
+
+  if (callbacks_.onMessageBegin() == CallbackResult::Error) {
+    return setError(ErrorCbMessageBegin, p);
+  }
+  return p;
+}
+
+const char* SimdHttpParserImpl::parseMethod(const char* p, const char* end) {
+  for (; p < end; ++p) {
+    const char c = *p;
+    if (c == ' ') {
+      method_ = findMethod(absl::string_view(method_buffer_, method_length_));
+      if (method_.empty()) {
+        return setError(ErrorInvalidMethod, p);
+      }
+      state_ = State::SpacesBeforeUrl;
+      return p + 1;
+    }
+    if (!MethodChars[static_cast<uint8_t>(c)] || method_length_ == MaxMethodLength) {
+      return setError(ErrorInvalidMethod, p);
+    }
+    method_buffer_[method_length_++] = c;
+  }
+  // The method continues in the next slice. Reject it now if no method starts with it.
+  if (!isMethodPrefix(absl::string_view(method_buffer_, method_length_))) {
+    return setError(ErrorInvalidMethod, p);
+  }
+  return p;
+}
+
+const char* SimdHttpParserImpl::parseSpacesBeforeUrl(const char* p, const char* end) {
+  while (p < end && *p == ' ') {
+    ++p;
+  }
+  if (p < end) {
+    // The target of a CONNECT request is an authority.
+    url_state_ = method_ == ConnectMethod ? UrlState::ServerStart : UrlState::Start;
+    state_ = State::Url;
+  }
+  return p;
+}
+
+const char* SimdHttpParserImpl::parseUrl(const char* p, const char* end) {
+  const char* const begin = p;
+  while (p < end) {
+    // The path, query and fragment make up most of a URL, and are scanned for their delimiters.
+    switch (url_state_) {
+    case UrlState::Path:
+      p = findUrlPathDelimiter(p, end);
+      break;
+    case UrlState::Query:
+      p = findUrlQueryDelimiter(p, end);
+      break;
+    case UrlState::Fragment:
+      p = findUrlFragmentDelimiter(p, end);
+      break;
+    default:
+      break;
+    }
+    if (p == end) {
+      break;
+    }
+
+    const uint8_t c = *p;
+    if (c == ' ' || c == '\r' || c == '\n') {
+      if (url_state_ < UrlState::Server) {
+        return setError(ErrorInvalidUrl, p);
+      }
+      if (p != begin && callbacks_.onUrl(begin, p - begin) == CallbackResult::Error) {
+        return setError(ErrorCbUrl, p);
+      }
+      if (c == ' ') {
+        state_ = State::RequestVersion;
+      } else {
+        // A request line without a version is a HTTP/0.9 request.
+        http_major_ = 0;
+        http_minor_ = 9;
+        state_ = c == '\r' ? State::StartLineAlmostDone : State::HeaderFieldStart;
+      }
+      return p + 1;
+    }
+
+    switch (url_state_) {
+    case UrlState::Start:
+      url_state_ = (c == '/' || c == '*') ? UrlState::Path
+                   : isAlpha(c)           ? UrlState::Schema
+                                          : UrlState::Invalid;
+      break;
+    case UrlState::Schema:
+      url_state_ = isAlpha(c) ? UrlState::Schema
+                   : c == ':' ? UrlState::SchemaSlash
+                              : UrlState::Invalid;
+      break;
+    case UrlState::SchemaSlash:
+      url_state_ = c == '/' ? UrlState::SchemaSlashSlash : UrlState::Invalid;
+      break;
+    case UrlState::SchemaSlashSlash:
+      url_state_ = c == '/' ? UrlState::ServerStart : UrlState::Invalid;
+      break;
+    case UrlState::ServerWithAt:
+    case UrlState::ServerStart:
+    case UrlState::Server:
+      if (c == '/') {
+        url_state_ = UrlState::Path;
+      } else if (c == '?') {
+        url_state_ = UrlState::Query;
+      } else if (c == '@') {
+        url_state_ =
+            url_state_ == UrlState::ServerWithAt ? UrlState::Invalid : UrlState::ServerWithAt;
+      } else if (UserinfoChars[c] || c == '[' || c == ']') {
+        url_state_ = UrlState::Server;
+      } else {
+        url_state_ = UrlState::Invalid;
+      }
+      break;
+    case UrlState::Path:
+      url_state_ = UrlChars[c]  ? UrlState::Path
+                   : c == '?'   ? UrlState::Query
+                   : c == '#'   ? UrlState::Fragment
+                                : UrlState::Invalid;
+      break;
+    case UrlState::Query:
+      url_state_ = (UrlChars[c] || c == '?') ? UrlState::Query
+                   : c == '#'                ? UrlState::Fragment
+                                             : UrlState::Invalid;
+      break;
+    case UrlState::Fragment:
+      url_state_ = (UrlChars[c] || c == '?' || c == '#') ? UrlState::Fragment : UrlState::Invalid;
+      break;
+    case UrlState::Invalid:
+      break;
+    }
+    if (url_state_ == UrlState::Invalid) {
+      return setError(ErrorInvalidUrl, p);
+    }
+    ++p;
+  }
+
+  // The URL continues in the next slice.
+  if (p != begin && callbacks_.onUrl(begin, p - begin) == CallbackResult::Error) {
+    return setError(ErrorCbUrl, p);
+  }
+  return p;
+}
+
+const char* SimdHttpParserImpl::parseRequestVersion(const char* p, const char* end) {
+  if (version_index_ == 0) {
+    while (p < end && *p == ' ') {
+      ++p;
+    }
+    if (end - p >= 10 && memcmp(p, "HTTP/1.1\r\n", 10) == 0) {
+      http_major_ = 1;
+      http_minor_ = 1;
+      state_ = State::HeaderFieldStart;
+      return p + 10;
+    }
+  }
+  for (; p < end; ++p, ++version_index_) {
+    const char c = *p;
+    switch (version_index_) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+    case 4:
+      if (c != "HTTP/"[version_index_]) {
+        return setError(ErrorInvalidConstant, p);
+      }
+      break;
+    case 5:
+    case 7:
+      if (!isDigit(c)) {
+        return setError(ErrorInvalidVersion, p);
+      }
+      (version_index_ == 5 ? http_major_ : http_minor_) = c - '0';
+      break;
+    case 6:
+      if (c != '.') {
+        return setError(ErrorInvalidVersion, p);
+      }
+      break;
+    default:
+      if (c == '\r') {
+        state_ = State::StartLineAlmostDone;
+        return p + 1;
+      }
+      if (c == '\n') {
+        state_ = State::HeaderFieldStart;
+        return p + 1;
+      }
+      return setError(ErrorInvalidVersion, p);
+    }
+  }
+  return p;
+}
+
+const char* SimdHttpParserImpl::parseResponseVersion(const char* p, const char* end) {
+  if (version_index_ == 0 && end - p >= 9 && memcmp(p, "HTTP/1.1 ", 9) == 0) {
+    http_major_ = 1;
+    http_minor_ = 1;
+    state_ = State::StatusCodeStart;
+    return p + 9;
+  }
+  for (; p < end; ++p, ++version_index_) {
+    const char c = *p;
+    switch (version_index_) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+    case 4:
+      if (c != "HTTP/"[version_index_]) {
+        return setError(ErrorInvalidConstant, p);
+      }
+      break;
+    case 5:
+    case 7:
+      if (!isDigit(c)) {
+        return setError(ErrorInvalidVersion, p);
+      }
+      (version_index_ == 5 ? http_major_ : http_minor_) = c - '0';
+      break;
+    case 6:
+      if (c != '.') {
+        return setError(ErrorInvalidVersion, p);
+      }
+      break;
+    default:
+      if (c != ' ') {
+        return setError(ErrorInvalidVersion, p);
+      }
+      state_ = State::StatusCodeStart;
+      return p + 1;
+    }
+  }
+  return p;
+}
+
+const char* SimdHttpParserImpl::parseStatusCodeStart(const char* p) {
+  if (*p == ' ') {
+    return p + 1;
+  }
+  if (!isDigit(*p)) {
+    return setError(ErrorInvalidStatus, p);
+  }
+  status_code_ = *p - '0';
+  state_ = State::StatusCode;
+  return p + 1;
+}
+
+const char* SimdHttpParserImpl::parseStatusCode(const char* p, const char* end) {
+  for (; p < end; ++p) {
+    const char c = *p;
+    if (isDigit(c)) {
+      status_code_ = status_code_ * 10 + (c - '0');
+      if (status_code_ > 999) {
+        return setError(ErrorInvalidStatus, p);
+      }
+      continue;
+    }
+    switch (c) {
+    case ' ':
+      state_ = State::ReasonPhrase;
+      return p + 1;
+    case '\r':
+      state_ = State::StartLineAlmostDone;
+      return p + 1;
+    case '\n':
+      state_ = State::HeaderFieldStart;
+      return p + 1;
+    default:
+      return setError(ErrorInvalidStatus, p);
+    }
+  }
+  return p;
+}
+
+const char* SimdHttpParserImpl::parseReasonPhrase(const char* p, const char* end) {
+  // The reason phrase is not validated, nor passed to the callbacks.
+  p = findLineDelimiter(p, end);
+  if (p == end) {
+    return p;
+  }
+  state_ = *p == '\r' ? State::StartLineAlmostDone : State::HeaderFieldStart;
+  return p + 1;
+}
+
+const char* SimdHttpParserImpl::parseHeaderFieldStart(const char* p, const char* end) {
+  switch (*p) {
+  case '\r':
+    state_ = State::HeadersAlmostDone;
+    return p + 1;
+  case '\n':
+    return onHeadersEnd(p);
+  default:
+    if (!TokenChars[static_cast<uint8_t>(*p)]) {
+      return setError(ErrorInvalidHeaderToken, p);
+    }
+    header_name_length_ = 0;
+    state_ = State::HeaderField;
+    return parseHeaderField(p, end);
+  }
+}
+
+const char* SimdHttpParserImpl::parseHeaderField(const char* p, const char* end) {
+  const char* name_end = findNonTokenChar(p, end);
+  if (name_end != end && *name_end != ':') {
+    return setError(ErrorInvalidHeaderToken, name_end);
+  }
+  if (!trailing_) {
+    recordHeaderName(p, name_end);
+  }
+  if (name_end != p &&
+      callbacks_.onHeaderField(p, name_end - p) == CallbackResult::Error) {
+    return setError(ErrorCbHeaderField, name_end);
+  }
+  if (name_end == end) {
+    return end;
+  }
+  classifyHeaderName();
+  state_ = State::HeaderValueDiscardWs;
+  if (status_ != ParserStatus::Ok) {
+    return name_end + 1;
+  }
+  return parseHeaderValueDiscardWs(name_end + 1, end);
+}
+
+const char* SimdHttpParserImpl::parseHeaderValueDiscardWs(const char* p, const char* end) {
+  while (p < end && (*p == ' ' || *p == '\t')) {
+    ++p;
+  }
+  if (p == end) {
+    return p;
+  }
+  switch (*p) {
+  case '\r':
+    state_ = State::HeaderValueDiscardWsAlmostDone;
+    return p + 1;
+  case '\n':
+    state_ = State::HeaderValueDiscardLws;
+    return p + 1;
+  default:
+    // As with http_parser, the first character of a value is not validated here, and is left to
+    // the codec to validate.
+    state_ = State::HeaderValue;
+    return parseHeaderValue(p, p + 1, end);
+  }
+}
+
+const char* SimdHttpParserImpl::parseHeaderValueDiscardLws(const char* p) {
+  if (*p == ' ' || *p == '\t') {
+    // The value starts on a continuation line.
+    state_ = State::HeaderValueDiscardWs;
+    return p + 1;
+  }
+  // The header value is empty.
+  if (!finishHeader()) {
+    return p;
+  }
+  state_ = State::HeaderFieldStart;
+  if (callbacks_.onHeaderValue(p, 0) == CallbackResult::Error) {
+    return setError(ErrorCbHeaderValue, p);
+  }
+  return p;
+}
+
+const char* SimdHttpParserImpl::parseHeaderValue(const char* p, const char* scan_begin,
+                                                 const char* end) {
+  const char* value_end = findHeaderValueDelimiter(scan_begin, end);
+  if (value_end != end && *value_end != '\r' && *value_end != '\n') {
+    return setError(ErrorInvalidHeaderToken, value_end);
+  }
+  if (value_end != p) {
+    if (header_kind_ != HeaderKind::Other) {
+      header_value_.append(p, value_end - p);
+    }
+    if (callbacks_.onHeaderValue(p, value_end - p) == CallbackResult::Error) {
+      return setError(ErrorCbHeaderValue, value_end);
+    }
+    if (status_ != ParserStatus::Ok) {
+      // Paused. The line end is parsed when the parser is resumed.
+      return value_end;
+    }
+  }
+  if (value_end == end) {
+    return end;
+  }
+  if (*value_end == '\n') {
+    state_ = State::HeaderValueLws;
+    return value_end + 1;
+  }
+  if (end - value_end >= 3 && value_end[1] == '\n') {
+    // The common case of a CRLF followed by the next line, which is parsed here rather than by
+    // going through the intermediate states.
+    state_ = State::HeaderValueLws;
+    return parseHeaderValueLws(value_end + 2);
+  }
+  state_ = State::HeaderAlmostDone;
+  return value_end + 1;
+}
+
+const char* SimdHttpParserImpl::parseHeaderValueLws(const char* p) {
+  if (*p == ' ' || *p == '\t') {
+    // An obsolete line folding. The whitespace is part of the value, as with http_parser.
+    state_ = State::HeaderValue;
+    return p;
+  }
+  if (!finishHeader()) {
+    return p;
+  }
+  state_ = State::HeaderFieldStart;
+  return p;
+}
+
+void SimdHttpParserImpl::recordHeaderName(const char* begin, const char* end) {
+  const size_t length = end - begin;
+  if (header_name_length_ + length <= MaxClassifiedHeaderNameLength) {
+    for (size_t i = 0; i < length; ++i) {
+      header_name_[header_name_length_ + i] = absl::ascii_tolower(begin[i]);
+    }
+  }
+  header_name_length_ += length;
+}
+
+void SimdHttpParserImpl::classifyHeaderName() {
+  header_kind_ = HeaderKind::Other;
+  if (trailing_ || header_name_length_ > MaxClassifiedHeaderNameLength) {
+    return;
+  }
+  const absl::string_view name(header_name_, header_name_length_);
+  if (name == "content-length") {
+    header_kind_ = HeaderKind::ContentLength;
+  } else if (name == "transfer-encoding") {
+    header_kind_ = HeaderKind::TransferEncoding;
+  } else if (name == "connection" || name == "proxy-connection") {
+    header_kind_ = HeaderKind::Connection;
+  } else if (name == "upgrade") {
+    header_kind_ = HeaderKind::Upgrade;
+  }
+  header_value_.clear();
+}
+
+bool SimdHttpParserImpl::finishHeader() {
+  switch (header_kind_) {
+  case HeaderKind::Other:
+    return true;
+  case HeaderKind::ContentLength: {
+    if (content_length_.has_value()) {
+      setError(ErrorUnexpectedContentLength, nullptr);
+      return false;
+    }
+    const absl::string_view value = absl::StripAsciiWhitespace(header_value_);
+    if (value.empty()) {
+      setError(ErrorInvalidContentLength, nullptr);
+      return false;
+    }
+    uint64_t content_length = 0;
+    for (const char c : value) {
+      if (!isDigit(c) || content_length > (UINT64_MAX - 10) / 10) {
+        setError(ErrorInvalidContentLength, nullptr);
+        return false;
+      }
+      content_length = content_length * 10 + (c - '0');
+    }
+    content_length_ = content_length;
+    break;
+  }
+  case HeaderKind::TransferEncoding: {
+    // The body is chunked if chunked is the last transfer coding.
+    has_transfer_encoding_ = true;
+    const size_t last_comma = header_value_.rfind(',');
+    const absl::string_view last_coding =
+        last_comma == std::string::npos
+            ? absl::string_view(header_value_)
+            : absl::string_view(header_value_).substr(last_comma + 1);
+    chunked_ = absl::EqualsIgnoreCase(absl::StripAsciiWhitespace(last_coding), "chunked");
+    break;
+  }
+  case HeaderKind::Connection:
+    for (const absl::string_view token : absl::StrSplit(header_value_, ',')) {
+      const absl::string_view option = absl::StripAsciiWhitespace(token);
+      if (absl::EqualsIgnoreCase(option, "close")) {
+        connection_close_ = true;
+      } else if (absl::EqualsIgnoreCase(option, "keep-alive")) {
+        connection_keep_alive_ = true;
+      } else if (absl::EqualsIgnoreCase(option, "upgrade")) {
+        connection_upgrade_ = true;
+      }
+    }
+    break;
+  case HeaderKind::Upgrade:
+    has_upgrade_ = true;
+    break;
+  }
+  header_kind_ = HeaderKind::Other;
+  return true;
+}
+
+const char* SimdHttpParserImpl::onHeadersEnd(const char* p) {
+  if (trailing_) {
+    return completeMessage(p + 1);
+  }
+  if (has_transfer_encoding_ && content_length_.has_value()) {
+    return setError(ErrorUnexpectedContentLength, p);
+  }
+  if (has_upgrade_ && connection_upgrade_) {
+    upgrade_ = type_ == MessageType::Request || status_code_ == 101;
+  } else {
+    upgrade_ = method_ == ConnectMethod;
+  }
+
+  switch (callbacks_.onHeadersComplete()) {
+  case CallbackResult::Success:
+    break;
+  case CallbackResult::NoBody:
+    skip_body_ = true;
+    break;
+  case CallbackResult::NoBodyData:
+    upgrade_ = true;
+    skip_body_ = true;
+    break;
+  case CallbackResult::Error:
+    return setError(ErrorCbHeadersComplete, p);
+  }
+  if (status_ != ParserStatus::Ok) {
+    // Paused. The body is started when the parser is resumed, at the same LF.
+    state_ = State::HeadersDone;
+    return p;
+  }
+  return startBody(p);
+}
+
+const char* SimdHttpParserImpl::startBody(const char* p) {
+  const char* body = p + 1;
+  const bool has_body = chunked_ || content_length_.value_or(0) > 0;
+  if (upgrade_ && (method_ == ConnectMethod || skip_body_ || !has_body)) {
+    // Whatever follows is not HTTP/1.1 data. completeMessage() stops parsing.
+    return completeMessage(body);
+  }
+  if (skip_body_) {
+    return completeMessage(body);
+  }
+  if (chunked_) {
+    state_ = State::ChunkSizeStart;
+    return body;
+  }
+  if (has_transfer_encoding_) {
+    // A request body must be chunked if it has any transfer coding, while a response body is then
+    // read until the connection is closed.
+    if (type_ == MessageType::Request) {
+      return setError(ErrorInvalidTransferEncoding, p);
+    }
+    state_ = State::BodyIdentityEof;
+    return body;
+  }
+  if (content_length_.has_value()) {
+    if (content_length_.value() == 0) {
+      return completeMessage(body);
+    }
+    remaining_ = content_length_.value();
+    state_ = State::BodyIdentity;
+    return body;
+  }
+  if (!messageNeedsEof()) {
+    return completeMessage(body);
+  }
+  state_ = State::BodyIdentityEof;
+  return body;
+}
+
+const char* SimdHttpParserImpl::parseBody(const char* p, const char* end) {
+  if (state_ == State::BodyIdentityEof) {
+    callbacks_.bufferBody(p, end - p);
+    return end;
+  }
+  const uint64_t length = std::min<uint64_t>(remaining_, end - p);
+  callbacks_.bufferBody(p, length);
+  remaining_ -= length;
+  p += length;
+  if (remaining_ != 0) {
+    return p;
+  }
+  if (state_ == State::ChunkData) {
+    if (end - p >= 2 && p[0] == '\r' && p[1] == '\n') {
+      state_ = State::ChunkSizeStart;
+      return p + 2;
+    }
+    state_ = State::ChunkDataAlmostDone;
+    return p;
+  }
+  return completeMessage(p);
+}
+
+const char* SimdHttpParserImpl::parseChunkSize(const char* p, const char* end) {
+  if (state_ == State::ChunkSizeStart) {
+    const int8_t digit = HexDigits[static_cast<uint8_t>(*p)];
+    if (digit < 0) {
+      return setError(ErrorInvalidChunkSize, p);
+    }
+    remaining_ = digit;
+    state_ = State::ChunkSize;
+    ++p;
+  }
+  for (; p < end; ++p) {
+    const int8_t digit = HexDigits[static_cast<uint8_t>(*p)];
+    if (digit >= 0) {
+      if (remaining_ > (UINT64_MAX - 16) / 16) {
+        return setError(ErrorInvalidContentLength, p);
+      }
+      remaining_ = remaining_ * 16 + digit;
+      continue;
+    }
+    switch (*p) {
+    case '\r':
+      state_ = State::ChunkSizeAlmostDone;
+      return p + 1;
+    case ';':
+    case ' ':
+      state_ = State::ChunkParameters;
+      return p + 1;
+    default:
+      return setError(ErrorInvalidChunkSize, p);
+    }
+  }
+  return p;
+}
+
+const char* SimdHttpParserImpl::parseChunkSizeAlmostDone(const char* p) {
+  if (*p != '\n') {
+    return setError(ErrorLfExpected, p);
+  }
+  const bool is_final_chunk = remaining_ == 0;
+  if (is_final_chunk) {
+    trailing_ = true;
+    state_ = State::HeaderFieldStart;
+  } else {
+    state_ = State::ChunkData;
+  }
+  callbacks_.onChunkHeader(is_final_chunk);
+  return p + 1;
+}
+
+const char* SimdHttpParserImpl::completeMessage(const char* next) {
+  state_ = newMessageState();
+  if (callbacks_.onMessageComplete() == CallbackResult::Error) {
+    return setError(ErrorCbMessageComplete, next);
+  }
+  stopped_ = upgrade_;
+  return next;
+}
+
+bool SimdHttpParserImpl::messageNeedsEof() const {
+  if (type_ == MessageType::Request) {
+    return false;
+  }
+  if (status_code_ / 100 == 1 || status_code_ == 204 || status_code_ == 304 || skip_body_) {
+    return false;
+  }
+  if (has_transfer_encoding_ && !chunked_) {
+    return true;
+  }
+  return !chunked_ && !content_length_.has_value();
+}
+
+bool SimdHttpParserImpl::shouldKeepAlive() const {
+  if (http_major_ > 0 && http_minor_ > 0) {
+    if (connection_close_) {
+      return false;
+    }
+  } else if (!connection_keep_alive_) {
+    return false;
+  }
+  return !messageNeedsEof();
+}
+
+SimdHttpParserImpl::State SimdHttpParserImpl::newMessageState() const {
+  return shouldKeepAlive() ? State::MessageStart : State::Dead;
+}
+
+void SimdHttpParserImpl::onEof() {
+  switch (state_) {
+  case State::MessageStart:
+  case State::Dead:
+    return;
+  case State::BodyIdentityEof:
+    state_ = State::Dead;
+    if (callbacks_.onMessageComplete() == CallbackResult::Error) {
+      setError(ErrorCbMessageComplete, nullptr);
+    }
+    return;
+  default:
+    setError(ErrorInvalidEofState, nullptr);
+    return;
+  }
+}
+
+const char* SimdHttpParserImpl::setError(const char* error_name, const char* p) {
+  status_ = ParserStatus::Error;
+  error_name_ = error_name;
+  return p;
+}
+
+const char* SimdHttpParserImpl::expectLf(const char* p, State next_state, const char* error_name) {
+  if (*p != '\n') {
+    return setError(error_name, p);
+  }
+  state_ = next_state;
+  return p + 1;
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "common/http/http1/parser.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * A Parser which scans for delimiters and validates URL, header name and header value characters
+ * many bytes at a time, using SSE2 where available and lookup tables otherwise. The spans passed to
+ * the callbacks point directly into the parsed slice, and a header field or value is passed in a
+ * single call unless it is split across slices.
+ *
+ * The parser accepts the same messages as http_parser 2.9.3 in its non-strict mode, and reports
+ * errors with the same error names, with these exceptions:
+ * - A CR in the start line, a header line or the chunked framing must be followed by a LF, and a
+ *   chunk must be followed by CRLF.
+ * - Request lines must use the "HTTP/" protocol name exactly.
+ * - Header names must not contain spaces.
+ * - Content-length, transfer-encoding, connection and upgrade trailers do not affect framing.
+ */
+class SimdHttpParserImpl : public Parser {
+public:
+  SimdHttpParserImpl(MessageType type, ParserCallbacks& callbacks);
+
+  // Http1::Parser
+  size_t execute(const char* slice, size_t len) override;
+  void resume() override;
+  CallbackResult pause() override;
+  ParserStatus getStatus() const override { return status_; }
+  uint16_t statusCode() const override { return status_code_; }
+  int httpMajor() const override { return http_major_; }
+  int httpMinor() const override { return http_minor_; }
+  absl::optional<uint64_t> contentLength() const override { return content_length_; }
+  bool isChunked() const override { return chunked_; }
+  absl::string_view methodName() const override { return method_; }
+  absl::string_view errnoName() const override;
+
+private:
+  enum class State : uint8_t {
+    MessageStart,
+    Method,
+    SpacesBeforeUrl,
+    Url,
+    RequestVersion,
+    ResponseVersion,
+    StatusCodeStart,
+    StatusCode,
+    ReasonPhrase,
+    StartLineAlmostDone,
+    HeaderFieldStart,
+    HeaderField,
+    HeaderValueDiscardWs,
+    HeaderValueDiscardWsAlmostDone,
+    HeaderValueDiscardLws,
+    HeaderValue,
+    HeaderAlmostDone,
+    HeaderValueLws,
+    HeadersAlmostDone,
+    HeadersDone,
+    BodyIdentity,
+    BodyIdentityEof,
+    ChunkSizeStart,
+    ChunkSize,
+    ChunkParameters,
+    ChunkSizeAlmostDone,
+    ChunkData,
+    ChunkDataAlmostDone,
+    ChunkDataDone,
+    Dead,
+  };
+
+  // The states of the request target, following the URL states of http_parser.
+  enum class UrlState : uint8_t {
+    Start,
+    Schema,
+    SchemaSlash,
+    SchemaSlashSlash,
+    ServerStart,
+    Server,
+    ServerWithAt,
+    Path,
+    Query,
+    Fragment,
+    Invalid,
+  };
+
+  // Headers which determine the framing of a message or whether the connection is kept alive.
+  enum class HeaderKind : uint8_t { Other, ContentLength, TransferEncoding, Connection, Upgrade };
+
+  // The state handlers. Each parses input from p, and returns the end of the parsed input.
+  const char* parseMessageStart(const char* p, const char* end);
+  const char* parseMethod(const char* p, const char* end);
+  const char* parseSpacesBeforeUrl(const char* p, const char* end);
+  const char* parseUrl(const char* p, const char* end);
+  const char* parseRequestVersion(const char* p, const char* end);
+  const char* parseResponseVersion(const char* p, const char* end);
+  const char* parseStatusCodeStart(const char* p);
+  const char* parseStatusCode(const char* p, const char* end);
+  const char* parseReasonPhrase(const char* p, const char* end);
+  const char* parseHeaderFieldStart(const char* p, const char* end);
+  const char* parseHeaderField(const char* p, const char* end);
+  const char* parseHeaderValueDiscardWs(const char* p, const char* end);
+  const char* parseHeaderValueDiscardLws(const char* p);
+  // Scans the value for its end from scan_begin.
+  const char* parseHeaderValue(const char* p, const char* scan_begin, const char* end);
+  const char* parseHeaderValueLws(const char* p);
+  const char* parseChunkSize(const char* p, const char* end);
+  const char* parseChunkSizeAlmostDone(const char* p);
+  const char* parseBody(const char* p, const char* end);
+
+  // Called at the LF ending the headers or trailers.
+  const char* onHeadersEnd(const char* p);
+  // Called at the LF ending the headers, once onHeadersComplete() has returned.
+  const char* startBody(const char* p);
+  // Completes the message. Returns next, the end of the message.
+  const char* completeMessage(const char* next);
+  // Applies the content-length, transfer-encoding, connection and upgrade headers.
+  bool finishHeader();
+  void recordHeaderName(const char* begin, const char* end);
+  void classifyHeaderName();
+  bool messageNeedsEof() const;
+  bool shouldKeepAlive() const;
+  State newMessageState() const;
+  void onEof();
+  const char* setError(const char* error_name, const char* p);
+  const char* expectLf(const char* p, State next_state, const char* error_name);
+
+  static constexpr size_t MaxMethodLength = 11;
+  // The length of "transfer-encoding", the longest header name of a HeaderKind.
+  static constexpr size_t MaxClassifiedHeaderNameLength = 17;
+
+  const MessageType type_;
+  ParserCallbacks& callbacks_;
+  State state_{State::MessageStart};
+  UrlState url_state_{UrlState::Start};
+  HeaderKind header_kind_{HeaderKind::Other};
+  ParserStatus status_{ParserStatus::Ok};
+  const char* error_name_{};
+  // Set when parsing must stop at the end of an upgraded message, without pausing the parser.
+  bool stopped_{};
+
+  // The method of a request, pointing to a static string.
+  absl::string_view method_;
+  char method_buffer_[MaxMethodLength];
+  uint8_t method_length_{};
+  // The index of the next character of "HTTP/x.y" to parse.
+  uint8_t version_index_{};
+  uint8_t http_major_{};
+  uint8_t http_minor_{};
+  uint16_t status_code_{};
+
+  // The lowercase header name, recorded up to MaxClassifiedHeaderNameLength characters.
+  char header_name_[MaxClassifiedHeaderNameLength];
+  size_t header_name_length_{};
+  // The value of a header of a HeaderKind other than Other.
+  std::string header_value_;
+
+  absl::optional<uint64_t> content_length_;
+  // The size of the rest of the identity body or of the current chunk.
+  uint64_t remaining_{};
+  bool chunked_{};
+  bool has_transfer_encoding_{};
+  bool has_upgrade_{};
+  bool connection_close_{};
+  bool connection_keep_alive_{};
+  bool connection_upgrade_{};
+  bool upgrade_{};
+  bool skip_body_{};
+  // Set while parsing the trailers of a chunked body.
+  bool trailing_{};
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -23,6 +23,7 @@
 #include "common/runtime/runtime_features.h"
 
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_set.h"
 
 namespace Envoy {
 namespace Http {
@@ -117,7 +118,25 @@ void ConnectionImpl::StreamImpl::destroy() {
   parent_.stats_.pending_send_bytes_.sub(pending_send_data_.length());
 }
 
-static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& header) {
+// Headers whose values are usually unique to a request or response. Adding them to the HPACK
+// dynamic table would evict the header fields which repeat across the streams of a connection,
+// such as :status, server, content-type and the date of the current second, which are otherwise
+// encoded once per connection and then referenced by their index in the table. nghttp2 can only
+// keep a header field out of the table by marking it never indexed, which RFC 7541 section 7.1.3
+// reserves for sensitive values and which intermediaries must preserve when forwarding it, so this
+// is only done when "envoy.reloadable_features.http2_never_index_unique_header_values" is enabled.
+static const absl::flat_hash_set<absl::string_view>& uniqueValueHeaders() {
+  CONSTRUCT_ON_FIRST_USE(absl::flat_hash_set<absl::string_view>,
+                         {Headers::get().ClientTraceId.get(),
+                          Headers::get().EnvoyUpstreamServiceTime.get(),
+                          Headers::get().RequestId.get(), CustomHeaders::get().OtSpanContext.get(),
+                          CustomHeaders::get().B3ParentSpanId.get(),
+                          CustomHeaders::get().B3SpanId.get(),
+                          CustomHeaders::get().B3TraceId.get()});
+}
+
+static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& header,
+                         bool never_index_unique_values) {
   uint8_t flags = 0;
   if (header.key().isReference()) {
     flags |= NGHTTP2_NV_FLAG_NO_COPY_NAME;
@@ -126,6 +145,9 @@ static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& he
     flags |= NGHTTP2_NV_FLAG_NO_COPY_VALUE;
   }
   const absl::string_view header_key = header.key().getStringView();
+  if (never_index_unique_values && uniqueValueHeaders().contains(header_key)) {
+    flags |= NGHTTP2_NV_FLAG_NO_INDEX;
+  }
   const absl::string_view header_value = header.value().getStringView();
   headers.push_back({removeConst<uint8_t>(header_key.data()),
                      removeConst<uint8_t>(header_value.data()), header_key.size(),
@@ -135,10 +157,12 @@ static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& he
 void ConnectionImpl::StreamImpl::buildHeaders(std::vector<nghttp2_nv>& final_headers,
                                               const HeaderMap& headers) {
   final_headers.reserve(headers.size());
-  headers.iterate([&final_headers](const HeaderEntry& header) -> HeaderMap::Iterate {
-    insertHeader(final_headers, header);
-    return HeaderMap::Iterate::Continue;
-  });
+  const bool never_index_unique_values = parent_.never_index_unique_header_values_;
+  headers.iterate(
+      [&final_headers, never_index_unique_values](const HeaderEntry& header) -> HeaderMap::Iterate {
+        insertHeader(final_headers, header, never_index_unique_values);
+        return HeaderMap::Iterate::Continue;
+      });
 }
 
 void ConnectionImpl::ServerStreamImpl::encode100ContinueHeaders(const ResponseHeaderMap& headers) {
@@ -400,7 +424,8 @@ Status ConnectionImpl::StreamImpl::onDataSourceSend(const uint8_t* framehd, size
 
   parent_.outbound_data_frames_++;
 
-  Buffer::OwnedImpl output;
+  Buffer::OwnedImpl frame;
+  Buffer::OwnedImpl& output = parent_.frame_batch_ != nullptr ? *parent_.frame_batch_ : frame;
   auto status = parent_.addOutboundFrameFragment(output, framehd, FRAME_HEADER_SIZE);
   if (!status.ok()) {
     ENVOY_CONN_LOG(debug, "error sending data frame: Too many frames in the outbound queue",
@@ -411,7 +436,9 @@ Status ConnectionImpl::StreamImpl::onDataSourceSend(const uint8_t* framehd, size
 
   parent_.stats_.pending_send_bytes_.sub(length);
   output.move(pending_send_data_, length);
-  parent_.connection_.write(output, false);
+  if (parent_.frame_batch_ == nullptr) {
+    parent_.connection_.write(output, false);
+  }
   return status;
 }
 
@@ -554,6 +581,10 @@ ConnectionImpl::ConnectionImpl(Network::Connection& connection, CodecStats& stat
           http2_options.max_inbound_window_update_frames_per_data_frame_sent().value()),
       skip_encoding_empty_trailers_(Runtime::runtimeFeatureEnabled(
           "envoy.reloadable_features.http2_skip_encoding_empty_trailers")),
+      never_index_unique_header_values_(Runtime::runtimeFeatureEnabled(
+          "envoy.reloadable_features.http2_never_index_unique_header_values")),
+      batch_frame_writes_(
+          Runtime::runtimeFeatureEnabled("envoy.reloadable_features.http2_batch_frame_writes")),
       dispatching_(false), raised_goaway_(false), pending_deferred_reset_(false) {}
 
 ConnectionImpl::~ConnectionImpl() {
@@ -792,6 +823,8 @@ int ConnectionImpl::onFrameSend(const nghttp2_frame* frame) {
   }
 
   case NGHTTP2_HEADERS:
+    onHeadersSent(frame->hd, frame->headers);
+    FALLTHRU;
   case NGHTTP2_DATA: {
     StreamImpl* stream = getStream(frame->hd.stream_id);
     stream->local_end_stream_sent_ = frame->hd.flags & NGHTTP2_FLAG_END_STREAM;
@@ -802,6 +835,21 @@ int ConnectionImpl::onFrameSend(const nghttp2_frame* frame) {
   return 0;
 }
 
+void ConnectionImpl::onHeadersSent(const nghttp2_frame_hd& hd, const nghttp2_headers& headers) {
+  uint64_t raw_bytes = 0;
+  for (size_t i = 0; i < headers.nvlen; ++i) {
+    raw_bytes += headers.nva[i].namelen + headers.nva[i].valuelen;
+  }
+  // The frame length covers the header block split across any CONTINUATION frames, along with the
+  // padding and the 5 byte priority fields, if any.
+  const uint64_t encoded_bytes =
+      hd.length - headers.padlen - ((hd.flags & NGHTTP2_FLAG_PRIORITY) ? 5 : 0);
+  stats_.tx_headers_raw_bytes_.add(raw_bytes);
+  stats_.tx_headers_encoded_bytes_.add(encoded_bytes);
+  ENVOY_CONN_LOG(trace, "sent headers stream_id={} raw_bytes={} encoded_bytes={}", connection_,
+                 hd.stream_id, raw_bytes, encoded_bytes);
+}
+
 int ConnectionImpl::onError(absl::string_view error) {
   ENVOY_CONN_LOG(debug, "invalid http2: {}", connection_, error);
   return 0;
@@ -882,7 +930,8 @@ void ConnectionImpl::releaseOutboundControlFrame() {
 
 StatusOr<ssize_t> ConnectionImpl::onSend(const uint8_t* data, size_t length) {
   ENVOY_CONN_LOG(trace, "send data: bytes={}", connection_, length);
-  Buffer::OwnedImpl buffer;
+  Buffer::OwnedImpl frame;
+  Buffer::OwnedImpl& buffer = frame_batch_ != nullptr ? *frame_batch_ : frame;
   auto status = addOutboundFrameFragment(buffer, data, length);
   if (!status.ok()) {
     ENVOY_CONN_LOG(debug, "error sending frame: Too many frames in the outbound queue.",
@@ -897,7 +946,10 @@ StatusOr<ssize_t> ConnectionImpl::onSend(const uint8_t* data, size_t length) {
   // deleted before the codec object is deleted. This is presently guaranteed by the
   // destruction order of the Network::ConnectionImpl object where write_buffer_ is
   // destroyed before the filter_manager_ which owns the codec through Http::ConnectionManagerImpl.
-  connection_.write(buffer, false);
+  // Batched frames are written the same way by sendPendingFrames().
+  if (frame_batch_ == nullptr) {
+    connection_.write(buffer, false);
+  }
   return length;
 }
 
@@ -1014,7 +1066,21 @@ Status ConnectionImpl::sendPendingFrames() {
     return okStatus();
   }
 
+  // Frames sent by nested calls are added to the batch of the outermost call, which writes it once
+  // nghttp2 is done. The frames serialized before any error are written, as they would be without
+  // batching.
+  Buffer::OwnedImpl frame_batch;
+  const bool owns_frame_batch = batch_frame_writes_ && frame_batch_ == nullptr;
+  if (owns_frame_batch) {
+    frame_batch_ = &frame_batch;
+  }
   const int rc = nghttp2_session_send(session_);
+  if (owns_frame_batch) {
+    frame_batch_ = nullptr;
+    if (frame_batch.length() > 0) {
+      connection_.write(frame_batch, false);
+    }
+  }
   if (rc != 0) {
     ASSERT(rc == NGHTTP2_ERR_CALLBACK_FAILURE);
 
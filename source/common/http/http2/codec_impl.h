@@ -188,7 +188,7 @@ protected:
     ssize_t onDataSourceRead(uint64_t length, uint32_t* data_flags);
     Status onDataSourceSend(const uint8_t* framehd, size_t length);
     void resetStreamWorker(StreamResetReason reason);
-    static void buildHeaders(std::vector<nghttp2_nv>& final_headers, const HeaderMap& headers);
+    void buildHeaders(std::vector<nghttp2_nv>& final_headers, const HeaderMap& headers);
     void saveHeader(HeaderString&& name, HeaderString&& value);
     void encodeHeadersBase(const std::vector<nghttp2_nv>& final_headers, bool end_stream);
     virtual void submitHeaders(const std::vector<nghttp2_nv>& final_headers,
@@ -513,6 +513,19 @@ protected:
   // flag.
   const bool skip_encoding_empty_trailers_;
 
+  // Whether the headers with values which are usually unique to a stream, such as x-request-id, are
+  // sent as literals which are never indexed, so that they do not evict the header fields repeated
+  // across streams from the HPACK dynamic tables. Controlled by the
+  // "envoy.reloadable_features.http2_never_index_unique_header_values" runtime feature flag.
+  const bool never_index_unique_header_values_;
+
+  // Whether the frames serialized by nghttp2 during sendPendingFrames() are collected into a single
+  // buffer and written to the connection once, rather than written one at a time. Controlled by
+  // the "envoy.reloadable_features.http2_batch_frame_writes" runtime feature flag.
+  const bool batch_frame_writes_;
+  // Collects the frames of the current sendPendingFrames() call when frame writes are batched.
+  Buffer::OwnedImpl* frame_batch_{};
+
 private:
   virtual ConnectionCallbacks& callbacks() PURE;
   virtual Status onBeginHeaders(const nghttp2_frame* frame) PURE;
@@ -521,6 +534,7 @@ private:
   Status onFrameReceived(const nghttp2_frame* frame);
   int onBeforeFrameSend(const nghttp2_frame* frame);
   int onFrameSend(const nghttp2_frame* frame);
+  void onHeadersSent(const nghttp2_frame_hd& hd, const nghttp2_headers& headers);
   int onError(absl::string_view error);
   virtual int onHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value) PURE;
   int onInvalidFrame(int32_t stream_id, int error_code);
@@ -23,6 +23,7 @@
 #include "common/runtime/runtime_features.h"
 
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_set.h"
 
 namespace Envoy {
 namespace Http {
@@ -121,7 +122,25 @@ void ConnectionImpl::StreamImpl::destroy() {
   parent_.stats_.pending_send_bytes_.sub(pending_send_data_.length());
 }
 
-static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& header) {
+// Headers whose values are usually unique to a request or response. Adding them to the HPACK
+// dynamic table would evict the header fields which repeat across the streams of a connection,
+// such as :status, server, content-type and the date of the current second, which are otherwise
+// encoded once per connection and then referenced by their index in the table. nghttp2 can only
+// keep a header field out of the table by marking it never indexed, which RFC 7541 section 7.1.3
+// reserves for sensitive values and which intermediaries must preserve when forwarding it, so this
+// is only done when "envoy.reloadable_features.http2_never_index_unique_header_values" is enabled.
+static const absl::flat_hash_set<absl::string_view>& uniqueValueHeaders() {
+  CONSTRUCT_ON_FIRST_USE(absl::flat_hash_set<absl::string_view>,
+                         {Headers::get().ClientTraceId.get(),
+                          Headers::get().EnvoyUpstreamServiceTime.get(),
+                          Headers::get().RequestId.get(), CustomHeaders::get().OtSpanContext.get(),
+                          CustomHeaders::get().B3ParentSpanId.get(),
+                          CustomHeaders::get().B3SpanId.get(),
+                          CustomHeaders::get().B3TraceId.get()});
+}
+
+static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& header,
+                         bool never_index_unique_values) {
   uint8_t flags = 0;
   if (header.key().isReference()) {
     flags |= NGHTTP2_NV_FLAG_NO_COPY_NAME;
@@ -130,6 +149,9 @@ static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& he
     flags |= NGHTTP2_NV_FLAG_NO_COPY_VALUE;
   }
   const absl::string_view header_key = header.key().getStringView();
+  if (never_index_unique_values && uniqueValueHeaders().contains(header_key)) {
+    flags |= NGHTTP2_NV_FLAG_NO_INDEX;
+  }
   const absl::string_view header_value = header.value().getStringView();
   headers.push_back({removeConst<uint8_t>(header_key.data()),
                      removeConst<uint8_t>(header_value.data()), header_key.size(),
@@ -139,10 +161,12 @@ static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& he
 void ConnectionImpl::StreamImpl::buildHeaders(std::vector<nghttp2_nv>& final_headers,
                                               const HeaderMap& headers) {
   final_headers.reserve(headers.size());
-  headers.iterate([&final_headers](const HeaderEntry& header) -> HeaderMap::Iterate {
-    insertHeader(final_headers, header);
-    return HeaderMap::Iterate::Continue;
-  });
+  const bool never_index_unique_values = parent_.never_index_unique_header_values_;
+  headers.iterate(
+      [&final_headers, never_index_unique_values](const HeaderEntry& header) -> HeaderMap::Iterate {
+        insertHeader(final_headers, header, never_index_unique_values);
+        return HeaderMap::Iterate::Continue;
+      });
 }
 
 void ConnectionImpl::ServerStreamImpl::encode100ContinueHeaders(const ResponseHeaderMap& headers) {
@@ -536,6 +560,8 @@ ConnectionImpl::ConnectionImpl(Network::Connection& connection, CodecStats& stat
           http2_options.max_inbound_window_update_frames_per_data_frame_sent().value()),
       skip_encoding_empty_trailers_(Runtime::runtimeFeatureEnabled(
           "envoy.reloadable_features.http2_skip_encoding_empty_trailers")),
+      never_index_unique_header_values_(Runtime::runtimeFeatureEnabled(
+          "envoy.reloadable_features.http2_never_index_unique_header_values")),
       dispatching_(false), raised_goaway_(false), pending_deferred_reset_(false) {}
 
 ConnectionImpl::~ConnectionImpl() {
@@ -767,6 +793,8 @@ int ConnectionImpl::onFrameSend(const nghttp2_frame* frame) {
   }
 
   case NGHTTP2_HEADERS:
+    onHeadersSent(frame->hd, frame->headers);
+    FALLTHRU;
   case NGHTTP2_DATA: {
     StreamImpl* stream = getStream(frame->hd.stream_id);
     stream->local_end_stream_sent_ = frame->hd.flags & NGHTTP2_FLAG_END_STREAM;
@@ -777,6 +805,21 @@ int ConnectionImpl::onFrameSend(const nghttp2_frame* frame) {
   return 0;
 }
 
+void ConnectionImpl::onHeadersSent(const nghttp2_frame_hd& hd, const nghttp2_headers& headers) {
+  uint64_t raw_bytes = 0;
+  for (size_t i = 0; i < headers.nvlen; ++i) {
+    raw_bytes += headers.nva[i].namelen + headers.nva[i].valuelen;
+  }
+  // The frame length covers the header block split across any CONTINUATION frames, along with the
+  // padding and the 5 byte priority fields, if any.
+  const uint64_t encoded_bytes =
+      hd.length - headers.padlen - ((hd.flags & NGHTTP2_FLAG_PRIORITY) ? 5 : 0);
+  stats_.tx_headers_raw_bytes_.add(raw_bytes);
+  stats_.tx_headers_encoded_bytes_.add(encoded_bytes);
+  ENVOY_CONN_LOG(trace, "sent headers stream_id={} raw_bytes={} encoded_bytes={}", connection_,
+                 hd.stream_id, raw_bytes, encoded_bytes);
+}
+
 int ConnectionImpl::onError(absl::string_view error) {
   ENVOY_CONN_LOG(debug, "invalid http2: {}", connection_, error);
   return 0;
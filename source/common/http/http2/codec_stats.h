@@ -26,6 +26,8 @@ namespace Http2 {
   COUNTER(rx_reset)                                                                                \
   COUNTER(trailers)                                                                                \
   COUNTER(tx_flush_timeout)                                                                        \
+  COUNTER(tx_headers_encoded_bytes)                                                                \
+  COUNTER(tx_headers_raw_bytes)                                                                    \
   COUNTER(tx_reset)                                                                                \
   GAUGE(streams_active, Accumulate)                                                                \
   GAUGE(pending_send_bytes, Accumulate)
@@ -0,0 +1,573 @@
+#include "common/http/http2/shared_conn_pool.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/event/deferred_task.h"
+#include "common/http/header_map_impl.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+ConnectionPool::InstancePtr SharedConnPoolRegistry::allocateConnPool(
+    Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
+    Upstream::ResourcePriority priority, uint32_t group_size, const PoolFactory& factory) {
+  const Key key{host.get(), priority};
+  SharedConnPoolSharedPtr shared;
+  uint32_t group;
+  bool owner = false;
+  {
+    Thread::LockGuard lock(mutex_);
+    group = groupOf(dispatcher, group_size);
+    Group& entry = groups_[key][group];
+    entry.members_++;
+    if (entry.pool_ == nullptr) {
+      entry.pool_ = std::make_shared<SharedConnPool>(dispatcher);
+      owner = true;
+    }
+    shared = entry.pool_;
+  }
+  if (owner) {
+    // Other workers only access the pool on this worker, so it may be created without the lock.
+    ConnectionPool::InstancePtr pool = factory();
+    shared->pool_ = pool.get();
+    return std::make_unique<OwnerConnPool>(std::move(pool), std::move(shared), shared_from_this(),
+                                           key, group);
+  }
+  return std::make_unique<RemoteConnPool>(dispatcher, std::move(host), std::move(shared),
+                                          shared_from_this(), key, group, group_size, factory);
+}
+
+size_t SharedConnPoolRegistry::numSharedPools() {
+  Thread::LockGuard lock(mutex_);
+  size_t pools = 0;
+  for (const auto& entry : groups_) {
+    for (const auto& group : entry.second) {
+      if (group.second.pool_ != nullptr) {
+        pools++;
+      }
+    }
+  }
+  return pools;
+}
+
+uint32_t SharedConnPoolRegistry::groupOf(const Event::Dispatcher& dispatcher,
+                                         uint32_t group_size) {
+  const uint32_t worker = worker_numbers_.try_emplace(&dispatcher, worker_numbers_.size())
+                              .first->second;
+  return worker / std::max<uint32_t>(group_size, 1);
+}
+
+void SharedConnPoolRegistry::leaveGroup(const Key& key, uint32_t group,
+                                        const SharedConnPool* owned_pool) {
+  Thread::LockGuard lock(mutex_);
+  auto it = groups_.find(key);
+  ASSERT(it != groups_.end());
+  auto group_it = it->second.find(group);
+  ASSERT(group_it != it->second.end());
+  Group& entry = group_it->second;
+  if (owned_pool != nullptr && entry.pool_.get() == owned_pool) {
+    entry.pool_ = nullptr;
+  }
+  ASSERT(entry.members_ > 0);
+  if (--entry.members_ == 0) {
+    it->second.erase(group_it);
+    if (it->second.empty()) {
+      groups_.erase(it);
+    }
+  }
+}
+
+OwnerConnPool::OwnerConnPool(ConnectionPool::InstancePtr pool, SharedConnPoolSharedPtr shared,
+                             SharedConnPoolRegistrySharedPtr registry,
+                             SharedConnPoolRegistry::Key key, uint32_t group)
+    : pool_(std::move(pool)), shared_(std::move(shared)), registry_(std::move(registry)),
+      key_(key), group_(group) {}
+
+OwnerConnPool::~OwnerConnPool() {
+  // Streams of other workers which arrive from now on fail, and the other workers allocate another
+  // pool for their next streams. Those in the pool are reset when it is destroyed.
+  shared_->pool_ = nullptr;
+  shared_->destroyed_ = true;
+  registry_->leaveGroup(key_, group_, shared_.get());
+}
+
+RemoteConnPool::RemoteConnPool(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
+                               SharedConnPoolSharedPtr shared,
+                               SharedConnPoolRegistrySharedPtr registry,
+                               SharedConnPoolRegistry::Key key, uint32_t group, uint32_t group_size,
+                               SharedConnPoolRegistry::PoolFactory factory)
+    : dispatcher_(dispatcher), host_(std::move(host)), shared_(std::move(shared)),
+      registry_(std::move(registry)), key_(key), group_(group), group_size_(group_size),
+      factory_(std::move(factory)) {}
+
+RemoteConnPool::~RemoteConnPool() {
+  // Detaching the streams below must not run the drained callbacks of a pool being destroyed.
+  drained_callbacks_.clear();
+  while (!streams_.empty()) {
+    RemoteStreamSharedPtr stream = streams_.begin()->second;
+    const bool ready = stream->callbacks_ == nullptr;
+    postToOwner(*stream, [](OwnerStream& owner) {
+      owner.cancel(Envoy::ConnectionPool::CancelPolicy::Default);
+    });
+    stream->detach();
+    if (ready) {
+      stream->runResetCallbacks(StreamResetReason::ConnectionTermination);
+    }
+  }
+  if (pool_ == nullptr) {
+    registry_->leaveGroup(key_, group_, nullptr);
+  }
+}
+
+void RemoteConnPool::addDrainedCallback(DrainedCb cb) {
+  drained_callbacks_.push_back(cb);
+  watchPoolDrained();
+  checkForDrained();
+}
+
+void RemoteConnPool::drainConnections() {
+  if (pool_ != nullptr) {
+    pool_->drainConnections();
+  }
+  SharedConnPoolSharedPtr shared = shared_;
+  shared_->dispatcher_.post([shared]() {
+    if (shared->pool_ != nullptr) {
+      shared->pool_->drainConnections();
+    }
+  });
+}
+
+ConnectionPool::Cancellable* RemoteConnPool::newStream(ResponseDecoder& response_decoder,
+                                                       ConnectionPool::Callbacks& callbacks) {
+  if (pool_ == nullptr && shared_->destroyed_) {
+    reallocatePool();
+  }
+  if (pool_ != nullptr) {
+    ConnectionPool::Cancellable* handle = pool_->newStream(response_decoder, callbacks);
+    watchPoolDrained();
+    return handle;
+  }
+  auto stream = std::make_shared<RemoteStream>(*this, response_decoder, callbacks);
+  stream->owner_ = std::make_shared<OwnerStream>(shared_, dispatcher_, stream, host_);
+  streams_.emplace(stream.get(), stream);
+  postToOwner(*stream, [](OwnerStream& owner) { owner.start(); });
+  return stream.get();
+}
+
+void RemoteConnPool::prefetchConnections(uint32_t connections) {
+  if (pool_ != nullptr) {
+    pool_->prefetchConnections(connections);
+    return;
+  }
+  SharedConnPoolSharedPtr shared = shared_;
+  shared_->dispatcher_.post([shared, connections]() {
+    if (shared->pool_ != nullptr) {
+      shared->pool_->prefetchConnections(connections);
+    }
+  });
+}
+
+void RemoteConnPool::postToOwner(const RemoteStream& stream,
+                                 std::function<void(OwnerStream&)> event) {
+  // The reference is moved into the event so that the owner half is only released on its worker.
+  shared_->dispatcher_.post(
+      [owner = stream.owner_, event = std::move(event)]() { event(*owner); });
+}
+
+void RemoteConnPool::checkForDrained() {
+  if (!drained_callbacks_.empty() && streams_.empty() &&
+      (pool_ == nullptr || !pool_->hasActiveConnections())) {
+    ENVOY_LOG(debug, "invoking drained callbacks");
+    for (const DrainedCb& cb : drained_callbacks_) {
+      cb();
+    }
+  }
+}
+
+void RemoteConnPool::reallocatePool() {
+  ENVOY_LOG(debug, "shared pool destroyed, allocating another");
+  registry_->leaveGroup(key_, group_, nullptr);
+  pool_ = registry_->allocateConnPool(dispatcher_, host_, key_.second, group_size_, factory_);
+}
+
+void RemoteConnPool::watchPoolDrained() {
+  if (pool_ != nullptr && !drained_callbacks_.empty() && !watching_pool_drained_) {
+    watching_pool_drained_ = true;
+    pool_->addDrainedCallback([this]() -> void { checkForDrained(); });
+  }
+}
+
+RemoteConnPool::RemoteStream::RemoteStream(RemoteConnPool& parent,
+                                           ResponseDecoder& response_decoder,
+                                           ConnectionPool::Callbacks& callbacks)
+    : parent_(&parent), response_decoder_(response_decoder), callbacks_(&callbacks),
+      stream_info_(Http::Protocol::Http2, parent.dispatcher_.timeSource()) {}
+
+void RemoteConnPool::RemoteStream::cancel(Envoy::ConnectionPool::CancelPolicy cancel_policy) {
+  ASSERT(parent_ != nullptr && callbacks_ != nullptr);
+  parent_->postToOwner(*this,
+                       [cancel_policy](OwnerStream& owner) { owner.cancel(cancel_policy); });
+  detach();
+}
+
+void RemoteConnPool::RemoteStream::encodeHeaders(const RequestHeaderMap& headers,
+                                                 bool end_stream) {
+  ASSERT(parent_ != nullptr);
+  local_end_stream_ = end_stream;
+  std::shared_ptr<RequestHeaderMap> copy = createHeaderMap<RequestHeaderMapImpl>(headers);
+  parent_->postToOwner(*this, [copy, end_stream](OwnerStream& owner) {
+    owner.encodeHeaders(*copy, end_stream);
+  });
+  checkForComplete();
+}
+
+void RemoteConnPool::RemoteStream::encodeData(Buffer::Instance& data, bool end_stream) {
+  ASSERT(parent_ != nullptr);
+  local_end_stream_ = end_stream;
+  request_bytes_in_flight_ += data.length();
+  auto moved = std::make_shared<Buffer::OwnedImpl>();
+  moved->move(data);
+  parent_->postToOwner(*this, [moved, end_stream](OwnerStream& owner) {
+    owner.encodeData(*moved, end_stream);
+  });
+  if (buffer_limit_ > 0 && request_bytes_in_flight_ > buffer_limit_ &&
+      !above_request_watermark_) {
+    above_request_watermark_ = true;
+    runHighWatermarkCallbacks();
+  }
+  checkForComplete();
+}
+
+void RemoteConnPool::RemoteStream::encodeTrailers(const RequestTrailerMap& trailers) {
+  ASSERT(parent_ != nullptr);
+  local_end_stream_ = true;
+  std::shared_ptr<RequestTrailerMap> copy = createHeaderMap<RequestTrailerMapImpl>(trailers);
+  parent_->postToOwner(*this, [copy](OwnerStream& owner) { owner.encodeTrailers(*copy); });
+  checkForComplete();
+}
+
+void RemoteConnPool::RemoteStream::encodeMetadata(const MetadataMapVector& metadata_map_vector) {
+  ASSERT(parent_ != nullptr);
+  auto copy = std::make_shared<MetadataMapVector>();
+  for (const MetadataMapPtr& metadata_map : metadata_map_vector) {
+    copy->push_back(std::make_unique<MetadataMap>(*metadata_map));
+  }
+  parent_->postToOwner(*this, [copy](OwnerStream& owner) { owner.encodeMetadata(*copy); });
+}
+
+void RemoteConnPool::RemoteStream::resetStream(StreamResetReason reason) {
+  if (parent_ == nullptr) {
+    return;
+  }
+  RemoteStreamSharedPtr self = shared_from_this();
+  parent_->postToOwner(*this, [reason](OwnerStream& owner) { owner.resetStream(reason); });
+  detach();
+  runResetCallbacks(reason);
+}
+
+void RemoteConnPool::RemoteStream::readDisable(bool disable) {
+  if (parent_ != nullptr) {
+    parent_->postToOwner(*this, [disable](OwnerStream& owner) { owner.readDisable(disable); });
+  }
+}
+
+void RemoteConnPool::RemoteStream::setFlushTimeout(std::chrono::milliseconds timeout) {
+  if (parent_ != nullptr) {
+    parent_->postToOwner(*this,
+                         [timeout](OwnerStream& owner) { owner.setFlushTimeout(timeout); });
+  }
+}
+
+void RemoteConnPool::RemoteStream::onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                                                 const std::string& transport_failure_reason,
+                                                 Upstream::HostDescriptionConstSharedPtr host) {
+  ConnectionPool::Callbacks* callbacks = callbacks_;
+  detach();
+  callbacks->onPoolFailure(reason, transport_failure_reason, std::move(host));
+}
+
+void RemoteConnPool::RemoteStream::onPoolReady(
+    Upstream::HostDescriptionConstSharedPtr host, uint32_t buffer_limit,
+    Network::Address::InstanceConstSharedPtr connection_local_address) {
+  buffer_limit_ = buffer_limit;
+  connection_local_address_ = std::move(connection_local_address);
+  ConnectionPool::Callbacks* callbacks = callbacks_;
+  callbacks_ = nullptr;
+  callbacks->onPoolReady(*this, std::move(host), stream_info_);
+}
+
+void RemoteConnPool::RemoteStream::onResetStream(StreamResetReason reason) {
+  detach();
+  runResetCallbacks(reason);
+}
+
+void RemoteConnPool::RemoteStream::onRemoteEndStream(bool end_stream) {
+  remote_end_stream_ = end_stream;
+  checkForComplete();
+}
+
+void RemoteConnPool::RemoteStream::onRequestDataEncoded(uint64_t length) {
+  ASSERT(request_bytes_in_flight_ >= length);
+  request_bytes_in_flight_ -= length;
+  if (above_request_watermark_ && request_bytes_in_flight_ <= buffer_limit_ / 2) {
+    above_request_watermark_ = false;
+    runLowWatermarkCallbacks();
+  }
+}
+
+void RemoteConnPool::RemoteStream::checkForComplete() {
+  if (local_end_stream_ && remote_end_stream_) {
+    detach();
+  }
+}
+
+void RemoteConnPool::RemoteStream::detach() {
+  if (parent_ == nullptr) {
+    return;
+  }
+  RemoteConnPool* parent = parent_;
+  parent_ = nullptr;
+  // Events which have yet to run on the owner half hold their own references to it. This one is
+  // released on the worker of the owner half as well, as it may be the last.
+  parent->shared_->dispatcher_.post([owner = std::move(owner_)]() {});
+  // Like the streams of codecs, the stream is destroyed in a later iteration of the event loop, as
+  // its callbacks may still reference it.
+  Event::DeferredTaskUtil::deferredRun(parent->dispatcher_, [self = shared_from_this()]() {});
+  parent->streams_.erase(this);
+  parent->checkForDrained();
+}
+
+void RemoteConnPool::OwnerStream::start() {
+  if (shared_->pool_ == nullptr) {
+    postToRemote([host = host_](RemoteStream& remote) {
+      remote.onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure,
+                           "shared pool destroyed", host);
+    });
+    return;
+  }
+  self_ = shared_from_this();
+  handle_ = shared_->pool_->newStream(*this, *this);
+}
+
+void RemoteConnPool::OwnerStream::cancel(Envoy::ConnectionPool::CancelPolicy cancel_policy) {
+  std::shared_ptr<OwnerStream> self = shared_from_this();
+  cancelled_ = true;
+  if (handle_ != nullptr) {
+    handle_->cancel(cancel_policy);
+    handle_ = nullptr;
+    complete();
+  } else if (encoder_ != nullptr) {
+    encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+  }
+}
+
+void RemoteConnPool::OwnerStream::encodeHeaders(const RequestHeaderMap& headers,
+                                                bool end_stream) {
+  if (encoder_ != nullptr) {
+    std::shared_ptr<OwnerStream> self = shared_from_this();
+    encoder_->encodeHeaders(headers, end_stream);
+    onLocalEndStream(end_stream);
+  }
+}
+
+void RemoteConnPool::OwnerStream::encodeData(Buffer::Instance& data, bool end_stream) {
+  const uint64_t length = data.length();
+  postToRemote([length](RemoteStream& remote) { remote.onRequestDataEncoded(length); });
+  if (encoder_ != nullptr) {
+    std::shared_ptr<OwnerStream> self = shared_from_this();
+    encoder_->encodeData(data, end_stream);
+    onLocalEndStream(end_stream);
+  }
+}
+
+void RemoteConnPool::OwnerStream::encodeTrailers(const RequestTrailerMap& trailers) {
+  if (encoder_ != nullptr) {
+    std::shared_ptr<OwnerStream> self = shared_from_this();
+    encoder_->encodeTrailers(trailers);
+    onLocalEndStream(true);
+  }
+}
+
+void RemoteConnPool::OwnerStream::encodeMetadata(const MetadataMapVector& metadata_map_vector) {
+  if (encoder_ != nullptr) {
+    encoder_->encodeMetadata(metadata_map_vector);
+  }
+}
+
+void RemoteConnPool::OwnerStream::resetStream(StreamResetReason reason) {
+  if (encoder_ != nullptr) {
+    encoder_->getStream().resetStream(reason);
+  }
+}
+
+void RemoteConnPool::OwnerStream::readDisable(bool disable) {
+  if (encoder_ != nullptr) {
+    encoder_->getStream().readDisable(disable);
+  }
+}
+
+void RemoteConnPool::OwnerStream::setFlushTimeout(std::chrono::milliseconds timeout) {
+  if (encoder_ != nullptr) {
+    encoder_->getStream().setFlushTimeout(timeout);
+  }
+}
+
+void RemoteConnPool::OwnerStream::onResponseDataDecoded(uint64_t length) {
+  ASSERT(response_bytes_in_flight_ >= length);
+  response_bytes_in_flight_ -= length;
+  if (above_response_watermark_ && response_bytes_in_flight_ <= buffer_limit_ / 2) {
+    above_response_watermark_ = false;
+    if (encoder_ != nullptr) {
+      encoder_->getStream().readDisable(false);
+    }
+  }
+}
+
+void RemoteConnPool::OwnerStream::decodeData(Buffer::Instance& data, bool end_stream) {
+  std::shared_ptr<OwnerStream> self = shared_from_this();
+  const uint64_t length = data.length();
+  response_bytes_in_flight_ += length;
+  auto moved = std::make_shared<Buffer::OwnedImpl>();
+  moved->move(data);
+  postToRemote([moved, length, end_stream](RemoteStream& remote) {
+    remote.response_decoder_.decodeData(*moved, end_stream);
+    // The decoder may have reset the stream.
+    if (remote.parent_ != nullptr) {
+      remote.parent_->postToOwner(
+          remote, [length](OwnerStream& owner) { owner.onResponseDataDecoded(length); });
+      remote.onRemoteEndStream(end_stream);
+    }
+  });
+  // Like the buffer of a stream, the data the remote worker has yet to decode stops reading from
+  // the connection once it is above the buffer limit.
+  if (buffer_limit_ > 0 && response_bytes_in_flight_ > buffer_limit_ &&
+      !above_response_watermark_ && encoder_ != nullptr) {
+    above_response_watermark_ = true;
+    encoder_->getStream().readDisable(true);
+  }
+  onRemoteEndStream(end_stream);
+}
+
+void RemoteConnPool::OwnerStream::decodeMetadata(MetadataMapPtr&& metadata_map) {
+  auto moved = std::make_shared<MetadataMapPtr>(std::move(metadata_map));
+  postToRemote([moved](RemoteStream& remote) {
+    remote.response_decoder_.decodeMetadata(std::move(*moved));
+  });
+}
+
+void RemoteConnPool::OwnerStream::decode100ContinueHeaders(ResponseHeaderMapPtr&& headers) {
+  auto moved = std::make_shared<ResponseHeaderMapPtr>(std::move(headers));
+  postToRemote([moved](RemoteStream& remote) {
+    remote.response_decoder_.decode100ContinueHeaders(std::move(*moved));
+  });
+}
+
+void RemoteConnPool::OwnerStream::decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream) {
+  std::shared_ptr<OwnerStream> self = shared_from_this();
+  auto moved = std::make_shared<ResponseHeaderMapPtr>(std::move(headers));
+  postToRemote([moved, end_stream](RemoteStream& remote) {
+    remote.response_decoder_.decodeHeaders(std::move(*moved), end_stream);
+    remote.onRemoteEndStream(end_stream);
+  });
+  onRemoteEndStream(end_stream);
+}
+
+void RemoteConnPool::OwnerStream::decodeTrailers(ResponseTrailerMapPtr&& trailers) {
+  std::shared_ptr<OwnerStream> self = shared_from_this();
+  auto moved = std::make_shared<ResponseTrailerMapPtr>(std::move(trailers));
+  postToRemote([moved](RemoteStream& remote) {
+    remote.response_decoder_.decodeTrailers(std::move(*moved));
+    remote.onRemoteEndStream(true);
+  });
+  onRemoteEndStream(true);
+}
+
+void RemoteConnPool::OwnerStream::onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                                                absl::string_view transport_failure_reason,
+                                                Upstream::HostDescriptionConstSharedPtr host) {
+  std::shared_ptr<OwnerStream> self = shared_from_this();
+  handle_ = nullptr;
+  postToRemote([reason, transport_failure_reason = std::string(transport_failure_reason),
+                host](RemoteStream& remote) {
+    remote.onPoolFailure(reason, transport_failure_reason, host);
+  });
+  complete();
+}
+
+void RemoteConnPool::OwnerStream::onPoolReady(RequestEncoder& encoder,
+                                              Upstream::HostDescriptionConstSharedPtr host,
+                                              const StreamInfo::StreamInfo&) {
+  std::shared_ptr<OwnerStream> self = shared_from_this();
+  handle_ = nullptr;
+  if (cancelled_) {
+    encoder.getStream().resetStream(StreamResetReason::LocalReset);
+    complete();
+    return;
+  }
+  encoder_ = &encoder;
+  buffer_limit_ = encoder.getStream().bufferLimit();
+  encoder.getStream().addCallbacks(*this);
+  postToRemote([host, buffer_limit = buffer_limit_,
+                connection_local_address = encoder.getStream().connectionLocalAddress()](
+                   RemoteStream& remote) {
+    remote.onPoolReady(host, buffer_limit, connection_local_address);
+  });
+}
+
+void RemoteConnPool::OwnerStream::onResetStream(StreamResetReason reason, absl::string_view) {
+  std::shared_ptr<OwnerStream> self = shared_from_this();
+  // The stream does not run its callbacks after a reset, so they are left in place.
+  encoder_ = nullptr;
+  postToRemote([reason](RemoteStream& remote) { remote.onResetStream(reason); });
+  complete();
+}
+
+void RemoteConnPool::OwnerStream::onAboveWriteBufferHighWatermark() {
+  postToRemote([](RemoteStream& remote) { remote.runHighWatermarkCallbacks(); });
+}
+
+void RemoteConnPool::OwnerStream::onBelowWriteBufferLowWatermark() {
+  postToRemote([](RemoteStream& remote) { remote.runLowWatermarkCallbacks(); });
+}
+
+void RemoteConnPool::OwnerStream::postToRemote(std::function<void(RemoteStream&)> event) {
+  RemoteStreamSharedPtr remote = remote_.lock();
+  if (remote == nullptr) {
+    return;
+  }
+  // The reference is moved into the event, as the remote half must only be released on its worker.
+  remote_dispatcher_.post([remote = std::move(remote), event = std::move(event)]() {
+    // Events of streams which were cancelled, reset or destroyed with their pool are dropped.
+    if (remote->parent_ != nullptr) {
+      event(*remote);
+    }
+  });
+}
+
+void RemoteConnPool::OwnerStream::complete() {
+  if (encoder_ != nullptr) {
+    encoder_->getStream().removeCallbacks(*this);
+    encoder_ = nullptr;
+  }
+  self_.reset();
+}
+
+void RemoteConnPool::OwnerStream::onLocalEndStream(bool end_stream) {
+  local_end_stream_ = end_stream;
+  if (local_end_stream_ && remote_end_stream_) {
+    complete();
+  }
+}
+
+void RemoteConnPool::OwnerStream::onRemoteEndStream(bool end_stream) {
+  remote_end_stream_ = end_stream;
+  if (local_end_stream_ && remote_end_stream_) {
+    complete();
+  }
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/http/codec.h"
+#include "envoy/http/conn_pool.h"
+#include "envoy/upstream/upstream.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/http/codec_helper.h"
+#include "common/stream_info/stream_info_impl.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+/**
+ * An HTTP/2 connection pool which is shared by a group of workers. The pool lives on the dispatcher
+ * of the worker which allocated it first, and the other workers of the group hand their streams to
+ * that dispatcher.
+ */
+struct SharedConnPool {
+  SharedConnPool(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+  Event::Dispatcher& dispatcher_;
+  // The pool, which is only accessed on dispatcher_. It is cleared when the pool is destroyed.
+  ConnectionPool::Instance* pool_{};
+  // Set when the pool is destroyed, so that the other workers allocate another.
+  std::atomic<bool> destroyed_{};
+};
+
+using SharedConnPoolSharedPtr = std::shared_ptr<SharedConnPool>;
+
+/**
+ * Allocates HTTP/2 connection pools which are shared by groups of workers, so that connections to
+ * a host are established by each group rather than by each worker. Workers are numbered in the
+ * order they first allocate a pool, and each group is a fixed range of worker numbers, so that a
+ * worker always shares pools with the same workers.
+ */
+class SharedConnPoolRegistry : public std::enable_shared_from_this<SharedConnPoolRegistry> {
+public:
+  using PoolFactory = std::function<ConnectionPool::InstancePtr()>;
+
+  /**
+   * Allocates the pool of a worker for a host. The first worker of a group to allocate a pool gets
+   * the pool created by factory, and the other workers of the group get pools which hand their
+   * streams to it. Once that pool is destroyed, the next worker of the group to allocate a pool
+   * owns the shared pool instead.
+   * @param dispatcher supplies the dispatcher of the worker. It must belong to a worker rather than
+   *        the main thread, which would otherwise take the place of a worker in a group.
+   * @param host supplies the host of the pool.
+   * @param priority supplies the priority of the pool.
+   * @param group_size supplies the number of workers which share a pool.
+   * @param factory supplies the factory of the shared pool.
+   * @return ConnectionPool::InstancePtr the pool of the worker.
+   */
+  ConnectionPool::InstancePtr allocateConnPool(Event::Dispatcher& dispatcher,
+                                               Upstream::HostConstSharedPtr host,
+                                               Upstream::ResourcePriority priority,
+                                               uint32_t group_size, const PoolFactory& factory);
+
+  /**
+   * @return the number of pools which are shared by groups of workers.
+   */
+  size_t numSharedPools();
+
+private:
+  friend class OwnerConnPool;
+  friend class RemoteConnPool;
+
+  using Key = std::pair<const Upstream::Host*, Upstream::ResourcePriority>;
+
+  struct Group {
+    // The shared pool, or null if the pool of its owner has been destroyed.
+    SharedConnPoolSharedPtr pool_;
+    // The number of pools of the workers of the group which have not been destroyed.
+    uint32_t members_{};
+  };
+
+  // Called when the pool of a worker is destroyed. If it owned the shared pool, the next worker
+  // of the group to allocate a pool owns the next one.
+  void leaveGroup(const Key& key, uint32_t group, const SharedConnPool* owned_pool);
+  uint32_t groupOf(const Event::Dispatcher& dispatcher, uint32_t group_size)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  Thread::MutexBasicLockable mutex_;
+  absl::flat_hash_map<const Event::Dispatcher*, uint32_t> worker_numbers_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<Key, absl::flat_hash_map<uint32_t, Group>> groups_ ABSL_GUARDED_BY(mutex_);
+};
+
+using SharedConnPoolRegistrySharedPtr = std::shared_ptr<SharedConnPoolRegistry>;
+
+/**
+ * The pool of the worker which owns a shared pool. Streams of the worker go straight to the shared
+ * pool.
+ */
+class OwnerConnPool : public ConnectionPool::Instance {
+public:
+  OwnerConnPool(ConnectionPool::InstancePtr pool, SharedConnPoolSharedPtr shared,
+                SharedConnPoolRegistrySharedPtr registry, SharedConnPoolRegistry::Key key,
+                uint32_t group);
+  ~OwnerConnPool() override;
+
+  // Http::ConnectionPool::Instance
+  Http::Protocol protocol() const override { return pool_->protocol(); }
+  void addDrainedCallback(DrainedCb cb) override { pool_->addDrainedCallback(cb); }
+  void drainConnections() override { pool_->drainConnections(); }
+  bool hasActiveConnections() const override { return pool_->hasActiveConnections(); }
+  Upstream::HostDescriptionConstSharedPtr host() const override { return pool_->host(); }
+  ConnectionPool::Cancellable* newStream(ResponseDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks) override {
+    return pool_->newStream(response_decoder, callbacks);
+  }
+  void prefetchConnections(uint32_t connections) override {
+    pool_->prefetchConnections(connections);
+  }
+
+private:
+  ConnectionPool::InstancePtr pool_;
+  const SharedConnPoolSharedPtr shared_;
+  const SharedConnPoolRegistrySharedPtr registry_;
+  const SharedConnPoolRegistry::Key key_;
+  const uint32_t group_;
+};
+
+/**
+ * The pool of a worker which hands its streams to a shared pool owned by another worker. Stream
+ * events are passed between the workers by posting them to their dispatchers, with headers and
+ * trailers encoded by this worker copied and bodies moved into new buffers. The body data in
+ * flight between the workers is bounded by the buffer limit of the stream, as if it were buffered
+ * by the stream. If the shared pool is destroyed, the pool allocates another one for the worker,
+ * which may then own the shared pool of its group.
+ */
+class RemoteConnPool : public ConnectionPool::Instance, Logger::Loggable<Logger::Id::pool> {
+public:
+  RemoteConnPool(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
+                 SharedConnPoolSharedPtr shared, SharedConnPoolRegistrySharedPtr registry,
+                 SharedConnPoolRegistry::Key key, uint32_t group, uint32_t group_size,
+                 SharedConnPoolRegistry::PoolFactory factory);
+  ~RemoteConnPool() override;
+
+  // Http::ConnectionPool::Instance
+  Http::Protocol protocol() const override { return Http::Protocol::Http2; }
+  void addDrainedCallback(DrainedCb cb) override;
+  void drainConnections() override;
+  bool hasActiveConnections() const override {
+    return !streams_.empty() || (pool_ != nullptr && pool_->hasActiveConnections());
+  }
+  Upstream::HostDescriptionConstSharedPtr host() const override { return host_; }
+  ConnectionPool::Cancellable* newStream(ResponseDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks) override;
+  void prefetchConnections(uint32_t connections) override;
+
+private:
+  class OwnerStream;
+
+  /**
+   * The half of a stream on the worker which created it. It is only accessed on that worker.
+   */
+  class RemoteStream : public ConnectionPool::Cancellable,
+                       public RequestEncoder,
+                       public Stream,
+                       public StreamCallbackHelper,
+                       public std::enable_shared_from_this<RemoteStream> {
+  public:
+    RemoteStream(RemoteConnPool& parent, ResponseDecoder& response_decoder,
+                 ConnectionPool::Callbacks& callbacks);
+
+    // ConnectionPool::Cancellable
+    void cancel(Envoy::ConnectionPool::CancelPolicy cancel_policy) override;
+
+    // Http::StreamEncoder
+    void encodeData(Buffer::Instance& data, bool end_stream) override;
+    Stream& getStream() override { return *this; }
+    void encodeMetadata(const MetadataMapVector& metadata_map_vector) override;
+    Http1StreamEncoderOptionsOptRef http1StreamEncoderOptions() override { return absl::nullopt; }
+
+    // Http::RequestEncoder
+    void encodeHeaders(const RequestHeaderMap& headers, bool end_stream) override;
+    void encodeTrailers(const RequestTrailerMap& trailers) override;
+
+    // Http::Stream
+    void addCallbacks(StreamCallbacks& callbacks) override { addCallbacksHelper(callbacks); }
+    void removeCallbacks(StreamCallbacks& callbacks) override { removeCallbacksHelper(callbacks); }
+    void resetStream(StreamResetReason reason) override;
+    void readDisable(bool disable) override;
+    uint32_t bufferLimit() override { return buffer_limit_; }
+    const Network::Address::InstanceConstSharedPtr& connectionLocalAddress() override {
+      return connection_local_address_;
+    }
+    void setFlushTimeout(std::chrono::milliseconds timeout) override;
+
+    // Events posted by the owner half of the stream.
+    void onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                       const std::string& transport_failure_reason,
+                       Upstream::HostDescriptionConstSharedPtr host);
+    void onPoolReady(Upstream::HostDescriptionConstSharedPtr host, uint32_t buffer_limit,
+                     Network::Address::InstanceConstSharedPtr connection_local_address);
+    void onResetStream(StreamResetReason reason);
+    void onRemoteEndStream(bool end_stream);
+    void onRequestDataEncoded(uint64_t length);
+
+    // Detaches the stream once both directions have ended.
+    void checkForComplete();
+    // Stops delivering events of the stream, and removes it from its pool.
+    void detach();
+
+    RemoteConnPool* parent_;
+    ResponseDecoder& response_decoder_;
+    ConnectionPool::Callbacks* callbacks_;
+    std::shared_ptr<OwnerStream> owner_;
+    // Supplied to the callbacks when the stream is ready, in place of the stream info of the
+    // connection, which belongs to the worker owning the shared pool.
+    StreamInfo::StreamInfoImpl stream_info_;
+    uint32_t buffer_limit_{};
+    Network::Address::InstanceConstSharedPtr connection_local_address_;
+    bool remote_end_stream_{};
+    // Request body bytes posted to the owner half which it has yet to encode.
+    uint64_t request_bytes_in_flight_{};
+    bool above_request_watermark_{};
+  };
+
+  using RemoteStreamSharedPtr = std::shared_ptr<RemoteStream>;
+
+  /**
+   * The half of a stream on the worker which owns the shared pool. It is only accessed on that
+   * worker, and keeps itself alive until the stream in the shared pool is complete.
+   */
+  class OwnerStream : public ResponseDecoder,
+                      public ConnectionPool::Callbacks,
+                      public StreamCallbacks,
+                      public std::enable_shared_from_this<OwnerStream> {
+  public:
+    OwnerStream(SharedConnPoolSharedPtr shared, Event::Dispatcher& remote_dispatcher,
+                RemoteStreamSharedPtr remote, Upstream::HostDescriptionConstSharedPtr host)
+        : shared_(std::move(shared)), remote_dispatcher_(remote_dispatcher),
+          remote_(std::move(remote)), host_(std::move(host)) {}
+
+    // Events posted by the remote half of the stream.
+    void start();
+    void cancel(Envoy::ConnectionPool::CancelPolicy cancel_policy);
+    void encodeHeaders(const RequestHeaderMap& headers, bool end_stream);
+    void encodeData(Buffer::Instance& data, bool end_stream);
+    void encodeTrailers(const RequestTrailerMap& trailers);
+    void encodeMetadata(const MetadataMapVector& metadata_map_vector);
+    void resetStream(StreamResetReason reason);
+    void readDisable(bool disable);
+    void setFlushTimeout(std::chrono::milliseconds timeout);
+    void onResponseDataDecoded(uint64_t length);
+
+    // Http::StreamDecoder
+    void decodeData(Buffer::Instance& data, bool end_stream) override;
+    void decodeMetadata(MetadataMapPtr&& metadata_map) override;
+
+    // Http::ResponseDecoder
+    void decode100ContinueHeaders(ResponseHeaderMapPtr&& headers) override;
+    void decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream) override;
+    void decodeTrailers(ResponseTrailerMapPtr&& trailers) override;
+
+    // ConnectionPool::Callbacks
+    void onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                       absl::string_view transport_failure_reason,
+                       Upstream::HostDescriptionConstSharedPtr host) override;
+    void onPoolReady(RequestEncoder& encoder, Upstream::HostDescriptionConstSharedPtr host,
+                     const StreamInfo::StreamInfo& info) override;
+
+    // Http::StreamCallbacks
+    void onResetStream(StreamResetReason reason,
+                       absl::string_view transport_failure_reason) override;
+    void onAboveWriteBufferHighWatermark() override;
+    void onBelowWriteBufferLowWatermark() override;
+
+  private:
+    // Runs an event on the remote half of the stream, on its worker.
+    void postToRemote(std::function<void(RemoteStream&)> event);
+    // Releases the stream once the shared pool is done with it.
+    void complete();
+    void onLocalEndStream(bool end_stream);
+    void onRemoteEndStream(bool end_stream);
+
+    const SharedConnPoolSharedPtr shared_;
+    Event::Dispatcher& remote_dispatcher_;
+    // The remote half is owned by the worker which created it.
+    const std::weak_ptr<RemoteStream> remote_;
+    const Upstream::HostDescriptionConstSharedPtr host_;
+    std::shared_ptr<OwnerStream> self_;
+    ConnectionPool::Cancellable* handle_{};
+    RequestEncoder* encoder_{};
+    uint32_t buffer_limit_{};
+    // Response body bytes posted to the remote half which it has yet to decode.
+    uint64_t response_bytes_in_flight_{};
+    bool above_response_watermark_{};
+    bool cancelled_{};
+    bool local_end_stream_{};
+    bool remote_end_stream_{};
+  };
+
+  // Runs an event on the owner half of a stream, on the worker which owns the shared pool.
+  void postToOwner(const RemoteStream& stream, std::function<void(OwnerStream&)> event);
+  void checkForDrained();
+  // Allocates the pool new streams go to once the shared pool has been destroyed.
+  void reallocatePool();
+  // Passes the drain of the allocated pool on to the drained callbacks.
+  void watchPoolDrained();
+
+  Event::Dispatcher& dispatcher_;
+  const Upstream::HostConstSharedPtr host_;
+  const SharedConnPoolSharedPtr shared_;
+  const SharedConnPoolRegistrySharedPtr registry_;
+  const SharedConnPoolRegistry::Key key_;
+  const uint32_t group_;
+  const uint32_t group_size_;
+  const SharedConnPoolRegistry::PoolFactory factory_;
+  absl::flat_hash_map<const RemoteStream*, RemoteStreamSharedPtr> streams_;
+  std::list<DrainedCb> drained_callbacks_;
+  // The pool allocated once the shared pool has been destroyed.
+  ConnectionPool::InstancePtr pool_;
+  bool watching_pool_drained_{};
+};
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
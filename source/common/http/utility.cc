@@ -411,6 +411,14 @@ Utility::parseHttp1Settings(const envoy::config::core::v3::Http1ProtocolOptions&
     ret.header_key_format_ = Http1Settings::HeaderKeyFormat::Default;
   }
 
+  if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.http1_simd_parser")) {
+    ret.parser_type_ = Http1Settings::ParserType::Simd;
+  }
+  ret.borrow_header_values_ =
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.http1_borrowed_header_values");
+  ret.reuse_raw_header_lines_ =
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.http1_raw_header_lines");
+
   return ret;
 }
 
@@ -0,0 +1,350 @@
+#include "common/io/io_uring_impl.h"
+
+#include <cstring>
+
+#include "envoy/common/exception.h"
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/logger.h"
+#include "common/common/utility.h"
+
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Envoy {
+namespace Io {
+
+#if defined(__linux__)
+
+struct IoUringImpl::Sqe : public io_uring_sqe {};
+
+namespace {
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+  return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int ioUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  int rc;
+  do {
+    rc = syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0);
+  } while (rc < 0 && errno == EINTR);
+  return rc;
+}
+
+int ioUringRegister(int ring_fd, unsigned opcode, const void* arg, unsigned nr_args) {
+  return syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+// The ring indices are shared with the kernel; these provide the ordering required by the
+// io_uring ABI when publishing submissions and consuming completions.
+uint32_t loadAcquire(const uint32_t* p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+void storeRelease(uint32_t* p, uint32_t v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+void closeFd(os_fd_t fd) {
+  const Api::SysCallIntResult result = Api::OsSysCallsSingleton::get().close(fd);
+  if (result.rc_ != 0) {
+    ENVOY_LOG_MISC(warn, "unable to close io_uring descriptor {}: {}", fd,
+                   errorDetails(result.errno_));
+  }
+}
+
+} // namespace
+
+IoUringImpl::IoUringImpl(uint32_t entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = ioUringSetup(entries, &params);
+  if (ring_fd_ < 0) {
+    throw EnvoyException(fmt::format("unable to create io_uring: {}", errorDetails(errno)));
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+
+  sq_ring_ptr_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring_ptr_ == MAP_FAILED) {
+    sq_ring_ptr_ = nullptr;
+  } else if (single_mmap) {
+    cq_ring_ptr_ = sq_ring_ptr_;
+  } else {
+    cq_ring_ptr_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ptr_ == MAP_FAILED) {
+      cq_ring_ptr_ = nullptr;
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ptr_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_fd_, IORING_OFF_SQES);
+  if (sqes_ptr_ == MAP_FAILED) {
+    sqes_ptr_ = nullptr;
+  }
+  if (sq_ring_ptr_ == nullptr || cq_ring_ptr_ == nullptr || sqes_ptr_ == nullptr) {
+    const int error = errno;
+    release();
+    throw EnvoyException(fmt::format("unable to map io_uring: {}", errorDetails(error)));
+  }
+
+  char* sq = static_cast<char*>(sq_ring_ptr_);
+  sq_head_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+  sq_entries_ = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_entries);
+  sq_array_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+
+  char* cq = static_cast<char*>(cq_ring_ptr_);
+  cq_head_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+
+  sqe_tail_ = *sq_tail_;
+}
+
+IoUringImpl::~IoUringImpl() { release(); }
+
+void IoUringImpl::release() {
+  if (sqes_ptr_ != nullptr) {
+    munmap(sqes_ptr_, sqes_size_);
+  }
+  if (cq_ring_ptr_ != nullptr && cq_ring_ptr_ != sq_ring_ptr_) {
+    munmap(cq_ring_ptr_, cq_ring_size_);
+  }
+  if (sq_ring_ptr_ != nullptr) {
+    munmap(sq_ring_ptr_, sq_ring_size_);
+  }
+  if (SOCKET_VALID(event_fd_)) {
+    closeFd(event_fd_);
+  }
+  closeFd(ring_fd_);
+}
+
+bool IoUringImpl::isSupported() {
+  static const bool supported = []() {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    const int fd = ioUringSetup(2, &params);
+    if (fd < 0) {
+      return false;
+    }
+    closeFd(fd);
+    return true;
+  }();
+  return supported;
+}
+
+os_fd_t IoUringImpl::registerEventfd() {
+  ASSERT(!SOCKET_VALID(event_fd_));
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (!SOCKET_VALID(event_fd_) ||
+      ioUringRegister(ring_fd_, IORING_REGISTER_EVENTFD, &event_fd_, 1) < 0) {
+    throw EnvoyException(
+        fmt::format("unable to register io_uring eventfd: {}", errorDetails(errno)));
+  }
+  return event_fd_;
+}
+
+Api::SysCallIntResult IoUringImpl::registerBuffers(const struct iovec* iovecs,
+                                                   unsigned nr_iovecs) {
+  const int rc = ioUringRegister(ring_fd_, IORING_REGISTER_BUFFERS, iovecs, nr_iovecs);
+  return {rc, rc < 0 ? errno : 0};
+}
+
+IoUringImpl::Sqe* IoUringImpl::getSqe() {
+  if (sqe_tail_ - loadAcquire(sq_head_) >= sq_entries_) {
+    return nullptr;
+  }
+  const uint32_t index = sqe_tail_ & sq_mask_;
+  Sqe* sqe = &static_cast<Sqe*>(sqes_ptr_)[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sq_array_[index] = index;
+  ++sqe_tail_;
+  return sqe;
+}
+
+bool IoUringImpl::prepareAccept(os_fd_t fd, struct sockaddr* remote_addr,
+                                socklen_t* remote_addr_len, bool multishot, uint64_t user_data) {
+  Sqe* sqe = getSqe();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(remote_addr);
+  sqe->addr2 = reinterpret_cast<uint64_t>(remote_addr_len);
+  sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+  if (multishot) {
+    sqe->ioprio |= IORING_ACCEPT_MULTISHOT;
+  }
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool IoUringImpl::prepareConnect(os_fd_t fd, const struct sockaddr* addr, socklen_t addr_len,
+                                 uint64_t user_data) {
+  Sqe* sqe = getSqe();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_CONNECT;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(addr);
+  sqe->off = addr_len;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool IoUringImpl::prepareReadv(os_fd_t fd, const struct iovec* iovecs, unsigned nr_vecs,
+                               uint64_t user_data) {
+  Sqe* sqe = getSqe();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_READV;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(iovecs);
+  sqe->len = nr_vecs;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool IoUringImpl::prepareReadFixed(os_fd_t fd, void* buf, unsigned len, uint16_t buf_index,
+                                   uint64_t user_data) {
+  Sqe* sqe = getSqe();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_READ_FIXED;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(buf);
+  sqe->len = len;
+  sqe->buf_index = buf_index;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool IoUringImpl::prepareWritev(os_fd_t fd, const struct iovec* iovecs, unsigned nr_vecs,
+                                uint64_t user_data) {
+  Sqe* sqe = getSqe();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_WRITEV;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(iovecs);
+  sqe->len = nr_vecs;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool IoUringImpl::preparePollAdd(os_fd_t fd, uint32_t poll_mask, uint64_t user_data) {
+  Sqe* sqe = getSqe();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = poll_mask;
+  sqe->user_data = user_data;
+  return true;
+}
+
+bool IoUringImpl::prepareCancel(uint64_t target_user_data, uint64_t user_data) {
+  Sqe* sqe = getSqe();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = target_user_data;
+  sqe->user_data = user_data;
+  return true;
+}
+
+Api::SysCallIntResult IoUringImpl::submit() {
+  const uint32_t to_submit = pendingSubmissions();
+  if (to_submit == 0) {
+    return {0, 0};
+  }
+  storeRelease(sq_tail_, sqe_tail_);
+  const int rc = ioUringEnter(ring_fd_, to_submit, 0, 0);
+  return {rc, rc < 0 ? errno : 0};
+}
+
+uint32_t IoUringImpl::pendingSubmissions() const { return sqe_tail_ - loadAcquire(sq_head_); }
+
+Api::SysCallIntResult IoUringImpl::waitForCompletion() {
+  const int rc = ioUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+  return {rc, rc < 0 ? errno : 0};
+}
+
+uint32_t IoUringImpl::forEveryCompletion(const CompletionCb& cb) {
+  uint32_t count = 0;
+  // The head is reloaded on every iteration as the callback may harvest completions itself.
+  for (uint32_t head = *cq_head_; head != loadAcquire(cq_tail_); head = *cq_head_) {
+    const io_uring_cqe& cqe = static_cast<const io_uring_cqe*>(cqes_)[head & cq_mask_];
+    const uint64_t user_data = cqe.user_data;
+    const int32_t result = cqe.res;
+    const bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+    // Release the entry before running the callback, which may prepare further requests.
+    storeRelease(cq_head_, head + 1);
+    cb(user_data, result, more);
+    ++count;
+  }
+  return count;
+}
+
+#else
+
+struct IoUringImpl::Sqe {};
+
+IoUringImpl::IoUringImpl(uint32_t) : ring_fd_(-1) {
+  throw EnvoyException("io_uring is only supported on Linux");
+}
+IoUringImpl::~IoUringImpl() = default;
+void IoUringImpl::release() {}
+bool IoUringImpl::isSupported() { return false; }
+os_fd_t IoUringImpl::registerEventfd() { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+Api::SysCallIntResult IoUringImpl::registerBuffers(const struct iovec*, unsigned) {
+  NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+}
+IoUringImpl::Sqe* IoUringImpl::getSqe() { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+bool IoUringImpl::prepareAccept(os_fd_t, struct sockaddr*, socklen_t*, bool, uint64_t) {
+  NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+}
+bool IoUringImpl::prepareConnect(os_fd_t, const struct sockaddr*, socklen_t, uint64_t) {
+  NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+}
+bool IoUringImpl::prepareReadv(os_fd_t, const struct iovec*, unsigned, uint64_t) {
+  NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+}
+bool IoUringImpl::prepareReadFixed(os_fd_t, void*, unsigned, uint16_t, uint64_t) {
+  NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+}
+bool IoUringImpl::prepareWritev(os_fd_t, const struct iovec*, unsigned, uint64_t) {
+  NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+}
+bool IoUringImpl::preparePollAdd(os_fd_t, uint32_t, uint64_t) { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+bool IoUringImpl::prepareCancel(uint64_t, uint64_t) { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+Api::SysCallIntResult IoUringImpl::submit() { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+uint32_t IoUringImpl::pendingSubmissions() const { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+Api::SysCallIntResult IoUringImpl::waitForCompletion() { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+uint32_t IoUringImpl::forEveryCompletion(const CompletionCb&) { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+
+#endif
+
+} // namespace Io
+} // namespace Envoy
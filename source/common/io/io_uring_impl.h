@@ -0,0 +1,130 @@
+#pragma once
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <cstdint>
+#include <functional>
+
+#include "envoy/api/os_sys_calls_common.h"
+#include "envoy/common/platform.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Io {
+
+/**
+ * Callback invoked for each harvested completion.
+ * @param user_data the value supplied when the request was prepared.
+ * @param result the result of the operation, or a negated errno on failure.
+ * @param more true if this is one completion of a multishot request that remains armed.
+ */
+using CompletionCb = std::function<void(uint64_t user_data, int32_t result, bool more)>;
+
+/**
+ * Thin wrapper around a Linux io_uring instance, set up directly through the io_uring_setup(2)
+ * and io_uring_enter(2) system calls. Requests are prepared in the submission queue and are only
+ * handed to the kernel by submit(), so that any number of operations can be issued with a single
+ * system call. The prepare*() methods return false if the submission queue is full, in which case
+ * the caller should submit() and retry.
+ *
+ * An instance is not thread safe and is intended to be owned by a single dispatcher thread.
+ */
+class IoUringImpl : NonCopyable {
+public:
+  /**
+   * @param entries supplies the number of submission queue entries, rounded up by the kernel to a
+   *        power of two.
+   * @throw EnvoyException if the ring cannot be created.
+   */
+  explicit IoUringImpl(uint32_t entries);
+  ~IoUringImpl();
+
+  /**
+   * @return bool whether io_uring is available on this host, i.e. the kernel supports it and it
+   *         has not been disabled by seccomp or sysctl.
+   */
+  static bool isSupported();
+
+  /**
+   * Creates an eventfd which is signalled whenever a completion is posted, so that completions
+   * can be harvested from a file event. May only be called once.
+   * @return os_fd_t the eventfd, owned by the ring.
+   */
+  os_fd_t registerEventfd();
+
+  /**
+   * Registers a set of buffers with the kernel for use with prepareReadFixed().
+   * @return Api::SysCallIntResult the result of the registration.
+   */
+  Api::SysCallIntResult registerBuffers(const struct iovec* iovecs, unsigned nr_iovecs);
+
+  bool prepareAccept(os_fd_t fd, struct sockaddr* remote_addr, socklen_t* remote_addr_len,
+                     bool multishot, uint64_t user_data);
+  bool prepareConnect(os_fd_t fd, const struct sockaddr* addr, socklen_t addr_len,
+                      uint64_t user_data);
+  bool prepareReadv(os_fd_t fd, const struct iovec* iovecs, unsigned nr_vecs, uint64_t user_data);
+  bool prepareReadFixed(os_fd_t fd, void* buf, unsigned len, uint16_t buf_index,
+                        uint64_t user_data);
+  bool prepareWritev(os_fd_t fd, const struct iovec* iovecs, unsigned nr_vecs,
+                     uint64_t user_data);
+  bool preparePollAdd(os_fd_t fd, uint32_t poll_mask, uint64_t user_data);
+  bool prepareCancel(uint64_t target_user_data, uint64_t user_data);
+
+  /**
+   * Hands all prepared requests to the kernel.
+   * @return Api::SysCallIntResult the number of requests submitted, or the error.
+   */
+  Api::SysCallIntResult submit();
+
+  /**
+   * Blocks until at least one completion is available.
+   */
+  Api::SysCallIntResult waitForCompletion();
+
+  /**
+   * Invokes cb for every completion currently in the completion queue, and consumes them.
+   * @return uint32_t the number of completions harvested.
+   */
+  uint32_t forEveryCompletion(const CompletionCb& cb);
+
+  /**
+   * @return uint32_t the number of prepared requests that have not yet been submitted.
+   */
+  uint32_t pendingSubmissions() const;
+
+private:
+  struct Sqe;
+  Sqe* getSqe();
+  void release();
+
+  int ring_fd_;
+  os_fd_t event_fd_{INVALID_SOCKET};
+
+  // Mapped regions.
+  void* sq_ring_ptr_{};
+  size_t sq_ring_size_{};
+  void* cq_ring_ptr_{};
+  size_t cq_ring_size_{};
+  void* sqes_ptr_{};
+  size_t sqes_size_{};
+
+  // Pointers into the shared rings.
+  uint32_t* sq_head_{};
+  uint32_t* sq_tail_{};
+  uint32_t sq_mask_{};
+  uint32_t sq_entries_{};
+  uint32_t* sq_array_{};
+  uint32_t* cq_head_{};
+  uint32_t* cq_tail_{};
+  uint32_t cq_mask_{};
+  void* cqes_{};
+
+  // Local submission tail. Entries between the kernel's head and sqe_tail_ have been prepared but
+  // not yet consumed by the kernel.
+  uint32_t sqe_tail_{};
+};
+
+} // namespace Io
+} // namespace Envoy
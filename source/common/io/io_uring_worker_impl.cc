@@ -0,0 +1,475 @@
+#include "common/io/io_uring_worker_impl.h"
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/macros.h"
+#include "common/common/utility.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Io {
+
+namespace {
+
+// Upper bound on the number of slices handed to the kernel by a single write request.
+constexpr uint64_t MaxWriteSlices = 64;
+
+// Reads filling less than this fraction of their buffer are copied, rather than tying the whole
+// buffer up until the data has been consumed.
+constexpr uint64_t MinHandedOverReadFraction = 4;
+
+uint64_t toUserData(IoUringRequest* request) { return reinterpret_cast<uint64_t>(request); }
+
+void closeDescriptor(os_fd_t fd) {
+  const Api::SysCallIntResult result = Api::OsSysCallsSingleton::get().close(fd);
+  if (result.rc_ != 0) {
+    ENVOY_LOG_MISC(debug, "io_uring close of fd={} failed: {}", fd, errorDetails(result.errno_));
+  }
+}
+
+using WorkerMap = absl::flat_hash_map<Event::Dispatcher*, std::weak_ptr<IoUringWorker>>;
+
+absl::Mutex& workersMutex() { MUTABLE_CONSTRUCT_ON_FIRST_USE(absl::Mutex); }
+
+WorkerMap& workers() { MUTABLE_CONSTRUCT_ON_FIRST_USE(WorkerMap); }
+
+} // namespace
+
+IoUringReadBuffers::IoUringReadBuffers(uint32_t count, uint32_t size)
+    : count_(count), size_(size),
+      memory_(std::make_unique<uint8_t[]>(static_cast<uint64_t>(size) * count)) {
+  free_.reserve(count);
+  for (int32_t i = count - 1; i >= 0; --i) {
+    free_.push_back(i);
+  }
+}
+
+std::vector<iovec> IoUringReadBuffers::iovecs() const {
+  std::vector<iovec> iovecs(count_);
+  for (uint32_t i = 0; i < count_; ++i) {
+    iovecs[i].iov_base = buffer(i);
+    iovecs[i].iov_len = size_;
+  }
+  return iovecs;
+}
+
+int32_t IoUringReadBuffers::acquire() {
+  absl::MutexLock lock(&mutex_);
+  if (free_.empty()) {
+    return -1;
+  }
+  const int32_t index = free_.back();
+  free_.pop_back();
+  return index;
+}
+
+void IoUringReadBuffers::release(int32_t index) {
+  absl::MutexLock lock(&mutex_);
+  free_.push_back(index);
+}
+
+/**
+ * Writes out the remaining data of a closed socket and then closes it.
+ */
+class IoUringWorker::ClosingSocket : public IoUringCompletionHandler {
+public:
+  ClosingSocket(IoUringWorker& worker, os_fd_t fd, std::unique_ptr<Buffer::Instance> data,
+                IoUringRequest* write)
+      : worker_(worker), fd_(fd), data_(std::move(data)), write_(write),
+        timer_(worker.dispatcher().createTimer([this]() -> void {
+          ENVOY_LOG(debug, "io_uring closing socket fd={} timed out with {} bytes unwritten", fd_,
+                    data_->length());
+          worker_.releaseClosingSocket(*this);
+        })) {
+    if (write_ != nullptr) {
+      write_->handler_ = this;
+    } else {
+      write_ = &worker_.submitWrite(fd_, *data_, *this);
+    }
+    timer_->enableTimer(worker_.options().close_flush_timeout_);
+  }
+
+  ~ClosingSocket() override {
+    if (write_ != nullptr) {
+      // The kernel may read the data until the cancelled write completes.
+      write_->cancelled_data_ = std::move(data_);
+      worker_.cancel(*write_);
+    }
+    worker_.closeSocket(fd_);
+  }
+
+  // IoUringCompletionHandler
+  void onCompletion(IoUringRequest&, int32_t result, bool) override {
+    write_ = nullptr;
+    if (result > 0) {
+      data_->drain(result);
+    }
+    if ((result > 0 || result == -EAGAIN || result == -EINTR) && data_->length() > 0) {
+      write_ = &worker_.submitWrite(fd_, *data_, *this);
+      return;
+    }
+    ENVOY_LOG(trace, "io_uring closing socket fd={} flushed with result {}", fd_, result);
+    worker_.releaseClosingSocket(*this);
+  }
+
+private:
+  IoUringWorker& worker_;
+  const os_fd_t fd_;
+  std::unique_ptr<Buffer::Instance> data_;
+  IoUringRequest* write_;
+  const Event::TimerPtr timer_;
+};
+
+IoUringWorker::IoUringWorker(Event::Dispatcher& dispatcher, const IoUringOptions& options)
+    : dispatcher_(dispatcher), options_(options), ring_(options.ring_size_) {
+  const os_fd_t event_fd = ring_.registerEventfd();
+  eventfd_event_ = dispatcher_.createFileEvent(
+      event_fd,
+      [this, event_fd](uint32_t) {
+        // Clear the eventfd counter before harvesting so that completions posted while harvesting
+        // signal it again.
+        uint64_t value;
+        iovec iov{&value, sizeof(value)};
+        const Api::SysCallSizeResult result =
+            Api::OsSysCallsSingleton::get().readv(event_fd, &iov, 1);
+        RELEASE_ASSERT(
+            result.rc_ == sizeof(value) || result.errno_ == SOCKET_ERROR_AGAIN,
+            fmt::format("io_uring eventfd read failed: {}", errorDetails(result.errno_)));
+        harvest();
+      },
+      Event::FileTriggerType::Level, Event::FileReadyType::Read);
+  submit_cb_ = dispatcher_.createSchedulableCallback([this]() {
+    if (submission_deferred_) {
+      // The kernel refused the requests until completions have been harvested.
+      std::shared_ptr<IoUringWorker> self = shared_from_this();
+      harvest();
+    }
+    submit();
+  });
+  dispatcher_destroy_cb_ = dispatcher_.addOnDestroyCallback([this]() { onDispatcherDestroyed(); });
+
+  if (options_.registered_buffer_count_ > 0) {
+    registered_buffers_ = std::make_shared<IoUringReadBuffers>(options_.registered_buffer_count_,
+                                                               options_.read_buffer_size_);
+    const std::vector<iovec> iovecs = registered_buffers_->iovecs();
+    const Api::SysCallIntResult result = ring_.registerBuffers(iovecs.data(), iovecs.size());
+    if (result.rc_ < 0) {
+      // Typically RLIMIT_MEMLOCK is too low. Reads fall back to heap buffers.
+      ENVOY_LOG(warn, "unable to register io_uring read buffers: {}", errorDetails(result.errno_));
+      registered_buffers_.reset();
+    }
+  }
+}
+
+IoUringWorker::~IoUringWorker() {
+  if (dispatcher_destroy_cb_ != nullptr) {
+    dispatcher_destroy_cb_->remove();
+  }
+  // Handles and sockets still being flushed keep their worker alive, so only requests of closed
+  // handles can be left.
+  ASSERT(closing_sockets_.empty());
+  for (auto& entry : requests_) {
+    if (entry.second->handler_ != nullptr) {
+      cancel(*entry.second);
+    }
+  }
+  // The kernel may still be accessing the memory owned by the requests, so wait for every request
+  // to complete before releasing it.
+  while (!requests_.empty()) {
+    submit();
+    if (ring_.forEveryCompletion([this](uint64_t user_data, int32_t result, bool more) {
+          onCompletion(user_data, result, more);
+        }) == 0) {
+      ring_.waitForCompletion();
+    }
+  }
+  // Nothing refers to the descriptors anymore.
+  for (os_fd_t fd : fds_to_close_) {
+    closeDescriptor(fd);
+  }
+}
+
+std::shared_ptr<IoUringWorker> IoUringWorker::get(Event::Dispatcher& dispatcher,
+                                                  const IoUringOptions& options) {
+  absl::MutexLock lock(&workersMutex());
+  WorkerMap& map = workers();
+  std::shared_ptr<IoUringWorker> worker = map[&dispatcher].lock();
+  if (worker == nullptr) {
+    ASSERT(dispatcher.isThreadSafe());
+    for (auto it = map.begin(); it != map.end();) {
+      if (it->second.expired()) {
+        map.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    worker = std::make_shared<IoUringWorker>(dispatcher, options);
+    map[&dispatcher] = worker;
+  }
+  return worker;
+}
+
+IoUringRequest& IoUringWorker::submitAccept(os_fd_t fd, bool multishot,
+                                            IoUringCompletionHandler& handler) {
+  IoUringRequest& request =
+      track(std::make_unique<IoUringRequest>(IoUringRequest::Type::Accept, &handler));
+  // Every completion of a multishot accept would overwrite the same address, so the peer address
+  // of sockets accepted that way has to be queried separately.
+  sockaddr* address = multishot ? nullptr : reinterpret_cast<sockaddr*>(&request.address_);
+  socklen_t* address_len = multishot ? nullptr : &request.address_len_;
+  prepare([this, fd, address, address_len, multishot, &request]() {
+    return ring_.prepareAccept(fd, address, address_len, multishot, toUserData(&request));
+  });
+  return request;
+}
+
+IoUringRequest& IoUringWorker::submitConnect(os_fd_t fd, const sockaddr* address,
+                                             socklen_t address_len,
+                                             IoUringCompletionHandler& handler) {
+  IoUringRequest& request =
+      track(std::make_unique<IoUringRequest>(IoUringRequest::Type::Connect, &handler));
+  ASSERT(address_len <= sizeof(request.address_));
+  memcpy(&request.address_, address, address_len);
+  request.address_len_ = address_len;
+  prepare([this, fd, &request]() {
+    return ring_.prepareConnect(fd, reinterpret_cast<const sockaddr*>(&request.address_),
+                                request.address_len_, toUserData(&request));
+  });
+  return request;
+}
+
+IoUringRequest& IoUringWorker::submitRead(os_fd_t fd, IoUringCompletionHandler& handler) {
+  IoUringRequest& request =
+      track(std::make_unique<IoUringRequest>(IoUringRequest::Type::Read, &handler));
+  const uint32_t size = options_.read_buffer_size_;
+  if (registered_buffers_ != nullptr) {
+    request.buffer_index_ = registered_buffers_->acquire();
+  }
+  if (request.buffer_index_ >= 0) {
+    request.buffer_ = registered_buffers_->buffer(request.buffer_index_);
+    prepare([this, fd, size, &request]() {
+      return ring_.prepareReadFixed(fd, request.buffer_, size, request.buffer_index_,
+                                    toUserData(&request));
+    });
+  } else {
+    request.heap_buffer_ = std::make_unique<uint8_t[]>(size);
+    request.buffer_ = request.heap_buffer_.get();
+    request.iovecs_.push_back({request.buffer_, size});
+    prepare([this, fd, &request]() {
+      return ring_.prepareReadv(fd, request.iovecs_.data(), 1, toUserData(&request));
+    });
+  }
+  return request;
+}
+
+IoUringRequest& IoUringWorker::submitWrite(os_fd_t fd, const Buffer::Instance& data,
+                                           IoUringCompletionHandler& handler) {
+  IoUringRequest& request =
+      track(std::make_unique<IoUringRequest>(IoUringRequest::Type::Write, &handler));
+  // The slices stay valid until the completion as the owner only drains the buffer once the
+  // kernel has reported how much was written.
+  for (const Buffer::RawSlice& slice : data.getRawSlices(MaxWriteSlices)) {
+    request.iovecs_.push_back({slice.mem_, slice.len_});
+  }
+  prepare([this, fd, &request]() {
+    return ring_.prepareWritev(fd, request.iovecs_.data(), request.iovecs_.size(),
+                               toUserData(&request));
+  });
+  return request;
+}
+
+IoUringRequest& IoUringWorker::submitPoll(os_fd_t fd, uint32_t poll_mask,
+                                          IoUringCompletionHandler& handler) {
+  IoUringRequest& request =
+      track(std::make_unique<IoUringRequest>(IoUringRequest::Type::Poll, &handler));
+  prepare([this, fd, poll_mask, &request]() {
+    return ring_.preparePollAdd(fd, poll_mask, toUserData(&request));
+  });
+  return request;
+}
+
+void IoUringWorker::moveReadData(IoUringRequest& request, uint64_t length,
+                                 Buffer::Instance& buffer) {
+  ASSERT(request.type_ == IoUringRequest::Type::Read && length <= options_.read_buffer_size_);
+  if (length * MinHandedOverReadFraction < options_.read_buffer_size_) {
+    buffer.add(request.buffer_, length);
+    return;
+  }
+  Buffer::BufferFragmentImpl* fragment;
+  if (request.buffer_index_ >= 0) {
+    fragment = new Buffer::BufferFragmentImpl(
+        request.buffer_, length,
+        [buffers = registered_buffers_, index = request.buffer_index_](
+            const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+          buffers->release(index);
+          delete fragment;
+        });
+    request.buffer_index_ = -1;
+  } else {
+    fragment = new Buffer::BufferFragmentImpl(
+        request.heap_buffer_.release(), length,
+        [](const void* data, size_t, const Buffer::BufferFragmentImpl* fragment) {
+          delete[] static_cast<const uint8_t*>(data);
+          delete fragment;
+        });
+  }
+  request.buffer_ = nullptr;
+  buffer.addBufferFragment(*fragment);
+}
+
+void IoUringWorker::cancel(IoUringRequest& request) {
+  ASSERT(requests_.contains(&request));
+  request.handler_ = nullptr;
+  // The cancellation itself completes with a user data of zero, which is ignored.
+  prepare([this, &request]() { return ring_.prepareCancel(toUserData(&request), 0); });
+}
+
+void IoUringWorker::closeSocket(os_fd_t fd) {
+  if (submit()) {
+    closeDescriptor(fd);
+    return;
+  }
+  // The descriptor could be reused by another socket before the queued requests which refer to it
+  // are submitted.
+  fds_to_close_.push_back(fd);
+}
+
+void IoUringWorker::closeAfterFlush(os_fd_t fd, std::unique_ptr<Buffer::Instance> data,
+                                    IoUringRequest* write) {
+  auto closing_socket = std::make_unique<ClosingSocket>(*this, fd, std::move(data), write);
+  ClosingSocket* key = closing_socket.get();
+  closing_sockets_.emplace(key, std::move(closing_socket));
+  self_ = shared_from_this();
+}
+
+void IoUringWorker::releaseClosingSocket(ClosingSocket& socket) {
+  // Releasing the last reference destroys the worker once this returns.
+  std::shared_ptr<IoUringWorker> self = shared_from_this();
+  closing_sockets_.erase(&socket);
+  if (closing_sockets_.empty()) {
+    self_.reset();
+  }
+}
+
+void IoUringWorker::onDispatcherDestroyed() {
+  ENVOY_LOG(debug, "io_uring dispatcher destroyed with {} sockets being flushed",
+            closing_sockets_.size());
+  dispatcher_destroy_cb_ = nullptr;
+  std::shared_ptr<IoUringWorker> self = shared_from_this();
+  {
+    // A dispatcher created later at the same address must get a worker of its own.
+    absl::MutexLock lock(&workersMutex());
+    auto it = workers().find(&dispatcher_);
+    if (it != workers().end() && it->second.lock() == self) {
+      workers().erase(it);
+    }
+  }
+  closing_sockets_.clear();
+  self_.reset();
+  // The events belong to the dispatcher, so they have to go before it.
+  eventfd_event_.reset();
+  submit_cb_.reset();
+}
+
+IoUringRequest& IoUringWorker::track(std::unique_ptr<IoUringRequest> request) {
+  ASSERT(dispatcher_.isThreadSafe());
+  IoUringRequest* key = request.get();
+  requests_.emplace(key, std::move(request));
+  return *key;
+}
+
+template <class PrepareFn> void IoUringWorker::prepare(PrepareFn prepare_fn) {
+  // If the submission queue is full, hand what has been queued so far to the kernel to make room.
+  // Requests waiting for room must not be overtaken, as a cancellation has to follow the request
+  // it cancels.
+  if (deferred_prepares_.empty() && (prepare_fn() || (submit() && prepare_fn()))) {
+    scheduleSubmit();
+    return;
+  }
+  // The kernel is not taking requests for now. submit() queues this one once it is, and has
+  // already arranged to be retried.
+  deferred_prepares_.emplace_back(std::move(prepare_fn));
+}
+
+void IoUringWorker::scheduleSubmit() {
+  if (submit_cb_ == nullptr) {
+    // The dispatcher is gone, so there is no end of the loop iteration to wait for.
+    submit();
+  } else if (!submit_cb_->enabled()) {
+    // Defer submission to the end of the loop iteration so that the requests issued by all the
+    // events dispatched in it are submitted with a single system call.
+    submit_cb_->scheduleCallbackCurrentIteration();
+  }
+}
+
+bool IoUringWorker::submit() {
+  submission_deferred_ = false;
+  while (true) {
+    while (!deferred_prepares_.empty() && deferred_prepares_.front()()) {
+      deferred_prepares_.pop_front();
+    }
+    if (ring_.pendingSubmissions() == 0) {
+      break;
+    }
+    const Api::SysCallIntResult result = ring_.submit();
+    if (result.rc_ > 0 || (result.rc_ < 0 && result.errno_ == EINTR)) {
+      continue;
+    }
+    // The kernel is short of memory for requests, or its completion queue has overflowed. Either
+    // clears once completions have been harvested, so retry in the next loop iteration rather
+    // than spin here.
+    RELEASE_ASSERT(result.rc_ == 0 || result.errno_ == EAGAIN || result.errno_ == EBUSY,
+                   fmt::format("io_uring submission failed: {}", errorDetails(result.errno_)));
+    ENVOY_LOG(debug, "io_uring submission of {} requests deferred: {}",
+              ring_.pendingSubmissions() + deferred_prepares_.size(),
+              result.rc_ == 0 ? "no request taken" : errorDetails(result.errno_));
+    submission_deferred_ = true;
+    if (submit_cb_ != nullptr) {
+      submit_cb_->scheduleCallbackNextIteration();
+    }
+    return false;
+  }
+  for (os_fd_t fd : fds_to_close_) {
+    closeDescriptor(fd);
+  }
+  fds_to_close_.clear();
+  return true;
+}
+
+void IoUringWorker::harvest() {
+  // A handler may release the last handle referencing this worker.
+  std::shared_ptr<IoUringWorker> self = shared_from_this();
+  ring_.forEveryCompletion([this](uint64_t user_data, int32_t result, bool more) {
+    onCompletion(user_data, result, more);
+  });
+}
+
+void IoUringWorker::onCompletion(uint64_t user_data, int32_t result, bool more) {
+  if (user_data == 0) {
+    return;
+  }
+  IoUringRequest* request = reinterpret_cast<IoUringRequest*>(user_data);
+  ASSERT(requests_.contains(request));
+  if (request->handler_ != nullptr) {
+    request->handler_->onCompletion(*request, result, more);
+  } else if (request->type_ == IoUringRequest::Type::Accept && result >= 0) {
+    // The listener went away while the socket was being accepted.
+    const Api::SysCallIntResult close_result = Api::OsSysCallsSingleton::get().close(result);
+    if (close_result.rc_ != 0) {
+      ENVOY_LOG(debug, "io_uring close of accepted socket failed: {}",
+                errorDetails(close_result.errno_));
+    }
+  }
+  if (!more) {
+    if (request->buffer_index_ >= 0) {
+      registered_buffers_->release(request->buffer_index_);
+    }
+    requests_.erase(request);
+  }
+}
+
+} // namespace Io
+} // namespace Envoy
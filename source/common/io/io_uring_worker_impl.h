@@ -0,0 +1,247 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/common/callback.h"
+#include "envoy/common/pure.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/file_event.h"
+#include "envoy/event/schedulable_cb.h"
+#include "envoy/event/timer.h"
+
+#include "common/common/logger.h"
+#include "common/common/non_copyable.h"
+#include "common/io/io_uring_impl.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Io {
+
+/**
+ * Tuning for the io_uring instances created for each dispatcher.
+ */
+struct IoUringOptions {
+  // Number of submission queue entries of each ring.
+  uint32_t ring_size_{1024};
+  // Size of the buffer each in flight read completes into.
+  uint32_t read_buffer_size_{65536};
+  // Number of read buffers pre-registered with the kernel. Zero disables registered buffers.
+  uint32_t registered_buffer_count_{32};
+  // Number of bytes a socket may have queued for writing before writes return EAGAIN.
+  uint64_t write_buffer_limit_{1024 * 1024};
+  // Whether listeners keep a single multishot accept armed, on kernels which support it.
+  bool enable_multishot_accept_{true};
+  // How long the data queued by a closed socket is written out for before the socket is closed
+  // regardless.
+  std::chrono::milliseconds close_flush_timeout_{10000};
+};
+
+class IoUringRequest;
+
+/**
+ * The read buffers registered with a ring. The buffer a read completed into may be handed over to
+ * a Buffer::Instance, which can release it on any thread and after the worker has gone away, so
+ * the memory and the unused buffers are shared with the buffer fragments referencing them.
+ */
+class IoUringReadBuffers : NonCopyable {
+public:
+  IoUringReadBuffers(uint32_t count, uint32_t size);
+
+  /**
+   * @return std::vector<iovec> the buffers, to register them with a ring.
+   */
+  std::vector<iovec> iovecs() const;
+
+  /**
+   * @return int32_t the index of an unused buffer, or -1 if they are all in use.
+   */
+  int32_t acquire();
+
+  void release(int32_t index);
+
+  uint8_t* buffer(int32_t index) const {
+    return memory_.get() + static_cast<uint64_t>(index) * size_;
+  }
+
+private:
+  const uint32_t count_;
+  const uint32_t size_;
+  const std::unique_ptr<uint8_t[]> memory_;
+  absl::Mutex mutex_;
+  std::vector<int32_t> free_ ABSL_GUARDED_BY(mutex_);
+};
+
+/**
+ * Receives the completions of requests submitted through an IoUringWorker.
+ */
+class IoUringCompletionHandler {
+public:
+  virtual ~IoUringCompletionHandler() = default;
+
+  /**
+   * Called for every completion of a request.
+   * @param request supplies the completed request. It is destroyed once this returns, unless more
+   *        is true.
+   * @param result supplies the result of the operation, or a negated errno on failure.
+   * @param more is true if the request is multishot and remains armed.
+   */
+  virtual void onCompletion(IoUringRequest& request, int32_t result, bool more) PURE;
+};
+
+/**
+ * An operation in flight on an io_uring. The request owns any memory the kernel accesses while the
+ * operation is in progress. Requests are owned by the worker and outlive the handler that
+ * submitted them if the handler goes away first, in which case the handler is cleared and the
+ * request is cancelled.
+ */
+class IoUringRequest : NonCopyable {
+public:
+  enum class Type { Accept, Connect, Read, Write, Poll };
+
+  IoUringRequest(Type type, IoUringCompletionHandler* handler) : type_(type), handler_(handler) {}
+
+  const Type type_;
+  IoUringCompletionHandler* handler_;
+
+  // Accept and connect.
+  sockaddr_storage address_{};
+  socklen_t address_len_{sizeof(sockaddr_storage)};
+
+  // Read. If the request reads into a registered buffer, buffer_index_ is its index, otherwise the
+  // request owns heap_buffer_. Either is cleared once the buffer has been handed over by
+  // IoUringWorker::moveReadData().
+  uint8_t* buffer_{};
+  int32_t buffer_index_{-1};
+  std::unique_ptr<uint8_t[]> heap_buffer_;
+
+  // Write. If the request is cancelled while the kernel may still read the data, it takes over
+  // the buffer holding it.
+  absl::InlinedVector<iovec, 16> iovecs_;
+  std::unique_ptr<Buffer::Instance> cancelled_data_;
+};
+
+/**
+ * An io_uring shared by every io_uring backed handle on a dispatcher. Requests are queued in the
+ * submission queue as handles issue them and are handed to the kernel together, with one system
+ * call, once the current event loop iteration has finished dispatching. Completions are harvested
+ * when the ring signals its eventfd and are delivered to the handler of each request.
+ *
+ * A worker must only be used from the thread running its dispatcher. The sockets it is still
+ * flushing keep it alive until they have been flushed, they time out or the dispatcher is
+ * destroyed.
+ */
+class IoUringWorker : public std::enable_shared_from_this<IoUringWorker>,
+                      Logger::Loggable<Logger::Id::io> {
+public:
+  IoUringWorker(Event::Dispatcher& dispatcher, const IoUringOptions& options);
+  ~IoUringWorker();
+
+  /**
+   * @return the worker for the dispatcher, creating it with the given options if there is none.
+   */
+  static std::shared_ptr<IoUringWorker> get(Event::Dispatcher& dispatcher,
+                                            const IoUringOptions& options);
+
+  Event::Dispatcher& dispatcher() { return dispatcher_; }
+  const IoUringOptions& options() const { return options_; }
+
+  IoUringRequest& submitAccept(os_fd_t fd, bool multishot, IoUringCompletionHandler& handler);
+  IoUringRequest& submitConnect(os_fd_t fd, const sockaddr* address, socklen_t address_len,
+                                IoUringCompletionHandler& handler);
+  IoUringRequest& submitRead(os_fd_t fd, IoUringCompletionHandler& handler);
+  IoUringRequest& submitWrite(os_fd_t fd, const Buffer::Instance& data,
+                              IoUringCompletionHandler& handler);
+  IoUringRequest& submitPoll(os_fd_t fd, uint32_t poll_mask, IoUringCompletionHandler& handler);
+
+  /**
+   * Appends the data a read request completed with to a buffer. The memory of large reads is
+   * handed over to the buffer rather than copied, and is released once the data has been drained.
+   * @param request supplies the completed read request.
+   * @param length supplies the number of bytes read.
+   * @param buffer supplies the buffer to append to.
+   */
+  void moveReadData(IoUringRequest& request, uint64_t length, Buffer::Instance& buffer);
+
+  /**
+   * Detaches a request from its handler and asks the kernel to cancel it. The request is freed
+   * once its final completion has been harvested.
+   */
+  void cancel(IoUringRequest& request);
+
+  /**
+   * Closes a socket which queued requests may still refer to. The kernel looks up the file
+   * descriptor of a request when it is submitted, so the queued requests are handed to the kernel
+   * first, lest they act on another socket which reuses the descriptor. If the kernel is not taking
+   * requests for now, the socket is closed once they have been submitted.
+   */
+  void closeSocket(os_fd_t fd);
+
+  /**
+   * Takes ownership of a socket whose handle has been closed while it still had data queued for
+   * writing. The data is written out in the background and the socket is closed once it has been
+   * flushed, writing fails or IoUringOptions::close_flush_timeout_ expires.
+   * @param fd supplies the socket.
+   * @param data supplies the data to write. The buffer itself is handed over as an in flight write
+   *        may reference its slices.
+   * @param write supplies the in flight write request of the socket, if any, which is taken over.
+   */
+  void closeAfterFlush(os_fd_t fd, std::unique_ptr<Buffer::Instance> data, IoUringRequest* write);
+
+  /**
+   * @return uint64_t the number of requests that have been submitted and not yet completed.
+   */
+  uint64_t requestsInFlight() const { return requests_.size(); }
+
+private:
+  class ClosingSocket;
+
+  IoUringRequest& track(std::unique_ptr<IoUringRequest> request);
+  template <class PrepareFn> void prepare(PrepareFn prepare_fn);
+  void scheduleSubmit();
+  /**
+   * Hands the queued requests to the kernel now, rather than at the end of the event loop
+   * iteration.
+   * @return bool whether every request was submitted. If the kernel refused some, submission is
+   *         retried in the next loop iteration, after harvesting completions.
+   */
+  bool submit();
+  void harvest();
+  void releaseClosingSocket(ClosingSocket& socket);
+  void onDispatcherDestroyed();
+  void onCompletion(uint64_t user_data, int32_t result, bool more);
+
+  Event::Dispatcher& dispatcher_;
+  const IoUringOptions options_;
+  IoUringImpl ring_;
+  Event::FileEventPtr eventfd_event_;
+  Event::SchedulableCallbackPtr submit_cb_;
+  // Set while the kernel refuses requests until completions have been harvested.
+  bool submission_deferred_{false};
+  // Requests which did not fit in the submission queue while the kernel refused requests.
+  std::list<std::function<bool()>> deferred_prepares_;
+  // Sockets to close once the requests which may refer to them have been submitted.
+  std::vector<os_fd_t> fds_to_close_;
+
+  // Null if no read buffers are registered with the ring.
+  std::shared_ptr<IoUringReadBuffers> registered_buffers_;
+
+  // Requests submitted and not yet completed, keyed by the user data they were submitted with.
+  absl::flat_hash_map<IoUringRequest*, std::unique_ptr<IoUringRequest>> requests_;
+  absl::flat_hash_map<ClosingSocket*, std::unique_ptr<ClosingSocket>> closing_sockets_;
+  // Keeps the worker alive while there are closing sockets, even if no handle is left.
+  std::shared_ptr<IoUringWorker> self_;
+  Common::CallbackHandle* dispatcher_destroy_cb_{};
+};
+
+using IoUringWorkerSharedPtr = std::shared_ptr<IoUringWorker>;
+
+} // namespace Io
+} // namespace Envoy
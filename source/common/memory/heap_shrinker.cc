@@ -1,5 +1,6 @@
 #include "common/memory/heap_shrinker.h"
 
+#include "common/buffer/slice_pool.h"
 #include "common/memory/utils.h"
 #include "common/stats/symbol_table_impl.h"
 
@@ -31,6 +32,8 @@ HeapShrinker::HeapShrinker(Event::Dispatcher& dispatcher, Server::OverloadManage
 
 void HeapShrinker::shrinkHeap() {
   if (active_) {
+    // Each thread returns its recycled buffer slices to the heap the next time it uses a buffer.
+    Buffer::SlicePool::releaseRetained();
     Utils::releaseFreeMemory();
     shrink_counter_->inc();
   }
@@ -13,7 +13,9 @@
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/enum_to_int.h"
+#include "common/common/utility.h"
 #include "common/network/address_impl.h"
+#include "common/network/io_socket_handle_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/raw_buffer_socket.h"
 #include "common/network/utility.h"
@@ -69,9 +71,9 @@ ConnectionImpl::ConnectionImpl(Event::Dispatcher& dispatcher, ConnectionSocketPt
 
   // We never ask for both early close and read at the same time. If we are reading, we want to
   // consume all available data.
-  file_event_ = dispatcher_.createFileEvent(
-      ConnectionImpl::ioHandle().fd(), [this](uint32_t events) -> void { onFileEvent(events); },
-      trigger, Event::FileReadyType::Read | Event::FileReadyType::Write);
+  file_event_ = ConnectionImpl::ioHandle().createFileEvent(
+      dispatcher_, [this](uint32_t events) -> void { onFileEvent(events); }, trigger,
+      Event::FileReadyType::Read | Event::FileReadyType::Write);
 
   transport_socket_->setTransportSocketCallbacks(*this);
 }
@@ -104,7 +106,7 @@ void ConnectionImpl::close(ConnectionCloseType type) {
     return;
   }
 
-  uint64_t data_to_write = write_buffer_->length();
+  uint64_t data_to_write = pendingWriteLength();
   ENVOY_CONN_LOG(debug, "closing data_to_write={} type={}", *this, data_to_write, enumToInt(type));
   const bool delayed_close_timeout_set = delayed_close_timeout_.count() > 0;
   if (data_to_write == 0 || type == ConnectionCloseType::NoFlush ||
@@ -213,6 +215,11 @@ void ConnectionImpl::closeSocket(ConnectionEvent close_type) {
   // counted buffer fragments, it helps avoid lifetime issues with the
   // connection outlasting the subscriber.
   write_buffer_->drain(write_buffer_->length());
+  splice_pipe_.reset();
+  if (splice_peer_ != nullptr) {
+    splice_peer_->splice_peer_ = nullptr;
+    splice_peer_ = nullptr;
+  }
 
   connection_stats_.reset();
 
@@ -394,6 +401,8 @@ void ConnectionImpl::write(Buffer::Instance& data, bool end_stream) {
 
 void ConnectionImpl::write(Buffer::Instance& data, bool end_stream, bool through_filter_chain) {
   ASSERT(!end_stream || enable_half_close_);
+  // Data written once splicing has started could overtake the data spliced before it.
+  ASSERT(splice_pipe_ == nullptr || data.length() == 0);
 
   if (write_end_stream_) {
     // It is an API violation to write more data after writing end_stream, but a duplicate
@@ -555,7 +564,8 @@ void ConnectionImpl::onReadReady() {
     return;
   }
 
-  IoResult result = transport_socket_->doRead(read_buffer_);
+  IoResult result =
+      splice_peer_ != nullptr ? spliceRead() : transport_socket_->doRead(read_buffer_);
   uint64_t new_buffer_size = read_buffer_.length();
   updateReadBufferStats(result.bytes_processed_, new_buffer_size);
 
@@ -624,9 +634,17 @@ void ConnectionImpl::onWriteReady() {
     }
   }
 
-  IoResult result = transport_socket_->doWrite(*write_buffer_, write_end_stream_);
+  // Data spliced from the peer is written after the data buffered before splicing started, and the
+  // end of stream after both.
+  const bool spliced_data_pending = splice_pipe_ != nullptr && splice_pipe_->length() > 0;
+  IoResult result =
+      transport_socket_->doWrite(*write_buffer_, write_end_stream_ && !spliced_data_pending);
   ASSERT(!result.end_stream_read_); // The interface guarantees that only read operations set this.
-  uint64_t new_buffer_size = write_buffer_->length();
+  if (spliced_data_pending && result.action_ == PostIoAction::KeepOpen &&
+      write_buffer_->length() == 0) {
+    spliceWrite(result);
+  }
+  uint64_t new_buffer_size = pendingWriteLength();
   updateWriteBufferStats(result.bytes_processed_, new_buffer_size);
 
   // NOTE: If the delayed_close_timer_ is set, it must only trigger after a delayed_close_timeout_
@@ -690,7 +708,92 @@ void ConnectionImpl::updateWriteBufferStats(uint64_t num_written, uint64_t new_s
 
 bool ConnectionImpl::bothSidesHalfClosed() {
   // If the write_buffer_ is not empty, then the end_stream has not been sent to the transport yet.
-  return read_end_stream_ && write_end_stream_ && write_buffer_->length() == 0;
+  return read_end_stream_ && write_end_stream_ && pendingWriteLength() == 0;
+}
+
+uint64_t ConnectionImpl::pendingWriteLength() const {
+  return write_buffer_->length() + (splice_pipe_ != nullptr ? splice_pipe_->length() : 0);
+}
+
+bool ConnectionImpl::startSplice(Connection& peer) {
+  auto* peer_impl = dynamic_cast<ConnectionImpl*>(&peer);
+  if (peer_impl == nullptr || peer_impl == this || &peer_impl->dispatcher_ != &dispatcher_ ||
+      !canSplice() || !peer_impl->canSplice()) {
+    return false;
+  }
+  // Each pipe holds up to the buffer limit of the connection it is written to, which bounds the
+  // data in flight in the same way as its write buffer.
+  SplicePipePtr pipe = SplicePipe::create(read_buffer_limit_);
+  SplicePipePtr peer_pipe = SplicePipe::create(peer_impl->read_buffer_limit_);
+  if (pipe == nullptr || peer_pipe == nullptr) {
+    return false;
+  }
+
+  ENVOY_CONN_LOG(debug, "splicing with connection {}", *this, peer.id());
+  splice_pipe_ = std::move(pipe);
+  splice_peer_ = peer_impl;
+  peer_impl->splice_pipe_ = std::move(peer_pipe);
+  peer_impl->splice_peer_ = this;
+  return true;
+}
+
+bool ConnectionImpl::canSplice() const {
+  const auto* io_handle = dynamic_cast<const IoSocketHandleImpl*>(&ioHandle());
+  return state() == State::Open && !connecting_ && splice_peer_ == nullptr &&
+         read_buffer_.length() == 0 && !read_end_stream_ && !write_end_stream_ &&
+         dynamic_cast<const RawBufferSocket*>(transport_socket_.get()) != nullptr &&
+         io_handle != nullptr && io_handle->allowsDescriptorIo() &&
+         !filter_manager_.hasWriteFilters() && !filter_manager_.hasMultipleReadFilters();
+}
+
+IoResult ConnectionImpl::spliceRead() {
+  SplicePipe& pipe = *splice_peer_->splice_pipe_;
+  if (pipe.length() > 0) {
+    // The peer has yet to write out the data read last, and wakes this connection up once it has.
+    return {PostIoAction::KeepOpen, 0, false};
+  }
+
+  const Api::SysCallSizeResult result = pipe.fill(ioHandle().fd());
+  if (result.rc_ > 0) {
+    ENVOY_CONN_LOG(trace, "spliced {} bytes", *this, result.rc_);
+    stream_info_.addBytesReceived(result.rc_);
+    splice_peer_->onSplicedData(result.rc_);
+    return {PostIoAction::KeepOpen, static_cast<uint64_t>(result.rc_), false};
+  } else if (result.rc_ == 0) {
+    return {PostIoAction::KeepOpen, 0, true};
+  } else if (result.errno_ == SOCKET_ERROR_AGAIN) {
+    return {PostIoAction::KeepOpen, 0, false};
+  }
+  ENVOY_CONN_LOG(debug, "splice error: {}", *this, errorDetails(result.errno_));
+  return {PostIoAction::Close, 0, false};
+}
+
+void ConnectionImpl::spliceWrite(IoResult& result) {
+  const Api::SysCallSizeResult spliced = splice_pipe_->drain(ioHandle().fd());
+  if (spliced.rc_ < 0) {
+    if (spliced.errno_ != SOCKET_ERROR_AGAIN) {
+      ENVOY_CONN_LOG(debug, "splice error: {}", *this, errorDetails(spliced.errno_));
+      result.action_ = PostIoAction::Close;
+    }
+    return;
+  }
+
+  result.bytes_processed_ += spliced.rc_;
+  if (splice_pipe_->length() > 0) {
+    return;
+  }
+  if (splice_peer_ != nullptr) {
+    splice_peer_->setReadBufferReady();
+  }
+  if (write_end_stream_) {
+    result.action_ = transport_socket_->doWrite(*write_buffer_, true).action_;
+  }
+}
+
+void ConnectionImpl::onSplicedData(uint64_t length) {
+  stream_info_.addBytesSent(length);
+  updateWriteBufferStats(0, pendingWriteLength());
+  file_event_->activate(Event::FileReadyType::Write);
 }
 
 absl::string_view ConnectionImpl::transportFailureReason() const {
@@ -11,6 +11,7 @@
 #include "common/buffer/watermark_buffer.h"
 #include "common/event/libevent.h"
 #include "common/network/connection_impl_base.h"
+#include "common/network/splice_pipe.h"
 #include "common/stream_info/stream_info_impl.h"
 
 #include "absl/types/optional.h"
@@ -90,6 +91,7 @@ public:
   StreamInfo::StreamInfo& streamInfo() override { return stream_info_; }
   const StreamInfo::StreamInfo& streamInfo() const override { return stream_info_; }
   absl::string_view transportFailureReason() const override;
+  bool startSplice(Connection& peer) override;
 
   // Network::FilterManagerConnection
   void rawWrite(Buffer::Instance& data, bool end_stream) override;
@@ -177,9 +179,29 @@ private:
   // Returns true iff end of stream has been both written and read.
   bool bothSidesHalfClosed();
 
+  // Returns the number of bytes written to the connection and not yet to the socket.
+  uint64_t pendingWriteLength() const;
+
+  // Returns true iff data can be spliced between the socket and a pipe, which requires the
+  // transport socket to pass the data through unchanged and the I/O handle not to hold any. Spliced
+  // data bypasses the filters, so there must be no write filters and no read filter other than the
+  // one forwarding the data.
+  bool canSplice() const;
+  // Splices data received on the socket into the pipe of the peer, when it is empty.
+  IoResult spliceRead();
+  // Writes the data spliced from the peer to the socket, and the end of stream after it.
+  void spliceWrite(IoResult& result);
+  // Called by the peer when it has spliced data into the pipe of this connection.
+  void onSplicedData(uint64_t length);
+
   static std::atomic<uint64_t> next_global_id_;
 
   std::list<BytesSentCb> bytes_sent_callbacks_;
+  // The connection data is spliced to and from, which refers back to this one, until either is
+  // closed.
+  ConnectionImpl* splice_peer_{};
+  // Data spliced from the peer and not yet written to the socket. It outlives the peer.
+  SplicePipePtr splice_pipe_;
   // Tracks the number of times reads have been disabled. If N different components call
   // readDisabled(true) this allows the connection to only resume reads when readDisabled(false)
   // has been called N times.
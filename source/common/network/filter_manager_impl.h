@@ -108,6 +108,8 @@ public:
   bool initializeReadFilters();
   void onRead();
   FilterStatus onWrite();
+  bool hasWriteFilters() const { return !downstream_filters_.empty(); }
+  bool hasMultipleReadFilters() const { return upstream_filters_.size() > 1; }
 
 private:
   struct ActiveReadFilter : public ReadFilterCallbacks, LinkedObject<ActiveReadFilter> {
@@ -1,6 +1,7 @@
 #include "common/network/io_socket_handle_impl.h"
 
 #include "envoy/buffer/buffer.h"
+#include "envoy/event/dispatcher.h"
 
 #include "common/api/os_sys_calls_impl.h"
 #include "common/common/utility.h"
@@ -23,6 +24,12 @@ IoSocketHandleImpl::~IoSocketHandleImpl() {
 
 Api::IoCallUint64Result IoSocketHandleImpl::close() {
   ASSERT(SOCKET_VALID(fd_));
+  if (zero_copy_ != nullptr && !zero_copy_->idle()) {
+    // The kernel may still transmit from memory held by the sender.
+    ZeroCopySender::closeAfterCompletions(fd_, std::move(zero_copy_));
+    SET_SOCKET_INVALID(fd_);
+    return Api::ioCallUint64ResultNoError();
+  }
   const int rc = Api::OsSysCallsSingleton::get().close(fd_).rc_;
   SET_SOCKET_INVALID(fd_);
   return Api::IoCallUint64Result(rc, Api::IoErrorPtr(nullptr, IoSocketError::deleteIoError));
@@ -47,6 +54,10 @@ Api::IoCallUint64Result IoSocketHandleImpl::readv(uint64_t max_length, Buffer::R
       fd_, iov.begin(), static_cast<int>(num_slices_to_read)));
 }
 
+Api::IoCallUint64Result IoSocketHandleImpl::read(Buffer::Instance& buffer, uint64_t max_length) {
+  return buffer.read(*this, max_length);
+}
+
 Api::IoCallUint64Result IoSocketHandleImpl::writev(const Buffer::RawSlice* slices,
                                                    uint64_t num_slice) {
   absl::FixedArray<iovec> iov(num_slice);
@@ -65,6 +76,19 @@ Api::IoCallUint64Result IoSocketHandleImpl::writev(const Buffer::RawSlice* slice
       Api::OsSysCallsSingleton::get().writev(fd_, iov.begin(), num_slices_to_write));
 }
 
+Api::IoCallUint64Result IoSocketHandleImpl::write(Buffer::Instance& buffer) {
+  if (zero_copy_ == nullptr) {
+    return buffer.write(*this);
+  }
+  if (!zero_copy_->idle()) {
+    zero_copy_->reapCompletions(fd_);
+  }
+  if (buffer.length() < zero_copy_->config()->min_write_size_) {
+    return buffer.write(*this);
+  }
+  return sysCallResultToIoCallResult(zero_copy_->send(fd_, buffer));
+}
+
 Api::IoCallUint64Result IoSocketHandleImpl::sendmsg(const Buffer::RawSlice* slices,
                                                     uint64_t num_slice, int flags,
                                                     const Address::Ip* self_ip,
@@ -394,7 +418,9 @@ IoHandlePtr IoSocketHandleImpl::accept(struct sockaddr* addr, socklen_t* addrlen
     return nullptr;
   }
 
-  return std::make_unique<IoSocketHandleImpl>(result.rc_, socket_v6only_);
+  // The socket inherits the zero copy option of the listener.
+  return std::make_unique<IoSocketHandleImpl>(
+      result.rc_, socket_v6only_, zero_copy_ != nullptr ? zero_copy_->config() : nullptr);
 }
 
 Api::SysCallIntResult IoSocketHandleImpl::connect(Address::InstanceConstSharedPtr address) {
@@ -472,5 +498,30 @@ Address::InstanceConstSharedPtr IoSocketHandleImpl::peerAddress() {
   return Address::addressFromSockAddr(ss, ss_len);
 }
 
+Api::SysCallIntResult IoSocketHandleImpl::shutdown(int how) {
+  return Api::OsSysCallsSingleton::get().shutdown(fd_, how);
+}
+
+Event::FileEventPtr IoSocketHandleImpl::createFileEvent(Event::Dispatcher& dispatcher,
+                                                        Event::FileReadyCb cb,
+                                                        Event::FileTriggerType trigger,
+                                                        uint32_t events) {
+  if (zero_copy_ != nullptr) {
+    zero_copy_->setDispatcher(dispatcher);
+    // The kernel wakes up the socket when it queues a completion, which releases the memory of
+    // the sends of sockets that are not written to anymore.
+    return dispatcher.createFileEvent(
+        fd_,
+        [this, cb](uint32_t events) {
+          if (zero_copy_ != nullptr && !zero_copy_->idle()) {
+            zero_copy_->reapCompletions(fd_);
+          }
+          cb(events);
+        },
+        trigger, events);
+  }
+  return dispatcher.createFileEvent(fd_, cb, trigger, events);
+}
+
 } // namespace Network
 } // namespace Envoy
@@ -7,17 +7,24 @@
 
 #include "common/common/logger.h"
 #include "common/network/io_socket_error_impl.h"
+#include "common/network/zero_copy_sender.h"
 
 namespace Envoy {
 namespace Network {
 
 /**
- * IoHandle derivative for sockets
+ * IoHandle derivative for sockets. If given a zero copy configuration, writes of buffers of at
+ * least its minimum size are sent with MSG_ZEROCOPY, and sockets accepted through the handle do
+ * the same.
  */
 class IoSocketHandleImpl : public IoHandle, protected Logger::Loggable<Logger::Id::io> {
 public:
-  explicit IoSocketHandleImpl(os_fd_t fd = INVALID_SOCKET, bool socket_v6only = false)
-      : fd_(fd), socket_v6only_(socket_v6only) {}
+  explicit IoSocketHandleImpl(os_fd_t fd = INVALID_SOCKET, bool socket_v6only = false,
+                              ZeroCopyConfigSharedPtr zero_copy_config = nullptr)
+      : fd_(fd), socket_v6only_(socket_v6only),
+        zero_copy_(zero_copy_config != nullptr
+                       ? std::make_unique<ZeroCopySender>(std::move(zero_copy_config))
+                       : nullptr) {}
 
   // Close underlying socket if close() hasn't been call yet.
   ~IoSocketHandleImpl() override;
@@ -32,8 +39,12 @@ public:
   Api::IoCallUint64Result readv(uint64_t max_length, Buffer::RawSlice* slices,
                                 uint64_t num_slice) override;
 
+  Api::IoCallUint64Result read(Buffer::Instance& buffer, uint64_t max_length) override;
+
   Api::IoCallUint64Result writev(const Buffer::RawSlice* slices, uint64_t num_slice) override;
 
+  Api::IoCallUint64Result write(Buffer::Instance& buffer) override;
+
   Api::IoCallUint64Result sendmsg(const Buffer::RawSlice* slices, uint64_t num_slice, int flags,
                                   const Address::Ip* self_ip,
                                   const Address::Instance& peer_address) override;
@@ -58,8 +69,12 @@ public:
   absl::optional<int> domain() override;
   Address::InstanceConstSharedPtr localAddress() override;
   Address::InstanceConstSharedPtr peerAddress() override;
+  Api::SysCallIntResult shutdown(int how) override;
+  Event::FileEventPtr createFileEvent(Event::Dispatcher& dispatcher, Event::FileReadyCb cb,
+                                      Event::FileTriggerType trigger, uint32_t events) override;
+  bool allowsDescriptorIo() const override { return true; }
 
-private:
+protected:
   // Converts a SysCallSizeResult to IoCallUint64Result.
   template <typename T>
   Api::IoCallUint64Result sysCallResultToIoCallResult(const Api::SysCallResult<T>& result) {
@@ -80,6 +95,7 @@ private:
 
   os_fd_t fd_;
   int socket_v6only_{false};
+  ZeroCopySenderPtr zero_copy_;
 
   // The minimum cmsg buffer size to filled in destination address, packets dropped and gso
   // size when receiving a packet. It is possible for a received packet to contain both IPv4
@@ -0,0 +1,507 @@
+#include "common/network/io_uring_socket_handle_impl.h"
+
+#include "envoy/buffer/buffer.h"
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/assert.h"
+#include "common/common/utility.h"
+
+namespace Envoy {
+namespace Network {
+
+namespace {
+
+Api::IoCallUint64Result ioErrorResult(int error) {
+  if (error == SOCKET_ERROR_AGAIN) {
+    return Api::IoCallUint64Result(0, Api::IoErrorPtr(IoSocketError::getIoSocketEagainInstance(),
+                                                      IoSocketError::deleteIoError));
+  }
+  return Api::IoCallUint64Result(
+      0, Api::IoErrorPtr(new IoSocketError(error), IoSocketError::deleteIoError));
+}
+
+Api::IoCallUint64Result ioSuccessResult(uint64_t rc) {
+  return Api::IoCallUint64Result(rc, Api::IoErrorPtr(nullptr, IoSocketError::deleteIoError));
+}
+
+// Errors after which a request is simply resubmitted.
+bool isTransientError(int32_t result) {
+  return result == -EAGAIN || result == -EINTR || result == -ECONNABORTED;
+}
+
+} // namespace
+
+IoUringSocketHandleImpl::IoUringSocketHandleImpl(const Io::IoUringOptions& options, os_fd_t fd,
+                                                 bool socket_v6only)
+    : IoSocketHandleImpl(fd, socket_v6only), options_(options),
+      write_buffer_(std::make_unique<Buffer::OwnedImpl>()),
+      multishot_accept_(options.enable_multishot_accept_) {}
+
+IoUringSocketHandleImpl::~IoUringSocketHandleImpl() {
+  if (SOCKET_VALID(fd_)) {
+    IoUringSocketHandleImpl::close();
+  }
+}
+
+Api::IoCallUint64Result IoUringSocketHandleImpl::close() {
+  ASSERT(SOCKET_VALID(fd_));
+  if (worker_ == nullptr) {
+    return IoSocketHandleImpl::close();
+  }
+
+  if (file_event_ != nullptr) {
+    file_event_->detach();
+    file_event_ = nullptr;
+  }
+  for (Io::IoUringRequest* request : {read_request_, accept_request_, connect_request_}) {
+    if (request != nullptr) {
+      worker_->cancel(*request);
+    }
+  }
+  read_request_ = accept_request_ = connect_request_ = nullptr;
+  for (const AcceptedSocket& socket : accepted_sockets_) {
+    Api::OsSysCallsSingleton::get().close(socket.fd_);
+  }
+  accepted_sockets_.clear();
+
+  Io::IoUringWorkerSharedPtr worker = std::move(worker_);
+  if (write_error_ == 0 && write_buffer_->length() > 0) {
+    // The data has already been accepted by writev(), so it is flushed before the socket is
+    // closed, as the kernel would have done for data in the socket send buffer.
+    worker->closeAfterFlush(fd_, std::move(write_buffer_), write_request_);
+    write_request_ = nullptr;
+    SET_SOCKET_INVALID(fd_);
+    return ioSuccessResult(0);
+  }
+  if (write_request_ != nullptr) {
+    worker->cancel(*write_request_);
+    write_request_ = nullptr;
+  }
+  // Requests still queued would otherwise be submitted after the descriptor has been closed, and
+  // act on whichever socket reuses it.
+  worker->closeSocket(fd_);
+  SET_SOCKET_INVALID(fd_);
+  return ioSuccessResult(0);
+}
+
+Api::IoCallUint64Result IoUringSocketHandleImpl::readv(uint64_t max_length,
+                                                       Buffer::RawSlice* slices,
+                                                       uint64_t num_slice) {
+  if (!onRing()) {
+    return IoSocketHandleImpl::readv(max_length, slices, num_slice);
+  }
+
+  if (read_buffer_.length() == 0) {
+    return emptyReadResult();
+  }
+
+  uint64_t bytes_read = 0;
+  for (uint64_t i = 0; i < num_slice && bytes_read < max_length; ++i) {
+    const uint64_t length = std::min(
+        {static_cast<uint64_t>(slices[i].len_), max_length - bytes_read, read_buffer_.length()});
+    if (length == 0) {
+      break;
+    }
+    read_buffer_.copyOut(0, length, slices[i].mem_);
+    read_buffer_.drain(length);
+    bytes_read += length;
+  }
+  maybeSubmitRead();
+  return ioSuccessResult(bytes_read);
+}
+
+Api::IoCallUint64Result IoUringSocketHandleImpl::read(Buffer::Instance& buffer,
+                                                      uint64_t max_length) {
+  if (!onRing()) {
+    return IoSocketHandleImpl::read(buffer, max_length);
+  }
+  if (read_buffer_.length() == 0) {
+    return emptyReadResult();
+  }
+  // The memory the reads completed into moves along with the data.
+  const uint64_t length = std::min(max_length, read_buffer_.length());
+  buffer.move(read_buffer_, length);
+  maybeSubmitRead();
+  return ioSuccessResult(length);
+}
+
+Api::IoCallUint64Result IoUringSocketHandleImpl::writev(const Buffer::RawSlice* slices,
+                                                        uint64_t num_slice) {
+  if (!onRing()) {
+    return IoSocketHandleImpl::writev(slices, num_slice);
+  }
+  if (write_error_ != 0) {
+    return ioErrorResult(write_error_);
+  }
+  if (connecting_) {
+    return ioErrorResult(SOCKET_ERROR_AGAIN);
+  }
+
+  uint64_t bytes_written = 0;
+  for (uint64_t i = 0; i < num_slice; ++i) {
+    const uint64_t length = std::min(static_cast<uint64_t>(slices[i].len_), writeSpace());
+    if (length > 0) {
+      write_buffer_->add(slices[i].mem_, length);
+      bytes_written += length;
+    }
+    if (length < slices[i].len_) {
+      break;
+    }
+  }
+  if (bytes_written == 0) {
+    bool has_data = false;
+    for (uint64_t i = 0; i < num_slice; ++i) {
+      has_data |= slices[i].len_ > 0;
+    }
+    if (has_data) {
+      // Report writability again once the queued data has drained below the limit.
+      write_blocked_ = true;
+      return ioErrorResult(SOCKET_ERROR_AGAIN);
+    }
+  }
+  maybeSubmitWrite();
+  return ioSuccessResult(bytes_written);
+}
+
+Api::IoCallUint64Result IoUringSocketHandleImpl::write(Buffer::Instance& buffer) {
+  if (!onRing()) {
+    return IoSocketHandleImpl::write(buffer);
+  }
+  if (write_error_ != 0) {
+    return ioErrorResult(write_error_);
+  }
+  if (connecting_) {
+    return ioErrorResult(SOCKET_ERROR_AGAIN);
+  }
+
+  const uint64_t length = std::min(buffer.length(), writeSpace());
+  if (length == 0 && buffer.length() > 0) {
+    write_blocked_ = true;
+    return ioErrorResult(SOCKET_ERROR_AGAIN);
+  }
+  // The slices are taken over rather than copied, and written out from where the caller put the
+  // data.
+  write_buffer_->move(buffer, length);
+  maybeSubmitWrite();
+  return ioSuccessResult(length);
+}
+
+Api::SysCallIntResult IoUringSocketHandleImpl::listen(int backlog) {
+  listening_ = true;
+  return IoSocketHandleImpl::listen(backlog);
+}
+
+IoHandlePtr IoUringSocketHandleImpl::accept(struct sockaddr* addr, socklen_t* addrlen) {
+  if (!onRing()) {
+    // The listen socket may be shared with listeners on other dispatchers, which accept
+    // synchronously when the socket reports readiness.
+    const Api::SysCallSocketResult result =
+        Api::OsSysCallsSingleton::get().accept(fd_, addr, addrlen);
+    if (SOCKET_INVALID(result.rc_)) {
+      return nullptr;
+    }
+    return std::make_unique<IoUringSocketHandleImpl>(options_, result.rc_, socket_v6only_);
+  }
+
+  if (accepted_sockets_.empty()) {
+    errno = SOCKET_ERROR_AGAIN;
+    return nullptr;
+  }
+  const AcceptedSocket socket = accepted_sockets_.front();
+  accepted_sockets_.pop_front();
+  maybeSubmitAccept();
+
+  if (addr != nullptr) {
+    if (socket.address_len_ > 0) {
+      *addrlen = std::min(*addrlen, socket.address_len_);
+      memcpy(addr, &socket.address_, *addrlen);
+    } else {
+      Api::OsSysCallsSingleton::get().getpeername(socket.fd_, addr, addrlen);
+    }
+  }
+  return std::make_unique<IoUringSocketHandleImpl>(options_, socket.fd_, socket_v6only_);
+}
+
+Api::SysCallIntResult IoUringSocketHandleImpl::connect(Address::InstanceConstSharedPtr address) {
+  if (!onRing()) {
+    return IoSocketHandleImpl::connect(address);
+  }
+  ASSERT(connect_request_ == nullptr && !connecting_);
+  connect_request_ =
+      &worker_->submitConnect(fd_, address->sockAddr(), address->sockAddrLen(), *this);
+  connecting_ = true;
+  return {-1, SOCKET_ERROR_IN_PROGRESS};
+}
+
+Api::SysCallIntResult IoUringSocketHandleImpl::getOption(int level, int optname, void* optval,
+                                                         socklen_t* optlen) {
+  if (level == SOL_SOCKET && optname == SO_ERROR && connect_error_ != 0 &&
+      *optlen >= sizeof(int)) {
+    // The error of a connect submitted to the ring is not reflected in the socket error.
+    *static_cast<int*>(optval) = connect_error_;
+    *optlen = sizeof(int);
+    return {0, 0};
+  }
+  return IoSocketHandleImpl::getOption(level, optname, optval, optlen);
+}
+
+Api::SysCallIntResult IoUringSocketHandleImpl::shutdown(int how) {
+  if (onRing() && how == ENVOY_SHUT_WR && write_buffer_->length() > 0) {
+    // Shut down once the data already accepted by writev() has been written.
+    shutdown_pending_ = true;
+    return {0, 0};
+  }
+  return IoSocketHandleImpl::shutdown(how);
+}
+
+Event::FileEventPtr IoUringSocketHandleImpl::createFileEvent(Event::Dispatcher& dispatcher,
+                                                             Event::FileReadyCb cb,
+                                                             Event::FileTriggerType trigger,
+                                                             uint32_t events) {
+  if (file_event_ != nullptr || (worker_ != nullptr && &worker_->dispatcher() != &dispatcher)) {
+    // Only a single dispatcher can drive the handle through its ring. This happens for listen
+    // sockets shared by the listeners of several workers; the others fall back to readiness.
+    return IoSocketHandleImpl::createFileEvent(dispatcher, cb, trigger, events);
+  }
+  if (worker_ == nullptr) {
+    worker_ = Io::IoUringWorker::get(dispatcher, options_);
+  }
+  return std::make_unique<IoUringFileEvent>(*this, dispatcher, cb, trigger, events);
+}
+
+void IoUringSocketHandleImpl::onCompletion(Io::IoUringRequest& request, int32_t result,
+                                           bool more) {
+  switch (request.type_) {
+  case Io::IoUringRequest::Type::Read:
+    onReadCompletion(request, result);
+    break;
+  case Io::IoUringRequest::Type::Write:
+    onWriteCompletion(result);
+    break;
+  case Io::IoUringRequest::Type::Accept:
+    onAcceptCompletion(request, result, more);
+    break;
+  case Io::IoUringRequest::Type::Connect:
+    onConnectCompletion(result);
+    break;
+  case Io::IoUringRequest::Type::Poll:
+    NOT_REACHED_GCOVR_EXCL_LINE;
+  }
+}
+
+bool IoUringSocketHandleImpl::onRing() const {
+  return worker_ != nullptr && worker_->dispatcher().isThreadSafe();
+}
+
+Api::IoCallUint64Result IoUringSocketHandleImpl::emptyReadResult() const {
+  if (read_error_ != 0) {
+    return ioErrorResult(read_error_);
+  }
+  return read_eof_ ? ioSuccessResult(0) : ioErrorResult(SOCKET_ERROR_AGAIN);
+}
+
+uint64_t IoUringSocketHandleImpl::writeSpace() const {
+  const uint64_t queued = write_buffer_->length();
+  return queued < options_.write_buffer_limit_ ? options_.write_buffer_limit_ - queued : 0;
+}
+
+uint32_t IoUringSocketHandleImpl::readyEvents() const {
+  if (listening_) {
+    return accepted_sockets_.empty() ? 0 : Event::FileReadyType::Read;
+  }
+  uint32_t events = 0;
+  if (read_buffer_.length() > 0 || read_eof_ || read_error_ != 0) {
+    events |= Event::FileReadyType::Read;
+  }
+  if (read_eof_ || read_error_ != 0) {
+    events |= Event::FileReadyType::Closed;
+  }
+  if (!connecting_ && (!write_blocked_ || write_error_ != 0)) {
+    events |= Event::FileReadyType::Write;
+  }
+  return events;
+}
+
+void IoUringSocketHandleImpl::onEnabled(uint32_t events) {
+  enabled_events_ = events;
+  if (listening_) {
+    maybeSubmitAccept();
+  } else {
+    maybeSubmitRead();
+  }
+}
+
+void IoUringSocketHandleImpl::notify(uint32_t events) {
+  if (file_event_ != nullptr) {
+    file_event_->onReady(events);
+  }
+}
+
+void IoUringSocketHandleImpl::maybeSubmitRead() {
+  // Reads are only kept outstanding while the owner is interested in reading, or in the remote
+  // close, so that a read disabled connection exerts back pressure on its peer.
+  if (read_request_ == nullptr && !connecting_ && !read_eof_ && read_error_ == 0 &&
+      (enabled_events_ & (Event::FileReadyType::Read | Event::FileReadyType::Closed)) &&
+      read_buffer_.length() < options_.read_buffer_size_) {
+    read_request_ = &worker_->submitRead(fd_, *this);
+  }
+}
+
+void IoUringSocketHandleImpl::maybeSubmitWrite() {
+  if (write_request_ == nullptr && write_buffer_->length() > 0) {
+    write_request_ = &worker_->submitWrite(fd_, *write_buffer_, *this);
+  }
+}
+
+void IoUringSocketHandleImpl::maybeSubmitAccept() {
+  // A multishot accept stays armed while the listener is disabled; sockets accepted in the
+  // meantime are queued.
+  if (accept_request_ == nullptr && (enabled_events_ & Event::FileReadyType::Read) &&
+      (multishot_accept_ || accepted_sockets_.empty())) {
+    accept_request_ = &worker_->submitAccept(fd_, multishot_accept_, *this);
+  }
+}
+
+void IoUringSocketHandleImpl::onReadCompletion(Io::IoUringRequest& request, int32_t result) {
+  read_request_ = nullptr;
+  if (result > 0) {
+    worker_->moveReadData(request, result, read_buffer_);
+    notify(Event::FileReadyType::Read);
+  } else if (result == 0) {
+    read_eof_ = true;
+    notify(Event::FileReadyType::Read | Event::FileReadyType::Closed);
+  } else if (!isTransientError(result) && !(result == -ENOTCONN && connecting_)) {
+    // A read submitted in the same batch as the connect may be processed before it, in which case
+    // reading resumes once connected.
+    read_error_ = -result;
+    notify(Event::FileReadyType::Read | Event::FileReadyType::Closed);
+  }
+  maybeSubmitRead();
+}
+
+void IoUringSocketHandleImpl::onWriteCompletion(int32_t result) {
+  write_request_ = nullptr;
+  if (result > 0) {
+    write_buffer_->drain(result);
+    if (write_blocked_ && write_buffer_->length() < options_.write_buffer_limit_) {
+      write_blocked_ = false;
+      notify(Event::FileReadyType::Write);
+    }
+  } else if (!isTransientError(result)) {
+    write_error_ = -result;
+    write_buffer_->drain(write_buffer_->length());
+    notify(Event::FileReadyType::Write);
+  }
+  maybeSubmitWrite();
+  if (shutdown_pending_ && write_buffer_->length() == 0) {
+    shutdown_pending_ = false;
+    IoSocketHandleImpl::shutdown(ENVOY_SHUT_WR);
+  }
+}
+
+void IoUringSocketHandleImpl::onAcceptCompletion(Io::IoUringRequest& request, int32_t result,
+                                                 bool more) {
+  if (!more) {
+    accept_request_ = nullptr;
+  }
+  if (result >= 0) {
+    // Multishot accepts do not report the peer address, see IoUringWorker::submitAccept().
+    AcceptedSocket socket{result, {}, 0};
+    if (!multishot_accept_) {
+      socket.address_ = request.address_;
+      socket.address_len_ = request.address_len_;
+    }
+    accepted_sockets_.push_back(socket);
+    notify(Event::FileReadyType::Read);
+  } else if (result == -EINVAL && multishot_accept_) {
+    ENVOY_LOG(debug, "multishot accept is not supported, falling back to single shot accepts");
+    multishot_accept_ = false;
+  } else if (!isTransientError(result)) {
+    ENVOY_LOG(debug, "accept failed on fd={}: {}", fd_, errorDetails(-result));
+  }
+  maybeSubmitAccept();
+}
+
+void IoUringSocketHandleImpl::onConnectCompletion(int32_t result) {
+  connect_request_ = nullptr;
+  connecting_ = false;
+  if (result < 0) {
+    connect_error_ = -result;
+  } else {
+    maybeSubmitRead();
+  }
+  notify(Event::FileReadyType::Write);
+}
+
+IoUringFileEvent::IoUringFileEvent(IoUringSocketHandleImpl& handle, Event::Dispatcher& dispatcher,
+                                   Event::FileReadyCb cb, Event::FileTriggerType trigger,
+                                   uint32_t events)
+    : handle_(&handle), cb_(cb), trigger_(trigger),
+      dispatch_cb_(dispatcher.createSchedulableCallback([this]() { dispatch(); })) {
+  ASSERT(handle_->file_event_ == nullptr);
+  handle_->file_event_ = this;
+  setEnabled(events);
+}
+
+IoUringFileEvent::~IoUringFileEvent() {
+  if (handle_ != nullptr) {
+    handle_->file_event_ = nullptr;
+    handle_->onEnabled(0);
+  }
+}
+
+void IoUringFileEvent::activate(uint32_t events) {
+  injected_events_ |= events;
+  schedule();
+}
+
+void IoUringFileEvent::setEnabled(uint32_t events) {
+  enabled_events_ = events;
+  if (handle_ == nullptr) {
+    return;
+  }
+  handle_->onEnabled(events);
+  // Like re-registering a descriptor with epoll, enabling events reports those that are already
+  // ready.
+  edge_events_ |= handle_->readyEvents();
+  if (edge_events_ & enabled_events_) {
+    schedule();
+  }
+}
+
+void IoUringFileEvent::onReady(uint32_t events) {
+  edge_events_ |= events;
+  if (events & enabled_events_) {
+    schedule();
+  }
+}
+
+void IoUringFileEvent::schedule() {
+  if (!dispatch_cb_->enabled()) {
+    dispatch_cb_->scheduleCallbackNextIteration();
+  }
+}
+
+void IoUringFileEvent::dispatch() {
+  uint32_t events = injected_events_;
+  injected_events_ = 0;
+  if (handle_ != nullptr) {
+    // Readiness is re-evaluated here, as it may have been consumed since it was reported.
+    const uint32_t ready = handle_->readyEvents();
+    const uint32_t triggered = trigger_ == Event::FileTriggerType::Level ? ready : edge_events_;
+    events |= triggered & ready & enabled_events_;
+    if (trigger_ == Event::FileTriggerType::Level && (ready & enabled_events_)) {
+      // Keep firing until the callback has consumed the readiness. If it does, the next dispatch
+      // finds nothing to report.
+      schedule();
+    }
+  }
+  edge_events_ = 0;
+  if (events != 0) {
+    // This may destroy the file event.
+    cb_(events);
+  }
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/file_event.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/io/io_uring_worker_impl.h"
+#include "common/network/io_socket_handle_impl.h"
+
+namespace Envoy {
+namespace Network {
+
+class IoUringFileEvent;
+
+/**
+ * IoHandle derivative for stream sockets whose I/O is performed by the io_uring of the dispatcher
+ * the handle is registered with. Once createFileEvent() has been called, the handle keeps a read
+ * (or, for listen sockets, an accept) outstanding on the ring while reading is enabled and stages
+ * the results, so that read(), readv() and accept() are served from memory. read() hands over the
+ * memory large reads completed into, while readv() copies the data out. write() takes over the
+ * slices of the data, and writev() copies it, into a per handle buffer which is written out in the
+ * background. connect() completes asynchronously. Readiness is reported through the file event
+ * returned by createFileEvent(), which emulates the trigger semantics of the libevent backed file
+ * events.
+ *
+ * Until a file event has been created the handle behaves exactly like IoSocketHandleImpl, so that
+ * listener filters may still peek at the socket directly.
+ *
+ * Transport sockets which bypass the IoHandle and perform I/O on the descriptor themselves, such
+ * as TLS, cannot be used with this handle. It reports so through allowsDescriptorIo(), and the TLS
+ * transport socket closes such connections rather than race the ring for the data.
+ */
+class IoUringSocketHandleImpl : public IoSocketHandleImpl, public Io::IoUringCompletionHandler {
+public:
+  IoUringSocketHandleImpl(const Io::IoUringOptions& options, os_fd_t fd = INVALID_SOCKET,
+                          bool socket_v6only = false);
+  ~IoUringSocketHandleImpl() override;
+
+  // Network::IoHandle
+  Api::IoCallUint64Result close() override;
+  Api::IoCallUint64Result readv(uint64_t max_length, Buffer::RawSlice* slices,
+                                uint64_t num_slice) override;
+  Api::IoCallUint64Result read(Buffer::Instance& buffer, uint64_t max_length) override;
+  Api::IoCallUint64Result writev(const Buffer::RawSlice* slices, uint64_t num_slice) override;
+  Api::IoCallUint64Result write(Buffer::Instance& buffer) override;
+  Api::SysCallIntResult listen(int backlog) override;
+  IoHandlePtr accept(struct sockaddr* addr, socklen_t* addrlen) override;
+  Api::SysCallIntResult connect(Address::InstanceConstSharedPtr address) override;
+  Api::SysCallIntResult getOption(int level, int optname, void* optval, socklen_t* optlen) override;
+  Api::SysCallIntResult shutdown(int how) override;
+  Event::FileEventPtr createFileEvent(Event::Dispatcher& dispatcher, Event::FileReadyCb cb,
+                                      Event::FileTriggerType trigger, uint32_t events) override;
+  // The ring may be reading from the descriptor at any time.
+  bool allowsDescriptorIo() const override { return false; }
+
+  // Io::IoUringCompletionHandler
+  void onCompletion(Io::IoUringRequest& request, int32_t result, bool more) override;
+
+private:
+  friend class IoUringFileEvent;
+
+  struct AcceptedSocket {
+    os_fd_t fd_;
+    sockaddr_storage address_;
+    socklen_t address_len_;
+  };
+
+  // @return whether I/O on this handle goes through the ring on the calling thread.
+  bool onRing() const;
+  // @return the result of reading while no data is staged.
+  Api::IoCallUint64Result emptyReadResult() const;
+  // @return uint64_t the number of bytes that may still be queued for writing.
+  uint64_t writeSpace() const;
+  // @return uint32_t the FileReadyType events the handle is currently ready for.
+  uint32_t readyEvents() const;
+  void onEnabled(uint32_t events);
+  void notify(uint32_t events);
+  void maybeSubmitRead();
+  void maybeSubmitWrite();
+  void maybeSubmitAccept();
+  void onReadCompletion(Io::IoUringRequest& request, int32_t result);
+  void onWriteCompletion(int32_t result);
+  void onAcceptCompletion(Io::IoUringRequest& request, int32_t result, bool more);
+  void onConnectCompletion(int32_t result);
+
+  const Io::IoUringOptions options_;
+  Io::IoUringWorkerSharedPtr worker_;
+  IoUringFileEvent* file_event_{};
+  uint32_t enabled_events_{};
+
+  Io::IoUringRequest* read_request_{};
+  Buffer::OwnedImpl read_buffer_;
+  bool read_eof_{};
+  int read_error_{};
+
+  Io::IoUringRequest* write_request_{};
+  // Held by pointer so that it can be handed to the worker, with any write in flight referencing
+  // it, if the handle is closed before the data has been written.
+  std::unique_ptr<Buffer::Instance> write_buffer_;
+  bool write_blocked_{};
+  bool shutdown_pending_{};
+  int write_error_{};
+
+  Io::IoUringRequest* connect_request_{};
+  bool connecting_{};
+  int connect_error_{};
+
+  bool listening_{};
+  bool multishot_accept_;
+  Io::IoUringRequest* accept_request_{};
+  std::deque<AcceptedSocket> accepted_sockets_;
+};
+
+/**
+ * FileEvent for an IoUringSocketHandleImpl. The callback is run from a schedulable callback when
+ * the handle reports new readiness, when the enabled events change, or when activated.
+ */
+class IoUringFileEvent : public Event::FileEvent {
+public:
+  IoUringFileEvent(IoUringSocketHandleImpl& handle, Event::Dispatcher& dispatcher,
+                   Event::FileReadyCb cb, Event::FileTriggerType trigger, uint32_t events);
+  ~IoUringFileEvent() override;
+
+  // Event::FileEvent
+  void activate(uint32_t events) override;
+  void setEnabled(uint32_t events) override;
+
+  /**
+   * Called by the handle when it becomes ready for events.
+   */
+  void onReady(uint32_t events);
+
+  /**
+   * Called by the handle when it is closed.
+   */
+  void detach() { handle_ = nullptr; }
+
+private:
+  void schedule();
+  void dispatch();
+
+  IoUringSocketHandleImpl* handle_;
+  Event::FileReadyCb cb_;
+  const Event::FileTriggerType trigger_;
+  uint32_t enabled_events_{};
+  // Events the handle became ready for since the callback last ran.
+  uint32_t edge_events_{};
+  // Events injected by activate() and pending delivery.
+  uint32_t injected_events_{};
+  Event::SchedulableCallbackPtr dispatch_cb_;
+};
+
+} // namespace Network
+} // namespace Envoy
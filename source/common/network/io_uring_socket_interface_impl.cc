@@ -0,0 +1,55 @@
+#include "common/network/io_uring_socket_interface_impl.h"
+
+#include "envoy/extensions/network/socket_interface/v3/io_uring_socket_interface.pb.h"
+#include "envoy/extensions/network/socket_interface/v3/io_uring_socket_interface.pb.validate.h"
+
+#include "common/io/io_uring_impl.h"
+#include "common/network/io_uring_socket_handle_impl.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Network {
+
+IoUringSocketInterfaceImpl::IoUringSocketInterfaceImpl()
+    : supported_(Io::IoUringImpl::isSupported()) {}
+
+IoHandlePtr IoUringSocketInterfaceImpl::makeSocket(os_fd_t fd, bool socket_v6only,
+                                                   Socket::Type socket_type) const {
+  if (!supported_ || socket_type != Socket::Type::Stream) {
+    return SocketInterfaceImpl::makeSocket(fd, socket_v6only, socket_type);
+  }
+  return std::make_unique<IoUringSocketHandleImpl>(options_, fd, socket_v6only);
+}
+
+Server::BootstrapExtensionPtr IoUringSocketInterfaceImpl::createBootstrapExtension(
+    const Protobuf::Message& message, Server::Configuration::ServerFactoryContext& context) {
+  const auto& config = MessageUtil::downcastAndValidate<
+      const envoy::extensions::network::socket_interface::v3::IoUringSocketInterface&>(
+      message, context.messageValidationContext().staticValidationVisitor());
+  options_.ring_size_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, ring_size, options_.ring_size_);
+  options_.read_buffer_size_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, read_buffer_size, options_.read_buffer_size_);
+  options_.registered_buffer_count_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+      config, registered_buffer_count, options_.registered_buffer_count_);
+  options_.write_buffer_limit_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, write_buffer_limit, options_.write_buffer_limit_);
+  options_.enable_multishot_accept_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+      config, enable_multishot_accept, options_.enable_multishot_accept_);
+  options_.close_flush_timeout_ = std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(
+      config, close_flush_timeout, options_.close_flush_timeout_.count()));
+  if (!supported_) {
+    ENVOY_LOG_MISC(warn, "io_uring is not available, {} falls back to the default socket interface",
+                   name());
+  }
+  return std::make_unique<SocketInterfaceExtension>(*this);
+}
+
+ProtobufTypes::MessagePtr IoUringSocketInterfaceImpl::createEmptyConfigProto() {
+  return std::make_unique<
+      envoy::extensions::network::socket_interface::v3::IoUringSocketInterface>();
+}
+
+REGISTER_FACTORY(IoUringSocketInterfaceImpl, Server::Configuration::BootstrapExtensionFactory);
+
+} // namespace Network
+} // namespace Envoy
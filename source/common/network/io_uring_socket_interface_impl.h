@@ -0,0 +1,41 @@
+#pragma once
+
+#include "common/io/io_uring_worker_impl.h"
+#include "common/network/socket_interface_impl.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Socket interface creating stream sockets whose I/O goes through an io_uring per dispatcher, see
+ * IoUringSocketHandleImpl. Datagram sockets, and all sockets if io_uring is not available on the
+ * host, are created as by the default socket interface.
+ */
+class IoUringSocketInterfaceImpl : public SocketInterfaceImpl {
+public:
+  IoUringSocketInterfaceImpl();
+
+  // Server::Configuration::BootstrapExtensionFactory
+  Server::BootstrapExtensionPtr
+  createBootstrapExtension(const Protobuf::Message& config,
+                           Server::Configuration::ServerFactoryContext& context) override;
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+  std::string name() const override {
+    return "envoy.extensions.network.socket_interface.io_uring";
+  };
+
+  const Io::IoUringOptions& options() const { return options_; }
+
+protected:
+  // SocketInterfaceImpl
+  IoHandlePtr makeSocket(os_fd_t fd, bool socket_v6only, Socket::Type socket_type) const override;
+
+private:
+  Io::IoUringOptions options_;
+  const bool supported_;
+};
+
+DECLARE_FACTORY(IoUringSocketInterfaceImpl);
+
+} // namespace Network
+} // namespace Envoy
@@ -2,16 +2,27 @@
 
 #include "envoy/common/exception.h"
 #include "envoy/extensions/network/socket_interface/v3/default_socket_interface.pb.h"
+#include "envoy/extensions/network/socket_interface/v3/default_socket_interface.pb.validate.h"
 #include "envoy/network/socket.h"
 
 #include "common/api/os_sys_calls_impl.h"
 #include "common/common/utility.h"
 #include "common/network/address_impl.h"
 #include "common/network/io_socket_handle_impl.h"
+#include "common/protobuf/utility.h"
 
 namespace Envoy {
 namespace Network {
 
+IoHandlePtr SocketInterfaceImpl::makeSocket(os_fd_t fd, bool socket_v6only,
+                                            Socket::Type socket_type) const {
+  if (zero_copy_config_ != nullptr && socket_type == Socket::Type::Stream &&
+      ZeroCopySender::enable(fd)) {
+    return std::make_unique<IoSocketHandleImpl>(fd, socket_v6only, zero_copy_config_);
+  }
+  return std::make_unique<IoSocketHandleImpl>(fd, socket_v6only);
+}
+
 IoHandlePtr SocketInterfaceImpl::socket(Socket::Type socket_type, Address::Type addr_type,
                                         Address::IpVersion version, bool socket_v6only) const {
 #if defined(__APPLE__) || defined(WIN32)
@@ -42,7 +53,7 @@ IoHandlePtr SocketInterfaceImpl::socket(Socket::Type socket_type, Address::Type
   const Api::SysCallSocketResult result = Api::OsSysCallsSingleton::get().socket(domain, flags, 0);
   RELEASE_ASSERT(SOCKET_VALID(result.rc_),
                  fmt::format("socket(2) failed, got error: {}", errorDetails(result.errno_)));
-  IoHandlePtr io_handle = std::make_unique<IoSocketHandleImpl>(result.rc_, socket_v6only);
+  IoHandlePtr io_handle = makeSocket(result.rc_, socket_v6only, socket_type);
 
 #if defined(__APPLE__) || defined(WIN32)
   // Cannot set SOCK_NONBLOCK as a ::socket flag.
@@ -87,9 +98,18 @@ bool SocketInterfaceImpl::ipFamilySupported(int domain) {
   return SOCKET_VALID(result.rc_);
 }
 
-Server::BootstrapExtensionPtr
-SocketInterfaceImpl::createBootstrapExtension(const Protobuf::Message&,
-                                              Server::Configuration::ServerFactoryContext&) {
+Server::BootstrapExtensionPtr SocketInterfaceImpl::createBootstrapExtension(
+    const Protobuf::Message& message, Server::Configuration::ServerFactoryContext& context) {
+  const auto& config = MessageUtil::downcastAndValidate<
+      const envoy::extensions::network::socket_interface::v3::DefaultSocketInterface&>(
+      message, context.messageValidationContext().staticValidationVisitor());
+  if (config.has_zero_copy_min_write_size()) {
+    const std::chrono::milliseconds close_timeout(
+        PROTOBUF_GET_MS_OR_DEFAULT(config, zero_copy_close_timeout, 10000));
+    zero_copy_config_ = std::make_shared<const ZeroCopyConfig>(
+        config.zero_copy_min_write_size().value(), close_timeout, context.scope(),
+        context.timeSource());
+  }
   return std::make_unique<SocketInterfaceExtension>(*this);
 }
 
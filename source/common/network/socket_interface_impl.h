@@ -4,6 +4,7 @@
 #include "envoy/network/socket.h"
 
 #include "common/network/socket_interface.h"
+#include "common/network/zero_copy_sender.h"
 
 namespace Envoy {
 namespace Network {
@@ -26,6 +27,16 @@ public:
   std::string name() const override {
     return "envoy.extensions.network.socket_interface.default_socket_interface";
   };
+
+protected:
+  /**
+   * Wraps a newly created socket in an IoHandle.
+   */
+  virtual IoHandlePtr makeSocket(os_fd_t fd, bool socket_v6only, Socket::Type socket_type) const;
+
+private:
+  // Set if stream sockets use zero copy sends.
+  ZeroCopyConfigSharedPtr zero_copy_config_;
 };
 
 DECLARE_FACTORY(SocketInterfaceImpl);
@@ -0,0 +1,89 @@
+#include "common/network/splice_pipe.h"
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/assert.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+
+#include "common/api/os_sys_calls_impl_linux.h"
+#endif
+
+namespace Envoy {
+namespace Network {
+
+SplicePipePtr SplicePipe::create(uint32_t capacity) {
+#if defined(__linux__)
+  auto& os_sys_calls = Api::LinuxOsSysCallsSingleton::get();
+  int fds[2];
+  if (os_sys_calls.pipe2(fds, O_NONBLOCK | O_CLOEXEC).rc_ != 0) {
+    return nullptr;
+  }
+  // Growing the pipe is subject to the limits of the user, so the default size is a fallback.
+  Api::SysCallIntResult result{-1, 0};
+  if (capacity > 0) {
+    result = os_sys_calls.fcntl(fds[1], F_SETPIPE_SZ, capacity);
+  }
+  if (result.rc_ < 0) {
+    result = os_sys_calls.fcntl(fds[1], F_GETPIPE_SZ, 0);
+  }
+  if (result.rc_ <= 0) {
+    Api::OsSysCallsSingleton::get().close(fds[0]);
+    Api::OsSysCallsSingleton::get().close(fds[1]);
+    return nullptr;
+  }
+  return SplicePipePtr{new SplicePipe(fds[0], fds[1], result.rc_)};
+#else
+  UNREFERENCED_PARAMETER(capacity);
+  return nullptr;
+#endif
+}
+
+SplicePipe::~SplicePipe() {
+#if defined(__linux__)
+  // Data still in the pipe is discarded along with it.
+  Api::OsSysCallsSingleton::get().close(read_fd_);
+  Api::OsSysCallsSingleton::get().close(write_fd_);
+#endif
+}
+
+Api::SysCallSizeResult SplicePipe::fill(os_fd_t fd) {
+#if defined(__linux__)
+  ASSERT(length_ < capacity_);
+  const Api::SysCallSizeResult result = Api::LinuxOsSysCallsSingleton::get().splice(
+      fd, write_fd_, capacity_ - length_, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (result.rc_ > 0) {
+    length_ += result.rc_;
+  }
+  return result;
+#else
+  UNREFERENCED_PARAMETER(fd);
+  NOT_REACHED_GCOVR_EXCL_LINE;
+#endif
+}
+
+Api::SysCallSizeResult SplicePipe::drain(os_fd_t fd) {
+#if defined(__linux__)
+  auto& os_sys_calls = Api::LinuxOsSysCallsSingleton::get();
+  ssize_t moved = 0;
+  while (length_ > 0) {
+    const Api::SysCallSizeResult result =
+        os_sys_calls.splice(read_fd_, fd, length_, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (result.rc_ <= 0) {
+      if (moved == 0) {
+        return result;
+      }
+      break;
+    }
+    length_ -= result.rc_;
+    moved += result.rc_;
+  }
+  return {moved, 0};
+#else
+  UNREFERENCED_PARAMETER(fd);
+  NOT_REACHED_GCOVR_EXCL_LINE;
+#endif
+}
+
+} // namespace Network
+} // namespace Envoy
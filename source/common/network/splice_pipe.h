@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/api/os_sys_calls_common.h"
+#include "envoy/common/platform.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Network {
+
+class SplicePipe;
+using SplicePipePtr = std::unique_ptr<SplicePipe>;
+
+/**
+ * A pipe through which data is moved from one socket to another with splice(2), so that the
+ * kernel forwards it without copying it to user space. The pipe bounds how much data is in flight
+ * between the two sockets.
+ */
+class SplicePipe : NonCopyable {
+public:
+  ~SplicePipe();
+
+  /**
+   * @param capacity supplies the number of bytes the pipe should be able to hold, or zero for the
+   *        default size of a pipe. The kernel rounds it up to a power of two pages, and the
+   *        default size is kept if it refuses to resize the pipe.
+   * @return the pipe, or nullptr if the platform does not support splicing.
+   */
+  static SplicePipePtr create(uint32_t capacity);
+
+  /**
+   * Moves as much data from a socket into the pipe as it has room for.
+   * @return the result of the system call, which returns zero at the end of the stream.
+   */
+  Api::SysCallSizeResult fill(os_fd_t fd);
+
+  /**
+   * Moves data from the pipe to a socket, until the pipe is empty or the socket would block.
+   * @return the result of the last system call, or the total number of bytes moved if any.
+   */
+  Api::SysCallSizeResult drain(os_fd_t fd);
+
+  /**
+   * @return the number of bytes in the pipe.
+   */
+  uint64_t length() const { return length_; }
+
+  /**
+   * @return the number of bytes the pipe can hold.
+   */
+  uint64_t capacity() const { return capacity_; }
+
+private:
+  SplicePipe(int read_fd, int write_fd, uint64_t capacity)
+      : read_fd_(read_fd), write_fd_(write_fd), capacity_(capacity) {}
+
+  const int read_fd_;
+  const int write_fd_;
+  const uint64_t capacity_;
+  uint64_t length_{0};
+};
+
+} // namespace Network
+} // namespace Envoy
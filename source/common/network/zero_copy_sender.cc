@@ -0,0 +1,203 @@
+#include "common/network/zero_copy_sender.h"
+
+#include "envoy/common/callback.h"
+#include "envoy/event/file_event.h"
+#include "envoy/event/timer.h"
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/assert.h"
+#include "common/common/utility.h"
+
+#include "absl/container/fixed_array.h"
+
+#if defined(__linux__)
+#include <linux/errqueue.h>
+#endif
+
+namespace Envoy {
+namespace Network {
+
+namespace {
+
+// Upper bound on the number of slices handed to the kernel by a single send.
+constexpr uint64_t MaxSlices = 16;
+
+// Resets the connection, which discards the data still queued on the socket, and closes it.
+void abortiveClose(os_fd_t fd) {
+  auto& os_sys_calls = Api::OsSysCallsSingleton::get();
+  const struct linger linger = {1, 0};
+  os_sys_calls.setsockopt(fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+  os_sys_calls.close(fd);
+}
+
+/**
+ * A closed socket waiting for the completions of its zero copy sends.
+ */
+class LingeringSocket : Logger::Loggable<Logger::Id::io> {
+public:
+  LingeringSocket(Event::Dispatcher& dispatcher, os_fd_t fd, ZeroCopySenderPtr sender)
+      : fd_(fd), sender_(std::move(sender)) {
+    // Completions are signalled as errors, which wake up readers. The trigger is edge so that
+    // data received in the meantime is not reported over and over again.
+    file_event_ = dispatcher.createFileEvent(
+        fd_, [this](uint32_t) { onEvent(); }, Event::FileTriggerType::Edge,
+        Event::FileReadyType::Read);
+    timer_ = dispatcher.createTimer([this]() {
+      ENVOY_LOG(debug, "zero copy sends of closed socket fd={} did not complete in time", fd_);
+      sender_->config()->stats_.close_timeouts_.inc();
+      abortiveClose(fd_);
+      delete this;
+    });
+    timer_->enableTimer(sender_->config()->close_timeout_);
+    // The file event and timer die with the dispatcher, so the socket is reset rather than left
+    // open for good.
+    dispatcher_destroy_cb_ = dispatcher.addOnDestroyCallback([this]() {
+      ENVOY_LOG(debug, "dispatcher destroyed before zero copy sends of fd={} completed", fd_);
+      abortiveClose(fd_);
+      delete this;
+    });
+  }
+
+  ~LingeringSocket() { dispatcher_destroy_cb_->remove(); }
+
+private:
+  void onEvent() {
+    sender_->reapCompletions(fd_);
+    if (sender_->idle()) {
+      Api::OsSysCallsSingleton::get().close(fd_);
+      delete this;
+    }
+  }
+
+  const os_fd_t fd_;
+  const ZeroCopySenderPtr sender_;
+  Event::FileEventPtr file_event_;
+  Event::TimerPtr timer_;
+  Common::CallbackHandle* dispatcher_destroy_cb_{};
+};
+
+} // namespace
+
+ZeroCopyConfig::ZeroCopyConfig(uint64_t min_write_size, std::chrono::milliseconds close_timeout,
+                               Stats::Scope& scope, TimeSource& time_source)
+    : min_write_size_(min_write_size), close_timeout_(close_timeout),
+      stats_({ALL_ZERO_COPY_STATS(POOL_COUNTER_PREFIX(scope, "zero_copy."),
+                                  POOL_HISTOGRAM_PREFIX(scope, "zero_copy."))}),
+      time_source_(time_source) {}
+
+bool ZeroCopySender::enable(os_fd_t fd) {
+#if defined(__linux__) && defined(SO_ZEROCOPY)
+  const int enable = 1;
+  return Api::OsSysCallsSingleton::get()
+             .setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable))
+             .rc_ == 0;
+#else
+  UNREFERENCED_PARAMETER(fd);
+  return false;
+#endif
+}
+
+Api::SysCallSizeResult ZeroCopySender::send(os_fd_t fd, Buffer::Instance& buffer) {
+#if defined(__linux__) && defined(SO_ZEROCOPY)
+  const Buffer::RawSliceVector slices = buffer.getRawSlices(MaxSlices);
+  absl::FixedArray<iovec> iov(slices.size());
+  for (uint64_t i = 0; i < slices.size(); i++) {
+    iov[i].iov_base = slices[i].mem_;
+    iov[i].iov_len = slices[i].len_;
+  }
+  msghdr message{};
+  message.msg_iov = iov.begin();
+  message.msg_iovlen = iov.size();
+
+  auto& os_sys_calls = Api::OsSysCallsSingleton::get();
+  Api::SysCallSizeResult result = os_sys_calls.sendmsg(fd, &message, MSG_ZEROCOPY);
+  if (result.rc_ < 0 && result.errno_ == ENOBUFS) {
+    // The option memory of the socket, which holds the notifications, is exhausted.
+    config_->stats_.fallback_copies_.inc();
+    result = os_sys_calls.sendmsg(fd, &message, 0);
+    if (result.rc_ > 0) {
+      buffer.drain(result.rc_);
+    }
+    return result;
+  }
+  if (result.rc_ > 0) {
+    pending_.push_back(PendingSend{next_id_++, buffer.drainRetaining(result.rc_),
+                                   config_->time_source_.monotonicTime()});
+    config_->stats_.bytes_.add(result.rc_);
+  }
+  return result;
+#else
+  UNREFERENCED_PARAMETER(fd);
+  UNREFERENCED_PARAMETER(buffer);
+  NOT_REACHED_GCOVR_EXCL_LINE;
+#endif
+}
+
+void ZeroCopySender::reapCompletions(os_fd_t fd) {
+#if defined(__linux__) && defined(SO_ZEROCOPY)
+  auto& os_sys_calls = Api::OsSysCallsSingleton::get();
+  while (!pending_.empty()) {
+    // Room for the error and the address of its originator, which is unused for completions.
+    char control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+    msghdr message{};
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    if (os_sys_calls.recvmsg(fd, &message, MSG_ERRQUEUE).rc_ < 0) {
+      // EAGAIN once the error queue is empty.
+      return;
+    }
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&message, cmsg)) {
+      if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+          !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+        continue;
+      }
+      const auto* error = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+      if (error->ee_errno != 0 || error->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+      // A completion covers a range of consecutive sends, which the kernel merges.
+      onCompletion(error->ee_info, error->ee_data,
+                   (error->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0);
+    }
+  }
+#else
+  UNREFERENCED_PARAMETER(fd);
+#endif
+}
+
+void ZeroCopySender::onCompletion(uint32_t first, uint32_t last, bool copied) {
+  if (copied) {
+    // The device could not transmit from the memory directly, e.g. on loopback, and the kernel
+    // copied the data after all.
+    config_->stats_.fallback_copies_.inc();
+  }
+  const MonotonicTime now = config_->time_source_.monotonicTime();
+  // Completions normally arrive in order, but the ids may wrap around.
+  for (auto it = pending_.begin(); it != pending_.end();) {
+    if (static_cast<uint32_t>(it->id_ - first) <= static_cast<uint32_t>(last - first)) {
+      config_->stats_.completion_latency_.recordValue(
+          std::chrono::duration_cast<std::chrono::microseconds>(now - it->sent_at_).count());
+      it = pending_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ZeroCopySender::closeAfterCompletions(os_fd_t fd, ZeroCopySenderPtr sender) {
+  sender->reapCompletions(fd);
+  if (sender->idle()) {
+    Api::OsSysCallsSingleton::get().close(fd);
+  } else if (sender->dispatcher_ == nullptr) {
+    // There is no event loop to wait on, so the data is discarded instead.
+    abortiveClose(fd);
+  } else {
+    Event::Dispatcher& dispatcher = *sender->dispatcher_;
+    // Deletes itself once done.
+    new LingeringSocket(dispatcher, fd, std::move(sender));
+  }
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include "envoy/api/os_sys_calls.h"
+#include "envoy/buffer/buffer.h"
+#include "envoy/common/platform.h"
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * All zero copy send stats. @see stats_macros.h
+ */
+#define ALL_ZERO_COPY_STATS(COUNTER, HISTOGRAM)                                                    \
+  COUNTER(bytes)                                                                                   \
+  COUNTER(close_timeouts)                                                                          \
+  COUNTER(fallback_copies)                                                                         \
+  HISTOGRAM(completion_latency, Microseconds)
+
+/**
+ * Struct definition for all zero copy send stats. @see stats_macros.h
+ */
+struct ZeroCopyStats {
+  ALL_ZERO_COPY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * Configuration of zero copy sends, shared by every socket that uses them.
+ */
+struct ZeroCopyConfig {
+  ZeroCopyConfig(uint64_t min_write_size, std::chrono::milliseconds close_timeout,
+                 Stats::Scope& scope, TimeSource& time_source);
+
+  // Writes of fewer bytes are copied, as pinning the memory and reaping the completion costs more
+  // than copying small amounts of data.
+  const uint64_t min_write_size_;
+  // How long a closed socket is kept open waiting for the completions of its sends before it is
+  // reset.
+  const std::chrono::milliseconds close_timeout_;
+  ZeroCopyStats stats_;
+  TimeSource& time_source_;
+};
+
+using ZeroCopyConfigSharedPtr = std::shared_ptr<const ZeroCopyConfig>;
+
+/**
+ * Sends data from a buffer on a stream socket with MSG_ZEROCOPY. The kernel transmits directly
+ * from the memory of the buffer, so the written data is drained with
+ * Buffer::Instance::drainRetaining() and its memory is held until the kernel reports on the error
+ * queue of the socket that it no longer references it. Completions are reaped by the following
+ * sends, by the file events of the socket, which the kernel wakes up when it queues a completion,
+ * and by closeAfterCompletions() once the socket is closed.
+ *
+ * A sender must only be used from the thread owning the socket.
+ */
+class ZeroCopySender : Logger::Loggable<Logger::Id::io> {
+public:
+  explicit ZeroCopySender(ZeroCopyConfigSharedPtr config) : config_(std::move(config)) {}
+
+  /**
+   * Enables zero copy sends on a socket.
+   * @return whether the socket supports them.
+   */
+  static bool enable(os_fd_t fd);
+
+  const ZeroCopyConfigSharedPtr& config() const { return config_; }
+
+  /**
+   * Records the dispatcher of the thread owning the socket, which is used to wait for the
+   * outstanding completions once the socket is closed.
+   */
+  void setDispatcher(Event::Dispatcher& dispatcher) { dispatcher_ = &dispatcher; }
+
+  /**
+   * Sends as much of the buffer as possible and drains what was sent. If the kernel is short of
+   * memory to track the send, the data is copied instead.
+   * @return the result of the system call.
+   */
+  Api::SysCallSizeResult send(os_fd_t fd, Buffer::Instance& buffer);
+
+  /**
+   * Releases the data of every send the kernel has reported completion of.
+   */
+  void reapCompletions(os_fd_t fd);
+
+  /**
+   * @return whether there are no sends waiting for their completion.
+   */
+  bool idle() const { return pending_.empty(); }
+
+  /**
+   * Takes over a socket being closed while sends are waiting for their completion. The socket is
+   * kept open until they have all completed, or is reset if that takes longer than the close
+   * timeout or the dispatcher is destroyed first, so that the data is never released while the
+   * kernel may still transmit it.
+   */
+  static void closeAfterCompletions(os_fd_t fd, std::unique_ptr<ZeroCopySender> sender);
+
+private:
+  struct PendingSend {
+    uint32_t id_;
+    Buffer::RetainedDataPtr data_;
+    MonotonicTime sent_at_;
+  };
+
+  void onCompletion(uint32_t first, uint32_t last, bool copied);
+
+  const ZeroCopyConfigSharedPtr config_;
+  Event::Dispatcher* dispatcher_{};
+  // The kernel numbers the sends of a socket that transmitted data, starting at zero.
+  uint32_t next_id_{0};
+  std::deque<PendingSend> pending_;
+};
+
+using ZeroCopySenderPtr = std::unique_ptr<ZeroCopySender>;
+
+} // namespace Network
+} // namespace Envoy
@@ -48,6 +48,8 @@ namespace Router {
 namespace {
 
 const std::string DEPRECATED_ROUTER_NAME = "envoy.router";
+// Virtual hosts with at least this many routes get a RouteMatchIndex. Zero disables the index.
+const std::string ROUTE_MATCH_INDEX_MIN_ROUTES = "router.route_match_index_min_routes";
 
 } // namespace
 
@@ -1065,7 +1067,7 @@ RouteConstSharedPtr ConnectRouteEntryImpl::matches(const Http::RequestHeaderMap&
 }
 
 VirtualHostImpl::VirtualHostImpl(const envoy::config::route::v3::VirtualHost& virtual_host,
-                                 const ConfigImpl& global_route_config,
+                                 const CommonConfigSharedPtr& global_route_config,
                                  Server::Configuration::ServerFactoryContext& factory_context,
                                  Stats::Scope& scope, ProtobufMessage::ValidationVisitor& validator,
                                  bool validate_clusters)
@@ -1108,6 +1110,13 @@ VirtualHostImpl::VirtualHostImpl(const envoy::config::route::v3::VirtualHost& vi
     hedge_policy_ = virtual_host.hedge_policy();
   }
 
+  const uint64_t route_match_index_min_routes =
+      factory_context.runtime().snapshot().getInteger(ROUTE_MATCH_INDEX_MIN_ROUTES, 0);
+  if (route_match_index_min_routes > 0 &&
+      static_cast<uint64_t>(virtual_host.routes_size()) >= route_match_index_min_routes) {
+    route_match_index_ = std::make_unique<RouteMatchIndex>();
+  }
+
   for (const auto& route : virtual_host.routes()) {
     switch (route.match().path_specifier_case()) {
     case envoy::config::route::v3::RouteMatch::PathSpecifierCase::kPrefix: {
@@ -1131,6 +1140,10 @@ VirtualHostImpl::VirtualHostImpl(const envoy::config::route::v3::VirtualHost& vi
       NOT_REACHED_GCOVR_EXCL_LINE;
     }
 
+    if (route_match_index_ != nullptr) {
+      addToRouteMatchIndex(route, routes_.size() - 1);
+    }
+
     if (validate_clusters) {
       routes_.back()->validateClusters(factory_context.clusterManager());
       for (const auto& shadow_policy : routes_.back()->shadowPolicies()) {
@@ -1143,6 +1156,10 @@ VirtualHostImpl::VirtualHostImpl(const envoy::config::route::v3::VirtualHost& vi
     }
   }
 
+  if (route_match_index_ != nullptr) {
+    route_match_index_->finalize();
+  }
+
   for (const auto& virtual_cluster : virtual_host.virtual_clusters()) {
     virtual_clusters_.push_back(
         VirtualClusterEntry(virtual_cluster, stat_name_pool_, *vcluster_scope_));
@@ -1184,7 +1201,7 @@ VirtualHostImpl::VirtualClusterEntry::VirtualClusterEntry(
   }
 }
 
-const Config& VirtualHostImpl::routeConfig() const { return global_route_config_; }
+const CommonConfig& VirtualHostImpl::routeConfig() const { return *global_route_config_; }
 
 const RouteSpecificFilterConfig* VirtualHostImpl::perFilterConfig(const std::string& name) const {
   return per_filter_configs_.get(name);
@@ -1213,14 +1230,35 @@ const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(
 }
 
 RouteMatcher::RouteMatcher(const envoy::config::route::v3::RouteConfiguration& route_config,
-                           const ConfigImpl& global_route_config,
+                           const CommonConfigSharedPtr& global_route_config,
                            Server::Configuration::ServerFactoryContext& factory_context,
-                           ProtobufMessage::ValidationVisitor& validator, bool validate_clusters)
+                           ProtobufMessage::ValidationVisitor& validator, bool validate_clusters,
+                           const RouteMatcher* previous_matcher, bool track_virtual_hosts)
     : vhost_scope_(factory_context.scope().createScope("vhost")) {
   for (const auto& virtual_host_config : route_config.virtual_hosts()) {
-    VirtualHostSharedPtr virtual_host(new VirtualHostImpl(virtual_host_config, global_route_config,
-                                                          factory_context, *vhost_scope_, validator,
-                                                          validate_clusters));
+    VirtualHostSharedPtr virtual_host;
+    if (track_virtual_hosts) {
+      const uint64_t hash = MessageUtil::hash(virtual_host_config);
+      if (previous_matcher != nullptr) {
+        auto it = previous_matcher->virtual_hosts_by_hash_.find(hash);
+        if (it != previous_matcher->virtual_hosts_by_hash_.end()) {
+          virtual_host = it->second;
+          virtual_hosts_reused_++;
+        }
+      }
+      if (virtual_host == nullptr) {
+        virtual_host = std::make_shared<VirtualHostImpl>(virtual_host_config, global_route_config,
+                                                         factory_context, *vhost_scope_, validator,
+                                                         validate_clusters);
+        virtual_hosts_built_++;
+      }
+      virtual_hosts_by_hash_.emplace(hash, virtual_host);
+    } else {
+      virtual_host = std::make_shared<VirtualHostImpl>(virtual_host_config, global_route_config,
+                                                       factory_context, *vhost_scope_, validator,
+                                                       validate_clusters);
+      virtual_hosts_built_++;
+    }
     for (const std::string& domain_name : virtual_host_config.domains()) {
       const std::string domain = Http::LowerCaseString(domain_name).get();
       bool duplicate_found = false;
@@ -1270,38 +1308,91 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const RouteCallback& cb
     return SSL_REDIRECT_ROUTE;
   }
 
-  // Check for a route that matches the request.
-  for (auto route = routes_.begin(); route != routes_.end(); ++route) {
-    if (!headers.Path() && !(*route)->supportsPathlessHeaders()) {
-      continue;
+  RouteConstSharedPtr result;
+  if (route_match_index_ != nullptr && headers.Path() != nullptr) {
+    // Only evaluate the routes whose path specifier can match. Candidates are returned in route
+    // order so the first matching route still wins.
+    std::vector<uint32_t> candidates;
+    route_match_index_->findCandidates(headers.getPathValue(), candidates);
+    for (const uint32_t route_index : candidates) {
+      if (evaluateRoute(route_index, cb, headers, stream_info, random_value, result)) {
+        return result;
+      }
     }
+    return nullptr;
+  }
 
-    RouteConstSharedPtr route_entry = (*route)->matches(headers, stream_info, random_value);
-    if (nullptr == route_entry) {
+  // Check for a route that matches the request.
+  for (uint32_t route_index = 0; route_index < routes_.size(); ++route_index) {
+    if (!headers.Path() && !routes_[route_index]->supportsPathlessHeaders()) {
       continue;
     }
 
-    if (cb) {
-      RouteEvalStatus eval_status = (std::next(route) == routes_.end())
-                                        ? RouteEvalStatus::NoMoreRoutes
-                                        : RouteEvalStatus::HasMoreRoutes;
-      RouteMatchStatus match_status = cb(route_entry, eval_status);
-      if (match_status == RouteMatchStatus::Accept) {
-        return route_entry;
-      }
-      if (match_status == RouteMatchStatus::Continue &&
-          eval_status == RouteEvalStatus::NoMoreRoutes) {
-        return nullptr;
-      }
-      continue;
+    if (evaluateRoute(route_index, cb, headers, stream_info, random_value, result)) {
+      return result;
     }
-
-    return route_entry;
   }
 
   return nullptr;
 }
 
+bool VirtualHostImpl::evaluateRoute(uint32_t route_index, const RouteCallback& cb,
+                                    const Http::RequestHeaderMap& headers,
+                                    const StreamInfo::StreamInfo& stream_info,
+                                    uint64_t random_value, RouteConstSharedPtr& result) const {
+  RouteConstSharedPtr route_entry =
+      routes_[route_index]->matches(headers, stream_info, random_value);
+  if (nullptr == route_entry) {
+    return false;
+  }
+
+  if (cb) {
+    RouteEvalStatus eval_status = (route_index + 1 == routes_.size())
+                                      ? RouteEvalStatus::NoMoreRoutes
+                                      : RouteEvalStatus::HasMoreRoutes;
+    RouteMatchStatus match_status = cb(route_entry, eval_status);
+    if (match_status == RouteMatchStatus::Accept) {
+      result = std::move(route_entry);
+      return true;
+    }
+    if (match_status == RouteMatchStatus::Continue &&
+        eval_status == RouteEvalStatus::NoMoreRoutes) {
+      result = nullptr;
+      return true;
+    }
+    return false;
+  }
+
+  result = std::move(route_entry);
+  return true;
+}
+
+void VirtualHostImpl::addToRouteMatchIndex(const envoy::config::route::v3::Route& route,
+                                           uint32_t route_index) {
+  const bool case_sensitive = PROTOBUF_GET_WRAPPED_OR_DEFAULT(route.match(), case_sensitive, true);
+  switch (route.match().path_specifier_case()) {
+  case envoy::config::route::v3::RouteMatch::PathSpecifierCase::kPrefix:
+    if (case_sensitive) {
+      route_match_index_->addPrefix(route_index, route.match().prefix());
+      return;
+    }
+    break;
+  case envoy::config::route::v3::RouteMatch::PathSpecifierCase::kPath:
+    if (case_sensitive) {
+      route_match_index_->addExact(route_index, route.match().path());
+      return;
+    }
+    break;
+  case envoy::config::route::v3::RouteMatch::PathSpecifierCase::kSafeRegex:
+    // Safe regexes are always RE2 and matched against the whole path, like an anchored RE2::Set.
+    route_match_index_->addRegex(route_index, route.match().safe_regex().regex());
+    return;
+  default:
+    break;
+  }
+  route_match_index_->addUnindexed(route_index);
+}
+
 const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::RequestHeaderMap& headers) const {
   // Fast path the case where we only have a default virtual host.
   if (virtual_hosts_.empty() && wildcard_virtual_host_suffixes_.empty() &&
@@ -1373,25 +1464,59 @@ VirtualHostImpl::virtualClusterFromEntries(const Http::HeaderMap& headers) const
   return nullptr;
 }
 
+CommonConfigImpl::CommonConfigImpl(const envoy::config::route::v3::RouteConfiguration& config)
+    : request_headers_parser_(HeaderParser::configure(config.request_headers_to_add(),
+                                                      config.request_headers_to_remove())),
+      response_headers_parser_(HeaderParser::configure(config.response_headers_to_add(),
+                                                       config.response_headers_to_remove())),
+      name_(config.name()), uses_vhds_(config.has_vhds()),
+      most_specific_header_mutations_wins_(config.most_specific_header_mutations_wins()),
+      config_hash_(hash(config)) {
+  for (const std::string& header : config.internal_only_headers()) {
+    internal_only_headers_.push_back(Http::LowerCaseString(header));
+  }
+}
+
+uint64_t CommonConfigImpl::hash(const envoy::config::route::v3::RouteConfiguration& config) {
+  // Only copy the fields consumed above; the virtual hosts may be very large.
+  envoy::config::route::v3::RouteConfiguration common;
+  common.set_name(config.name());
+  *common.mutable_internal_only_headers() = config.internal_only_headers();
+  *common.mutable_request_headers_to_add() = config.request_headers_to_add();
+  *common.mutable_request_headers_to_remove() = config.request_headers_to_remove();
+  *common.mutable_response_headers_to_add() = config.response_headers_to_add();
+  *common.mutable_response_headers_to_remove() = config.response_headers_to_remove();
+  common.set_most_specific_header_mutations_wins(config.most_specific_header_mutations_wins());
+  if (config.has_vhds()) {
+    *common.mutable_vhds() = config.vhds();
+  }
+  return MessageUtil::hash(common);
+}
+
 ConfigImpl::ConfigImpl(const envoy::config::route::v3::RouteConfiguration& config,
                        Server::Configuration::ServerFactoryContext& factory_context,
                        ProtobufMessage::ValidationVisitor& validator,
-                       bool validate_clusters_default)
-    : name_(config.name()), symbol_table_(factory_context.scope().symbolTable()),
-      uses_vhds_(config.has_vhds()),
-      most_specific_header_mutations_wins_(config.most_specific_header_mutations_wins()) {
-  route_matcher_ = std::make_unique<RouteMatcher>(
-      config, *this, factory_context, validator,
-      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default));
-
-  for (const std::string& header : config.internal_only_headers()) {
-    internal_only_headers_.push_back(Http::LowerCaseString(header));
+                       bool validate_clusters_default, bool reuse_virtual_hosts,
+                       const ConfigImpl* previous_config) {
+  const bool validate_clusters =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default);
+  // Reused virtual hosts were validated against the clusters that existed when they were built.
+  reuse_virtual_hosts = reuse_virtual_hosts && !validate_clusters;
+
+  // Virtual hosts refer to the common configuration, so they can only be carried over if it is
+  // unchanged, in which case it is carried over as well.
+  const RouteMatcher* previous_matcher = nullptr;
+  if (reuse_virtual_hosts && previous_config != nullptr &&
+      previous_config->shared_config_->configHash() == CommonConfigImpl::hash(config)) {
+    shared_config_ = previous_config->shared_config_;
+    previous_matcher = previous_config->route_matcher_.get();
+  } else {
+    shared_config_ = std::make_shared<CommonConfigImpl>(config);
   }
 
-  request_headers_parser_ =
-      HeaderParser::configure(config.request_headers_to_add(), config.request_headers_to_remove());
-  response_headers_parser_ = HeaderParser::configure(config.response_headers_to_add(),
-                                                     config.response_headers_to_remove());
+  route_matcher_ =
+      std::make_unique<RouteMatcher>(config, shared_config_, factory_context, validator,
+                                     validate_clusters, previous_matcher, reuse_virtual_hosts);
 }
 
 RouteConstSharedPtr ConfigImpl::route(const RouteCallback& cb,
@@ -27,10 +27,12 @@
 #include "common/router/header_formatter.h"
 #include "common/router/header_parser.h"
 #include "common/router/metadatamatchcriteria_impl.h"
+#include "common/router/route_match_index.h"
 #include "common/router/router_ratelimit.h"
 #include "common/router/tls_context_match_criteria_impl.h"
 #include "common/stats/symbol_table_impl.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/types/optional.h"
 
@@ -153,14 +155,54 @@ private:
   const bool legacy_enabled_;
 };
 
-class ConfigImpl;
+/**
+ * The parts of a route configuration which are not specific to a virtual host. These are owned
+ * jointly by the ConfigImpl and its virtual hosts, so that virtual hosts can be carried over into
+ * a new version of the configuration when this part is unchanged.
+ */
+class CommonConfigImpl : public CommonConfig {
+public:
+  explicit CommonConfigImpl(const envoy::config::route::v3::RouteConfiguration& config);
+
+  /**
+   * @return uint64_t a hash of the parts of the supplied route configuration which are consumed by
+   *         CommonConfigImpl.
+   */
+  static uint64_t hash(const envoy::config::route::v3::RouteConfiguration& config);
+
+  const HeaderParser& requestHeaderParser() const { return *request_headers_parser_; };
+  const HeaderParser& responseHeaderParser() const { return *response_headers_parser_; };
+  uint64_t configHash() const { return config_hash_; }
+
+  // Router::CommonConfig
+  const std::list<Http::LowerCaseString>& internalOnlyHeaders() const override {
+    return internal_only_headers_;
+  }
+  const std::string& name() const override { return name_; }
+  bool usesVhds() const override { return uses_vhds_; }
+  bool mostSpecificHeaderMutationsWins() const override {
+    return most_specific_header_mutations_wins_;
+  }
+
+private:
+  std::list<Http::LowerCaseString> internal_only_headers_;
+  HeaderParserPtr request_headers_parser_;
+  HeaderParserPtr response_headers_parser_;
+  const std::string name_;
+  const bool uses_vhds_;
+  const bool most_specific_header_mutations_wins_;
+  const uint64_t config_hash_;
+};
+
+using CommonConfigSharedPtr = std::shared_ptr<const CommonConfigImpl>;
+
 /**
  * Holds all routing configuration for an entire virtual host.
  */
 class VirtualHostImpl : public VirtualHost {
 public:
   VirtualHostImpl(const envoy::config::route::v3::VirtualHost& virtual_host,
-                  const ConfigImpl& global_route_config,
+                  const CommonConfigSharedPtr& global_route_config,
                   Server::Configuration::ServerFactoryContext& factory_context, Stats::Scope& scope,
                   ProtobufMessage::ValidationVisitor& validator, bool validate_clusters);
 
@@ -169,7 +211,7 @@ public:
                                           const StreamInfo::StreamInfo& stream_info,
                                           uint64_t random_value) const;
   const VirtualCluster* virtualClusterFromEntries(const Http::HeaderMap& headers) const;
-  const ConfigImpl& globalRouteConfig() const { return global_route_config_; }
+  const CommonConfigImpl& globalRouteConfig() const { return *global_route_config_; }
   const HeaderParser& requestHeaderParser() const { return *request_headers_parser_; }
   const HeaderParser& responseHeaderParser() const { return *response_headers_parser_; }
 
@@ -177,7 +219,7 @@ public:
   const CorsPolicy* corsPolicy() const override { return cors_policy_.get(); }
   Stats::StatName statName() const override { return stat_name_; }
   const RateLimitPolicy& rateLimitPolicy() const override { return rate_limit_policy_; }
-  const Config& routeConfig() const override;
+  const CommonConfig& routeConfig() const override;
   const RouteSpecificFilterConfig* perFilterConfig(const std::string&) const override;
   bool includeAttemptCountInRequest() const override { return include_attempt_count_in_request_; }
   bool includeAttemptCountInResponse() const override { return include_attempt_count_in_response_; }
@@ -192,6 +234,14 @@ public:
 private:
   enum class SslRequirements { None, ExternalOnly, All };
 
+  void addToRouteMatchIndex(const envoy::config::route::v3::Route& route, uint32_t route_index);
+  // Evaluates the route at route_index. Returns true if route selection is complete, in which case
+  // result holds the selected route (or nullptr if no route was accepted).
+  bool evaluateRoute(uint32_t route_index, const RouteCallback& cb,
+                     const Http::RequestHeaderMap& headers,
+                     const StreamInfo::StreamInfo& stream_info, uint64_t random_value,
+                     RouteConstSharedPtr& result) const;
+
   struct VirtualClusterBase : public VirtualCluster {
   public:
     VirtualClusterBase(Stats::StatName stat_name, Stats::ScopePtr&& scope)
@@ -225,12 +275,13 @@ private:
   const Stats::StatName stat_name_;
   Stats::ScopePtr vcluster_scope_;
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  // Optional path index over routes_, see RouteMatchIndex.
+  RouteMatchIndexPtr route_match_index_;
   std::vector<VirtualClusterEntry> virtual_clusters_;
   SslRequirements ssl_requirements_;
   const RateLimitPolicyImpl rate_limit_policy_;
   std::unique_ptr<const CorsPolicyImpl> cors_policy_;
-  const ConfigImpl& global_route_config_; // See note in RouteEntryImplBase::clusterEntry() on why
-                                          // raw ref to the top level config is currently safe.
+  const CommonConfigSharedPtr global_route_config_;
   HeaderParserPtr request_headers_parser_;
   HeaderParserPtr response_headers_parser_;
   PerFilterConfigs per_filter_configs_;
@@ -915,16 +966,27 @@ public:
  */
 class RouteMatcher {
 public:
+  /**
+   * @param previous_matcher supplies the matcher of the route configuration being replaced, if
+   *        any. Virtual hosts whose proto is unchanged are shared with it rather than rebuilt.
+   *        Only consulted when track_virtual_hosts is set.
+   * @param track_virtual_hosts supplies whether to retain the hash of each virtual host so that
+   *        a later version of the route configuration can reuse them.
+   */
   RouteMatcher(const envoy::config::route::v3::RouteConfiguration& config,
-               const ConfigImpl& global_http_config,
+               const CommonConfigSharedPtr& global_route_config,
                Server::Configuration::ServerFactoryContext& factory_context,
-               ProtobufMessage::ValidationVisitor& validator, bool validate_clusters);
+               ProtobufMessage::ValidationVisitor& validator, bool validate_clusters,
+               const RouteMatcher* previous_matcher, bool track_virtual_hosts);
 
   RouteConstSharedPtr route(const RouteCallback& cb, const Http::RequestHeaderMap& headers,
                             const StreamInfo::StreamInfo& stream_info, uint64_t random_value) const;
 
   const VirtualHostImpl* findVirtualHost(const Http::RequestHeaderMap& headers) const;
 
+  uint32_t virtualHostsReused() const { return virtual_hosts_reused_; }
+  uint32_t virtualHostsBuilt() const { return virtual_hosts_built_; }
+
 private:
   using WildcardVirtualHosts =
       std::map<int64_t, absl::node_hash_map<std::string, VirtualHostSharedPtr>, std::greater<>>;
@@ -948,6 +1010,11 @@ private:
   WildcardVirtualHosts wildcard_virtual_host_prefixes_;
 
   VirtualHostSharedPtr default_virtual_host_;
+
+  // Virtual hosts keyed by the hash of their proto. Only populated when tracking is enabled.
+  absl::flat_hash_map<uint64_t, VirtualHostSharedPtr> virtual_hosts_by_hash_;
+  uint32_t virtual_hosts_reused_{};
+  uint32_t virtual_hosts_built_{};
 };
 
 /**
@@ -955,17 +1022,38 @@ private:
  */
 class ConfigImpl : public Config {
 public:
+  /**
+   * @param reuse_virtual_hosts supplies whether virtual hosts may be shared between versions of
+   *        the route configuration. This is only honored when clusters are not validated, as a
+   *        reused virtual host is not checked against the current set of clusters.
+   * @param previous_config supplies the configuration being replaced, if any. When both it and
+   *        this configuration allow reuse and their common configuration is identical, unchanged
+   *        virtual hosts are taken from it rather than rebuilt.
+   */
   ConfigImpl(const envoy::config::route::v3::RouteConfiguration& config,
              Server::Configuration::ServerFactoryContext& factory_context,
-             ProtobufMessage::ValidationVisitor& validator, bool validate_clusters_default);
+             ProtobufMessage::ValidationVisitor& validator, bool validate_clusters_default,
+             bool reuse_virtual_hosts = false, const ConfigImpl* previous_config = nullptr);
 
-  const HeaderParser& requestHeaderParser() const { return *request_headers_parser_; };
-  const HeaderParser& responseHeaderParser() const { return *response_headers_parser_; };
+  const HeaderParser& requestHeaderParser() const { return shared_config_->requestHeaderParser(); };
+  const HeaderParser& responseHeaderParser() const {
+    return shared_config_->responseHeaderParser();
+  };
 
   bool virtualHostExists(const Http::RequestHeaderMap& headers) const {
     return route_matcher_->findVirtualHost(headers) != nullptr;
   }
 
+  /**
+   * @return uint32_t the number of virtual hosts taken from the previous configuration.
+   */
+  uint32_t virtualHostsReused() const { return route_matcher_->virtualHostsReused(); }
+
+  /**
+   * @return uint32_t the number of virtual hosts built from their proto.
+   */
+  uint32_t virtualHostsBuilt() const { return route_matcher_->virtualHostsBuilt(); }
+
   // Router::Config
   RouteConstSharedPtr route(const Http::RequestHeaderMap& headers,
                             const StreamInfo::StreamInfo& stream_info,
@@ -978,26 +1066,20 @@ public:
                             uint64_t random_value) const override;
 
   const std::list<Http::LowerCaseString>& internalOnlyHeaders() const override {
-    return internal_only_headers_;
+    return shared_config_->internalOnlyHeaders();
   }
 
-  const std::string& name() const override { return name_; }
+  const std::string& name() const override { return shared_config_->name(); }
 
-  bool usesVhds() const override { return uses_vhds_; }
+  bool usesVhds() const override { return shared_config_->usesVhds(); }
 
   bool mostSpecificHeaderMutationsWins() const override {
-    return most_specific_header_mutations_wins_;
+    return shared_config_->mostSpecificHeaderMutationsWins();
   }
 
 private:
+  CommonConfigSharedPtr shared_config_;
   std::unique_ptr<RouteMatcher> route_matcher_;
-  std::list<Http::LowerCaseString> internal_only_headers_;
-  HeaderParserPtr request_headers_parser_;
-  HeaderParserPtr response_headers_parser_;
-  const std::string name_;
-  Stats::SymbolTable& symbol_table_;
-  const bool uses_vhds_;
-  const bool most_specific_header_mutations_wins_;
 };
 
 /**
@@ -19,6 +19,7 @@
 #include "common/http/header_map_impl.h"
 #include "common/protobuf/utility.h"
 #include "common/router/config_impl.h"
+#include "common/runtime/runtime_features.h"
 
 namespace Envoy {
 namespace Router {
@@ -80,7 +81,8 @@ RdsRouteConfigSubscription::RdsRouteConfigSubscription(
           fmt::format("RdsRouteConfigSubscription local-init-target {}", route_config_name_),
           [this]() { subscription_->start({route_config_name_}); }),
       local_init_manager_(fmt::format("RDS local-init-manager {}", route_config_name_)),
-      stat_prefix_(stat_prefix), stats_({ALL_RDS_STATS(POOL_COUNTER(*scope_))}),
+      stat_prefix_(stat_prefix),
+      stats_({ALL_RDS_STATS(POOL_COUNTER(*scope_), POOL_HISTOGRAM(*scope_))}),
       route_config_provider_manager_(route_config_provider_manager),
       manager_identifier_(manager_identifier) {
   const auto resource_name = getResourceName();
@@ -230,8 +232,11 @@ RdsRouteConfigProviderImpl::RdsRouteConfigProviderImpl(
       tls_(factory_context.threadLocal().allocateSlot()) {
   ConfigConstSharedPtr initial_config;
   if (config_update_info_->configInfo().has_value()) {
-    initial_config = std::make_shared<ConfigImpl>(config_update_info_->routeConfiguration(),
-                                                  factory_context_, validator_, false);
+    auto config = std::make_shared<const ConfigImpl>(config_update_info_->routeConfiguration(),
+                                                     factory_context_, validator_, false,
+                                                     reuseVirtualHosts());
+    last_config_ = config;
+    initial_config = std::move(config);
   } else {
     initial_config = std::make_shared<NullConfigImpl>();
   }
@@ -254,8 +259,22 @@ Router::ConfigConstSharedPtr RdsRouteConfigProviderImpl::config() {
 }
 
 void RdsRouteConfigProviderImpl::onConfigUpdate() {
-  ConfigConstSharedPtr new_config(new ConfigImpl(config_update_info_->routeConfiguration(),
-                                                 factory_context_, validator_, false));
+  const MonotonicTime start_time = factory_context_.timeSource().monotonicTime();
+  // Unchanged virtual hosts are shared with the config currently in use rather than rebuilt, so
+  // the cost of an update is proportional to what changed.
+  auto new_config = std::make_shared<const ConfigImpl>(config_update_info_->routeConfiguration(),
+                                                       factory_context_, validator_, false,
+                                                       reuseVirtualHosts(),
+                                                       last_config_.lock().get());
+  last_config_ = new_config;
+  const std::chrono::milliseconds rebuild_time =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          factory_context_.timeSource().monotonicTime() - start_time);
+  RdsStats& stats = subscription_->stats();
+  stats.virtual_host_reused_.add(new_config->virtualHostsReused());
+  stats.virtual_host_rebuilt_.add(new_config->virtualHostsBuilt());
+  stats.config_rebuild_time_.recordValue(rebuild_time.count());
+
   tls_->runOnAllThreads([new_config](ThreadLocal::ThreadLocalObjectSharedPtr previous)
                             -> ThreadLocal::ThreadLocalObjectSharedPtr {
     auto prev_config = std::dynamic_pointer_cast<ThreadLocalConfig>(previous);
@@ -269,7 +288,6 @@ void RdsRouteConfigProviderImpl::onConfigUpdate() {
     return;
   }
 
-  const auto config = std::static_pointer_cast<const ConfigImpl>(new_config);
   // Notifies connections that RouteConfiguration update has been propagated.
   // Callbacks processing is performed in FIFO order. The callback is skipped if alias used in
   // the VHDS update request do not match the aliases in the update response
@@ -279,7 +297,7 @@ void RdsRouteConfigProviderImpl::onConfigUpdate() {
       // TODO(dmitri-d) HeaderMapImpl is expensive, need to profile this
       auto host_header = Http::RequestHeaderMapImpl::create();
       host_header->setHost(VhdsSubscription::aliasToDomainName(it->alias_));
-      const bool host_exists = config->virtualHostExists(*host_header);
+      const bool host_exists = new_config->virtualHostExists(*host_header);
       std::weak_ptr<Http::RouteConfigUpdatedCallback> current_cb(it->cb_);
       it->thread_local_dispatcher_.post([current_cb, host_exists] {
         if (auto cb = current_cb.lock()) {
@@ -296,7 +314,13 @@ void RdsRouteConfigProviderImpl::onConfigUpdate() {
 void RdsRouteConfigProviderImpl::validateConfig(
     const envoy::config::route::v3::RouteConfiguration& config) const {
   // TODO(lizan): consider cache the config here until onConfigUpdate.
-  ConfigImpl validation_config(config, factory_context_, validator_, false);
+  // Virtual hosts carried over from the config in use have already been validated.
+  ConfigImpl validation_config(config, factory_context_, validator_, false, reuseVirtualHosts(),
+                               last_config_.lock().get());
+}
+
+bool RdsRouteConfigProviderImpl::reuseVirtualHosts() {
+  return Runtime::runtimeFeatureEnabled("envoy.reloadable_features.rds_reuse_virtual_hosts");
 }
 
 // Schedules a VHDS request on the main thread and queues up the callback to use when the VHDS
@@ -31,6 +31,7 @@
 #include "common/init/target_impl.h"
 #include "common/init/watcher_impl.h"
 #include "common/protobuf/utility.h"
+#include "common/router/config_impl.h"
 #include "common/router/route_config_update_receiver_impl.h"
 #include "common/router/vhds.h"
 
@@ -96,15 +97,18 @@ private:
 /**
  * All RDS stats. @see stats_macros.h
  */
-#define ALL_RDS_STATS(COUNTER)                                                                     \
+#define ALL_RDS_STATS(COUNTER, HISTOGRAM)                                                          \
   COUNTER(config_reload)                                                                           \
-  COUNTER(update_empty)
+  COUNTER(update_empty)                                                                            \
+  COUNTER(virtual_host_rebuilt)                                                                    \
+  COUNTER(virtual_host_reused)                                                                     \
+  HISTOGRAM(config_rebuild_time, Milliseconds)
 
 /**
  * Struct definition for all RDS stats. @see stats_macros.h
  */
 struct RdsStats {
-  ALL_RDS_STATS(GENERATE_COUNTER_STRUCT)
+  ALL_RDS_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 class RdsRouteConfigProviderImpl;
@@ -124,6 +128,7 @@ public:
     return route_config_providers_;
   }
   RouteConfigUpdatePtr& routeConfigUpdate() { return config_update_info_; }
+  RdsStats& stats() { return stats_; }
   void updateOnDemand(const std::string& aliases);
   void maybeCreateInitManager(const std::string& version_info,
                               std::unique_ptr<Init::ManagerImpl>& init_manager,
@@ -225,6 +230,12 @@ private:
   Server::Configuration::ServerFactoryContext& factory_context_;
   ProtobufMessage::ValidationVisitor& validator_;
   ThreadLocal::SlotPtr tls_;
+  // Whether configs share the unchanged virtual hosts of the config they replace.
+  static bool reuseVirtualHosts();
+
+  // The most recently built config, from which the next update takes its unchanged virtual hosts.
+  // It is owned by the thread local slot.
+  std::weak_ptr<const ConfigImpl> last_config_;
   std::list<UpdateOnDemandCallback> config_update_callbacks_;
   // A flag used to determine if this instance of RdsRouteConfigProviderImpl hasn't been
   // deallocated. Please also see a comment in requestVirtualHostsUpdate() method implementation.
@@ -0,0 +1,124 @@
+#include "common/router/route_match_index.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+#include "common/http/path_utility.h"
+
+namespace Envoy {
+namespace Router {
+
+namespace {
+constexpr uint32_t NoNode = 0;
+} // namespace
+
+RouteMatchIndex::RouteMatchIndex()
+    : prefix_trie_(1),
+      regex_set_(std::make_unique<re2::RE2::Set>(re2::RE2::Options(re2::RE2::Quiet),
+                                               re2::RE2::ANCHOR_BOTH)) {}
+
+uint32_t RouteMatchIndex::findChild(uint32_t node, uint8_t c) const {
+  const auto& children = prefix_trie_[node].children_;
+  const auto it =
+      std::lower_bound(children.begin(), children.end(), c,
+                       [](const std::pair<uint8_t, uint32_t>& child, uint8_t c) {
+                         return child.first < c;
+                       });
+  return (it != children.end() && it->first == c) ? it->second : NoNode;
+}
+
+void RouteMatchIndex::addPrefix(uint32_t route_index, absl::string_view prefix) {
+  ASSERT(!finalized_);
+  // The root is node 0, which is never a child, so NoNode doubles as "not found".
+  uint32_t node = 0;
+  for (const uint8_t c : prefix) {
+    uint32_t child = findChild(node, c);
+    if (child == NoNode) {
+      child = prefix_trie_.size();
+      auto& children = prefix_trie_[node].children_;
+      children.insert(std::lower_bound(children.begin(), children.end(),
+                                       std::make_pair(c, uint32_t(0))),
+                      {c, child});
+      // Note: this may reallocate prefix_trie_, so no references are held across it.
+      prefix_trie_.emplace_back();
+    }
+    node = child;
+  }
+  prefix_trie_[node].routes_.push_back(route_index);
+}
+
+void RouteMatchIndex::addExact(uint32_t route_index, absl::string_view path) {
+  ASSERT(!finalized_);
+  exact_paths_[std::string(path)].push_back(route_index);
+}
+
+void RouteMatchIndex::addRegex(uint32_t route_index, const std::string& regex) {
+  ASSERT(!finalized_);
+  if (regex_set_->Add(regex, nullptr) < 0) {
+    addUnindexed(route_index);
+    return;
+  }
+  regex_routes_.push_back(route_index);
+}
+
+void RouteMatchIndex::addUnindexed(uint32_t route_index) {
+  ASSERT(!finalized_);
+  unindexed_.push_back(route_index);
+}
+
+void RouteMatchIndex::finalize() {
+  ASSERT(!finalized_);
+  finalized_ = true;
+  if (regex_routes_.empty()) {
+    regex_set_.reset();
+    return;
+  }
+
+  if (!regex_set_->Compile()) {
+    // The combined program exceeded RE2's memory budget. Fall back to evaluating the regex routes
+    // individually.
+    regex_set_.reset();
+    unindexed_.insert(unindexed_.end(), regex_routes_.begin(), regex_routes_.end());
+    std::sort(unindexed_.begin(), unindexed_.end());
+    regex_routes_.clear();
+  }
+}
+
+void RouteMatchIndex::findCandidates(absl::string_view path,
+                                     std::vector<uint32_t>& candidates) const {
+  ASSERT(finalized_);
+  candidates = unindexed_;
+  path = Http::PathUtil::removeQueryAndFragment(path);
+
+  uint32_t node = 0;
+  candidates.insert(candidates.end(), prefix_trie_[node].routes_.begin(),
+                    prefix_trie_[node].routes_.end());
+  for (const uint8_t c : path) {
+    node = findChild(node, c);
+    if (node == NoNode) {
+      break;
+    }
+    candidates.insert(candidates.end(), prefix_trie_[node].routes_.begin(),
+                      prefix_trie_[node].routes_.end());
+  }
+
+  const auto exact = exact_paths_.find(path);
+  if (exact != exact_paths_.end()) {
+    candidates.insert(candidates.end(), exact->second.begin(), exact->second.end());
+  }
+
+  if (regex_set_ != nullptr) {
+    std::vector<int> matches;
+    if (regex_set_->Match(re2::StringPiece(path.data(), path.size()), &matches)) {
+      for (const int match : matches) {
+        candidates.push_back(regex_routes_[match]);
+      }
+    }
+  }
+
+  // A route is only ever registered under a single specifier, so there are no duplicates.
+  std::sort(candidates.begin(), candidates.end());
+}
+
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/non_copyable.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "re2/set.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Path based pre-filter over the ordered routes of a virtual host. Rather than evaluating every
+ * route in turn, a request is first looked up in the index which returns, in original route order,
+ * the routes whose path specifier can match the request path:
+ * - case sensitive prefix routes are stored in a trie and collected while walking the path.
+ * - case sensitive exact path routes are stored in a hash map.
+ * - safe_regex routes are compiled into a single anchored RE2::Set.
+ * - any other route (case insensitive, deprecated std::regex, CONNECT, ...) is unindexed and is
+ *   always returned as a candidate.
+ * Candidates are a superset of the matching routes; callers must still fully evaluate each one
+ * (headers, query parameters, runtime fractions, etc.) so first-match-wins semantics are unchanged.
+ */
+class RouteMatchIndex : NonCopyable {
+public:
+  RouteMatchIndex();
+
+  /**
+   * Routes must be added in ascending route_index order. After all routes have been added,
+   * finalize() must be called before findCandidates().
+   */
+  void addPrefix(uint32_t route_index, absl::string_view prefix);
+  void addExact(uint32_t route_index, absl::string_view path);
+  void addRegex(uint32_t route_index, const std::string& regex);
+  void addUnindexed(uint32_t route_index);
+  void finalize();
+
+  /**
+   * Finds the routes which may match a request path.
+   * @param path supplies the :path header value of the request, including any query string.
+   * @param candidates receives the candidate route indices in ascending order.
+   */
+  void findCandidates(absl::string_view path, std::vector<uint32_t>& candidates) const;
+
+private:
+  struct TrieNode {
+    // Sorted by character so that lookups can binary search.
+    std::vector<std::pair<uint8_t, uint32_t>> children_;
+    std::vector<uint32_t> routes_;
+  };
+
+  uint32_t findChild(uint32_t node, uint8_t c) const;
+
+  std::vector<TrieNode> prefix_trie_;
+  absl::flat_hash_map<std::string, std::vector<uint32_t>> exact_paths_;
+  std::unique_ptr<re2::RE2::Set> regex_set_;
+  // Maps RE2::Set pattern indices back to route indices.
+  std::vector<uint32_t> regex_routes_;
+  std::vector<uint32_t> unindexed_;
+  bool finalized_{};
+};
+
+using RouteMatchIndexPtr = std::unique_ptr<RouteMatchIndex>;
+
+} // namespace Router
+} // namespace Envoy
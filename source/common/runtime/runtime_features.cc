@@ -77,6 +77,7 @@ constexpr const char* runtime_features[] = {
     "envoy.reloadable_features.listener_in_place_filterchain_update",
     "envoy.reloadable_features.preserve_query_string_in_path_redirects",
     "envoy.reloadable_features.preserve_upstream_date",
+    "envoy.reloadable_features.rds_reuse_virtual_hosts",
     "envoy.reloadable_features.stop_faking_paths",
     "envoy.reloadable_features.hcm_stream_error_on_invalid_message",
     "envoy.reloadable_features.strict_1xx_and_204_response_headers",
@@ -95,6 +96,26 @@ constexpr const char* disabled_runtime_features[] = {
     "envoy.reloadable_features.new_codec_behavior",
     // TODO(alyssawilk) flip true after the release.
     "envoy.reloadable_features.new_tcp_connection_pool",
+    // TODO: flip true once the LB tests no longer pin the pick order after host updates.
+    "envoy.reloadable_features.edf_lb_incremental_refresh",
+    // TODO: flip true after lb_table_build_duration_ms is measured on large clusters.
+    "envoy.reloadable_features.background_lb_table_builds",
+    // TODO: flip true after comparing balance on clusters with slow connection setup.
+    "envoy.reloadable_features.least_request_outstanding_requests",
+    // TODO: flip true once per cluster health_check.attempt dashboards are updated.
+    "envoy.reloadable_features.health_check_probe_sharing",
+    // TODO: flip true once differential fuzzing against http_parser is clean.
+    "envoy.reloadable_features.http1_simd_parser",
+    // TODO: flip true after measuring the read slices retained by header maps.
+    "envoy.reloadable_features.http1_borrowed_header_values",
+    // TODO: flip true after the borrowed header values are enabled by default.
+    "envoy.reloadable_features.http1_raw_header_lines",
+    // TODO: flip true once frame counting tests expect one write per flush.
+    "envoy.reloadable_features.http2_batch_frame_writes",
+    // TODO: flip true after measuring memory retained by shared partial slices.
+    "envoy.reloadable_features.buffer_share_partial_slices",
+    // TODO: flip true only if HPACK literals without indexing become available from nghttp2.
+    "envoy.reloadable_features.http2_never_index_unique_header_values",
     // Sentinel and test flag.
     "envoy.reloadable_features.test_feature_false",
 };
@@ -157,11 +157,8 @@ void SymbolTableImpl::Encoding::decodeTokens(
 std::vector<absl::string_view> SymbolTableImpl::decodeStrings(const SymbolTable::Storage array,
                                                               size_t size) const {
   std::vector<absl::string_view> strings;
-  Thread::LockGuard lock(lock_);
   Encoding::decodeTokens(
-      array, size,
-      [this, &strings](Symbol symbol)
-          ABSL_NO_THREAD_SAFETY_ANALYSIS { strings.push_back(fromSymbol(symbol)); },
+      array, size, [this, &strings](Symbol symbol) { strings.push_back(fromSymbol(symbol)); },
       [&strings](absl::string_view str) { strings.push_back(str); });
   return strings;
 }
@@ -192,6 +189,12 @@ SymbolTableImpl::~SymbolTableImpl() {
   // is needed in production. But it would be good to ensure clean up during
   // tests.
   ASSERT(numSymbols() == 0);
+#ifndef NDEBUG
+  for (const DecodeShard& shard : decode_shards_) {
+    absl::ReaderMutexLock lock(&shard.mutex_);
+    ASSERT(shard.map_.empty());
+  }
+#endif
 }
 
 // TODO(ambuc): There is a possible performance optimization here for avoiding
@@ -208,18 +211,21 @@ void SymbolTableImpl::addTokensToEncoding(const absl::string_view name, Encoding
   std::vector<Symbol> symbols;
   symbols.reserve(tokens.size());
 
-  // Now take the lock and populate the Symbol objects, which involves bumping
-  // ref-counts in this.
-  {
-    Thread::LockGuard lock(lock_);
+  if (track_recent_lookups_.load(std::memory_order_relaxed)) {
+    Thread::LockGuard lock(lookup_lock_);
     recent_lookups_.lookup(name);
-    for (auto& token : tokens) {
-      // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
-      // length below some threshold, say 4 bytes. It might be preferable not to
-      // reserve Symbols for every 3 digit number found (for example) in ipv4
-      // addresses.
-      symbols.push_back(toSymbol(token));
-    }
+  } else {
+    untracked_lookups_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Now populate the Symbol objects, which involves bumping ref-counts in
+  // this. Each token only locks the shard it hashes to.
+  for (auto& token : tokens) {
+    // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
+    // length below some threshold, say 4 bytes. It might be preferable not to
+    // reserve Symbols for every 3 digit number found (for example) in ipv4
+    // addresses.
+    symbols.push_back(toSymbol(token));
   }
 
   // Now efficiently encode the array of 32-bit symbols into a uint8_t array.
@@ -227,9 +233,14 @@ void SymbolTableImpl::addTokensToEncoding(const absl::string_view name, Encoding
 }
 
 uint64_t SymbolTableImpl::numSymbols() const {
-  Thread::LockGuard lock(lock_);
-  ASSERT(encode_map_.size() == decode_map_.size());
-  return encode_map_.size();
+  // Shards are visited one at a time, so the result is only exact when no
+  // other thread is concurrently encoding or freeing names.
+  uint64_t num_symbols = 0;
+  for (const EncodeShard& shard : encode_shards_) {
+    absl::ReaderMutexLock lock(&shard.mutex_);
+    num_symbols += shard.map_.size();
+  }
+  return num_symbols;
 }
 
 std::string SymbolTableImpl::toString(const StatName& stat_name) const {
@@ -242,59 +253,87 @@ void SymbolTableImpl::callWithStringView(StatName stat_name,
 }
 
 void SymbolTableImpl::incRefCount(const StatName& stat_name) {
-  // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
+  // Before taking any locks, decode the array of symbols from the SymbolTable::Storage.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
 
-  Thread::LockGuard lock(lock_);
   for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
-
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end());
-
-    ++encode_search->second.ref_count_;
+    const absl::string_view token = fromSymbol(symbol);
+    EncodeShard& shard = encodeShard(token);
+    absl::ReaderMutexLock lock(&shard.mutex_);
+    auto encode_search = shard.map_.find(token);
+    ASSERT(encode_search != shard.map_.end());
+    encode_search->second.ref_count_.fetch_add(1, std::memory_order_relaxed);
   }
 }
 
 void SymbolTableImpl::free(const StatName& stat_name) {
-  // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
+  // Before taking any locks, decode the array of symbols from the SymbolTable::Storage.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
 
-  Thread::LockGuard lock(lock_);
   for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
-
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end());
-
-    // If that was the last remaining client usage of the symbol, erase the
-    // current mappings and add the now-unused symbol to the reuse pool.
-    //
-    // The "if (--EXPR.ref_count_)" pattern speeds up BM_CreateRace by 20% in
-    // symbol_table_speed_test.cc, relative to breaking out the decrement into a
-    // separate step, likely due to the non-trivial dereferences in EXPR.
-    if (--encode_search->second.ref_count_ == 0) {
-      decode_map_.erase(decode_search);
-      encode_map_.erase(encode_search);
-      pool_.push(symbol);
+    releaseSymbol(symbol);
+  }
+}
+
+void SymbolTableImpl::releaseSymbol(Symbol symbol) {
+  // The caller holds a reference, so the token cannot be erased out from under
+  // us until our own reference is dropped below.
+  const absl::string_view token = fromSymbol(symbol);
+  EncodeShard& shard = encodeShard(token);
+
+  {
+    // Dropping a reference that is not the last one does not change the shape
+    // of the map, so it can proceed concurrently with lookups.
+    absl::ReaderMutexLock lock(&shard.mutex_);
+    auto encode_search = shard.map_.find(token);
+    ASSERT(encode_search != shard.map_.end());
+    std::atomic<uint32_t>& ref_count = encode_search->second.ref_count_;
+    uint32_t count = ref_count.load(std::memory_order_relaxed);
+    while (count > 1) {
+      if (ref_count.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel)) {
+        return;
+      }
     }
   }
+
+  // We may hold the last reference. Take the shard exclusively so that no
+  // reader can resurrect the symbol between the final decrement and the erase.
+  absl::MutexLock lock(&shard.mutex_);
+  auto encode_search = shard.map_.find(token);
+  ASSERT(encode_search != shard.map_.end());
+
+  // If that was the last remaining client usage of the symbol, erase the
+  // current mappings and add the now-unused symbol to the reuse pool.
+  //
+  // The "if (--EXPR.ref_count_)" pattern speeds up BM_CreateRace by 20% in
+  // symbol_table_speed_test.cc, relative to breaking out the decrement into a
+  // separate step, likely due to the non-trivial dereferences in EXPR.
+  if (--encode_search->second.ref_count_ == 0) {
+    // Erase from the encode map first, as its key refers to the string owned
+    // by the decode map.
+    shard.map_.erase(encode_search);
+    DecodeShard& decode_shard = decodeShard(symbol);
+    {
+      absl::MutexLock decode_lock(&decode_shard.mutex_);
+      decode_shard.map_.erase(symbol);
+    }
+    Thread::LockGuard symbol_lock(symbol_lock_);
+    pool_.push(symbol);
+  }
 }
 
 uint64_t SymbolTableImpl::getRecentLookups(const RecentLookupsFn& iter) const {
   uint64_t total = 0;
   absl::flat_hash_map<std::string, uint64_t> name_count_map;
 
-  // We don't want to hold lock_ while calling the iterator, but we need it to
-  // access recent_lookups_, so we buffer in name_count_map.
+  // We don't want to hold lookup_lock_ while calling the iterator, but we need
+  // it to access recent_lookups_, so we buffer in name_count_map.
   {
-    Thread::LockGuard lock(lock_);
+    Thread::LockGuard lock(lookup_lock_);
     recent_lookups_.forEach(
         [&name_count_map](absl::string_view str, uint64_t count)
             ABSL_NO_THREAD_SAFETY_ANALYSIS { name_count_map[std::string(str)] += count; });
-    total += recent_lookups_.total();
+    total += recent_lookups_.total() + untracked_lookups_.load(std::memory_order_relaxed);
   }
 
   // Now we have the collated name-count map data: we need to vectorize and
@@ -340,17 +379,19 @@ DynamicSpans SymbolTableImpl::getDynamicSpans(StatName stat_name) const {
 }
 
 void SymbolTableImpl::setRecentLookupCapacity(uint64_t capacity) {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(lookup_lock_);
   recent_lookups_.setCapacity(capacity);
+  track_recent_lookups_.store(capacity > 0, std::memory_order_relaxed);
 }
 
 void SymbolTableImpl::clearRecentLookups() {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(lookup_lock_);
   recent_lookups_.clear();
+  untracked_lookups_.store(0, std::memory_order_relaxed);
 }
 
 uint64_t SymbolTableImpl::recentLookupCapacity() const {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(lookup_lock_);
   return recent_lookups_.capacity();
 }
 
@@ -361,39 +402,55 @@ StatNameSetPtr SymbolTableImpl::makeSet(absl::string_view name) {
 }
 
 Symbol SymbolTableImpl::toSymbol(absl::string_view sv) {
-  Symbol result;
-  auto encode_find = encode_map_.find(sv);
-  // If the string segment doesn't already exist,
-  if (encode_find == encode_map_.end()) {
-    // We create the actual string, place it in the decode_map_, and then insert
-    // a string_view pointing to it in the encode_map_. This allows us to only
-    // store the string once. We use unique_ptr so copies are not made as
-    // flat_hash_map moves values around.
-    InlineStringPtr str = InlineString::create(sv);
-    auto encode_insert = encode_map_.insert({str->toStringView(), SharedSymbol(next_symbol_)});
-    ASSERT(encode_insert.second);
-    auto decode_insert = decode_map_.insert({next_symbol_, std::move(str)});
-    ASSERT(decode_insert.second);
-
-    result = next_symbol_;
-    newSymbol();
-  } else {
-    // If the insertion didn't take place, return the actual value at that location and up the
-    // refcount at that location
-    result = encode_find->second.symbol_;
-    ++(encode_find->second.ref_count_);
+  EncodeShard& shard = encodeShard(sv);
+  {
+    // In steady state nearly every token is already interned, and bumping its
+    // ref-count can be done concurrently with other readers of the shard.
+    absl::ReaderMutexLock lock(&shard.mutex_);
+    auto encode_find = shard.map_.find(sv);
+    if (encode_find != shard.map_.end()) {
+      encode_find->second.ref_count_.fetch_add(1, std::memory_order_relaxed);
+      return encode_find->second.symbol_;
+    }
+  }
+
+  absl::MutexLock lock(&shard.mutex_);
+  // Another thread may have interned the token while the shard was unlocked.
+  auto encode_find = shard.map_.find(sv);
+  if (encode_find != shard.map_.end()) {
+    ++encode_find->second.ref_count_;
+    return encode_find->second.symbol_;
   }
-  return result;
-}
 
-absl::string_view SymbolTableImpl::fromSymbol(const Symbol symbol) const
-    ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
-  auto search = decode_map_.find(symbol);
-  RELEASE_ASSERT(search != decode_map_.end(), "no such symbol");
+  // We create the actual string, place it in the decode map, and then insert
+  // a string_view pointing to it in the encode map. This allows us to only
+  // store the string once. We use unique_ptr so copies are not made as
+  // flat_hash_map moves values around.
+  const Symbol symbol = newSymbol();
+  InlineStringPtr str = InlineString::create(sv);
+  auto encode_insert = shard.map_.insert({str->toStringView(), SharedSymbol(symbol)});
+  ASSERT(encode_insert.second);
+
+  // The encode shard stays locked until the decode map is populated, so no
+  // other thread can obtain the symbol before it can be decoded.
+  DecodeShard& decode_shard = decodeShard(symbol);
+  absl::MutexLock decode_lock(&decode_shard.mutex_);
+  auto decode_insert = decode_shard.map_.insert({symbol, std::move(str)});
+  ASSERT(decode_insert.second);
+  return symbol;
+}
+
+absl::string_view SymbolTableImpl::fromSymbol(const Symbol symbol) const {
+  const DecodeShard& shard = decodeShard(symbol);
+  absl::ReaderMutexLock lock(&shard.mutex_);
+  auto search = shard.map_.find(symbol);
+  RELEASE_ASSERT(search != shard.map_.end(), "no such symbol");
   return search->second->toStringView();
 }
 
-void SymbolTableImpl::newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+Symbol SymbolTableImpl::newSymbol() {
+  Thread::LockGuard lock(symbol_lock_);
+  const Symbol symbol = next_symbol_;
   if (pool_.empty()) {
     next_symbol_ = ++monotonic_counter_;
   } else {
@@ -402,6 +459,7 @@ void SymbolTableImpl::newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
   }
   // This should catch integer overflow for the new symbol.
   ASSERT(monotonic_counter_ != 0);
+  return symbol;
 }
 
 bool SymbolTableImpl::lessThan(const StatName& a, const StatName& b) const {
@@ -423,16 +481,20 @@ bool SymbolTableImpl::lessThan(const StatName& a, const StatName& b) const {
 
 #ifndef ENVOY_CONFIG_COVERAGE
 void SymbolTableImpl::debugPrint() const {
-  Thread::LockGuard lock(lock_);
-  std::vector<Symbol> symbols;
-  for (const auto& p : decode_map_) {
-    symbols.push_back(p.first);
+  std::vector<std::pair<Symbol, absl::string_view>> symbols;
+  for (const DecodeShard& shard : decode_shards_) {
+    absl::ReaderMutexLock lock(&shard.mutex_);
+    for (const auto& p : shard.map_) {
+      symbols.emplace_back(p.first, p.second->toStringView());
+    }
   }
   std::sort(symbols.begin(), symbols.end());
-  for (Symbol symbol : symbols) {
-    const InlineString& token = *decode_map_.find(symbol)->second;
-    const SharedSymbol& shared_symbol = encode_map_.find(token.toStringView())->second;
-    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token.toStringView(), shared_symbol.ref_count_);
+  for (const auto& p : symbols) {
+    const EncodeShard& shard = encodeShard(p.second);
+    absl::ReaderMutexLock lock(&shard.mutex_);
+    const SharedSymbol& shared_symbol = shard.map_.find(p.second)->second;
+    ENVOY_LOG_MISC(info, "{}: '{}' ({})", p.first, p.second,
+                   shared_symbol.ref_count_.load(std::memory_order_relaxed));
   }
 }
 #endif
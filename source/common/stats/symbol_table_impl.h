@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstring>
 #include <memory>
 #include <stack>
@@ -21,8 +23,10 @@
 
 #include "absl/container/fixed_array.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 
 namespace Envoy {
 namespace Stats {
@@ -62,6 +66,11 @@ using SymbolVec = std::vector<Symbol>;
  * that if a string is encoded, the resulting stat is destroyed, and then that
  * same string is re-encoded, it may or may not encode to the same underlying
  * symbol.
+ *
+ * The table is striped into shards: tokens are assigned to an encode shard by
+ * hash and symbols to a decode shard by value, each with its own reader/writer
+ * lock. Symbol numbering remains table-wide, so encodings are identical to
+ * those of an unsharded table.
  */
 class SymbolTableImpl : public SymbolTable {
 public:
@@ -205,15 +214,45 @@ private:
   friend class StatNameTest;
   friend class StatNameDeathTest;
 
+  // Encode and decode maps are striped across this many independently locked
+  // shards, so that threads creating or freeing stat names with disjoint
+  // tokens do not serialize on a single table-wide mutex.
+  static constexpr uint32_t NumShardBits = 4;
+  static constexpr uint32_t NumShards = 1 << NumShardBits;
+
   struct SharedSymbol {
     SharedSymbol(Symbol symbol) : symbol_(symbol), ref_count_(1) {}
 
+    // flat_hash_map relocates values when it grows, which only happens while
+    // the owning shard is held exclusively, so a relaxed copy of the count is
+    // safe.
+    SharedSymbol(SharedSymbol&& src) noexcept
+        : symbol_(src.symbol_), ref_count_(src.ref_count_.load(std::memory_order_relaxed)) {}
+
     Symbol symbol_;
-    uint32_t ref_count_;
+    // Reference counts are bumped while holding only a shared lock on the
+    // shard, so they must be atomic.
+    std::atomic<uint32_t> ref_count_;
   };
 
-  // This must be held during both encode() and free().
-  mutable Thread::MutexBasicLockable lock_;
+  // Bitmap implementation.
+  // The encode map stores both the symbol and the ref count of that symbol.
+  // Using absl::string_view lets us only store the complete string once, in the decode map.
+  using EncodeMap = absl::flat_hash_map<absl::string_view, SharedSymbol>;
+  using DecodeMap = absl::flat_hash_map<Symbol, InlineStringPtr>;
+
+  // Lookups of already-interned tokens, which dominate at steady state, take
+  // the shard mutex in shared mode. Insertions, and the release of the last
+  // reference to a symbol, take it exclusively. Aligned to avoid false sharing
+  // between adjacent shards.
+  struct alignas(64) EncodeShard {
+    mutable absl::Mutex mutex_;
+    EncodeMap map_ ABSL_GUARDED_BY(mutex_);
+  };
+  struct alignas(64) DecodeShard {
+    mutable absl::Mutex mutex_;
+    DecodeMap map_ ABSL_GUARDED_BY(mutex_);
+  };
 
   /**
    * Decodes a uint8_t array into an array of period-delimited strings. Note
@@ -236,20 +275,31 @@ private:
    * @param sv the individual string to be encoded as a symbol.
    * @return Symbol the encoded string.
    */
-  Symbol toSymbol(absl::string_view sv) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  Symbol toSymbol(absl::string_view sv);
 
   /**
-   * Convenience function for decode(), decoding one symbol at a time.
+   * Convenience function for decode(), decoding one symbol at a time. The
+   * returned view remains valid for as long as the caller holds a reference
+   * to the symbol.
    *
    * @param symbol the individual symbol to be decoded.
    * @return absl::string_view the decoded string.
    */
-  absl::string_view fromSymbol(Symbol symbol) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  absl::string_view fromSymbol(Symbol symbol) const;
+
+  /**
+   * Drops one reference to a symbol, erasing it from the table and returning
+   * it to the free pool if that was the last one.
+   *
+   * @param symbol the symbol to release.
+   */
+  void releaseSymbol(Symbol symbol);
 
   /**
-   * Stages a new symbol for use. To be called after a successful insertion.
+   * Allocates a symbol for a newly interned token, recycling from the free
+   * pool when possible.
    */
-  void newSymbol();
+  Symbol newSymbol();
 
   /**
    * Tokenizes name, finds or allocates symbols for each token, and adds them
@@ -260,31 +310,46 @@ private:
    */
   void addTokensToEncoding(absl::string_view name, Encoding& encoding);
 
+  EncodeShard& encodeShard(absl::string_view token) const {
+    // The low bits of the hash are consumed by the shard's own flat_hash_map,
+    // so pick the shard from the high bits.
+    const uint64_t hash = absl::Hash<absl::string_view>()(token);
+    return encode_shards_[hash >> (64 - NumShardBits)];
+  }
+  DecodeShard& decodeShard(Symbol symbol) const { return decode_shards_[symbol % NumShards]; }
+
   Symbol monotonicCounter() {
-    Thread::LockGuard lock(lock_);
+    Thread::LockGuard lock(symbol_lock_);
     return monotonic_counter_;
   }
 
+  // Guards symbol allocation. This is only taken when a token is interned for
+  // the first time or its last reference is dropped. When held together with a
+  // shard mutex, it is always acquired last.
+  mutable Thread::MutexBasicLockable symbol_lock_;
+
   // Stores the symbol to be used at next insertion. This should exist ahead of insertion time so
   // that if insertion succeeds, the value written is the correct one.
-  Symbol next_symbol_ ABSL_GUARDED_BY(lock_);
+  Symbol next_symbol_ ABSL_GUARDED_BY(symbol_lock_);
 
   // If the free pool is exhausted, we monotonically increase this counter.
-  Symbol monotonic_counter_;
-
-  // Bitmap implementation.
-  // The encode map stores both the symbol and the ref count of that symbol.
-  // Using absl::string_view lets us only store the complete string once, in the decode map.
-  using EncodeMap = absl::flat_hash_map<absl::string_view, SharedSymbol>;
-  using DecodeMap = absl::flat_hash_map<Symbol, InlineStringPtr>;
-  EncodeMap encode_map_ ABSL_GUARDED_BY(lock_);
-  DecodeMap decode_map_ ABSL_GUARDED_BY(lock_);
+  Symbol monotonic_counter_ ABSL_GUARDED_BY(symbol_lock_);
 
   // Free pool of symbols for re-use.
   // TODO(ambuc): There might be an optimization here relating to storing ranges of freed symbols
   // using an Envoy::IntervalSet.
-  std::stack<Symbol> pool_ ABSL_GUARDED_BY(lock_);
-  RecentLookups recent_lookups_ ABSL_GUARDED_BY(lock_);
+  std::stack<Symbol> pool_ ABSL_GUARDED_BY(symbol_lock_);
+
+  mutable std::array<EncodeShard, NumShards> encode_shards_;
+  mutable std::array<DecodeShard, NumShards> decode_shards_;
+
+  // Recent lookups are only remembered when a capacity has been configured,
+  // which is normally off; otherwise only a lock-free count is kept so that
+  // encode() does not funnel through lookup_lock_.
+  mutable Thread::MutexBasicLockable lookup_lock_;
+  RecentLookups recent_lookups_ ABSL_GUARDED_BY(lookup_lock_);
+  std::atomic<bool> track_recent_lookups_{false};
+  std::atomic<uint64_t> untracked_lookups_{0};
 };
 
 // Base class for holding the backing-storing for a StatName. The two derived
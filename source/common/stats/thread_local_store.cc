@@ -5,6 +5,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/stats/allocator.h"
 #include "envoy/stats/histogram.h"
@@ -207,10 +208,9 @@ void ThreadLocalStoreImpl::mergeHistograms(PostMergeCb merge_complete_cb) {
     merge_in_progress_ = true;
     tls_->runOnAllThreads(
         [this]() -> void {
-          for (const auto& id_hist : tls_->getTyped<TlsCache>().tls_histogram_cache_) {
-            const TlsHistogramSharedPtr& tls_hist = id_hist.second;
-            tls_hist->beginMerge();
-          }
+          // A single write swaps every TLS histogram of this thread, so the cost to the worker
+          // does not grow with the number of histograms.
+          ThreadLocalHistogramImpl::beginMerge(*tls_->getTyped<TlsCache>().histogram_index_);
         },
         [this, merge_complete_cb]() -> void { mergeInternal(merge_complete_cb); });
   } else {
@@ -703,19 +703,23 @@ Histogram& ThreadLocalStoreImpl::tlsHistogram(ParentHistogramImpl& parent, uint6
   // See comments in counterFromStatName() which explains the logic here.
 
   TlsHistogramSharedPtr* tls_histogram = nullptr;
+  TlsHistogramIndexSharedPtr index;
   if (!shutting_down_ && tls_ != nullptr) {
     TlsCache& tls_cache = tls_->getTyped<TlsCache>();
     tls_histogram = &tls_cache.tls_histogram_cache_[id];
     if (*tls_histogram != nullptr) {
       return **tls_histogram;
     }
+    index = tls_cache.histogram_index_;
+  } else {
+    index = std::make_shared<TlsHistogramIndex>();
   }
 
   StatNameTagHelper tag_helper(*this, parent.statName(), absl::nullopt);
 
-  TlsHistogramSharedPtr hist_tls_ptr(
-      new ThreadLocalHistogramImpl(parent.statName(), parent.unit(), tag_helper.tagExtractedName(),
-                                   tag_helper.statNameTags(), symbolTable()));
+  TlsHistogramSharedPtr hist_tls_ptr(new ThreadLocalHistogramImpl(
+      parent.statName(), parent.unit(), tag_helper.tagExtractedName(), tag_helper.statNameTags(),
+      symbolTable(), std::move(index)));
 
   parent.addTlsHistogram(hist_tls_ptr);
 
@@ -729,9 +733,10 @@ Histogram& ThreadLocalStoreImpl::tlsHistogram(ParentHistogramImpl& parent, uint6
 ThreadLocalHistogramImpl::ThreadLocalHistogramImpl(StatName name, Histogram::Unit unit,
                                                    StatName tag_extracted_name,
                                                    const StatNameTagVector& stat_name_tags,
-                                                   SymbolTable& symbol_table)
+                                                   SymbolTable& symbol_table,
+                                                   TlsHistogramIndexSharedPtr index)
     : HistogramImplHelper(name, tag_extracted_name, stat_name_tags, symbol_table), unit_(unit),
-      current_active_(0), used_(false), created_thread_id_(std::this_thread::get_id()),
+      index_(std::move(index)), used_(false), created_thread_id_(std::this_thread::get_id()),
       symbol_table_(symbol_table) {
   histograms_[0] = hist_alloc();
   histograms_[1] = hist_alloc();
@@ -745,8 +750,10 @@ ThreadLocalHistogramImpl::~ThreadLocalHistogramImpl() {
 
 void ThreadLocalHistogramImpl::recordValue(uint64_t value) {
   ASSERT(std::this_thread::get_id() == created_thread_id_);
-  hist_insert_intscale(histograms_[current_active_], value, 0, 1);
-  used_ = true;
+  hist_insert_intscale(histograms_[index_->current_active_], value, 0, 1);
+  if (!used_.load(std::memory_order_relaxed)) {
+    used_.store(true, std::memory_order_relaxed);
+  }
 }
 
 void ThreadLocalHistogramImpl::merge(histogram_t* target) {
@@ -837,16 +844,20 @@ bool ParentHistogramImpl::used() const {
 void ParentHistogramImpl::merge() {
   Thread::ReleasableLockGuard lock(merge_lock_);
   if (merged_ || usedLockHeld()) {
-    hist_clear(interval_histogram_);
-    // Here we could copy all the pointers to TLS histograms in the tls_histogram_ list,
-    // then release the lock before we do the actual merge. However it is not a big deal
-    // because the tls_histogram merge is not that expensive as it is a single histogram
-    // merge and adding TLS histograms is rare.
+    // Workers take merge_lock_ when they first record into this histogram, so only hold it long
+    // enough to copy the TLS histogram pointers. TLS histograms are never removed from
+    // tls_histograms_, and the backup histograms being merged are not written by their workers
+    // until the next merge swaps them back.
+    std::vector<ThreadLocalHistogramImpl*> tls_histograms;
+    tls_histograms.reserve(tls_histograms_.size());
     for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
-      tls_histogram->merge(interval_histogram_);
+      tls_histograms.push_back(tls_histogram.get());
     }
-    // Since TLS merge is done, we can release the lock here.
     lock.release();
+    hist_clear(interval_histogram_);
+    for (ThreadLocalHistogramImpl* tls_histogram : tls_histograms) {
+      tls_histogram->merge(interval_histogram_);
+    }
     hist_accumulate(cumulative_histogram_, &interval_histogram_, 1);
     cumulative_statistics_.refresh(cumulative_histogram_);
     interval_statistics_.refresh(interval_histogram_);
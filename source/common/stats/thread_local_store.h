@@ -27,27 +27,42 @@
 namespace Envoy {
 namespace Stats {
 
+/**
+ * Selects which of the two histograms of every ThreadLocalHistogramImpl on a thread is used to
+ * collect values. It is shared by all the TLS histograms of a thread so that the merge process
+ * swaps them with a single write on that thread, rather than by visiting each of them. It is
+ * written only by its thread, and only read by the main thread once that thread has swapped, so no
+ * synchronization is needed beyond the post that performs the swap. The index is padded to a cache
+ * line as it is read on every recorded value.
+ */
+struct alignas(64) TlsHistogramIndex {
+  uint64_t current_active_{0};
+};
+
+using TlsHistogramIndexSharedPtr = std::shared_ptr<TlsHistogramIndex>;
+
 /**
  * A histogram that is stored in TLS and used to record values per thread. This holds two
  * histograms, one to collect the values and other as backup that is used for merge process. The
- * swap happens during the merge process.
+ * swap happens during the merge process, see TlsHistogramIndex.
  */
 class ThreadLocalHistogramImpl : public HistogramImplHelper {
 public:
   ThreadLocalHistogramImpl(StatName name, Histogram::Unit unit, StatName tag_extracted_name,
-                           const StatNameTagVector& stat_name_tags, SymbolTable& symbol_table);
+                           const StatNameTagVector& stat_name_tags, SymbolTable& symbol_table,
+                           TlsHistogramIndexSharedPtr index);
   ~ThreadLocalHistogramImpl() override;
 
   void merge(histogram_t* target);
 
   /**
-   * Called in the beginning of merge process. Swaps the histogram used for collection so that we do
-   * not have to lock the histogram in high throughput TLS writes.
+   * Called in the beginning of merge process, on the thread which owns the index. Swaps the
+   * histograms used for collection by every TLS histogram sharing the index, so that we do not
+   * have to lock the histograms in high throughput TLS writes.
    */
-  void beginMerge() {
+  static void beginMerge(TlsHistogramIndex& index) {
     // This switches the current_active_ between 1 and 0.
-    ASSERT(std::this_thread::get_id() == created_thread_id_);
-    current_active_ = otherHistogramIndex();
+    index.current_active_ = 1 - index.current_active_;
   }
 
   // Stats::Histogram
@@ -60,13 +75,15 @@ public:
 
   // Stats::Metric
   SymbolTable& symbolTable() final { return symbol_table_; }
-  bool used() const override { return used_; }
+  bool used() const override { return used_.load(std::memory_order_relaxed); }
 
 private:
   Histogram::Unit unit_;
-  uint64_t otherHistogramIndex() const { return 1 - current_active_; }
-  uint64_t current_active_;
+  uint64_t otherHistogramIndex() const { return 1 - index_->current_active_; }
+  const TlsHistogramIndexSharedPtr index_;
   histogram_t* histograms_[2];
+  // Only ever set once, so that recording does not keep writing to a cache line that the main
+  // thread reads during the merge.
   std::atomic<bool> used_;
   std::thread::id created_thread_id_;
   SymbolTable& symbol_table_;
@@ -454,6 +471,9 @@ private:
 
     // Maps from histogram ID (monotonically increasing) to a TLS histogram.
     absl::flat_hash_map<uint64_t, TlsHistogramSharedPtr> tls_histogram_cache_;
+
+    // Shared by all the TLS histograms in tls_histogram_cache_.
+    TlsHistogramIndexSharedPtr histogram_index_{std::make_shared<TlsHistogramIndex>()};
   };
 
   template <class StatFn> bool iterHelper(StatFn fn) const {
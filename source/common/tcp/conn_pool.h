@@ -161,6 +161,11 @@ public:
 
   ConnectionPool::Cancellable*
   newPendingRequest(Envoy::ConnectionPool::AttachContext& context) override {
+    auto* reused = static_cast<TcpPendingRequest*>(reusePendingRequest());
+    if (reused != nullptr) {
+      reused->context_ = typedContext<TcpAttachContext>(context);
+      return reused;
+    }
     Envoy::ConnectionPool::PendingRequestPtr pending_stream =
         std::make_unique<TcpPendingRequest>(*this, typedContext<TcpAttachContext>(context));
     LinkedList::moveIntoList(std::move(pending_stream), pending_streams_);
@@ -115,6 +115,7 @@ Config::SharedConfig::SharedConfig(
 Config::Config(const envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy& config,
                Server::Configuration::FactoryContext& context)
     : max_connect_attempts_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_connect_attempts, 1)),
+      splice_forwarding_(config.splice_forwarding()),
       upstream_drain_manager_slot_(context.threadLocal().allocateSlot()),
       shared_config_(std::make_shared<SharedConfig>(config, context)),
       random_generator_(context.random()) {
@@ -519,6 +520,13 @@ void Filter::onPoolReady(Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
                   latched_data->connection().streamInfo().downstreamSslConnection());
   read_callbacks_->connection().streamInfo().setUpstreamFilterState(
       latched_data->connection().streamInfo().filterState());
+
+  // Start splicing only now that the data read while connecting has been handed to the upstream.
+  if (config_->spliceForwarding() && upstream_ != nullptr &&
+      upstream_->startSplice(read_callbacks_->connection())) {
+    ENVOY_CONN_LOG(debug, "splicing to upstream", read_callbacks_->connection());
+    config_->stats().downstream_cx_spliced_total_.inc();
+  }
 }
 
 void Filter::onPoolFailure(ConnectionPool::PoolFailureReason failure, absl::string_view,
@@ -50,6 +50,10 @@ TcpUpstream::onDownstreamEvent(Network::ConnectionEvent event) {
   return nullptr;
 }
 
+bool TcpUpstream::startSplice(Network::Connection& downstream) {
+  return upstream_conn_data_->connection().startSplice(downstream);
+}
+
 HttpUpstream::HttpUpstream(Tcp::ConnectionPool::UpstreamCallbacks& callbacks,
                            const std::string& hostname)
     : upstream_callbacks_(callbacks), response_decoder_(*this), hostname_(hostname) {}
@@ -57,6 +57,9 @@ public:
   // upstream to do any cleanup.
   virtual Tcp::ConnectionPool::ConnectionData*
   onDownstreamEvent(Network::ConnectionEvent event) PURE;
+  // Forwards data between the upstream and the downstream connection in the kernel. Returns false
+  // if either connection does not support it. @see Network::Connection::startSplice().
+  virtual bool startSplice(Network::Connection& downstream) PURE;
 };
 
 class TcpUpstream : public GenericUpstream {
@@ -69,6 +72,7 @@ public:
   void encodeData(Buffer::Instance& data, bool end_stream) override;
   void addBytesSentCallback(Network::Connection::BytesSentCb cb) override;
   Tcp::ConnectionPool::ConnectionData* onDownstreamEvent(Network::ConnectionEvent event) override;
+  bool startSplice(Network::Connection& downstream) override;
 
 private:
   Tcp::ConnectionPool::ConnectionDataPtr upstream_conn_data_;
@@ -89,6 +93,8 @@ public:
   void encodeData(Buffer::Instance& data, bool end_stream) override;
   void addBytesSentCallback(Network::Connection::BytesSentCb cb) override;
   Tcp::ConnectionPool::ConnectionData* onDownstreamEvent(Network::ConnectionEvent event) override;
+  // The data is carried in HTTP/2 DATA frames, which cannot be spliced.
+  bool startSplice(Network::Connection&) override { return false; }
 
   // Http::StreamCallbacks
   void onResetStream(Http::StreamResetReason reason,
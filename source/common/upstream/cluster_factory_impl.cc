@@ -6,6 +6,7 @@
 #include "common/network/address_impl.h"
 #include "common/network/resolver_impl.h"
 #include "common/network/socket_option_factory.h"
+#include "common/runtime/runtime_features.h"
 #include "common/upstream/health_checker_impl.h"
 
 #include "server/transport_socket_config_impl.h"
@@ -13,6 +14,8 @@
 namespace Envoy {
 namespace Upstream {
 
+SINGLETON_MANAGER_REGISTRATION(health_check_probe_registry);
+
 namespace {
 
 Stats::ScopePtr generateStatsScope(const envoy::config::cluster::v3::Cluster& config,
@@ -119,10 +122,17 @@ ClusterFactoryImplBase::create(const envoy::config::cluster::v3::Cluster& cluste
     if (cluster.health_checks().size() != 1) {
       throw EnvoyException("Multiple health checks not supported");
     } else {
+      HealthCheckProbeRegistrySharedPtr probe_registry;
+      if (Runtime::runtimeFeatureEnabled(
+              "envoy.reloadable_features.health_check_probe_sharing")) {
+        probe_registry = context.singletonManager().getTyped<HealthCheckProbeRegistry>(
+            SINGLETON_MANAGER_REGISTERED_NAME(health_check_probe_registry),
+            [] { return std::make_shared<HealthCheckProbeRegistry>(); });
+      }
       new_cluster_pair.first->setHealthChecker(HealthCheckerFactory::create(
           cluster.health_checks()[0], *new_cluster_pair.first, context.runtime(), context.random(),
           context.dispatcher(), context.logManager(), context.messageValidationVisitor(),
-          context.api()));
+          context.api(), std::move(probe_registry)));
     }
   }
 
@@ -47,6 +47,10 @@ namespace Envoy {
 namespace Upstream {
 namespace {
 
+// The number of threads which build Maglev tables and hash rings. Builds of different clusters run
+// in parallel, while the builds of a cluster are serialized.
+constexpr uint32_t LbTableBuilderConcurrency = 2;
+
 void addOptionsIfNotNull(Network::Socket::OptionsSharedPtr& options,
                          const Network::Socket::OptionsSharedPtr& to_add) {
   if (to_add != nullptr) {
@@ -245,7 +249,7 @@ ClusterManagerImpl::ClusterManagerImpl(
       config_tracker_entry_(
           admin.getConfigTracker().add("clusters", [this] { return dumpClusterConfigs(); })),
       time_source_(main_thread_dispatcher.timeSource()), dispatcher_(main_thread_dispatcher),
-      http_context_(http_context),
+      thread_factory_(api.threadFactory()), http_context_(http_context),
       subscription_factory_(local_info, main_thread_dispatcher, *this, random,
                             validation_context.dynamicValidationVisitor(), api, runtime_) {
   async_client_manager_ = std::make_unique<Grpc::AsyncClientManagerImpl>(
@@ -766,17 +770,21 @@ void ClusterManagerImpl::loadCluster(const envoy::config::cluster::v3::Cluster&
   // because the thread_aware_lb_ field takes precedence over the subset lb).
   if (cluster_reference.info()->lbType() == LoadBalancerType::RingHash) {
     if (!cluster_reference.info()->lbSubsetInfo().isEnabled()) {
-      cluster_entry_it->second->thread_aware_lb_ = std::make_unique<RingHashLoadBalancer>(
+      auto lb = std::make_unique<RingHashLoadBalancer>(
           cluster_reference.prioritySet(), cluster_reference.info()->stats(),
           cluster_reference.info()->statsScope(), runtime_, random_,
           cluster_reference.info()->lbRingHashConfig(), cluster_reference.info()->lbConfig());
+      maybeSetLbTableBuilder(*lb, *cluster_reference.info());
+      cluster_entry_it->second->thread_aware_lb_ = std::move(lb);
     }
   } else if (cluster_reference.info()->lbType() == LoadBalancerType::Maglev) {
     if (!cluster_reference.info()->lbSubsetInfo().isEnabled()) {
-      cluster_entry_it->second->thread_aware_lb_ = std::make_unique<MaglevLoadBalancer>(
+      auto lb = std::make_unique<MaglevLoadBalancer>(
           cluster_reference.prioritySet(), cluster_reference.info()->stats(),
           cluster_reference.info()->statsScope(), runtime_, random_,
           cluster_reference.info()->lbConfig());
+      maybeSetLbTableBuilder(*lb, *cluster_reference.info());
+      cluster_entry_it->second->thread_aware_lb_ = std::move(lb);
     }
   } else if (cluster_reference.info()->lbType() == LoadBalancerType::ClusterProvided) {
     cluster_entry_it->second->thread_aware_lb_ = std::move(new_cluster_pair.second);
@@ -785,6 +793,18 @@ void ClusterManagerImpl::loadCluster(const envoy::config::cluster::v3::Cluster&
   updateClusterCounts();
 }
 
+void ClusterManagerImpl::maybeSetLbTableBuilder(ThreadAwareLoadBalancerBase& lb,
+                                                const ClusterInfo& cluster_info) {
+  if (!Runtime::runtimeFeatureEnabled("envoy.reloadable_features.background_lb_table_builds")) {
+    return;
+  }
+  if (lb_table_builder_ == nullptr) {
+    lb_table_builder_ =
+        std::make_shared<LbTableBuilder>(thread_factory_, dispatcher_, LbTableBuilderConcurrency);
+  }
+  lb.setTableBuilder(lb_table_builder_, cluster_info.statsScope());
+}
+
 void ClusterManagerImpl::updateClusterCounts() {
   // This if/else block implements a control flow mechanism that can be used by an ADS
   // implementation to properly sequence CDS and RDS updates. It is not enforcing on ADS. ADS can
@@ -853,8 +873,10 @@ ClusterManagerImpl::tcpConnPoolForCluster(const std::string& cluster, ResourcePr
 
 void ClusterManagerImpl::postThreadLocalDrainConnections(const Cluster& cluster,
                                                          const HostVector& hosts_removed) {
-  tls_->runOnAllThreads([this, name = cluster.info()->name(), hosts_removed]() {
-    ThreadLocalClusterManagerImpl::removeHosts(name, hosts_removed, *tls_);
+  // The callback is copied for every worker, so the hosts are shared rather than captured by value.
+  tls_->runOnAllThreads([this, name = cluster.info()->name(),
+                         hosts_removed = std::make_shared<const HostVector>(hosts_removed)]() {
+    ThreadLocalClusterManagerImpl::removeHosts(name, *hosts_removed, *tls_);
   });
 }
 
@@ -863,12 +885,17 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(const Cluster& cluster, ui
                                                       const HostVector& hosts_removed) {
   const auto& host_set = cluster.prioritySet().hostSetsPerPriority()[priority];
 
+  // Only the changed hosts are posted, along with the host vectors of the host set which are
+  // shared by all workers. The callback is copied for every worker, so the changed hosts are shared
+  // as well, rather than copying them, and touching the reference count of every host, per worker.
   tls_->runOnAllThreads([this, name = cluster.info()->name(), priority,
                          update_params = HostSetImpl::updateHostsParams(*host_set),
-                         locality_weights = host_set->localityWeights(), hosts_added, hosts_removed,
+                         locality_weights = host_set->localityWeights(),
+                         hosts_added = std::make_shared<const HostVector>(hosts_added),
+                         hosts_removed = std::make_shared<const HostVector>(hosts_removed),
                          overprovisioning_factor = host_set->overprovisioningFactor()]() {
     ThreadLocalClusterManagerImpl::updateClusterMembership(
-        name, priority, update_params, locality_weights, hosts_added, hosts_removed, *tls_,
+        name, priority, update_params, locality_weights, *hosts_added, *hosts_removed, *tls_,
         overprovisioning_factor);
   });
 }
@@ -1136,6 +1163,8 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::updateClusterMembership(
   const auto& cluster_entry = config.thread_local_clusters_[name];
   ENVOY_LOG(debug, "membership update for TLS cluster {} added {} removed {}", name,
             hosts_added.size(), hosts_removed.size());
+  const auto& host_sets = cluster_entry->priority_set_.hostSetsPerPriority();
+  const bool had_hosts = priority < host_sets.size() && !host_sets[priority]->hosts().empty();
   cluster_entry->priority_set_.updateHosts(priority, std::move(update_hosts_params),
                                            std::move(locality_weights), hosts_added, hosts_removed,
                                            overprovisioning_factor);
@@ -1145,6 +1174,25 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::updateClusterMembership(
     ENVOY_LOG(debug, "re-creating local LB for TLS cluster {}", name);
     cluster_entry->lb_ = cluster_entry->lb_factory_->create();
   }
+
+  // Establish connections to the added hosts ahead of their first streams, if configured. The
+  // initial hosts of a priority are left alone, so that starting up or adding a cluster does not
+  // connect to every host at once, as are hosts which are not healthy and so unlikely to be picked.
+  // The main thread only makes occasional requests, so it does not warm up either.
+  const uint32_t warm_up_connections = cluster_entry->cluster_info_->warmUpConnections();
+  if (warm_up_connections > 0 && had_hosts &&
+      &config.thread_local_dispatcher_ != &config.parent_.dispatcher_) {
+    for (const HostSharedPtr& host : hosts_added) {
+      if (host->health() != Host::Health::Healthy) {
+        continue;
+      }
+      Http::ConnectionPool::Instance* pool =
+          cluster_entry->connPoolForHost(host, ResourcePriority::Default, absl::nullopt, nullptr);
+      if (pool != nullptr) {
+        pool->prefetchConnections(warm_up_connections);
+      }
+    }
+  }
 }
 
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::onHostHealthFailure(
@@ -1299,7 +1347,13 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
     cluster_info_->stats().upstream_cx_none_healthy_.inc();
     return nullptr;
   }
+  return connPoolForHost(host, priority, downstream_protocol, context);
+}
 
+Http::ConnectionPool::Instance*
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPoolForHost(
+    const HostConstSharedPtr& host, ResourcePriority priority,
+    absl::optional<Http::Protocol> downstream_protocol, LoadBalancerContext* context) {
   auto upstream_protocol = host->cluster().upstreamHttpProtocol(downstream_protocol);
   std::vector<uint8_t> hash_key = {uint8_t(upstream_protocol)};
 
@@ -1402,6 +1456,16 @@ Http::ConnectionPool::InstancePtr ProdClusterManagerFactory::allocateConnPool(
     const Network::TransportSocketOptionsSharedPtr& transport_socket_options) {
   if (protocol == Http::Protocol::Http2 &&
       runtime_.snapshot().featureEnabled("upstream.use_http2", 100)) {
+    // Pools which use per-request socket options have their own connections, so are not shared.
+    // Neither are those of the main thread, which are not part of any group of workers.
+    const uint32_t sharing_workers = host->cluster().http2PoolSharingWorkers();
+    if (sharing_workers > 1 && options == nullptr && transport_socket_options == nullptr &&
+        &dispatcher != &main_thread_dispatcher_) {
+      return shared_conn_pools_->allocateConnPool(
+          dispatcher, host, priority, sharing_workers, [host, priority, &dispatcher]() {
+            return Http::Http2::allocateConnPool(dispatcher, host, priority, nullptr, nullptr);
+          });
+    }
     return Http::Http2::allocateConnPool(dispatcher, host, priority, options,
                                          transport_socket_options);
   } else if (protocol == Http::Protocol::Http3) {
@@ -28,8 +28,10 @@
 #include "common/config/grpc_mux_impl.h"
 #include "common/config/subscription_factory_impl.h"
 #include "common/http/async_client_impl.h"
+#include "common/http/http2/shared_conn_pool.h"
 #include "common/upstream/load_stats_reporter.h"
 #include "common/upstream/priority_conn_pool_map.h"
+#include "common/upstream/thread_aware_lb_impl.h"
 #include "common/upstream/upstream_impl.h"
 
 namespace Envoy {
@@ -91,6 +93,9 @@ protected:
   Secret::SecretManager& secret_manager_;
   AccessLog::AccessLogManager& log_manager_;
   Singleton::Manager& singleton_manager_;
+  // Groups the HTTP/2 connection pools of workers for clusters which share them.
+  const Http::Http2::SharedConnPoolRegistrySharedPtr shared_conn_pools_{
+      std::make_shared<Http::Http2::SharedConnPoolRegistry>()};
 };
 
 // For friend declaration in ClusterManagerInitHelper.
@@ -338,6 +343,12 @@ private:
                                                absl::optional<Http::Protocol> downstream_protocol,
                                                LoadBalancerContext* context);
 
+      // Returns the HTTP connection pool for a host which has already been chosen.
+      Http::ConnectionPool::Instance*
+      connPoolForHost(const HostConstSharedPtr& host, ResourcePriority priority,
+                      absl::optional<Http::Protocol> downstream_protocol,
+                      LoadBalancerContext* context);
+
       Tcp::ConnectionPool::Instance* tcpConnPool(ResourcePriority priority,
                                                  LoadBalancerContext* context);
 
@@ -483,6 +494,7 @@ private:
   void onClusterInit(Cluster& cluster);
   void postThreadLocalHealthFailure(const HostSharedPtr& host);
   void updateClusterCounts();
+  void maybeSetLbTableBuilder(ThreadAwareLoadBalancerBase& lb, const ClusterInfo& cluster_info);
 
   ClusterManagerFactory& factory_;
   Runtime::Loader& runtime_;
@@ -512,9 +524,13 @@ private:
   TimeSource& time_source_;
   ClusterUpdatesMap updates_map_;
   Event::Dispatcher& dispatcher_;
+  Thread::ThreadFactory& thread_factory_;
   Http::Context& http_context_;
   Config::SubscriptionFactoryImpl subscription_factory_;
   ClusterSet primary_clusters_;
+  // Created on first use. Shared with the load balancers, which cancel their running builds on
+  // destruction.
+  LbTableBuilderSharedPtr lb_table_builder_;
 };
 
 } // namespace Upstream
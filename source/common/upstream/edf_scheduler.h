@@ -1,10 +1,16 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <queue>
+#include <vector>
 
 #include "common/common/assert.h"
 
+#include "absl/container/node_hash_map.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -23,55 +29,185 @@ namespace Upstream {
 // Each pick from the schedule has the earliest deadline entry selected. Entries have deadlines set
 // at current time + 1 / weight, providing weighted round robin behavior with floating point
 // weights and an O(log n) pick time.
+//
+// By default the queue is a plain binary heap, where an entry is rescheduled by adding it again.
+// An indexed scheduler additionally keeps the position of each entry in the heap, so that the
+// weight of an entry can be changed, or the entry removed, in O(log n) time without rebuilding the
+// schedule. Each entry is then scheduled at most once. The index costs a hash table lookup and a
+// node allocation per insertion, so it is only worth it for schedules which are updated in place.
 template <class C> class EdfScheduler {
 public:
+  /**
+   * @param indexed whether entries are indexed, which update(), remove() and refresh() require.
+   */
+  explicit EdfScheduler(bool indexed = false) : indexed_(indexed) {}
+
   /**
    * Pick queue entry with closest deadline.
    * @return std::shared_ptr<C> to the queue entry if a valid entry exists in the queue, nullptr
    *         otherwise. The entry is removed from the queue.
    */
   std::shared_ptr<C> pick() {
-    EDF_TRACE("Queue pick: queue_.size()={}, current_time_={}.", queue_.size(), current_time_);
-    while (true) {
-      if (queue_.empty()) {
-        EDF_TRACE("Queue is empty.");
-        return nullptr;
+    EDF_TRACE("Queue pick: size()={}, current_time_={}.", size(), current_time_);
+    if (!indexed_) {
+      std::shared_ptr<C> ret = pickEntry();
+      if (ret != nullptr) {
+        queue_.pop();
       }
-      const EdfEntry& edf_entry = queue_.top();
-      // Entry has been removed, let's see if there's another one.
-      if (edf_entry.entry_.expired()) {
-        EDF_TRACE("Entry has expired, repick.");
+      return ret;
+    }
+    std::shared_ptr<C> ret = pickNode();
+    if (ret != nullptr) {
+      removeNode(*indexed_queue_.front());
+    }
+    return ret;
+  }
+
+  /**
+   * Pick queue entry with closest deadline and add it back with the weight supplied by
+   * calculate_weight. This is equivalent to pick() followed by add(), without removing the entry
+   * from the index of an indexed scheduler.
+   * @param calculate_weight supplies the weight of the picked entry.
+   * @return std::shared_ptr<C> to the queue entry if a valid entry exists in the queue, nullptr
+   *         otherwise.
+   */
+  std::shared_ptr<C> pickAndAdd(const std::function<double(const C&)>& calculate_weight) {
+    if (!indexed_) {
+      std::shared_ptr<C> ret = pickEntry();
+      if (ret != nullptr) {
         queue_.pop();
-        continue;
+        add(calculate_weight(*ret), ret);
       }
-      std::shared_ptr<C> ret{edf_entry.entry_};
-      ASSERT(edf_entry.deadline_ >= current_time_);
-      current_time_ = edf_entry.deadline_;
-      queue_.pop();
-      EDF_TRACE("Picked {}, current_time_={}.", static_cast<const void*>(ret.get()), current_time_);
       return ret;
     }
+    std::shared_ptr<C> ret = pickNode();
+    if (ret != nullptr) {
+      Node& node = *indexed_queue_.front();
+      schedule(node, calculate_weight(*ret));
+      siftDown(0);
+    }
+    return ret;
   }
 
   /**
    * Insert entry into queue with a given weight. The deadline will be current_time_ + 1 / weight.
+   * If the scheduler is indexed and the entry is already in the queue, it is rescheduled.
    * @param weight floating point weight.
    * @param entry shared pointer to entry, only a weak reference will be retained.
    */
   void add(double weight, std::shared_ptr<C> entry) {
-    ASSERT(weight > 0);
-    const double deadline = current_time_ + 1.0 / weight;
+    if (!indexed_) {
+      ASSERT(weight > 0);
+      const double deadline = current_time_ + 1.0 / weight;
+      EDF_TRACE("Insertion {} in queue with deadline {} and weight {}.",
+                static_cast<const void*>(entry.get()), deadline, weight);
+      queue_.push({deadline, order_offset_++, entry});
+      ASSERT(queue_.top().deadline_ >= current_time_);
+      return;
+    }
+    Node& node = nodes_[entry.get()];
+    const bool queued = node.key_ != nullptr;
+    node.key_ = entry.get();
+    node.entry_ = entry;
+    schedule(node, weight);
     EDF_TRACE("Insertion {} in queue with deadline {} and weight {}.",
-              static_cast<const void*>(entry.get()), deadline, weight);
-    queue_.push({deadline, order_offset_++, entry});
-    ASSERT(queue_.top().deadline_ >= current_time_);
+              static_cast<const void*>(entry.get()), node.deadline_, weight);
+    if (queued) {
+      // Either the entry is rescheduled, or the object it pointed to was freed and another one
+      // allocated at the same address.
+      fixHeap(node.heap_index_);
+    } else {
+      node.heap_index_ = indexed_queue_.size();
+      indexed_queue_.push_back(&node);
+      siftUp(node.heap_index_);
+    }
+    ASSERT(indexed_queue_.front()->deadline_ >= current_time_);
+  }
+
+  /**
+   * Change the weight of an entry in the queue. Its deadline is moved as if it had been inserted
+   * with the new weight, but no earlier than the current time. The scheduler must be indexed.
+   * @param weight floating point weight.
+   * @param entry supplies the entry to update.
+   * @return bool whether the entry was in the queue.
+   */
+  bool update(double weight, const C& entry) {
+    ASSERT(indexed_);
+    auto it = nodes_.find(&entry);
+    if (it == nodes_.end() || it->second.entry_.expired()) {
+      return false;
+    }
+    Node& node = it->second;
+    node.epoch_ = epoch_;
+    if (weight != node.weight_) {
+      ASSERT(weight > 0);
+      node.weight_ = weight;
+      node.deadline_ = std::max(current_time_, node.start_time_ + 1.0 / weight);
+      fixHeap(node.heap_index_);
+    }
+    return true;
+  }
+
+  /**
+   * Remove an entry from the queue. The scheduler must be indexed.
+   * @param entry supplies the entry to remove.
+   * @return bool whether the entry was in the queue.
+   */
+  bool remove(const C& entry) {
+    ASSERT(indexed_);
+    auto it = nodes_.find(&entry);
+    if (it == nodes_.end()) {
+      return false;
+    }
+    const bool live = !it->second.entry_.expired();
+    removeNode(it->second);
+    return live;
+  }
+
+  /**
+   * Bring the queue in line with a new set of entries, in O(n + k log n) time for k changed
+   * entries rather than the O(n log n) time of building a new queue. Entries which are already in
+   * the queue keep their place in the schedule, adjusted for any change of weight, new entries are
+   * added and entries not in the set are removed. The scheduler must be indexed.
+   * @param entries supplies the entries.
+   * @param calculate_weight supplies the weight of each entry.
+   */
+  template <class Container>
+  void refresh(const Container& entries,
+               const std::function<double(const C&)>& calculate_weight) {
+    ASSERT(indexed_);
+    ++epoch_;
+    for (const auto& entry : entries) {
+      const double weight = calculate_weight(*entry);
+      if (!update(weight, *entry)) {
+        add(weight, entry);
+      }
+    }
+    for (auto it = nodes_.begin(); it != nodes_.end();) {
+      if (it->second.epoch_ != epoch_) {
+        removeFromQueue(it->second);
+        nodes_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
   }
 
   /**
    * Implements empty() on the internal queue. Does not attempt to discard expired elements.
    * @return bool whether or not the internal queue is empty.
    */
-  bool empty() const { return queue_.empty(); }
+  bool empty() const { return indexed_ ? indexed_queue_.empty() : queue_.empty(); }
+
+  /**
+   * @return size_t the number of entries in the queue, including expired elements.
+   */
+  size_t size() const { return indexed_ ? indexed_queue_.size() : queue_.size(); }
+
+  /**
+   * @return bool whether the scheduler is indexed.
+   */
+  bool indexed() const { return indexed_; }
 
 private:
   struct EdfEntry {
@@ -89,6 +225,144 @@ private:
     }
   };
 
+  struct Node {
+    const C* key_{};
+    // We only hold a weak pointer, so that entries whose object has been freed are lazily unloaded
+    // from the queue.
+    std::weak_ptr<C> entry_;
+    double weight_{};
+    // The time at which the entry was scheduled, and its deadline.
+    double start_time_{};
+    double deadline_{};
+    // Tie breaker for entries with the same deadline. This is used to provide FIFO behavior.
+    uint64_t order_offset_{};
+    // The position of the node in indexed_queue_.
+    size_t heap_index_{};
+    // The last refresh() which saw the entry.
+    uint64_t epoch_{};
+  };
+
+  static bool earlier(const Node& lhs, const Node& rhs) {
+    return lhs.deadline_ < rhs.deadline_ ||
+           (lhs.deadline_ == rhs.deadline_ && lhs.order_offset_ < rhs.order_offset_);
+  }
+
+  // Moves current_time_ to the deadline of the earliest live entry, discarding expired entries.
+  // @return the entry, which is left at the top of queue_, or nullptr if the queue is empty.
+  std::shared_ptr<C> pickEntry() {
+    while (!queue_.empty()) {
+      const EdfEntry& edf_entry = queue_.top();
+      std::shared_ptr<C> ret = edf_entry.entry_.lock();
+      // Entry has been removed, let's see if there's another one.
+      if (ret == nullptr) {
+        EDF_TRACE("Entry has expired, repick.");
+        queue_.pop();
+        continue;
+      }
+      ASSERT(edf_entry.deadline_ >= current_time_);
+      current_time_ = edf_entry.deadline_;
+      EDF_TRACE("Picked {}, current_time_={}.", static_cast<const void*>(ret.get()),
+                current_time_);
+      return ret;
+    }
+    EDF_TRACE("Queue is empty.");
+    return nullptr;
+  }
+
+  // The same as pickEntry(), for indexed schedulers.
+  // @return the entry, which is left at the front of indexed_queue_, or nullptr if the queue is
+  //         empty.
+  std::shared_ptr<C> pickNode() {
+    while (!indexed_queue_.empty()) {
+      Node& node = *indexed_queue_.front();
+      std::shared_ptr<C> ret = node.entry_.lock();
+      // Entry has been removed, let's see if there's another one.
+      if (ret == nullptr) {
+        EDF_TRACE("Entry has expired, repick.");
+        removeNode(node);
+        continue;
+      }
+      ASSERT(node.deadline_ >= current_time_);
+      current_time_ = node.deadline_;
+      EDF_TRACE("Picked {}, current_time_={}.", static_cast<const void*>(ret.get()),
+                current_time_);
+      return ret;
+    }
+    EDF_TRACE("Queue is empty.");
+    return nullptr;
+  }
+
+  void schedule(Node& node, double weight) {
+    ASSERT(weight > 0);
+    node.weight_ = weight;
+    node.start_time_ = current_time_;
+    node.deadline_ = current_time_ + 1.0 / weight;
+    node.order_offset_ = order_offset_++;
+    node.epoch_ = epoch_;
+  }
+
+  void removeNode(Node& node) {
+    const C* key = node.key_;
+    removeFromQueue(node);
+    nodes_.erase(key);
+  }
+
+  void removeFromQueue(Node& node) {
+    const size_t index = node.heap_index_;
+    Node* last = indexed_queue_.back();
+    indexed_queue_.pop_back();
+    if (last != &node) {
+      indexed_queue_[index] = last;
+      last->heap_index_ = index;
+      fixHeap(index);
+    }
+  }
+
+  void fixHeap(size_t index) {
+    if (index > 0 && earlier(*indexed_queue_[index], *indexed_queue_[(index - 1) / 2])) {
+      siftUp(index);
+    } else {
+      siftDown(index);
+    }
+  }
+
+  void siftUp(size_t index) {
+    Node* node = indexed_queue_[index];
+    while (index > 0) {
+      const size_t parent = (index - 1) / 2;
+      if (!earlier(*node, *indexed_queue_[parent])) {
+        break;
+      }
+      indexed_queue_[index] = indexed_queue_[parent];
+      indexed_queue_[index]->heap_index_ = index;
+      index = parent;
+    }
+    indexed_queue_[index] = node;
+    node->heap_index_ = index;
+  }
+
+  void siftDown(size_t index) {
+    Node* node = indexed_queue_[index];
+    const size_t size = indexed_queue_.size();
+    while (true) {
+      size_t child = 2 * index + 1;
+      if (child >= size) {
+        break;
+      }
+      if (child + 1 < size && earlier(*indexed_queue_[child + 1], *indexed_queue_[child])) {
+        ++child;
+      }
+      if (!earlier(*indexed_queue_[child], *node)) {
+        break;
+      }
+      indexed_queue_[index] = indexed_queue_[child];
+      indexed_queue_[index]->heap_index_ = index;
+      index = child;
+    }
+    indexed_queue_[index] = node;
+    node->heap_index_ = index;
+  }
+
   // Current time in EDF scheduler.
   // TODO(htuch): Is it worth the small extra complexity to use integer time for performance
   // reasons?
@@ -96,8 +370,16 @@ private:
   // Offset used during addition to break ties when entries have the same weight but should reflect
   // FIFO insertion order in picks.
   uint64_t order_offset_{};
-  // Min priority queue for EDF.
+  const bool indexed_;
+  // Min priority queue for EDF, if the scheduler is not indexed.
   std::priority_queue<EdfEntry> queue_;
+  // Incremented by each refresh(), to find the entries it did not see.
+  uint64_t epoch_{};
+  // The entries of an indexed scheduler, by address. Nodes do not move, so that indexed_queue_ can
+  // point to them.
+  absl::node_hash_map<const C*, Node> nodes_;
+  // Min heap of the nodes for EDF, if the scheduler is indexed.
+  std::vector<Node*> indexed_queue_;
 };
 
 #undef EDF_DEBUG
@@ -0,0 +1,49 @@
+#include "common/upstream/hash_search_tree.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Upstream {
+
+HashSearchTree::HashSearchTree(const std::vector<uint64_t>& sorted_hashes)
+    : size_(sorted_hashes.size()) {
+  ASSERT(std::is_sorted(sorted_hashes.begin(), sorted_hashes.end()));
+  if (sorted_hashes.empty()) {
+    return;
+  }
+  max_hash_ = sorted_hashes.back();
+
+  levels_.push_back(toNodes(sorted_hashes));
+  while (levels_.back().size() > 1) {
+    std::vector<uint64_t> separators;
+    separators.reserve(levels_.back().size());
+    for (const Node& node : levels_.back()) {
+      separators.push_back(node.hashes_[NodeSize - 1]);
+    }
+    levels_.push_back(toNodes(separators));
+  }
+  std::reverse(levels_.begin(), levels_.end());
+}
+
+size_t HashSearchTree::memoryUsage() const {
+  size_t bytes = 0;
+  for (const std::vector<Node>& level : levels_) {
+    bytes += level.size() * sizeof(Node);
+  }
+  return bytes;
+}
+
+std::vector<HashSearchTree::Node> HashSearchTree::toNodes(const std::vector<uint64_t>& hashes) {
+  std::vector<Node> nodes((hashes.size() + NodeSize - 1) / NodeSize);
+  for (size_t i = 0; i < nodes.size() * NodeSize; ++i) {
+    nodes[i / NodeSize].hashes_[i % NodeSize] =
+        i < hashes.size() ? hashes[i] : std::numeric_limits<uint64_t>::max();
+  }
+  return nodes;
+}
+
+} // namespace Upstream
+} // namespace Envoy
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common/common/assert.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * A static B+ tree over a sorted array of hashes, e.g. the hashes of a hash ring. Finding the
+ * first hash greater than or equal to a value touches one cache line per level of the tree, where
+ * a binary search touches one per step once the array is larger than the cache. Each node is a
+ * cache line of hashes which is searched with SIMD instructions where they are available. The
+ * leaves are the sorted hashes themselves, so a search yields the position of a hash in the sorted
+ * array, and data about each hash can be kept in arrays parallel to it.
+ */
+class HashSearchTree {
+public:
+  static constexpr uint32_t NodeSize = 8;
+
+  HashSearchTree() = default;
+
+  /**
+   * @param sorted_hashes supplies the hashes, in ascending order. Duplicates are allowed.
+   */
+  explicit HashSearchTree(const std::vector<uint64_t>& sorted_hashes);
+
+  /**
+   * @param hash supplies the hash to look up.
+   * @return the position of the first hash greater than or equal to hash, or 0 if there is no such
+   *         hash, so that positions wrap around as on a ring. The tree must not be empty.
+   */
+  uint64_t lowerBound(uint64_t hash) const {
+    // Internal nodes are padded with the greatest possible hash rather than with the greatest
+    // hash of the tree, so a hash above all hashes could descend to a padding slot which has no
+    // node below it.
+    if (hash > max_hash_) {
+      return 0;
+    }
+    // Otherwise, each node on the path holds a hash which is greater than or equal to hash: the
+    // separator which led to the node, or the greatest hash of the tree in the last node of a
+    // level. So the count never reaches a padding slot.
+    uint64_t position = 0;
+    for (const std::vector<Node>& level : levels_) {
+      position = position * NodeSize + countLess(level[position], hash);
+    }
+    ASSERT(position < size_);
+    return position;
+  }
+
+  /**
+   * @param position supplies a position in the sorted array.
+   * @return the hash at position.
+   */
+  uint64_t hash(uint64_t position) const {
+    return levels_.back()[position / NodeSize].hashes_[position % NodeSize];
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  /**
+   * @return the number of bytes used by the nodes of the tree.
+   */
+  size_t memoryUsage() const;
+
+private:
+  struct alignas(64) Node {
+    uint64_t hashes_[NodeSize];
+  };
+  static_assert(sizeof(Node) == 64, "a node must fill a cache line");
+
+  // Splits hashes into nodes, padding the last one with the greatest hash.
+  static std::vector<Node> toNodes(const std::vector<uint64_t>& hashes);
+
+  // @return the number of hashes of node which are less than hash.
+  static uint32_t countLess(const Node& node, uint64_t hash) {
+#if defined(__AVX2__)
+    // AVX2 only has signed comparisons, so flip the sign bits to compare unsigned values.
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i value = _mm256_xor_si256(_mm256_set1_epi64x(hash), sign);
+    const __m256i* hashes = reinterpret_cast<const __m256i*>(node.hashes_);
+    const __m256i lo = _mm256_xor_si256(_mm256_load_si256(hashes), sign);
+    const __m256i hi = _mm256_xor_si256(_mm256_load_si256(hashes + 1), sign);
+    const int lo_mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(value, lo)));
+    const int hi_mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(value, hi)));
+    return __builtin_popcount(lo_mask | (hi_mask << 4));
+#elif defined(__aarch64__)
+    // Each lane of a comparison is all ones when true, so subtracting it counts the lesser hashes.
+    const uint64x2_t value = vdupq_n_u64(hash);
+    uint64x2_t count = vdupq_n_u64(0);
+    for (uint32_t i = 0; i < NodeSize; i += 2) {
+      count = vsubq_u64(count, vcltq_u64(vld1q_u64(node.hashes_ + i), value));
+    }
+    return static_cast<uint32_t>(vgetq_lane_u64(count, 0) + vgetq_lane_u64(count, 1));
+#else
+    // Branchless, so that compilers can vectorize it for the target.
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < NodeSize; ++i) {
+      count += node.hashes_[i] < hash;
+    }
+    return count;
+#endif
+  }
+
+  // levels_.front() is the root and levels_.back() the leaves. Each hash of a level above the
+  // leaves is the last hash of the corresponding node of the level below.
+  std::vector<std::vector<Node>> levels_;
+  size_t size_{};
+  uint64_t max_hash_{};
+};
+
+} // namespace Upstream
+} // namespace Envoy
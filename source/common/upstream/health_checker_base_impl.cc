@@ -5,9 +5,14 @@
 #include "envoy/data/core/v3/health_check_event.pb.h"
 #include "envoy/stats/scope.h"
 
+#include "common/common/empty_string.h"
+#include "common/network/raw_buffer_socket.h"
 #include "common/network/utility.h"
+#include "common/protobuf/utility.h"
 #include "common/router/router.h"
 
+#include "absl/strings/str_cat.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -36,7 +41,8 @@ HealthCheckerImplBase::HealthCheckerImplBase(const Cluster& cluster,
       healthy_edge_interval_(
           PROTOBUF_GET_MS_OR_DEFAULT(config, healthy_edge_interval, interval_.count())),
       transport_socket_options_(initTransportSocketOptions(config)),
-      transport_socket_match_metadata_(initTransportSocketMatchMetadata(config)) {
+      transport_socket_match_metadata_(initTransportSocketMatchMetadata(config)),
+      config_hash_(MessageUtil::hash(config)) {
   cluster_.prioritySet().addMemberUpdateCb(
       [this](const HostVector& hosts_added, const HostVector& hosts_removed) -> void {
         onClusterMemberUpdate(hosts_added, hosts_removed);
@@ -131,7 +137,11 @@ std::chrono::milliseconds HealthCheckerImplBase::interval(HealthState state,
 std::chrono::milliseconds
 HealthCheckerImplBase::intervalWithJitter(uint64_t base_time_ms,
                                           std::chrono::milliseconds interval_jitter) const {
-  const uint64_t jitter_percent_mod = interval_jitter_percent_ * base_time_ms / 100;
+  uint32_t interval_jitter_percent = interval_jitter_percent_;
+  if (probe_registry_ != nullptr && interval_jitter_percent == 0 && interval_jitter.count() == 0) {
+    interval_jitter_percent = SHARED_PROBE_INTERVAL_JITTER_PERCENT;
+  }
+  const uint64_t jitter_percent_mod = interval_jitter_percent * base_time_ms / 100;
   if (jitter_percent_mod > 0) {
     base_time_ms += random_.random() % jitter_percent_mod;
   }
@@ -173,6 +183,22 @@ void HealthCheckerImplBase::onClusterMemberUpdate(const HostVector& hosts_added,
   }
 }
 
+std::string HealthCheckerImplBase::probeKey(const HostSharedPtr& host) const {
+  // Health check connections use the transport socket and socket options of the cluster of the
+  // host, so only probes over plaintext connections without cluster specific options are shared.
+  if (transport_socket_match_metadata_ != nullptr ||
+      cluster_.info()->clusterSocketOptions() != nullptr ||
+      dynamic_cast<const Network::RawBufferSocketFactory*>(&host->transportSocketFactory()) ==
+          nullptr) {
+    return EMPTY_STRING;
+  }
+
+  const Network::Address::InstanceConstSharedPtr& source_address = cluster_.info()->sourceAddress();
+  return absl::StrCat(config_hash_, "|", host->healthCheckAddress()->asString(), "|",
+                      source_address != nullptr ? source_address->asString() : EMPTY_STRING, "|",
+                      probeAuthority(host));
+}
+
 void HealthCheckerImplBase::runCallbacks(HostSharedPtr host, HealthTransition changed_state) {
   for (const HostStatusCb& cb : callbacks_) {
     cb(host, changed_state);
@@ -238,9 +264,58 @@ HealthCheckerImplBase::ActiveHealthCheckSession::~ActiveHealthCheckSession() {
   ASSERT(interval_timer_ == nullptr && timeout_timer_ == nullptr);
 }
 
+void HealthCheckerImplBase::ActiveHealthCheckSession::start() {
+  if (parent_.probe_registry_ != nullptr) {
+    probe_key_ = parent_.probeKey(host_);
+    if (!probe_key_.empty()) {
+      probing_ = parent_.probe_registry_->subscribe(probe_key_, *this);
+    }
+  }
+
+  if (!probing_) {
+    // Catch up with the latest result of the probe run by another health checker rather than
+    // waiting for its next probe, which may be a no traffic interval away.
+    interval_timer_->enableTimer(std::chrono::milliseconds(0));
+    return;
+  }
+  onInitialInterval();
+}
+
+void HealthCheckerImplBase::ActiveHealthCheckSession::onProbeOwner() {
+  probing_ = true;
+  const HealthState state = host_->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)
+                                ? HealthState::Unhealthy
+                                : HealthState::Healthy;
+  interval_timer_->enableTimer(parent_.interval(state, HealthTransition::Unchanged));
+}
+
+std::chrono::milliseconds HealthCheckerImplBase::ActiveHealthCheckSession::onProbeResult(
+    const HealthCheckProbeResult& result) {
+  if (result.healthy_) {
+    return parent_.interval(HealthState::Healthy, setHealthy(result.degraded_));
+  }
+  return parent_.interval(HealthState::Unhealthy, setUnhealthy(result.failure_type_));
+}
+
+std::chrono::milliseconds HealthCheckerImplBase::ActiveHealthCheckSession::publishResult(
+    const HealthCheckProbeResult& result, std::chrono::milliseconds interval) {
+  if (probe_key_.empty()) {
+    return interval;
+  }
+
+  // The endpoint is probed as often as the most demanding of the health checkers sharing it wants.
+  const absl::optional<std::chrono::milliseconds> shared_interval =
+      parent_.probe_registry_->publish(probe_key_, result);
+  return shared_interval.has_value() ? std::min(interval, shared_interval.value()) : interval;
+}
+
 void HealthCheckerImplBase::ActiveHealthCheckSession::onDeferredDeleteBase() {
   // The session is about to be deferred deleted. Make sure all timers are gone and any
   // implementation specific state is destroyed.
+  if (!probe_key_.empty()) {
+    parent_.probe_registry_->unsubscribe(probe_key_, *this);
+    probe_key_.clear();
+  }
   interval_timer_.reset();
   timeout_timer_.reset();
   if (!host_->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)) {
@@ -253,6 +328,19 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::onDeferredDeleteBase() {
 }
 
 void HealthCheckerImplBase::ActiveHealthCheckSession::handleSuccess(bool degraded) {
+  const HealthTransition changed_state = setHealthy(degraded);
+  timeout_timer_->disableTimer();
+
+  const std::chrono::milliseconds interval =
+      publishResult({true, degraded, envoy::data::core::v3::ACTIVE},
+                    parent_.interval(HealthState::Healthy, changed_state));
+  // Sessions sharing the probe may have caused this session to be deferred deleted.
+  if (interval_timer_ != nullptr) {
+    interval_timer_->enableTimer(interval);
+  }
+}
+
+HealthTransition HealthCheckerImplBase::ActiveHealthCheckSession::setHealthy(bool degraded) {
   // If we are healthy, reset the # of unhealthy to zero.
   num_unhealthy_ = 0;
 
@@ -300,9 +388,7 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::handleSuccess(bool degrade
   parent_.stats_.success_.inc();
   first_check_ = false;
   parent_.runCallbacks(host_, changed_state);
-
-  timeout_timer_->disableTimer();
-  interval_timer_->enableTimer(parent_.interval(HealthState::Healthy, changed_state));
+  return changed_state;
 }
 
 HealthTransition HealthCheckerImplBase::ActiveHealthCheckSession::setUnhealthy(
@@ -352,7 +438,12 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::handleFailure(
   }
 
   if (interval_timer_ != nullptr) {
-    interval_timer_->enableTimer(parent_.interval(HealthState::Unhealthy, changed_state));
+    const std::chrono::milliseconds interval = publishResult(
+        {false, false, type}, parent_.interval(HealthState::Unhealthy, changed_state));
+    // Sessions sharing the probe may also have caused this session to be deferred deleted.
+    if (interval_timer_ != nullptr) {
+      interval_timer_->enableTimer(interval);
+    }
   }
 }
 
@@ -369,6 +460,14 @@ HealthCheckerImplBase::ActiveHealthCheckSession::clearPendingFlag(HealthTransiti
 }
 
 void HealthCheckerImplBase::ActiveHealthCheckSession::onIntervalBase() {
+  if (!probing_) {
+    const HealthCheckProbeResult* result = parent_.probe_registry_->lastResult(probe_key_);
+    if (result != nullptr) {
+      onProbeResult(*result);
+    }
+    return;
+  }
+
   onInterval();
   timeout_timer_->enableTimer(parent_.timeout_);
   parent_.stats_.attempt_.inc();
@@ -388,6 +487,60 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::onInitialInterval() {
   }
 }
 
+bool HealthCheckProbeRegistry::subscribe(const std::string& key, Subscriber& subscriber) {
+  std::list<Subscriber*>& subscribers = probes_[key].subscribers_;
+  subscribers.push_back(&subscriber);
+  return subscribers.size() == 1;
+}
+
+void HealthCheckProbeRegistry::unsubscribe(const std::string& key, Subscriber& subscriber) {
+  auto probe = probes_.find(key);
+  ASSERT(probe != probes_.end());
+  std::list<Subscriber*>& subscribers = probe->second.subscribers_;
+  const bool probing = subscribers.front() == &subscriber;
+  subscribers.remove(&subscriber);
+  if (subscribers.empty()) {
+    probes_.erase(probe);
+  } else if (probing) {
+    subscribers.front()->onProbeOwner();
+  }
+}
+
+absl::optional<std::chrono::milliseconds>
+HealthCheckProbeRegistry::publish(const std::string& key, const HealthCheckProbeResult& result) {
+  auto probe = probes_.find(key);
+  ASSERT(probe != probes_.end());
+  probe->second.last_result_ = result;
+
+  // Delivering a result runs the host status callbacks of the subscriber, which may remove hosts
+  // and so unsubscribe other subscribers. Only those still subscribed receive the result.
+  const std::vector<Subscriber*> subscribers(std::next(probe->second.subscribers_.begin()),
+                                             probe->second.subscribers_.end());
+  absl::optional<std::chrono::milliseconds> interval;
+  for (Subscriber* subscriber : subscribers) {
+    probe = probes_.find(key);
+    if (probe == probes_.end()) {
+      break;
+    }
+    const std::list<Subscriber*>& current = probe->second.subscribers_;
+    if (std::find(current.begin(), current.end(), subscriber) == current.end()) {
+      continue;
+    }
+    const std::chrono::milliseconds subscriber_interval = subscriber->onProbeResult(result);
+    interval = interval.has_value() ? std::min(interval.value(), subscriber_interval)
+                                    : subscriber_interval;
+  }
+  return interval;
+}
+
+const HealthCheckProbeResult* HealthCheckProbeRegistry::lastResult(const std::string& key) const {
+  const auto probe = probes_.find(key);
+  if (probe == probes_.end() || !probe->second.last_result_.has_value()) {
+    return nullptr;
+  }
+  return &probe->second.last_result_.value();
+}
+
 void HealthCheckEventLoggerImpl::logEjectUnhealthy(
     envoy::data::core::v3::HealthCheckerType health_checker_type,
     const HostDescriptionConstSharedPtr& host,
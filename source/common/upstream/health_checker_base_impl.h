@@ -6,6 +6,7 @@
 #include "envoy/data/core/v3/health_check_event.pb.h"
 #include "envoy/event/timer.h"
 #include "envoy/runtime/runtime.h"
+#include "envoy/singleton/instance.h"
 #include "envoy/stats/scope.h"
 #include "envoy/type/matcher/string.pb.h"
 #include "envoy/upstream/health_checker.h"
@@ -14,6 +15,9 @@
 #include "common/common/matchers.h"
 #include "common/network/transport_socket_options_impl.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -37,6 +41,80 @@ struct HealthCheckerStats {
   ALL_HEALTH_CHECKER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
 };
 
+/**
+ * The result of an active health check probe of an endpoint.
+ */
+struct HealthCheckProbeResult {
+  bool healthy_;
+  bool degraded_;
+  envoy::data::core::v3::HealthCheckFailureType failure_type_;
+};
+
+/**
+ * Shares active health check probes of endpoints between the health checkers of clusters whose
+ * health check config is identical. Each endpoint is probed only by the first subscriber of its
+ * probe key, and the results of its probes are delivered to the other subscribers. When the probing
+ * subscriber goes away the next one takes over. Only used on the main thread.
+ */
+class HealthCheckProbeRegistry : public Singleton::Instance {
+public:
+  class Subscriber {
+  public:
+    virtual ~Subscriber() = default;
+
+    /**
+     * Called when the subscriber takes over probing the endpoint from a subscriber which went away.
+     */
+    virtual void onProbeOwner() PURE;
+
+    /**
+     * Called with the result of a probe by another subscriber.
+     * @return the interval after which the subscriber wants the endpoint to be probed next.
+     */
+    virtual std::chrono::milliseconds onProbeResult(const HealthCheckProbeResult& result) PURE;
+  };
+
+  /**
+   * Subscribes to the probe of key.
+   * @return true if the subscriber is the first one, which probes the endpoint.
+   */
+  bool subscribe(const std::string& key, Subscriber& subscriber);
+
+  /**
+   * Unsubscribes from the probe of key, handing the probe over to the next subscriber if this one
+   * was probing.
+   */
+  void unsubscribe(const std::string& key, Subscriber& subscriber);
+
+  /**
+   * Delivers the result of a probe of key to all subscribers but the probing one.
+   * @return the shortest interval wanted by those subscribers, if there are any.
+   */
+  absl::optional<std::chrono::milliseconds> publish(const std::string& key,
+                                                    const HealthCheckProbeResult& result);
+
+  /**
+   * @return the result of the latest probe of key, or nullptr if there is none yet.
+   */
+  const HealthCheckProbeResult* lastResult(const std::string& key) const;
+
+  /**
+   * @return the number of distinct probes, which is the number of endpoints actually probed.
+   */
+  size_t numProbes() const { return probes_.size(); }
+
+private:
+  struct Probe {
+    // The front subscriber probes the endpoint.
+    std::list<Subscriber*> subscribers_;
+    absl::optional<HealthCheckProbeResult> last_result_;
+  };
+
+  absl::flat_hash_map<std::string, Probe> probes_;
+};
+
+using HealthCheckProbeRegistrySharedPtr = std::shared_ptr<HealthCheckProbeRegistry>;
+
 /**
  * Base implementation for all health checkers.
  */
@@ -47,6 +125,13 @@ public:
   // Upstream::HealthChecker
   void addHostCheckCompleteCb(HostStatusCb callback) override { callbacks_.push_back(callback); }
   void start() override;
+  /**
+   * Shares the probes of this health checker with those of other health checkers with identical
+   * config through registry. Must be called before start().
+   */
+  void shareProbes(HealthCheckProbeRegistrySharedPtr registry) {
+    probe_registry_ = std::move(registry);
+  }
   std::shared_ptr<const Network::TransportSocketOptionsImpl> transportSocketOptions() const {
     return transport_socket_options_;
   }
@@ -55,12 +140,17 @@ public:
   }
 
 protected:
-  class ActiveHealthCheckSession : public Event::DeferredDeletable {
+  class ActiveHealthCheckSession : public Event::DeferredDeletable,
+                                   public HealthCheckProbeRegistry::Subscriber {
   public:
     ~ActiveHealthCheckSession() override;
     HealthTransition setUnhealthy(envoy::data::core::v3::HealthCheckFailureType type);
     void onDeferredDeleteBase();
-    void start() { onInitialInterval(); }
+    void start();
+
+    // HealthCheckProbeRegistry::Subscriber
+    void onProbeOwner() override;
+    std::chrono::milliseconds onProbeResult(const HealthCheckProbeResult& result) override;
 
   protected:
     ActiveHealthCheckSession(HealthCheckerImplBase& parent, HostSharedPtr host);
@@ -76,6 +166,11 @@ protected:
     // been health checked.
     // Returns the changed state to use following the flag update.
     HealthTransition clearPendingFlag(HealthTransition changed_state);
+    HealthTransition setHealthy(bool degraded);
+    // Publishes the result of a probe to the sessions sharing it, and returns the interval after
+    // which the endpoint is probed next.
+    std::chrono::milliseconds publishResult(const HealthCheckProbeResult& result,
+                                            std::chrono::milliseconds interval);
     virtual void onInterval() PURE;
     void onIntervalBase();
     virtual void onTimeout() PURE;
@@ -89,6 +184,11 @@ protected:
     uint32_t num_unhealthy_{};
     uint32_t num_healthy_{};
     bool first_check_{true};
+    // The key of the probe shared with sessions of other health checkers, or empty if the probe
+    // is not shared.
+    std::string probe_key_;
+    // False while the shared probe is run by the session of another health checker.
+    bool probing_{true};
   };
 
   using ActiveHealthCheckSessionPtr = std::unique_ptr<ActiveHealthCheckSession>;
@@ -100,6 +200,8 @@ protected:
 
   virtual ActiveHealthCheckSessionPtr makeSession(HostSharedPtr host) PURE;
   virtual envoy::data::core::v3::HealthCheckerType healthCheckerType() const PURE;
+  // Returns the authority sent in probes of host, which is part of the probe key.
+  virtual std::string probeAuthority(const HostSharedPtr&) const { return {}; }
 
   const bool always_log_health_check_failures_;
   const Cluster& cluster_;
@@ -136,6 +238,9 @@ private:
   std::chrono::milliseconds intervalWithJitter(uint64_t base_time_ms,
                                                std::chrono::milliseconds interval_jitter) const;
   void onClusterMemberUpdate(const HostVector& hosts_added, const HostVector& hosts_removed);
+  // Returns the key of the probe of host shared with other health checkers, or an empty string if
+  // probes of host are not shared.
+  std::string probeKey(const HostSharedPtr& host) const;
   void runCallbacks(HostSharedPtr host, HealthTransition changed_state);
   void setUnhealthyCrossThread(const HostSharedPtr& host);
   static std::shared_ptr<const Network::TransportSocketOptionsImpl>
@@ -144,6 +249,9 @@ private:
   initTransportSocketMatchMetadata(const envoy::config::core::v3::HealthCheck& config);
 
   static const std::chrono::milliseconds NO_TRAFFIC_INTERVAL;
+  // Jitter applied to the intervals of health checkers sharing probes whose config does not set
+  // any, so that the probes of many endpoints started together do not stay in lockstep.
+  static constexpr uint32_t SHARED_PROBE_INTERVAL_JITTER_PERCENT = 10;
 
   std::list<HostStatusCb> callbacks_;
   const std::chrono::milliseconds interval_;
@@ -157,6 +265,8 @@ private:
   absl::node_hash_map<HostSharedPtr, ActiveHealthCheckSessionPtr> active_sessions_;
   const std::shared_ptr<const Network::TransportSocketOptionsImpl> transport_socket_options_;
   const MetadataConstSharedPtr transport_socket_match_metadata_;
+  const uint64_t config_hash_;
+  HealthCheckProbeRegistrySharedPtr probe_registry_;
 };
 
 class HealthCheckEventLoggerImpl : public HealthCheckEventLogger {
@@ -91,26 +91,31 @@ HealthCheckerSharedPtr HealthCheckerFactory::create(
     const envoy::config::core::v3::HealthCheck& health_check_config, Upstream::Cluster& cluster,
     Runtime::Loader& runtime, Random::RandomGenerator& random, Event::Dispatcher& dispatcher,
     AccessLog::AccessLogManager& log_manager,
-    ProtobufMessage::ValidationVisitor& validation_visitor, Api::Api& api) {
+    ProtobufMessage::ValidationVisitor& validation_visitor, Api::Api& api,
+    HealthCheckProbeRegistrySharedPtr probe_registry) {
   HealthCheckEventLoggerPtr event_logger;
   if (!health_check_config.event_log_path().empty()) {
     event_logger = std::make_unique<HealthCheckEventLoggerImpl>(
         log_manager, dispatcher.timeSource(), health_check_config.event_log_path());
   }
+  std::shared_ptr<HealthCheckerImplBase> health_checker;
   switch (health_check_config.health_checker_case()) {
   case envoy::config::core::v3::HealthCheck::HealthCheckerCase::kHttpHealthCheck:
-    return std::make_shared<ProdHttpHealthCheckerImpl>(cluster, health_check_config, dispatcher,
-                                                       runtime, random, std::move(event_logger));
+    health_checker = std::make_shared<ProdHttpHealthCheckerImpl>(
+        cluster, health_check_config, dispatcher, runtime, random, std::move(event_logger));
+    break;
   case envoy::config::core::v3::HealthCheck::HealthCheckerCase::kTcpHealthCheck:
-    return std::make_shared<TcpHealthCheckerImpl>(cluster, health_check_config, dispatcher, runtime,
-                                                  random, std::move(event_logger));
+    health_checker = std::make_shared<TcpHealthCheckerImpl>(
+        cluster, health_check_config, dispatcher, runtime, random, std::move(event_logger));
+    break;
   case envoy::config::core::v3::HealthCheck::HealthCheckerCase::kGrpcHealthCheck:
     if (!(cluster.info()->features() & Upstream::ClusterInfo::Features::HTTP2)) {
       throw EnvoyException(fmt::format("{} cluster must support HTTP/2 for gRPC healthchecking",
                                        cluster.info()->name()));
     }
-    return std::make_shared<ProdGrpcHealthCheckerImpl>(cluster, health_check_config, dispatcher,
-                                                       runtime, random, std::move(event_logger));
+    health_checker = std::make_shared<ProdGrpcHealthCheckerImpl>(
+        cluster, health_check_config, dispatcher, runtime, random, std::move(event_logger));
+    break;
   case envoy::config::core::v3::HealthCheck::HealthCheckerCase::kCustomHealthCheck: {
     auto& factory =
         Config::Utility::getAndCheckFactory<Server::Configuration::CustomHealthCheckerFactory>(
@@ -124,6 +129,11 @@ HealthCheckerSharedPtr HealthCheckerFactory::create(
     // Checked by schema.
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
+
+  if (probe_registry != nullptr) {
+    health_checker->shareProbes(std::move(probe_registry));
+  }
+  return health_checker;
 }
 
 HttpHealthCheckerImpl::HttpHealthCheckerImpl(const Cluster& cluster,
@@ -155,6 +165,10 @@ HttpHealthCheckerImpl::HttpHealthCheckerImpl(const Cluster& cluster,
   }
 }
 
+std::string HttpHealthCheckerImpl::probeAuthority(const HostSharedPtr& host) const {
+  return getHostname(host, host_value_, cluster_.info());
+}
+
 HttpHealthCheckerImpl::HttpStatusChecker::HttpStatusChecker(
     const Protobuf::RepeatedPtrField<envoy::type::v3::Int64Range>& expected_statuses,
     uint64_t default_expected_status) {
@@ -558,6 +572,10 @@ GrpcHealthCheckerImpl::GrpcHealthCheckerImpl(const Cluster& cluster,
   }
 }
 
+std::string GrpcHealthCheckerImpl::probeAuthority(const HostSharedPtr& host) const {
+  return getHostname(host, authority_value_, cluster_.info());
+}
+
 GrpcHealthCheckerImpl::GrpcActiveHealthCheckSession::GrpcActiveHealthCheckSession(
     GrpcHealthCheckerImpl& parent, const HostSharedPtr& host)
     : ActiveHealthCheckSession(parent, host), parent_(parent) {}
@@ -36,13 +36,16 @@ public:
    * @param log_manager supplies the log_manager.
    * @param validation_visitor message validation visitor instance.
    * @param api reference to the Api object
+   * @param probe_registry supplies the registry through which HTTP, TCP and gRPC health checkers
+   *        share probes with those of other clusters, or nullptr if probes are not shared.
    * @return a health checker.
    */
   static HealthCheckerSharedPtr
   create(const envoy::config::core::v3::HealthCheck& health_check_config,
          Upstream::Cluster& cluster, Runtime::Loader& runtime, Random::RandomGenerator& random,
          Event::Dispatcher& dispatcher, AccessLog::AccessLogManager& log_manager,
-         ProtobufMessage::ValidationVisitor& validation_visitor, Api::Api& api);
+         ProtobufMessage::ValidationVisitor& validation_visitor, Api::Api& api,
+         HealthCheckProbeRegistrySharedPtr probe_registry);
 };
 
 /**
@@ -140,6 +143,7 @@ private:
   envoy::data::core::v3::HealthCheckerType healthCheckerType() const override {
     return envoy::data::core::v3::HTTP;
   }
+  std::string probeAuthority(const HostSharedPtr& host) const override;
 
   Http::CodecClient::Type codecClientType(const envoy::type::v3::CodecClientType& type);
 
@@ -374,6 +378,7 @@ private:
   envoy::data::core::v3::HealthCheckerType healthCheckerType() const override {
     return envoy::data::core::v3::GRPC;
   }
+  std::string probeAuthority(const HostSharedPtr& host) const override;
 
   const Protobuf::MethodDescriptor& service_method_;
   absl::optional<std::string> service_name_;
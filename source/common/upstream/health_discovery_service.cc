@@ -341,7 +341,8 @@ void HdsCluster::startHealthchecks(AccessLog::AccessLogManager& access_log_manag
   for (auto& health_check : cluster_.health_checks()) {
     health_checkers_.push_back(
         Upstream::HealthCheckerFactory::create(health_check, *this, runtime, random, dispatcher,
-                                               access_log_manager, validation_visitor_, api));
+                                               access_log_manager, validation_visitor_, api,
+                                               nullptr));
     health_checkers_.back()->start();
   }
 }
@@ -11,6 +11,7 @@
 
 #include "common/common/assert.h"
 #include "common/protobuf/utility.h"
+#include "common/runtime/runtime_features.h"
 
 #include "absl/container/fixed_array.h"
 
@@ -701,9 +702,9 @@ EdfLoadBalancerBase::EdfLoadBalancerBase(
       seed_(random_.random()) {
   // We fully recompute the schedulers for a given host set here on membership change, which is
   // consistent with what other LB implementations do (e.g. thread aware).
-  // The downside of a full recompute is that time complexity is O(n * log n),
-  // so we will need to do better at delta tracking to scale (see
-  // https://github.com/envoyproxy/envoy/issues/2874).
+  // The downside of a full recompute is that time complexity is O(n * log n), so when
+  // envoy.reloadable_features.edf_lb_incremental_refresh is enabled the existing schedulers are
+  // instead updated in place (see https://github.com/envoyproxy/envoy/issues/2874).
   priority_set.addPriorityUpdateCb(
       [this](uint32_t priority, const HostVector&, const HostVector&) { refresh(priority); });
 }
@@ -715,9 +716,10 @@ void EdfLoadBalancerBase::initialize() {
 }
 
 void EdfLoadBalancerBase::refresh(uint32_t priority) {
-  const auto add_hosts_source = [this](HostsSource source, const HostVector& hosts) {
-    // Nuke existing scheduler if it exists.
-    auto& scheduler = scheduler_[source] = Scheduler{};
+  const bool incremental =
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.edf_lb_incremental_refresh");
+  const auto add_hosts_source = [this, incremental](HostsSource source, const HostVector& hosts) {
+    auto& scheduler = scheduler_[source];
     refreshHostSource(source);
 
     // Check if the original host weights are equal and skip EDF creation if they are. When all
@@ -725,10 +727,23 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
     // least-loaded host selection with lower memory and CPU overhead.
     if (hostWeightsAreEqual(hosts)) {
       // Skip edf creation.
+      scheduler.edf_ = nullptr;
       return;
     }
 
-    scheduler.edf_ = std::make_unique<EdfScheduler<const Host>>();
+    const auto calculate_weight = [this](const Host& host) { return hostWeight(host); };
+
+    // When the scheduler already exists, bring it in line with the new host list and weights
+    // rather than rebuilding it, so that an update costs time in proportion to the number of
+    // hosts which changed and the hosts which did not keep their place in the schedule.
+    if (incremental && scheduler.edf_ != nullptr && scheduler.edf_->indexed()) {
+      scheduler.edf_->refresh(hosts, calculate_weight);
+      return;
+    }
+
+    // Nuke existing scheduler if it exists. Only a scheduler which is refreshed in place needs to
+    // index its hosts.
+    scheduler.edf_ = std::make_unique<EdfScheduler<const Host>>(incremental);
 
     // Populate scheduler with host list.
     // TODO(mattklein123): We must build the EDF schedule even if all of the hosts are currently
@@ -748,8 +763,7 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
     // refreshes for the weighted case.
     if (!hosts.empty()) {
       for (uint32_t i = 0; i < seed_ % hosts.size(); ++i) {
-        auto host = scheduler.edf_->pick();
-        scheduler.edf_->add(hostWeight(*host), host);
+        scheduler.edf_->pickAndAdd(calculate_weight);
       }
     }
   };
@@ -791,11 +805,7 @@ HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* cont
   // whether to use EDF or do unweighted (fast) selection. EDF is non-null iff the original weights
   // of 2 or more hosts differ.
   if (scheduler.edf_ != nullptr) {
-    auto host = scheduler.edf_->pick();
-    if (host != nullptr) {
-      scheduler.edf_->add(hostWeight(*host), host);
-    }
-    return host;
+    return scheduler.edf_->pickAndAdd([this](const Host& host) { return hostWeight(host); });
   } else {
     const HostVector& hosts_to_use = hostSourceToHosts(*hosts_source);
     if (hosts_to_use.empty()) {
@@ -805,6 +815,23 @@ HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* cont
   }
 }
 
+HostConstSharedPtr LeastRequestLoadBalancer::chooseHostOnce(LoadBalancerContext* context) {
+  HostConstSharedPtr host = EdfLoadBalancerBase::chooseHostOnce(context);
+  if (use_outstanding_requests_ && host != nullptr) {
+    // The cluster stats count the requests of all priorities, so take the mean over all hosts.
+    const uint64_t cluster_outstanding_requests =
+        stats_.upstream_rq_active_.value() + stats_.upstream_rq_pending_active_.value();
+    uint64_t num_hosts = 0;
+    for (const auto& host_set : priority_set_.hostSetsPerPriority()) {
+      num_hosts += host_set->hosts().size();
+    }
+    if (host->outstandingRequests() * num_hosts > cluster_outstanding_requests) {
+      stats_.lb_least_request_above_mean_.inc();
+    }
+  }
+  return host;
+}
+
 HostConstSharedPtr LeastRequestLoadBalancer::unweightedHostPick(const HostVector& hosts_to_use,
                                                                 const HostsSource&) {
   HostSharedPtr candidate_host = nullptr;
@@ -818,8 +845,8 @@ HostConstSharedPtr LeastRequestLoadBalancer::unweightedHostPick(const HostVector
       continue;
     }
 
-    const auto candidate_active_rq = candidate_host->stats().rq_active_.value();
-    const auto sampled_active_rq = sampled_host->stats().rq_active_.value();
+    const auto candidate_active_rq = activeRequests(*candidate_host);
+    const auto sampled_active_rq = activeRequests(*sampled_host);
     if (sampled_active_rq < candidate_active_rq) {
       candidate_host = sampled_host;
     }
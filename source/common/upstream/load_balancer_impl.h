@@ -14,6 +14,7 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/protobuf/utility.h"
+#include "common/runtime/runtime_features.h"
 #include "common/runtime/runtime_protos.h"
 #include "common/upstream/edf_scheduler.h"
 
@@ -441,6 +442,13 @@ private:
  * 2) Use a weighted Maglev table, and perform P2C on two random hosts selected from the table.
  *    The benefit of the Maglev table is at the expense of resolution, memory usage is capped.
  *    Additionally, the Maglev table can be shared amongst all threads.
+ *
+ * By default the number of active requests of a host is its rq_active stat, which only counts a
+ * request once it is attached to a connection. When the
+ * envoy.reloadable_features.least_request_outstanding_requests runtime feature is enabled,
+ * Host::outstandingRequests() is used instead, which also counts the requests queued in connection
+ * pools. As it is shared by all workers and counts requests from the moment they are handed to a
+ * pool, workers no longer herd onto the same hosts while connections are being established.
  */
 class LeastRequestLoadBalancer : public EdfLoadBalancerBase,
                                  Logger::Loggable<Logger::Id::upstream> {
@@ -465,8 +473,13 @@ public:
     initialize();
   }
 
+  // Upstream::LoadBalancerBase
+  HostConstSharedPtr chooseHostOnce(LoadBalancerContext* context) override;
+
 protected:
   void refresh(uint32_t priority) override {
+    use_outstanding_requests_ = Runtime::runtimeFeatureEnabled(
+        "envoy.reloadable_features.least_request_outstanding_requests");
     active_request_bias_ =
         active_request_bias_runtime_ != nullptr ? active_request_bias_runtime_->value() : 1.0;
 
@@ -504,14 +517,17 @@ private:
     }
 
     if (active_request_bias_ == 1.0) {
-      return static_cast<double>(host.weight()) / (host.stats().rq_active_.value() + 1);
+      return static_cast<double>(host.weight()) / (activeRequests(host) + 1);
     }
 
     return static_cast<double>(host.weight()) /
-           std::pow(host.stats().rq_active_.value() + 1, active_request_bias_);
+           std::pow(activeRequests(host) + 1, active_request_bias_);
   }
   HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
                                         const HostsSource& source) override;
+  uint64_t activeRequests(const Host& host) const {
+    return use_outstanding_requests_ ? host.outstandingRequests() : host.stats().rq_active_.value();
+  }
 
   const uint32_t choice_count_;
 
@@ -520,6 +536,9 @@ private:
   // whenever a `HostSet` is updated.
   double active_request_bias_{};
 
+  // Whether to use Host::outstandingRequests(), cached like active_request_bias_.
+  bool use_outstanding_requests_{};
+
   const std::unique_ptr<Runtime::Double> active_request_bias_runtime_;
 };
 
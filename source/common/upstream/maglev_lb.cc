@@ -104,12 +104,16 @@ MaglevLoadBalancer::MaglevLoadBalancer(
     Runtime::Loader& runtime, Random::RandomGenerator& random,
     const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config, uint64_t table_size)
     : ThreadAwareLoadBalancerBase(priority_set, stats, runtime, random, common_config),
-      scope_(scope.createScope("maglev_lb.")), stats_(generateStats(*scope_)),
-      table_size_(table_size),
-      use_hostname_for_hashing_(
+      table_factory_(std::make_shared<TableFactory>(
+          scope, table_size,
           common_config.has_consistent_hashing_lb_config()
               ? common_config.consistent_hashing_lb_config().use_hostname_for_hashing()
-              : false) {}
+              : false)) {}
+
+MaglevLoadBalancer::TableFactory::TableFactory(Stats::Scope& scope, uint64_t table_size,
+                                               bool use_hostname_for_hashing)
+    : scope_(scope.createScope("maglev_lb.")), stats_(generateStats(*scope_)),
+      table_size_(table_size), use_hostname_for_hashing_(use_hostname_for_hashing) {}
 
 MaglevLoadBalancerStats MaglevLoadBalancer::generateStats(Stats::Scope& scope) {
   return {ALL_MAGLEV_LOAD_BALANCER_STATS(POOL_GAUGE(scope))};
@@ -75,23 +75,36 @@ public:
                      const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config,
                      uint64_t table_size = MaglevTable::DefaultTableSize);
 
-  const MaglevLoadBalancerStats& stats() const { return stats_; }
+  const MaglevLoadBalancerStats& stats() const { return table_factory_->stats_; }
 
 private:
+  struct TableFactory : public HashingLoadBalancerFactory {
+    TableFactory(Stats::Scope& scope, uint64_t table_size, bool use_hostname_for_hashing);
+
+    // ThreadAwareLoadBalancerBase::HashingLoadBalancerFactory
+    HashingLoadBalancerSharedPtr
+    createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
+                       double /* min_normalized_weight */,
+                       double max_normalized_weight) const override {
+      return std::make_shared<MaglevTable>(normalized_host_weights, max_normalized_weight,
+                                           table_size_, use_hostname_for_hashing_, stats_);
+    }
+
+    Stats::ScopePtr scope_;
+    // Set by the tables on creation.
+    mutable MaglevLoadBalancerStats stats_;
+    const uint64_t table_size_;
+    const bool use_hostname_for_hashing_;
+  };
+
   // ThreadAwareLoadBalancerBase
-  HashingLoadBalancerSharedPtr
-  createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
-                     double /* min_normalized_weight */, double max_normalized_weight) override {
-    return std::make_shared<MaglevTable>(normalized_host_weights, max_normalized_weight,
-                                         table_size_, use_hostname_for_hashing_, stats_);
+  HashingLoadBalancerFactorySharedPtr hashingLoadBalancerFactory() const override {
+    return table_factory_;
   }
 
   static MaglevLoadBalancerStats generateStats(Stats::Scope& scope);
 
-  Stats::ScopePtr scope_;
-  MaglevLoadBalancerStats stats_;
-  const uint64_t table_size_;
-  const bool use_hostname_for_hashing_;
+  const std::shared_ptr<const TableFactory> table_factory_;
 };
 
 } // namespace Upstream
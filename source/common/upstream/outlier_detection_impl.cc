@@ -1,6 +1,7 @@
 #include "common/upstream/outlier_detection_impl.h"
 
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -305,7 +306,7 @@ void DetectorImpl::initialize(const Cluster& cluster) {
             ejections_active_helper_.dec();
           }
 
-          host_monitors_.erase(host);
+          removeHostMonitor(host);
         }
       });
 
@@ -316,9 +317,26 @@ void DetectorImpl::addHostMonitor(HostSharedPtr host) {
   ASSERT(host_monitors_.count(host) == 0);
   DetectorHostMonitorImpl* monitor = new DetectorHostMonitorImpl(shared_from_this(), host);
   host_monitors_[host] = monitor;
+  monitor->columnIndex(column_hosts_.size());
+  column_hosts_.push_back(host);
+  column_monitors_.push_back(monitor);
   host->setOutlierDetector(DetectorHostMonitorPtr{monitor});
 }
 
+void DetectorImpl::removeHostMonitor(const HostSharedPtr& host) {
+  const auto monitor = host_monitors_.find(host);
+  ASSERT(monitor != host_monitors_.end());
+  const size_t index = monitor->second->columnIndex();
+  if (index != column_hosts_.size() - 1) {
+    column_hosts_[index] = std::move(column_hosts_.back());
+    column_monitors_[index] = column_monitors_.back();
+    column_monitors_[index]->columnIndex(index);
+  }
+  column_hosts_.pop_back();
+  column_monitors_.pop_back();
+  host_monitors_.erase(monitor);
+}
+
 void DetectorImpl::armIntervalTimer() {
   interval_timer_->enableTimer(std::chrono::milliseconds(
       runtime_.snapshot().getInteger("outlier_detection.interval_ms", config_.intervalMs())));
@@ -553,8 +571,48 @@ void DetectorImpl::onConsecutiveErrorWorker(
   }
 }
 
+namespace {
+
+// Sums values into independent partial sums, so that the compiler may vectorize the loop without
+// having to reassociate floating point additions.
+double sum(const std::vector<double>& values) {
+  double partial_sums[4] = {};
+  size_t i = 0;
+  for (; i + 4 <= values.size(); i += 4) {
+    partial_sums[0] += values[i];
+    partial_sums[1] += values[i + 1];
+    partial_sums[2] += values[i + 2];
+    partial_sums[3] += values[i + 3];
+  }
+  for (; i < values.size(); i++) {
+    partial_sums[0] += values[i];
+  }
+  return (partial_sums[0] + partial_sums[1]) + (partial_sums[2] + partial_sums[3]);
+}
+
+// Sums the squared deviations of values from mean, in the same way as sum().
+double sumOfSquaredDeviations(const std::vector<double>& values, double mean) {
+  double partial_sums[4] = {};
+  size_t i = 0;
+  for (; i + 4 <= values.size(); i += 4) {
+    const double deviations[4] = {values[i] - mean, values[i + 1] - mean, values[i + 2] - mean,
+                                  values[i + 3] - mean};
+    partial_sums[0] += deviations[0] * deviations[0];
+    partial_sums[1] += deviations[1] * deviations[1];
+    partial_sums[2] += deviations[2] * deviations[2];
+    partial_sums[3] += deviations[3] * deviations[3];
+  }
+  for (; i < values.size(); i++) {
+    const double deviation = values[i] - mean;
+    partial_sums[0] += deviation * deviation;
+  }
+  return (partial_sums[0] + partial_sums[1]) + (partial_sums[2] + partial_sums[3]);
+}
+
+} // namespace
+
 DetectorImpl::EjectionPair DetectorImpl::successRateEjectionThreshold(
-    double success_rate_sum, const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
+    double success_rate_sum, const std::vector<double>& valid_success_rates,
     double success_rate_stdev_factor) {
   // This function is using mean and standard deviation as statistical measures for outlier
   // detection. First the mean is calculated by dividing the sum of success rate data over the
@@ -571,14 +629,10 @@ DetectorImpl::EjectionPair DetectorImpl::successRateEjectionThreshold(
   // variance = 400
   // stdev = 20
   // threshold returned = 52
-  double mean = success_rate_sum / valid_success_rate_hosts.size();
-  double variance = 0;
-  std::for_each(valid_success_rate_hosts.begin(), valid_success_rate_hosts.end(),
-                [&variance, mean](HostSuccessRatePair v) {
-                  variance += std::pow(v.success_rate_ - mean, 2);
-                });
-  variance /= valid_success_rate_hosts.size();
-  double stdev = std::sqrt(variance);
+  const double mean = success_rate_sum / valid_success_rates.size();
+  const double variance =
+      sumOfSquaredDeviations(valid_success_rates, mean) / valid_success_rates.size();
+  const double stdev = std::sqrt(variance);
 
   return {mean, (mean - (success_rate_stdev_factor * stdev))};
 }
@@ -596,10 +650,6 @@ void DetectorImpl::processSuccessRateEjections(
       runtime_.snapshot().getInteger("outlier_detection.failure_percentage_request_volume",
                                      config_.failurePercentageRequestVolume());
 
-  std::vector<HostSuccessRatePair> valid_success_rate_hosts;
-  std::vector<HostSuccessRatePair> valid_failure_percentage_hosts;
-  double success_rate_sum = 0;
-
   // Reset the Detector's success rate mean and stdev.
   getSRNums(monitor_type) = {-1, -1};
 
@@ -609,68 +659,82 @@ void DetectorImpl::processSuccessRateEjections(
     return;
   }
 
-  // reserve upper bound of vector size to avoid reallocation.
-  valid_success_rate_hosts.reserve(host_monitors_.size());
-  valid_failure_percentage_hosts.reserve(host_monitors_.size());
+  // Gather the request counts of all hosts into columns. Hosts which are already ejected are
+  // counted as having no requests, so that no work is done for them below.
+  const size_t num_hosts = column_hosts_.size();
+  success_request_counts_.resize(num_hosts);
+  total_request_counts_.resize(num_hosts);
+  success_rates_.resize(num_hosts);
+  for (size_t i = 0; i < num_hosts; i++) {
+    if (column_hosts_[i]->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
+      success_request_counts_[i] = 0;
+      total_request_counts_[i] = 0;
+      continue;
+    }
+    const SuccessRateAccumulator& accumulator =
+        column_monitors_[i]->getSRMonitor(monitor_type).successRateAccumulator();
+    success_request_counts_[i] = accumulator.successRequestCount();
+    total_request_counts_[i] = accumulator.totalRequestCount();
+  }
 
-  for (const auto& host : host_monitors_) {
-    // Don't do work if the host is already ejected.
-    if (!host.first->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
-      absl::optional<std::pair<double, uint64_t>> host_success_rate_and_volume =
-          host.second->getSRMonitor(monitor_type)
-              .successRateAccumulator()
-              .getSuccessRateAndVolume();
-
-      if (!host_success_rate_and_volume) {
-        continue;
-      }
-      double success_rate = host_success_rate_and_volume.value().first;
-      double request_volume = host_success_rate_and_volume.value().second;
+  // The success rates of hosts without requests are not used.
+  for (size_t i = 0; i < num_hosts; i++) {
+    success_rates_[i] = total_request_counts_[i] == 0
+                            ? 0
+                            : success_request_counts_[i] * 100.0 / total_request_counts_[i];
+  }
 
-      if (request_volume >=
-          std::min(success_rate_request_volume, failure_percentage_request_volume)) {
-        host.second->successRate(monitor_type, success_rate);
-      }
+  valid_success_rate_hosts_.clear();
+  valid_success_rates_.clear();
+  valid_failure_percentage_hosts_.clear();
+  const uint64_t minimum_request_volume =
+      std::min(success_rate_request_volume, failure_percentage_request_volume);
+  for (size_t i = 0; i < num_hosts; i++) {
+    const uint64_t request_volume = total_request_counts_[i];
+    if (request_volume == 0) {
+      continue;
+    }
 
-      if (request_volume >= success_rate_request_volume) {
-        valid_success_rate_hosts.emplace_back(HostSuccessRatePair(host.first, success_rate));
-        success_rate_sum += success_rate;
-      }
-      if (request_volume >= failure_percentage_request_volume) {
-        valid_failure_percentage_hosts.emplace_back(HostSuccessRatePair(host.first, success_rate));
-      }
+    if (request_volume >= minimum_request_volume) {
+      column_monitors_[i]->successRate(monitor_type, success_rates_[i]);
+    }
+
+    if (request_volume >= success_rate_request_volume) {
+      valid_success_rate_hosts_.push_back(i);
+      valid_success_rates_.push_back(success_rates_[i]);
+    }
+    if (request_volume >= failure_percentage_request_volume) {
+      valid_failure_percentage_hosts_.push_back(i);
     }
   }
 
-  if (!valid_success_rate_hosts.empty() &&
-      valid_success_rate_hosts.size() >= success_rate_minimum_hosts) {
+  if (!valid_success_rates_.empty() && valid_success_rates_.size() >= success_rate_minimum_hosts) {
     const double success_rate_stdev_factor =
         runtime_.snapshot().getInteger("outlier_detection.success_rate_stdev_factor",
                                        config_.successRateStdevFactor()) /
         1000.0;
     getSRNums(monitor_type) = successRateEjectionThreshold(
-        success_rate_sum, valid_success_rate_hosts, success_rate_stdev_factor);
+        sum(valid_success_rates_), valid_success_rates_, success_rate_stdev_factor);
     const double success_rate_ejection_threshold = getSRNums(monitor_type).ejection_threshold_;
-    for (const auto& host_success_rate_pair : valid_success_rate_hosts) {
-      if (host_success_rate_pair.success_rate_ < success_rate_ejection_threshold) {
+    for (size_t j = 0; j < valid_success_rates_.size(); j++) {
+      if (valid_success_rates_[j] < success_rate_ejection_threshold) {
         stats_.ejections_success_rate_.inc(); // Deprecated.
+        const uint32_t index = valid_success_rate_hosts_[j];
         const envoy::data::cluster::v2alpha::OutlierEjectionType type =
-            host_monitors_[host_success_rate_pair.host_]
-                ->getSRMonitor(monitor_type)
-                .getEjectionType();
+            column_monitors_[index]->getSRMonitor(monitor_type).getEjectionType();
         updateDetectedEjectionStats(type);
-        ejectHost(host_success_rate_pair.host_, type);
+        ejectHost(column_hosts_[index], type);
       }
     }
   }
 
-  if (!valid_failure_percentage_hosts.empty() &&
-      valid_failure_percentage_hosts.size() >= failure_percentage_minimum_hosts) {
+  if (!valid_failure_percentage_hosts_.empty() &&
+      valid_failure_percentage_hosts_.size() >= failure_percentage_minimum_hosts) {
     const double failure_percentage_threshold = runtime_.snapshot().getInteger(
         "outlier_detection.failure_percentage_threshold", config_.failurePercentageThreshold());
 
-    for (const auto& host_success_rate_pair : valid_failure_percentage_hosts) {
-      if ((100.0 - host_success_rate_pair.success_rate_) >= failure_percentage_threshold) {
+    for (const uint32_t index : valid_failure_percentage_hosts_) {
+      if ((100.0 - success_rates_[index]) >= failure_percentage_threshold) {
         // We should eject.
 
         // The ejection type returned by the SuccessRateMonitor's getEjectionType() will be a
@@ -680,7 +744,7 @@ void DetectorImpl::processSuccessRateEjections(
                 ? envoy::data::cluster::v2alpha::FAILURE_PERCENTAGE
                 : envoy::data::cluster::v2alpha::FAILURE_PERCENTAGE_LOCAL_ORIGIN;
         updateDetectedEjectionStats(type);
-        ejectHost(host_success_rate_pair.host_, type);
+        ejectHost(column_hosts_[index], type);
       }
     }
   }
@@ -689,15 +753,16 @@ void DetectorImpl::processSuccessRateEjections(
 void DetectorImpl::onIntervalTimer() {
   MonotonicTime now = time_source_.monotonicTime();
 
-  for (auto host : host_monitors_) {
-    checkHostForUneject(host.first, host.second, now);
+  for (size_t i = 0; i < column_hosts_.size(); i++) {
+    DetectorHostMonitorImpl* monitor = column_monitors_[i];
+    checkHostForUneject(column_hosts_[i], monitor, now);
 
     // Need to update the writer bucket to keep the data valid.
-    host.second->updateCurrentSuccessRateBucket();
+    monitor->updateCurrentSuccessRateBucket();
     // Refresh host success rate stat for the /clusters endpoint. If there is a new valid value, it
     // will get updated in processSuccessRateEjections().
-    host.second->successRate(DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin, -1);
-    host.second->successRate(DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin, -1);
+    monitor->successRate(DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin, -1);
+    monitor->successRate(DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin, -1);
   }
 
   processSuccessRateEjections(DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin);
@@ -56,16 +56,6 @@ public:
                    EventLoggerSharedPtr event_logger);
 };
 
-/**
- * Thin struct to facilitate calculations for success rate outlier detection.
- */
-struct HostSuccessRatePair {
-  HostSuccessRatePair(HostSharedPtr host, double success_rate)
-      : host_(host), success_rate_(success_rate) {}
-  HostSharedPtr host_;
-  double success_rate_;
-};
-
 struct SuccessRateAccumulatorBucket {
   std::atomic<uint64_t> success_request_counter_;
   std::atomic<uint64_t> total_request_counter_;
@@ -97,6 +87,16 @@ public:
    * requests, an invalid absl::optional<double> is returned.
    */
   absl::optional<std::pair<double, uint64_t>> getSuccessRateAndVolume();
+  /**
+   * @return the number of successful requests over the last window of time.
+   */
+  uint64_t successRequestCount() const {
+    return backup_success_rate_bucket_->success_request_counter_;
+  }
+  /**
+   * @return the number of requests over the last window of time.
+   */
+  uint64_t totalRequestCount() const { return backup_success_rate_bucket_->total_request_counter_; }
 
 private:
   std::unique_ptr<SuccessRateAccumulatorBucket> current_success_rate_bucket_;
@@ -182,12 +182,17 @@ public:
   void localOriginFailure();
   void localOriginNoFailure();
 
+  // The index of the host in the host columns of the detector.
+  size_t columnIndex() const { return column_index_; }
+  void columnIndex(size_t index) { column_index_ = index; }
+
 private:
   std::weak_ptr<DetectorImpl> detector_;
   std::weak_ptr<Host> host_;
   absl::optional<MonotonicTime> last_ejection_time_;
   absl::optional<MonotonicTime> last_unejection_time_;
   uint32_t num_ejections_{};
+  size_t column_index_{};
 
   // counters for externally generated failures
   std::atomic<uint32_t> consecutive_5xx_{0};
@@ -353,19 +358,17 @@ public:
    * This function returns pair of double values for success rate outlier detection. The pair
    * contains the average success rate of all valid hosts in the cluster and the ejection threshold.
    * If a host's success rate is under this threshold, the host is an outlier.
-   * @param success_rate_sum is the sum of the data in the success_rate_data vector.
-   * @param valid_success_rate_hosts is the vector containing the individual success rate data
-   *        points.
+   * @param success_rate_sum is the sum of the data in the valid_success_rates vector.
+   * @param valid_success_rates is the vector containing the individual success rate data points.
    * @return EjectionPair
    */
   struct EjectionPair {
     double success_rate_average_; // average success rate of all valid hosts in the cluster
     double ejection_threshold_;   // ejection threshold for the cluster
   };
-  static EjectionPair
-  successRateEjectionThreshold(double success_rate_sum,
-                               const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
-                               double success_rate_stdev_factor);
+  static EjectionPair successRateEjectionThreshold(double success_rate_sum,
+                                                   const std::vector<double>& valid_success_rates,
+                                                   double success_rate_stdev_factor);
 
 private:
   DetectorImpl(const Cluster& cluster, const envoy::config::cluster::v3::OutlierDetection& config,
@@ -373,6 +376,7 @@ private:
                EventLoggerSharedPtr event_logger);
 
   void addHostMonitor(HostSharedPtr host);
+  void removeHostMonitor(const HostSharedPtr& host);
   void armIntervalTimer();
   void checkHostForUneject(HostSharedPtr host, DetectorHostMonitorImpl* monitor, MonotonicTime now);
   void ejectHost(HostSharedPtr host, envoy::data::cluster::v2alpha::OutlierEjectionType type);
@@ -417,6 +421,22 @@ private:
   absl::node_hash_map<HostSharedPtr, DetectorHostMonitorImpl*> host_monitors_;
   EventLoggerSharedPtr event_logger_;
 
+  // The hosts of host_monitors_ and their monitors as a structure of arrays, which is walked on
+  // each interval instead of the map. Hosts are added at the end, and removed by moving the last
+  // host into their place.
+  std::vector<HostSharedPtr> column_hosts_;
+  std::vector<DetectorHostMonitorImpl*> column_monitors_;
+
+  // Columns of request counts and success rates of the hosts, and of the indices and success rates
+  // of the hosts with enough requests, filled by processSuccessRateEjections(). They keep their
+  // capacity across intervals, so that evaluating an interval does not allocate.
+  std::vector<uint64_t> success_request_counts_;
+  std::vector<uint64_t> total_request_counts_;
+  std::vector<double> success_rates_;
+  std::vector<uint32_t> valid_success_rate_hosts_;
+  std::vector<double> valid_success_rates_;
+  std::vector<uint32_t> valid_failure_percentage_hosts_;
+
   // EjectionPair for external and local origin events.
   // When external/local origin events are not split, external_origin_sr_num_ are used for
   // both types of events: external and local. local_origin_sr_num_ is not used.
@@ -22,7 +22,13 @@ RingHashLoadBalancer::RingHashLoadBalancer(
     const absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig>& config,
     const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config)
     : ThreadAwareLoadBalancerBase(priority_set, stats, runtime, random, common_config),
-      scope_(scope.createScope("ring_hash_lb.")), stats_(generateStats(*scope_)),
+      table_factory_(std::make_shared<TableFactory>(scope, config, common_config)) {}
+
+RingHashLoadBalancer::TableFactory::TableFactory(
+    Stats::Scope& scope,
+    const absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig>& config,
+    const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config)
+    : scope_(scope.createScope("ring_hash_lb.")), stats_(generateStats(*scope_)),
       min_ring_size_(config ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.value(), minimum_ring_size,
                                                               DefaultMinRingSize)
                             : DefaultMinRingSize),
@@ -52,48 +58,18 @@ HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h, uint32_t a
     return nullptr;
   }
 
-  // Ported from https://github.com/RJ/ketama/blob/master/libketama/ketama.c (ketama_get_server)
-  // I've generally kept the variable names to make the code easier to compare.
-  // NOTE: The algorithm depends on using signed integers for lowp, midp, and highp. Do not
-  //       change them!
-  int64_t lowp = 0;
-  int64_t highp = ring_.size();
-  int64_t midp = 0;
-  while (true) {
-    midp = (lowp + highp) / 2;
-
-    if (midp == static_cast<int64_t>(ring_.size())) {
-      midp = 0;
-      break;
-    }
-
-    uint64_t midval = ring_[midp].hash_;
-    uint64_t midval1 = midp == 0 ? 0 : ring_[midp - 1].hash_;
-
-    if (h <= midval && h > midval1) {
-      break;
-    }
-
-    if (midval < h) {
-      lowp = midp + 1;
-    } else {
-      highp = midp - 1;
-    }
-
-    if (lowp > highp) {
-      midp = 0;
-      break;
-    }
-  }
+  // Like ketama (https://github.com/RJ/ketama/blob/master/libketama/ketama.c), select the first
+  // hash >= h, wrapping around to the start of the ring.
+  uint64_t position = ring_.lowerBound(h);
 
   // If a retry host predicate is being applied, behave as if this host was not in the ring.
   // Note that this does not guarantee a different host: e.g., attempt == ring_.size() or
   // when the offset causes us to select the same host at another location in the ring.
   if (attempt > 0) {
-    midp = (midp + attempt) % ring_.size();
+    position = (position + attempt) % ring_.size();
   }
 
-  return ring_[midp].host_;
+  return hosts_[host_indices_[position]];
 }
 
 using HashFunction = envoy::config::cluster::v3::Cluster::RingHashLbConfig::HashFunction;
@@ -120,7 +96,9 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
 
   // Reserve memory for the entire ring up front.
   const uint64_t ring_size = std::ceil(scale);
-  ring_.reserve(ring_size);
+  std::vector<std::pair<uint64_t, uint32_t>> ring;
+  ring.reserve(ring_size);
+  hosts_.reserve(normalized_host_weights.size());
 
   // Populate the hash ring by walking through the (host, weight) pairs in
   // normalized_host_weights, and generating (scale * weight) hashes for each host. Since these
@@ -147,6 +125,8 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
   uint64_t max_hashes_per_host = 0;
   for (const auto& entry : normalized_host_weights) {
     const auto& host = entry.first;
+    const uint32_t host_index = hosts_.size();
+    hosts_.push_back(host);
     const std::string& address_string =
         use_hostname_for_hashing ? host->hostname() : host->address()->asString();
     ASSERT(!address_string.empty());
@@ -172,7 +152,7 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
               : HashUtil::xxHash64(hash_key);
 
       ENVOY_LOG(trace, "ring hash: hash_key={} hash={}", hash_key.data(), hash);
-      ring_.push_back({hash, host});
+      ring.emplace_back(hash, host_index);
       ++i;
       ++current_hashes;
       hash_key_buffer.erase(offset_start, hash_key_buffer.end());
@@ -181,18 +161,26 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
     max_hashes_per_host = std::max(i, max_hashes_per_host);
   }
 
-  std::sort(ring_.begin(), ring_.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
-    return lhs.hash_ < rhs.hash_;
-  });
+  // Hashes which collide are ordered by host, so that the ring does not depend on the sort.
+  std::sort(ring.begin(), ring.end());
   if (ENVOY_LOG_CHECK_LEVEL(trace)) {
-    for (const auto& entry : ring_) {
+    for (const auto& entry : ring) {
+      const auto& host = hosts_[entry.second];
       ENVOY_LOG(trace, "ring hash: host={} hash={}",
-                use_hostname_for_hashing ? entry.host_->hostname()
-                                         : entry.host_->address()->asString(),
-                entry.hash_);
+                use_hostname_for_hashing ? host->hostname() : host->address()->asString(),
+                entry.first);
     }
   }
 
+  std::vector<uint64_t> hashes;
+  hashes.reserve(ring.size());
+  host_indices_.reserve(ring.size());
+  for (const auto& entry : ring) {
+    hashes.push_back(entry.first);
+    host_indices_.push_back(entry.second);
+  }
+  ring_ = HashSearchTree(hashes);
+
   stats_.size_.set(ring_size);
   stats_.min_hashes_per_host_.set(min_hashes_per_host);
   stats_.max_hashes_per_host_.set(max_hashes_per_host);
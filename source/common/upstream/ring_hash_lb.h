@@ -8,6 +8,7 @@
 #include "envoy/stats/stats_macros.h"
 
 #include "common/common/logger.h"
+#include "common/upstream/hash_search_tree.h"
 #include "common/upstream/thread_aware_lb_impl.h"
 
 namespace Envoy {
@@ -46,16 +47,11 @@ public:
       const absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig>& config,
       const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config);
 
-  const RingHashLoadBalancerStats& stats() const { return stats_; }
+  const RingHashLoadBalancerStats& stats() const { return table_factory_->stats_; }
 
 private:
   using HashFunction = envoy::config::cluster::v3::Cluster::RingHashLbConfig::HashFunction;
 
-  struct RingEntry {
-    uint64_t hash_;
-    HostConstSharedPtr host_;
-  };
-
   struct Ring : public HashingLoadBalancer {
     Ring(const NormalizedHostWeightVector& normalized_host_weights, double min_normalized_weight,
          uint64_t min_ring_size, uint64_t max_ring_size, HashFunction hash_function,
@@ -64,32 +60,52 @@ private:
     // ThreadAwareLoadBalancerBase::HashingLoadBalancer
     HostConstSharedPtr chooseHost(uint64_t hash, uint32_t attempt) const override;
 
-    std::vector<RingEntry> ring_;
+    // The hashes of the ring, in a layout which is fast to search, and for each position on the
+    // ring the index of its host in hosts_.
+    HashSearchTree ring_;
+    std::vector<uint32_t> host_indices_;
+    std::vector<HostConstSharedPtr> hosts_;
 
     RingHashLoadBalancerStats& stats_;
   };
   using RingConstSharedPtr = std::shared_ptr<const Ring>;
 
+  struct TableFactory : public HashingLoadBalancerFactory {
+    TableFactory(
+        Stats::Scope& scope,
+        const absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig>& config,
+        const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config);
+
+    // ThreadAwareLoadBalancerBase::HashingLoadBalancerFactory
+    HashingLoadBalancerSharedPtr
+    createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
+                       double min_normalized_weight,
+                       double /* max_normalized_weight */) const override {
+      return std::make_shared<Ring>(normalized_host_weights, min_normalized_weight, min_ring_size_,
+                                    max_ring_size_, hash_function_, use_hostname_for_hashing_,
+                                    stats_);
+    }
+
+    Stats::ScopePtr scope_;
+    // Set by the rings on creation.
+    mutable RingHashLoadBalancerStats stats_;
+    const uint64_t min_ring_size_;
+    const uint64_t max_ring_size_;
+    const HashFunction hash_function_;
+    const bool use_hostname_for_hashing_;
+  };
+
   // ThreadAwareLoadBalancerBase
-  HashingLoadBalancerSharedPtr
-  createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
-                     double min_normalized_weight, double /* max_normalized_weight */) override {
-    return std::make_shared<Ring>(normalized_host_weights, min_normalized_weight, min_ring_size_,
-                                  max_ring_size_, hash_function_, use_hostname_for_hashing_,
-                                  stats_);
+  HashingLoadBalancerFactorySharedPtr hashingLoadBalancerFactory() const override {
+    return table_factory_;
   }
 
   static RingHashLoadBalancerStats generateStats(Stats::Scope& scope);
 
-  Stats::ScopePtr scope_;
-  RingHashLoadBalancerStats stats_;
-
   static const uint64_t DefaultMinRingSize = 1024;
   static const uint64_t DefaultMaxRingSize = 1024 * 1024 * 8;
-  const uint64_t min_ring_size_;
-  const uint64_t max_ring_size_;
-  const HashFunction hash_function_;
-  const bool use_hostname_for_hashing_;
+
+  const std::shared_ptr<const TableFactory> table_factory_;
 };
 
 } // namespace Upstream
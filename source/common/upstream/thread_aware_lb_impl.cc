@@ -1,5 +1,6 @@
 #include "common/upstream/thread_aware_lb_impl.h"
 
+#include <chrono>
 #include <memory>
 
 namespace Envoy {
@@ -86,55 +87,201 @@ void normalizeWeights(const HostSet& host_set, bool in_panic,
 
 } // namespace
 
+LbTableBuilder::LbTableBuilder(Thread::ThreadFactory& thread_factory,
+                               Event::Dispatcher& main_thread_dispatcher, uint32_t concurrency)
+    : main_thread_dispatcher_(main_thread_dispatcher) {
+  for (uint32_t i = 0; i < concurrency; ++i) {
+    threads_.emplace_back(thread_factory.createThread([this]() -> void { threadRoutine(); },
+                                                      Thread::Options{"lb_table_build"}));
+  }
+}
+
+LbTableBuilder::~LbTableBuilder() {
+  {
+    Thread::LockGuard lock(mutex_);
+    exit_ = true;
+    builds_posted_.notifyAll();
+  }
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+void LbTableBuilder::post(std::function<void()> build) {
+  Thread::LockGuard lock(mutex_);
+  builds_.push_back(std::move(build));
+  builds_posted_.notifyOne();
+}
+
+void LbTableBuilder::threadRoutine() {
+  while (true) {
+    std::function<void()> build;
+    {
+      Thread::LockGuard lock(mutex_);
+      while (builds_.empty() && !exit_) {
+        builds_posted_.wait(mutex_);
+      }
+      // Builds which have been posted are run before exiting, so that each build which was started
+      // is completed.
+      if (builds_.empty()) {
+        return;
+      }
+      build = std::move(builds_.front());
+      builds_.pop_front();
+    }
+    build();
+  }
+}
+
+ThreadAwareLoadBalancerBase::TableBuilds::TableBuilds(LbTableBuilder& builder,
+                                                      Stats::Scope& scope)
+    : builder_(builder),
+      stats_({ALL_LB_TABLE_BUILD_STATS(POOL_COUNTER_PREFIX(scope, "lb_table_"),
+                                       POOL_HISTOGRAM_PREFIX(scope, "lb_table_"))}) {}
+
+ThreadAwareLoadBalancerBase::~ThreadAwareLoadBalancerBase() {
+  // A running build is not waited for. It only holds shared references, and drops its tables.
+  if (table_builds_ != nullptr) {
+    table_builds_->cancelled_ = true;
+    table_builds_->pending_params_ = nullptr;
+  }
+}
+
 void ThreadAwareLoadBalancerBase::initialize() {
-  // TODO(mattklein123): In the future, once initialized and the initial LB is built, it would be
-  // better to use a background thread for computing LB updates. This has the substantial benefit
-  // that if the LB computation thread falls behind, host set updates can be trivially collapsed.
-  // I will look into doing this in a follow up. Doing everything using a background thread heavily
-  // complicated initialization as the load balancer would need its own initialized callback. I
-  // think the synchronous/asynchronous split is probably the best option.
+  // The initial tables are built synchronously, as the load balancer would otherwise need its own
+  // initialized callback. Later host set updates are built by the table builder if there is one.
+  // This has the substantial benefit that if the builds fall behind, host set updates can be
+  // trivially collapsed.
   priority_set_.addPriorityUpdateCb(
       [this](uint32_t, const HostVector&, const HostVector&) -> void { refresh(); });
 
-  refresh();
+  TableParamsPtr params = tableParams();
+  publishTables(*factory_, *params,
+                buildPerPriorityState(*params, *hashingLoadBalancerFactory(), nullptr));
+}
+
+void ThreadAwareLoadBalancerBase::setTableBuilder(LbTableBuilderSharedPtr builder,
+                                                  Stats::Scope& scope) {
+  table_builder_ = std::move(builder);
+  table_builds_ = std::make_shared<TableBuilds>(*table_builder_, scope);
+  absl::WriterMutexLock lock(&factory_->mutex_);
+  factory_->track_updates_ = true;
 }
 
 void ThreadAwareLoadBalancerBase::refresh() {
-  auto per_priority_state_vector = std::make_shared<std::vector<PerPriorityStatePtr>>(
-      priority_set_.hostSetsPerPriority().size());
-  auto healthy_per_priority_load =
+  TableParamsPtr params = tableParams();
+  if (table_builds_ == nullptr) {
+    publishTables(*factory_, *params,
+                  buildPerPriorityState(*params, *hashingLoadBalancerFactory(), nullptr));
+    return;
+  }
+
+  if (table_builds_->running_) {
+    if (table_builds_->pending_params_ != nullptr) {
+      table_builds_->stats_.builds_collapsed_.inc();
+    }
+    table_builds_->pending_params_ = std::move(params);
+    return;
+  }
+  startTableBuild(table_builds_, factory_, hashingLoadBalancerFactory(), std::move(params));
+}
+
+ThreadAwareLoadBalancerBase::TableParamsPtr ThreadAwareLoadBalancerBase::tableParams() {
+  auto params = std::make_unique<TableParams>();
+  params->per_priority_params_.resize(priority_set_.hostSetsPerPriority().size());
+  params->healthy_per_priority_load_ =
       std::make_shared<HealthyLoad>(per_priority_load_.healthy_priority_load_);
-  auto degraded_per_priority_load =
+  params->degraded_per_priority_load_ =
       std::make_shared<DegradedLoad>(per_priority_load_.degraded_priority_load_);
 
   for (const auto& host_set : priority_set_.hostSetsPerPriority()) {
     const uint32_t priority = host_set->priority();
-    (*per_priority_state_vector)[priority] = std::make_unique<PerPriorityState>();
-    const auto& per_priority_state = (*per_priority_state_vector)[priority];
+    PriorityTableParams& priority_params = params->per_priority_params_[priority];
     // Copy panic flag from LoadBalancerBase. It is calculated when there is a change
     // in hosts set or hosts' health.
-    per_priority_state->global_panic_ = per_priority_panic_[priority];
+    priority_params.global_panic_ = per_priority_panic_[priority];
 
     // Normalize host and locality weights such that the sum of all normalized weights is 1.
-    NormalizedHostWeightVector normalized_host_weights;
-    double min_normalized_weight = 1.0;
-    double max_normalized_weight = 0.0;
-    normalizeWeights(*host_set, per_priority_state->global_panic_, normalized_host_weights,
-                     min_normalized_weight, max_normalized_weight);
-    per_priority_state->current_lb_ =
-        createLoadBalancer(normalized_host_weights, min_normalized_weight, max_normalized_weight);
+    normalizeWeights(*host_set, priority_params.global_panic_,
+                     priority_params.normalized_host_weights_,
+                     priority_params.min_normalized_weight_,
+                     priority_params.max_normalized_weight_);
   }
+  return params;
+}
 
-  {
-    absl::WriterMutexLock lock(&factory_->mutex_);
-    factory_->healthy_per_priority_load_ = healthy_per_priority_load;
-    factory_->degraded_per_priority_load_ = degraded_per_priority_load;
-    factory_->per_priority_state_ = per_priority_state_vector;
+ThreadAwareLoadBalancerBase::PerPriorityStateVectorSharedPtr
+ThreadAwareLoadBalancerBase::buildPerPriorityState(const TableParams& params,
+                                                   const HashingLoadBalancerFactory& factory,
+                                                   const std::atomic<bool>* cancelled) {
+  auto per_priority_state_vector =
+      std::make_shared<std::vector<PerPriorityStatePtr>>(params.per_priority_params_.size());
+  for (uint32_t priority = 0; priority < params.per_priority_params_.size(); ++priority) {
+    if (cancelled != nullptr && *cancelled) {
+      return nullptr;
+    }
+    const PriorityTableParams& priority_params = params.per_priority_params_[priority];
+    (*per_priority_state_vector)[priority] = std::make_unique<PerPriorityState>();
+    const auto& per_priority_state = (*per_priority_state_vector)[priority];
+    per_priority_state->global_panic_ = priority_params.global_panic_;
+    per_priority_state->current_lb_ = factory.createLoadBalancer(
+        priority_params.normalized_host_weights_, priority_params.min_normalized_weight_,
+        priority_params.max_normalized_weight_);
   }
+  return per_priority_state_vector;
+}
+
+void ThreadAwareLoadBalancerBase::publishTables(
+    LoadBalancerFactoryImpl& factory, const TableParams& params,
+    PerPriorityStateVectorSharedPtr per_priority_state) {
+  absl::WriterMutexLock lock(&factory.mutex_);
+  factory.healthy_per_priority_load_ = params.healthy_per_priority_load_;
+  factory.degraded_per_priority_load_ = params.degraded_per_priority_load_;
+  factory.per_priority_state_ = std::move(per_priority_state);
+  factory.version_.fetch_add(1, std::memory_order_release);
+}
+
+void ThreadAwareLoadBalancerBase::startTableBuild(
+    const std::shared_ptr<TableBuilds>& builds, std::shared_ptr<LoadBalancerFactoryImpl> factory,
+    HashingLoadBalancerFactorySharedPtr hashing_factory, TableParamsPtr params) {
+  builds->running_ = true;
+  // The build only shares ownership of what it uses, so that the load balancer does not have to
+  // wait for it on destruction.
+  std::shared_ptr<TableParams> shared_params = std::move(params);
+  builds->builder_.post([builds, factory, hashing_factory, shared_params]() mutable -> void {
+    Event::Dispatcher& dispatcher = builds->builder_.mainThreadDispatcher();
+    const MonotonicTime start = dispatcher.timeSource().monotonicTime();
+    PerPriorityStateVectorSharedPtr per_priority_state =
+        buildPerPriorityState(*shared_params, *hashing_factory, &builds->cancelled_);
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        dispatcher.timeSource().monotonicTime() - start);
+
+    // Everything is moved to the completion, so that it is released on the main thread.
+    dispatcher.post([builds = std::move(builds), factory = std::move(factory),
+                     hashing_factory = std::move(hashing_factory),
+                     shared_params = std::move(shared_params),
+                     per_priority_state = std::move(per_priority_state), duration]() -> void {
+      if (builds->cancelled_) {
+        return;
+      }
+      publishTables(*factory, *shared_params, per_priority_state);
+      builds->stats_.builds_.inc();
+      builds->stats_.build_duration_ms_.recordValue(duration.count());
+      builds->running_ = false;
+      if (builds->pending_params_ != nullptr) {
+        startTableBuild(builds, factory, hashing_factory, std::move(builds->pending_params_));
+      }
+    });
+  });
 }
 
 HostConstSharedPtr
 ThreadAwareLoadBalancerBase::LoadBalancerImpl::chooseHost(LoadBalancerContext* context) {
+  // Pick up the tables which were built in the background since the last pick.
+  if (factory_ != nullptr && factory_->version_.load(std::memory_order_acquire) != version_) {
+    factory_->update(*this);
+  }
+
   // Make sure we correctly return nullptr for any early chooseHost() calls.
   if (per_priority_state_ == nullptr) {
     return nullptr;
@@ -174,15 +321,21 @@ ThreadAwareLoadBalancerBase::LoadBalancerImpl::chooseHost(LoadBalancerContext* c
 
 LoadBalancerPtr ThreadAwareLoadBalancerBase::LoadBalancerFactoryImpl::create() {
   auto lb = std::make_unique<LoadBalancerImpl>(stats_, random_);
+  update(*lb);
+  return lb;
+}
 
+void ThreadAwareLoadBalancerBase::LoadBalancerFactoryImpl::update(LoadBalancerImpl& lb) {
   // We must protect current_lb_ via a RW lock since it is accessed and written to by multiple
   // threads. All complex processing has already been precalculated however.
   absl::ReaderMutexLock lock(&mutex_);
-  lb->healthy_per_priority_load_ = healthy_per_priority_load_;
-  lb->degraded_per_priority_load_ = degraded_per_priority_load_;
-  lb->per_priority_state_ = per_priority_state_;
-
-  return lb;
+  lb.healthy_per_priority_load_ = healthy_per_priority_load_;
+  lb.degraded_per_priority_load_ = degraded_per_priority_load_;
+  lb.per_priority_state_ = per_priority_state_;
+  lb.version_ = version_.load(std::memory_order_relaxed);
+  if (track_updates_) {
+    lb.factory_ = shared_from_this();
+  }
 }
 
 } // namespace Upstream
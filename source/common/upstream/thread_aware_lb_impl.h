@@ -1,7 +1,18 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <list>
+
+#include "envoy/common/time.h"
 #include "envoy/config/cluster/v3/cluster.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
 
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
 #include "common/upstream/load_balancer_impl.h"
 
 #include "absl/synchronization/mutex.h"
@@ -11,6 +22,53 @@ namespace Upstream {
 
 using NormalizedHostWeightVector = std::vector<std::pair<HostConstSharedPtr, double>>;
 
+/**
+ * All stats for the tables built by an LbTableBuilder. @see stats_macros.h
+ */
+#define ALL_LB_TABLE_BUILD_STATS(COUNTER, HISTOGRAM)                                               \
+  COUNTER(builds)                                                                                  \
+  COUNTER(builds_collapsed)                                                                        \
+  HISTOGRAM(build_duration_ms, Milliseconds)
+
+/**
+ * Struct definition for all LB table build stats. @see stats_macros.h
+ */
+struct LbTableBuildStats {
+  ALL_LB_TABLE_BUILD_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * A pool of threads which build the tables of thread aware load balancers, e.g. Maglev tables and
+ * hash rings, so that host set updates of large clusters do not block the main thread. Builds
+ * complete on the main thread, by posting to its dispatcher.
+ */
+class LbTableBuilder {
+public:
+  LbTableBuilder(Thread::ThreadFactory& thread_factory, Event::Dispatcher& main_thread_dispatcher,
+                 uint32_t concurrency);
+  ~LbTableBuilder();
+
+  /**
+   * Runs a build on one of the threads of the pool. Builds run in the order they are posted.
+   * @param build supplies the build to run.
+   */
+  void post(std::function<void()> build);
+
+  Event::Dispatcher& mainThreadDispatcher() { return main_thread_dispatcher_; }
+
+private:
+  void threadRoutine();
+
+  Event::Dispatcher& main_thread_dispatcher_;
+  Thread::MutexBasicLockable mutex_;
+  Thread::CondVar builds_posted_;
+  std::list<std::function<void()>> builds_ ABSL_GUARDED_BY(mutex_);
+  bool exit_ ABSL_GUARDED_BY(mutex_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+using LbTableBuilderSharedPtr = std::shared_ptr<LbTableBuilder>;
+
 class ThreadAwareLoadBalancerBase : public LoadBalancerBase, public ThreadAwareLoadBalancer {
 public:
   /**
@@ -28,10 +86,32 @@ public:
   };
   using HashingLoadBalancerSharedPtr = std::shared_ptr<HashingLoadBalancer>;
 
+  /**
+   * Creates the hashing load balancers of a thread aware load balancer. Table builds share it, as
+   * they may still be running on an LbTableBuilder when the thread aware load balancer is gone.
+   */
+  class HashingLoadBalancerFactory {
+  public:
+    virtual ~HashingLoadBalancerFactory() = default;
+    virtual HashingLoadBalancerSharedPtr
+    createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
+                       double min_normalized_weight, double max_normalized_weight) const PURE;
+  };
+  using HashingLoadBalancerFactorySharedPtr = std::shared_ptr<const HashingLoadBalancerFactory>;
+
   // Upstream::ThreadAwareLoadBalancer
   LoadBalancerFactorySharedPtr factory() override { return factory_; }
   void initialize() override;
 
+  /**
+   * Has the tables for host set updates after initialize() built by builder rather than on the
+   * calling thread. Workers keep using the previous tables until the new ones are published, and
+   * updates which arrive while a build is running are collapsed into the next build.
+   * @param builder supplies the builder.
+   * @param scope supplies the scope for the build stats.
+   */
+  void setTableBuilder(LbTableBuilderSharedPtr builder, Stats::Scope& scope);
+
   // Upstream::LoadBalancerBase
   HostConstSharedPtr chooseHostOnce(LoadBalancerContext*) override {
     NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
@@ -44,6 +124,7 @@ protected:
       const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config)
       : LoadBalancerBase(priority_set, stats, runtime, random, common_config),
         factory_(new LoadBalancerFactoryImpl(stats, random)) {}
+  ~ThreadAwareLoadBalancerBase() override;
 
 private:
   struct PerPriorityState {
@@ -52,6 +133,8 @@ private:
   };
   using PerPriorityStatePtr = std::unique_ptr<PerPriorityState>;
 
+  struct LoadBalancerFactoryImpl;
+
   struct LoadBalancerImpl : public LoadBalancer {
     LoadBalancerImpl(ClusterStats& stats, Random::RandomGenerator& random)
         : stats_(stats), random_(random) {}
@@ -64,15 +147,23 @@ private:
     std::shared_ptr<std::vector<PerPriorityStatePtr>> per_priority_state_;
     std::shared_ptr<HealthyLoad> healthy_per_priority_load_;
     std::shared_ptr<DegradedLoad> degraded_per_priority_load_;
+    // Set when tables are built in the background, so that the LB picks up the tables published
+    // after it was created.
+    std::shared_ptr<LoadBalancerFactoryImpl> factory_;
+    uint64_t version_{};
   };
 
-  struct LoadBalancerFactoryImpl : public LoadBalancerFactory {
+  struct LoadBalancerFactoryImpl : public LoadBalancerFactory,
+                                   public std::enable_shared_from_this<LoadBalancerFactoryImpl> {
     LoadBalancerFactoryImpl(ClusterStats& stats, Random::RandomGenerator& random)
         : stats_(stats), random_(random) {}
 
     // Upstream::LoadBalancerFactory
     LoadBalancerPtr create() override;
 
+    // Copies the latest published tables to lb.
+    void update(LoadBalancerImpl& lb);
+
     ClusterStats& stats_;
     Random::RandomGenerator& random_;
     absl::Mutex mutex_;
@@ -80,14 +171,61 @@ private:
     // This is split out of PerPriorityState so LoadBalancerBase::ChoosePriority can be reused.
     std::shared_ptr<HealthyLoad> healthy_per_priority_load_ ABSL_GUARDED_BY(mutex_);
     std::shared_ptr<DegradedLoad> degraded_per_priority_load_ ABSL_GUARDED_BY(mutex_);
+    bool track_updates_ ABSL_GUARDED_BY(mutex_){};
+    // Incremented each time tables are published.
+    std::atomic<uint64_t> version_{};
+  };
+
+  // The inputs of a table build for one priority, which are computed on the main thread.
+  struct PriorityTableParams {
+    NormalizedHostWeightVector normalized_host_weights_;
+    double min_normalized_weight_{1.0};
+    double max_normalized_weight_{0.0};
+    bool global_panic_{};
+  };
+
+  struct TableParams {
+    std::vector<PriorityTableParams> per_priority_params_;
+    std::shared_ptr<HealthyLoad> healthy_per_priority_load_;
+    std::shared_ptr<DegradedLoad> degraded_per_priority_load_;
+  };
+  using TableParamsPtr = std::unique_ptr<TableParams>;
+
+  using PerPriorityStateVectorSharedPtr = std::shared_ptr<std::vector<PerPriorityStatePtr>>;
+
+  // The table builds of a load balancer, which are shared with the build running on the builder.
+  // Apart from builder_ and cancelled_, they are only accessed on the main thread.
+  struct TableBuilds {
+    TableBuilds(LbTableBuilder& builder, Stats::Scope& scope);
+
+    // Kept alive by the load balancer, and by its own threads while a build is running.
+    LbTableBuilder& builder_;
+    LbTableBuildStats stats_;
+    // Whether a build is running on builder_ or waiting for its completion to run.
+    bool running_{};
+    // The params of the latest update, which are built once the running build completes.
+    TableParamsPtr pending_params_;
+    // Set when the load balancer is destroyed. The running build then stops at the next priority,
+    // and its completion drops the tables.
+    std::atomic<bool> cancelled_{};
   };
 
-  virtual HashingLoadBalancerSharedPtr
-  createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
-                     double min_normalized_weight, double max_normalized_weight) PURE;
+  virtual HashingLoadBalancerFactorySharedPtr hashingLoadBalancerFactory() const PURE;
   void refresh();
+  TableParamsPtr tableParams();
+  static PerPriorityStateVectorSharedPtr
+  buildPerPriorityState(const TableParams& params, const HashingLoadBalancerFactory& factory,
+                        const std::atomic<bool>* cancelled);
+  static void publishTables(LoadBalancerFactoryImpl& factory, const TableParams& params,
+                            PerPriorityStateVectorSharedPtr per_priority_state);
+  static void startTableBuild(const std::shared_ptr<TableBuilds>& builds,
+                              std::shared_ptr<LoadBalancerFactoryImpl> factory,
+                              HashingLoadBalancerFactorySharedPtr hashing_factory,
+                              TableParamsPtr params);
 
   std::shared_ptr<LoadBalancerFactoryImpl> factory_;
+  LbTableBuilderSharedPtr table_builder_;
+  std::shared_ptr<TableBuilds> table_builds_;
 };
 
 } // namespace Upstream
@@ -234,6 +234,12 @@ public:
   void weight(uint32_t new_weight) override;
   bool used() const override { return used_; }
   void used(bool new_used) override { used_ = new_used; }
+  uint64_t outstandingRequests() const override {
+    return outstanding_requests_.value_.load(std::memory_order_relaxed);
+  }
+  void addOutstandingRequests(int64_t delta) const override {
+    outstanding_requests_.value_.fetch_add(delta, std::memory_order_relaxed);
+  }
 
 protected:
   static Network::ClientConnectionPtr
@@ -250,6 +256,12 @@ private:
   ActiveHealthFailureType active_health_failure_type_{};
   std::atomic<uint32_t> weight_;
   std::atomic<bool> used_;
+  // Updated by the connection pools of every worker, so it gets a cache line of its own rather
+  // than sharing one with fields which are read on every host selection.
+  struct alignas(64) PaddedCounter {
+    std::atomic<uint64_t> value_{};
+  };
+  mutable PaddedCounter outstanding_requests_;
 };
 
 class HostsPerLocalityImpl : public HostsPerLocality {
@@ -536,6 +548,12 @@ public:
     return idle_timeout_;
   }
   float prefetchRatio() const override { return prefetch_ratio_; }
+  uint32_t maxPredictedConnections() const override { return max_predicted_connections_; }
+  std::chrono::milliseconds predictedRateHalfLife() const override {
+    return predicted_rate_half_life_;
+  }
+  uint32_t warmUpConnections() const override { return warm_up_connections_; }
+  uint32_t http2PoolSharingWorkers() const override { return http2_pool_sharing_workers_; }
   uint32_t perConnectionBufferLimitBytes() const override {
     return per_connection_buffer_limit_bytes_;
   }
@@ -656,6 +674,10 @@ private:
   const std::chrono::milliseconds connect_timeout_;
   absl::optional<std::chrono::milliseconds> idle_timeout_;
   const float prefetch_ratio_;
+  const uint32_t max_predicted_connections_;
+  const std::chrono::milliseconds predicted_rate_half_life_;
+  const uint32_t warm_up_connections_;
+  const uint32_t http2_pool_sharing_workers_;
   const uint32_t per_connection_buffer_limit_bytes_;
   TransportSocketMatcherPtr socket_matcher_;
   Stats::ScopePtr stats_scope_;
@@ -28,6 +28,13 @@ public:
     }
     return io_handle_.readv(max_length, slices, num_slice);
   }
+  Api::IoCallUint64Result read(Buffer::Instance& buffer, uint64_t max_length) override {
+    if (closed_) {
+      return Api::IoCallUint64Result(0, Api::IoErrorPtr(new Network::IoSocketError(EBADF),
+                                                        Network::IoSocketError::deleteIoError));
+    }
+    return io_handle_.read(buffer, max_length);
+  }
   Api::IoCallUint64Result writev(const Buffer::RawSlice* slices, uint64_t num_slice) override {
     if (closed_) {
       return Api::IoCallUint64Result(0, Api::IoErrorPtr(new Network::IoSocketError(EBADF),
@@ -35,6 +42,13 @@ public:
     }
     return io_handle_.writev(slices, num_slice);
   }
+  Api::IoCallUint64Result write(Buffer::Instance& buffer) override {
+    if (closed_) {
+      return Api::IoCallUint64Result(0, Api::IoErrorPtr(new Network::IoSocketError(EBADF),
+                                                        Network::IoSocketError::deleteIoError));
+    }
+    return io_handle_.write(buffer);
+  }
   Api::IoCallUint64Result sendmsg(const Buffer::RawSlice* slices, uint64_t num_slice, int flags,
                                   const Envoy::Network::Address::Ip* self_ip,
                                   const Network::Address::Instance& peer_address) override {
@@ -92,6 +106,12 @@ public:
   Network::Address::InstanceConstSharedPtr peerAddress() override {
     return io_handle_.peerAddress();
   }
+  Api::SysCallIntResult shutdown(int how) override { return io_handle_.shutdown(how); }
+  Event::FileEventPtr createFileEvent(Event::Dispatcher& dispatcher, Event::FileReadyCb cb,
+                                      Event::FileTriggerType trigger, uint32_t events) override {
+    return io_handle_.createFileEvent(dispatcher, cb, trigger, events);
+  }
+  bool allowsDescriptorIo() const override { return io_handle_.allowsDescriptorIo(); }
 
 private:
   Network::IoHandle& io_handle_;
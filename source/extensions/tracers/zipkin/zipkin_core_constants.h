@@ -4,6 +4,7 @@
 
 #include "envoy/http/header_map.h"
 
+#include "common/http/headers.h"
 #include "common/singleton/const_singleton.h"
 
 namespace Envoy {
@@ -45,9 +46,9 @@ constexpr bool DEFAULT_SHARED_SPAN_CONTEXT = true;
 class ZipkinCoreConstantValues {
 public:
   // Zipkin B3 headers
-  const Http::LowerCaseString X_B3_TRACE_ID{"x-b3-traceid"};
-  const Http::LowerCaseString X_B3_SPAN_ID{"x-b3-spanid"};
-  const Http::LowerCaseString X_B3_PARENT_SPAN_ID{"x-b3-parentspanid"};
+  const Http::LowerCaseString& X_B3_TRACE_ID{Http::CustomHeaders::get().B3TraceId};
+  const Http::LowerCaseString& X_B3_SPAN_ID{Http::CustomHeaders::get().B3SpanId};
+  const Http::LowerCaseString& X_B3_PARENT_SPAN_ID{Http::CustomHeaders::get().B3ParentSpanId};
   const Http::LowerCaseString X_B3_SAMPLED{"x-b3-sampled"};
   const Http::LowerCaseString X_B3_FLAGS{"x-b3-flags"};
 
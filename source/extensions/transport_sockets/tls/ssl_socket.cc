@@ -180,7 +180,15 @@ void SslSocket::onSuccess(SSL* ssl) {
 
 void SslSocket::onFailure() { drainErrorQueue(); }
 
-PostIoAction SslSocket::doHandshake() { return info_->doHandshake(); }
+PostIoAction SslSocket::doHandshake() {
+  if (!callbacks_->ioHandle().allowsDescriptorIo()) {
+    // BoringSSL reads and writes the descriptor itself, which the handle does not allow.
+    ENVOY_CONN_LOG(error, "TLS is not supported by the socket interface of this connection",
+                   callbacks_->connection());
+    return PostIoAction::Close;
+  }
+  return info_->doHandshake();
+}
 
 void SslSocket::drainErrorQueue() {
   bool saw_error = false;
@@ -211,6 +211,11 @@ void InstanceImpl::updateServerStats() {
                                        parent_stats.parent_memory_allocated_);
   server_stats_->memory_heap_size_.set(Memory::Stats::totalCurrentlyReserved());
   server_stats_->memory_physical_size_.set(Memory::Stats::totalPhysicalBytes());
+  const Buffer::SlicePool::Stats slice_pool_stats = Buffer::SlicePool::stats();
+  server_stats_->slice_pool_hits_.add(slice_pool_stats.hits_ - slice_pool_stats_.hits_);
+  server_stats_->slice_pool_misses_.add(slice_pool_stats.misses_ - slice_pool_stats_.misses_);
+  server_stats_->slice_pool_retained_bytes_.set(slice_pool_stats.retained_bytes_);
+  slice_pool_stats_ = slice_pool_stats;
   server_stats_->parent_connections_.set(parent_stats.parent_connections_);
   server_stats_->total_connections_.set(listener_manager_->numConnections() +
                                         parent_stats.parent_connections_);
@@ -23,6 +23,7 @@
 #include "envoy/tracing/http_tracer.h"
 
 #include "common/access_log/access_log_manager_impl.h"
+#include "common/buffer/slice_pool.h"
 #include "common/common/assert.h"
 #include "common/common/cleanup.h"
 #include "common/common/logger_delegates.h"
@@ -57,6 +58,8 @@ namespace Server {
   COUNTER(envoy_bug_failures)                                                                      \
   COUNTER(dynamic_unknown_fields)                                                                  \
   COUNTER(static_unknown_fields)                                                                   \
+  COUNTER(slice_pool_hits)                                                                         \
+  COUNTER(slice_pool_misses)                                                                       \
   GAUGE(concurrency, NeverImport)                                                                  \
   GAUGE(days_until_first_cert_expiring, Accumulate)                                                \
   GAUGE(hot_restart_epoch, NeverImport)                                                            \
@@ -66,6 +69,7 @@ namespace Server {
   GAUGE(memory_heap_size, Accumulate)                                                              \
   GAUGE(memory_physical_size, Accumulate)                                                          \
   GAUGE(parent_connections, Accumulate)                                                            \
+  GAUGE(slice_pool_retained_bytes, NeverImport)                                                    \
   GAUGE(state, NeverImport)                                                                        \
   GAUGE(stats_recent_lookups, NeverImport)                                                         \
   GAUGE(total_connections, Accumulate)                                                             \
@@ -321,6 +325,8 @@ private:
   time_t original_start_time_;
   Stats::StoreRoot& stats_store_;
   std::unique_ptr<ServerStats> server_stats_;
+  // The slice pool statistics as of the last stats flush, to increment the counters by the change.
+  Buffer::SlicePool::Stats slice_pool_stats_{};
   Assert::ActionRegistrationPtr assert_action_registration_;
   Assert::ActionRegistrationPtr envoy_bug_action_registration_;
   ThreadLocal::Instance& thread_local_;
@@ -120,6 +120,8 @@ public:
     size_ -= size;
   }
 
+  Buffer::RetainedDataPtr drainRetaining(uint64_t) override { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+
   Buffer::RawSliceVector
   getRawSlices(absl::optional<uint64_t> max_slices = absl::nullopt) const override {
     ASSERT(!max_slices.has_value() || max_slices.value() >= 1);
@@ -1,4 +1,5 @@
 #include "common/buffer/buffer_impl.h"
+#include "common/buffer/slice_pool.h"
 #include "common/common/assert.h"
 
 #include "absl/strings/string_view.h"
@@ -202,6 +203,42 @@ static void bufferMovePartial(benchmark::State& state) {
 }
 BENCHMARK(bufferMovePartial)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
 
+// Test the cycle of a proxied connection: data is read into a reservation of the read buffer,
+// moved to the write buffer of the peer connection and drained once written. The second argument
+// enables the slice pool, and the heap_allocations counter reports the number of slices which
+// were allocated from the heap.
+static void bufferReadMoveDrain(benchmark::State& state) {
+  const uint64_t max_retained_bytes = Buffer::SlicePool::maxRetainedBytesPerThread();
+  Buffer::SlicePool::setMaxRetainedBytesPerThread(state.range(1) ? 1024 * 1024 : 0);
+  const uint64_t misses = Buffer::SlicePool::stats().misses_;
+
+  Buffer::OwnedImpl read_buffer;
+  Buffer::OwnedImpl write_buffer;
+  for (auto _ : state) {
+    constexpr uint64_t NumSlices = 2;
+    Buffer::RawSlice slices[NumSlices];
+    const uint64_t slices_used = read_buffer.reserve(16384, slices, NumSlices);
+    uint64_t remaining = state.range(0);
+    for (uint64_t i = 0; i < slices_used; i++) {
+      slices[i].len_ = std::min<uint64_t>(slices[i].len_, remaining);
+      remaining -= slices[i].len_;
+    }
+    read_buffer.commit(slices, slices_used);
+    write_buffer.move(read_buffer);
+    write_buffer.drain(write_buffer.length());
+  }
+  state.counters["heap_allocations"] = benchmark::Counter(
+      Buffer::SlicePool::stats().misses_ - misses, benchmark::Counter::kAvgIterations);
+  Buffer::SlicePool::setMaxRetainedBytesPerThread(max_retained_bytes);
+}
+BENCHMARK(bufferReadMoveDrain)
+    ->Args({1, 0})
+    ->Args({1, 1})
+    ->Args({4096, 0})
+    ->Args({4096, 1})
+    ->Args({16384, 0})
+    ->Args({16384, 1});
+
 // Test the reserve+commit cycle, for the special case where the reserved space is
 // fully used (and therefore the commit size equals the reservation size).
 static void bufferReserveCommit(benchmark::State& state) {
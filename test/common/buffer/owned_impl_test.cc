@@ -6,6 +6,7 @@
 #include "test/common/buffer/utility.h"
 #include "test/mocks/api/mocks.h"
 #include "test/test_common/logging.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
 
 #include "absl/strings/str_cat.h"
@@ -510,6 +511,94 @@ TEST_F(OwnedImplTest, ExtractWithDrainTracker) {
   slice.reset();
 }
 
+TEST_F(OwnedImplTest, DrainRetainingWholeSlices) {
+  Buffer::OwnedImpl buffer;
+  buffer.appendSliceForTest("abc");
+  buffer.appendSliceForTest("defg");
+  buffer.appendSliceForTest("hi");
+  const Buffer::RawSliceVector slices = buffer.getRawSlices();
+
+  Buffer::RetainedDataPtr retained = buffer.drainRetaining(7);
+  EXPECT_EQ(7, retained->length());
+  EXPECT_EQ("hi", buffer.toString());
+  EXPECT_EQ(2, buffer.length());
+
+  // The memory of the drained slices is still valid.
+  EXPECT_EQ("abc", absl::string_view(static_cast<const char*>(slices[0].mem_), 3));
+  EXPECT_EQ("defg", absl::string_view(static_cast<const char*>(slices[1].mem_), 4));
+  retained.reset();
+  EXPECT_EQ("hi", buffer.toString());
+}
+
+TEST_F(OwnedImplTest, DrainRetainingPartialSlice) {
+  Buffer::OwnedImpl buffer;
+  buffer.add("abcde");
+  const Buffer::RawSliceVector slices = buffer.getRawSlices();
+  const char* data = static_cast<const char*>(slices[0].mem_);
+
+  Buffer::RetainedDataPtr retained = buffer.drainRetaining(2);
+  EXPECT_EQ(2, retained->length());
+  EXPECT_EQ("cde", buffer.toString());
+  // The rest of the partially drained slice references the same memory.
+  EXPECT_EQ(data + 2, buffer.getRawSlices()[0].mem_);
+
+  // Data added afterwards is not written into the shared memory.
+  buffer.add("xyz");
+  EXPECT_EQ("cdexyz", buffer.toString());
+  EXPECT_EQ(2, buffer.getRawSlices().size());
+
+  // The undrained data outlives the retained data and the other way round.
+  retained.reset();
+  EXPECT_EQ("cdexyz", buffer.toString());
+  retained = buffer.drainRetaining(4);
+  EXPECT_EQ(4, retained->length());
+  buffer.drain(buffer.length());
+  EXPECT_EQ("abcde", absl::string_view(data, 5));
+}
+
+TEST_F(OwnedImplTest, DrainRetainingWithDrainTracker) {
+  testing::InSequence s;
+
+  Buffer::OwnedImpl buffer;
+  buffer.add("abc");
+  testing::MockFunction<void()> tracker;
+  buffer.addDrainTracker(tracker.AsStdFunction());
+
+  // The drain tracker follows the rest of a partially drained slice.
+  testing::MockFunction<void()> done;
+  Buffer::RetainedDataPtr retained = buffer.drainRetaining(1);
+  EXPECT_CALL(done, Call());
+  EXPECT_CALL(tracker, Call());
+  done.Call();
+  Buffer::RetainedDataPtr retained2 = buffer.drainRetaining(2);
+  EXPECT_EQ(0, buffer.length());
+}
+
+TEST_F(OwnedImplTest, DrainRetainingFragment) {
+  std::string input{"fragment"};
+  auto frag = OwnedBufferFragmentImpl::create(
+      {input.c_str(), input.size()},
+      [this](const OwnedBufferFragmentImpl*) { release_callback_called_ = true; });
+  Buffer::OwnedImpl buffer;
+  buffer.addBufferFragment(*frag);
+  bool drain_tracker_called{false};
+  buffer.addDrainTracker([&] { drain_tracker_called = true; });
+
+  Buffer::RetainedDataPtr retained = buffer.drainRetaining(4);
+  EXPECT_EQ("ment", buffer.toString());
+  EXPECT_EQ(static_cast<const uint8_t*>(frag->data()) + 4, buffer.getRawSlices()[0].mem_);
+  Buffer::RetainedDataPtr retained2 = buffer.drainRetaining(4);
+  EXPECT_EQ(0, buffer.length());
+  EXPECT_TRUE(drain_tracker_called);
+
+  // The fragment is only released once nothing references its memory anymore.
+  EXPECT_FALSE(release_callback_called_);
+  retained.reset();
+  EXPECT_FALSE(release_callback_called_);
+  retained2.reset();
+  EXPECT_TRUE(release_callback_called_);
+}
+
 TEST_F(OwnedImplTest, DrainTracking) {
   testing::InSequence s;
 
@@ -635,6 +724,78 @@ TEST_F(OwnedImplTest, PartialMoveDrainTrackers) {
   buffer2.drain(buffer2.length());
 }
 
+// Verify that moving a large part of a slice shares its storage instead of copying it.
+TEST_F(OwnedImplTest, PartialMoveSharesSlice) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.buffer_share_partial_slices", "true"}});
+  testing::InSequence s;
+
+  Buffer::OwnedImpl buffer1;
+  Buffer::OwnedImpl buffer2;
+  buffer2.appendSliceForTest(std::string(1200, 'a') + std::string(1200, 'b') +
+                             std::string(1200, 'c'));
+  testing::MockFunction<void()> tracker;
+  buffer2.addDrainTracker(tracker.AsStdFunction());
+  const void* data = buffer2.getRawSlices()[0].mem_;
+
+  buffer1.move(buffer2, 1200);
+  EXPECT_EQ(std::string(1200, 'a'), buffer1.toString());
+  EXPECT_EQ(2400, buffer2.length());
+  EXPECT_EQ(data, buffer1.getRawSlices()[0].mem_);
+  EXPECT_EQ(static_cast<const char*>(data) + 1200, buffer2.getRawSlices()[0].mem_);
+
+  // The rest of the slice is shared again when moved.
+  buffer1.move(buffer2, 1200);
+  EXPECT_EQ(std::string(1200, 'a') + std::string(1200, 'b'), buffer1.toString());
+  EXPECT_EQ(2, buffer1.getRawSlices().size());
+  EXPECT_EQ(static_cast<const char*>(data) + 1200, buffer1.getRawSlices()[1].mem_);
+
+  // Data can be added to the buffer sharing the slice without overwriting it.
+  buffer2.add("d");
+  EXPECT_EQ(std::string(1200, 'c') + "d", buffer2.toString());
+  buffer1.drain(buffer1.length());
+
+  // The drain tracker stays with the part of the slice which was not moved.
+  testing::MockFunction<void()> done;
+  EXPECT_CALL(tracker, Call());
+  EXPECT_CALL(done, Call());
+  buffer2.drain(1200);
+  done.Call();
+  EXPECT_EQ("d", buffer2.toString());
+}
+
+// Verify that a part of a slice too small to justify keeping the whole slice alive is copied.
+TEST_F(OwnedImplTest, PartialMoveCopiesSmallPartOfSlice) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.buffer_share_partial_slices", "true"}});
+
+  Buffer::OwnedImpl buffer1;
+  Buffer::OwnedImpl buffer2;
+  buffer2.appendSliceForTest(std::string(16000, 'a'));
+  const void* data = buffer2.getRawSlices()[0].mem_;
+
+  buffer1.move(buffer2, 1000);
+  EXPECT_EQ(std::string(1000, 'a'), buffer1.toString());
+  EXPECT_EQ(15000, buffer2.length());
+  EXPECT_NE(data, buffer1.getRawSlices()[0].mem_);
+  EXPECT_EQ(static_cast<const char*>(data) + 1000, buffer2.getRawSlices()[0].mem_);
+}
+
+// Verify that parts of slices are copied when sharing is disabled.
+TEST_F(OwnedImplTest, PartialMoveSharingDisabled) {
+  Buffer::OwnedImpl buffer1;
+  Buffer::OwnedImpl buffer2;
+  buffer2.appendSliceForTest(std::string(1200, 'a') + std::string(1200, 'b'));
+  const void* data = buffer2.getRawSlices()[0].mem_;
+
+  buffer1.move(buffer2, 1200);
+  EXPECT_EQ(std::string(1200, 'a'), buffer1.toString());
+  EXPECT_EQ(std::string(1200, 'b'), buffer2.toString());
+  EXPECT_NE(data, buffer1.getRawSlices()[0].mem_);
+}
+
 TEST_F(OwnedImplTest, DrainTrackingOnDestruction) {
   testing::InSequence s;
 
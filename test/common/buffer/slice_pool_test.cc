@@ -0,0 +1,104 @@
+#include <thread>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/buffer/slice_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+class SlicePoolTest : public testing::Test {
+protected:
+  SlicePoolTest() : max_retained_bytes_(SlicePool::maxRetainedBytesPerThread()) {
+    // Empty the freelists of this thread, which were populated by earlier tests.
+    SlicePool::setMaxRetainedBytesPerThread(0);
+    OwnedSlice::create(0).reset();
+    SlicePool::setMaxRetainedBytesPerThread(4 * 16384);
+    initial_stats_ = SlicePool::stats();
+  }
+
+  ~SlicePoolTest() override { SlicePool::setMaxRetainedBytesPerThread(max_retained_bytes_); }
+
+  uint64_t hits() const { return SlicePool::stats().hits_ - initial_stats_.hits_; }
+  uint64_t misses() const { return SlicePool::stats().misses_ - initial_stats_.misses_; }
+
+  const uint64_t max_retained_bytes_;
+  SlicePool::Stats initial_stats_;
+};
+
+// A freed slice is reused by the next slice of the same size.
+TEST_F(SlicePoolTest, Reuse) {
+  SlicePtr slice = OwnedSlice::create(16384);
+  const uint8_t* storage = slice->data();
+  EXPECT_EQ(0, hits());
+  EXPECT_EQ(1, misses());
+
+  slice.reset();
+  EXPECT_EQ(20480, SlicePool::stats().retained_bytes_);
+
+  // A slice of another size does not use the freed block.
+  SlicePtr small = OwnedSlice::create(100);
+  EXPECT_EQ(0, hits());
+  EXPECT_EQ(2, misses());
+
+  slice = OwnedSlice::create("a", 1);
+  EXPECT_EQ(0, hits());
+  slice = OwnedSlice::create(16384);
+  EXPECT_EQ(storage, slice->data());
+  EXPECT_EQ(1, hits());
+  EXPECT_EQ(4096, SlicePool::stats().retained_bytes_);
+}
+
+// Slices too large for the freelists go to the heap.
+TEST_F(SlicePoolTest, Large) {
+  SlicePtr slice = OwnedSlice::create(SlicePool::MaxPooledPages * SlicePool::PageSize);
+  slice.reset();
+  EXPECT_EQ(0, misses());
+  EXPECT_EQ(0, SlicePool::stats().retained_bytes_);
+}
+
+// A thread retains no more than the configured number of bytes.
+TEST_F(SlicePoolTest, Bounded) {
+  std::vector<SlicePtr> slices;
+  for (int i = 0; i < 4; ++i) {
+    slices.push_back(OwnedSlice::create(16384));
+  }
+  slices.clear();
+  EXPECT_EQ(3 * 20480, SlicePool::stats().retained_bytes_);
+
+  SlicePool::setMaxRetainedBytesPerThread(0);
+  OwnedSlice::create(0).reset();
+  EXPECT_EQ(0, SlicePool::stats().retained_bytes_);
+}
+
+// Released blocks are freed the next time the thread uses the pool.
+TEST_F(SlicePoolTest, ReleaseRetained) {
+  OwnedSlice::create(16384).reset();
+  EXPECT_EQ(20480, SlicePool::stats().retained_bytes_);
+
+  SlicePool::releaseRetained();
+  EXPECT_EQ(20480, SlicePool::stats().retained_bytes_);
+  OwnedSlice::create(16384).reset();
+  EXPECT_EQ(0, hits());
+  EXPECT_EQ(2, misses());
+  EXPECT_EQ(20480, SlicePool::stats().retained_bytes_);
+}
+
+// Slices may be freed by another thread, and the statistics of exited threads are kept.
+TEST_F(SlicePoolTest, Threads) {
+  SlicePtr slice = OwnedSlice::create(16384);
+  std::thread thread([&slice]() {
+    slice.reset();
+    OwnedSlice::create(16384).reset();
+  });
+  thread.join();
+  EXPECT_EQ(1, hits());
+  EXPECT_EQ(1, misses());
+  EXPECT_EQ(0, SlicePool::stats().retained_bytes_);
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
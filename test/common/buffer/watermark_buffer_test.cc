@@ -188,6 +188,18 @@ TEST_F(WatermarkBufferTest, DrainUsingExtract) {
 
 // Verify that low watermark callback is called on drain in the case where the
 // high watermark is non-zero and low watermark is 0.
+TEST_F(WatermarkBufferTest, DrainRetaining) {
+  buffer_.add(TEN_BYTES, 10);
+  buffer_.add("a", 1);
+  EXPECT_EQ(1, times_high_watermark_called_);
+
+  // Retaining the drained memory does not count against the watermarks.
+  Buffer::RetainedDataPtr retained = buffer_.drainRetaining(7);
+  EXPECT_EQ(4, buffer_.length());
+  EXPECT_EQ(1, times_low_watermark_called_);
+  EXPECT_EQ(7, retained->length());
+}
+
 TEST_F(WatermarkBufferTest, DrainWithLowWatermarkOfZero) {
   buffer_.setWatermarks(0, 10);
 
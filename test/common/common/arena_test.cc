@@ -0,0 +1,69 @@
+#include <memory>
+
+#include "common/common/arena.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+TEST(ArenaTest, Disabled) {
+  Arena arena(0);
+  EXPECT_EQ(nullptr, arena.allocate(8));
+  EXPECT_EQ(0, arena.bytesUsed());
+  EXPECT_EQ(0, arena.overflows());
+}
+
+TEST(ArenaTest, BumpAndOverflow) {
+  Arena arena(64);
+  void* first = arena.allocate(1);
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(Arena::roundUp(1), arena.bytesUsed());
+  void* second = arena.allocate(16);
+  ASSERT_NE(nullptr, second);
+  EXPECT_EQ(static_cast<char*>(first) + Arena::roundUp(1), second);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(second) % alignof(std::max_align_t));
+
+  EXPECT_EQ(nullptr, arena.allocate(64));
+  EXPECT_EQ(1, arena.overflows());
+  // A smaller request that still fits is served after an overflow.
+  EXPECT_NE(nullptr, arena.allocate(8));
+  EXPECT_EQ(1, arena.overflows());
+}
+
+class Tracked : public ArenaAllocated {
+public:
+  explicit Tracked(int& destroyed) : destroyed_(destroyed) {}
+  ~Tracked() { destroyed_++; }
+
+private:
+  int& destroyed_;
+};
+
+TEST(ArenaAllocatedTest, PlacedInArena) {
+  Arena arena(256);
+  int destroyed = 0;
+  {
+    std::unique_ptr<Tracked> tracked(new (&arena) Tracked(destroyed));
+    EXPECT_GT(arena.bytesUsed(), sizeof(Tracked));
+    EXPECT_TRUE(ArenaAllocated::inArena(tracked.get()));
+  }
+  EXPECT_EQ(1, destroyed);
+}
+
+TEST(ArenaAllocatedTest, OverflowFallsBackToHeap) {
+  Arena arena(16);
+  int destroyed = 0;
+  {
+    std::unique_ptr<Tracked> tracked(new (&arena) Tracked(destroyed));
+    EXPECT_EQ(0, arena.bytesUsed());
+    EXPECT_EQ(1, arena.overflows());
+    EXPECT_FALSE(ArenaAllocated::inArena(tracked.get()));
+    std::unique_ptr<Tracked> heap(new Tracked(destroyed));
+    EXPECT_FALSE(ArenaAllocated::inArena(heap.get()));
+  }
+  EXPECT_EQ(2, destroyed);
+}
+
+} // namespace
+} // namespace Envoy
@@ -0,0 +1,77 @@
+#include <list>
+#include <string>
+#include <vector>
+
+#include "common/common/node_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+
+TEST(NodePoolTest, BlocksGrowGeometrically) {
+  NodePool pool(2, 8);
+  std::vector<void*> nodes;
+  for (int i = 0; i < 2; i++) {
+    nodes.push_back(pool.allocate(24));
+  }
+  EXPECT_EQ(1, pool.blocks());
+  nodes.push_back(pool.allocate(24));
+  EXPECT_EQ(2, pool.blocks());
+  // The second block holds 4 nodes, so 3 more fit before a third block is needed.
+  for (int i = 0; i < 3; i++) {
+    nodes.push_back(pool.allocate(24));
+  }
+  EXPECT_EQ(2, pool.blocks());
+  nodes.push_back(pool.allocate(24));
+  EXPECT_EQ(3, pool.blocks());
+
+  for (void* node : nodes) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(node) % alignof(std::max_align_t));
+    pool.deallocate(node, 24);
+  }
+}
+
+TEST(NodePoolTest, FreedNodesAreRecycled) {
+  NodePool pool;
+  void* first = pool.allocate(40);
+  pool.deallocate(first, 40);
+  EXPECT_EQ(first, pool.allocate(40));
+  EXPECT_EQ(1, pool.blocks());
+  pool.deallocate(first, 40);
+}
+
+TEST(NodePoolTest, OtherSizesBypassPool) {
+  NodePool pool;
+  void* node = pool.allocate(32);
+  const uint64_t reserved = pool.reservedBytes();
+  void* other = pool.allocate(512);
+  EXPECT_EQ(reserved, pool.reservedBytes());
+  EXPECT_EQ(1, pool.blocks());
+  pool.deallocate(other, 512);
+  pool.deallocate(node, 32);
+}
+
+TEST(NodePoolTest, BacksStdList) {
+  NodePool pool;
+  using PooledList = std::list<std::string, NodePoolAllocator<std::string>>;
+  PooledList list{NodePoolAllocator<std::string>(pool)};
+  for (int i = 0; i < 40; i++) {
+    list.emplace_back(std::to_string(i));
+  }
+  const uint64_t blocks = pool.blocks();
+  // 4 + 8 + 16 + 32 nodes.
+  EXPECT_EQ(4, blocks);
+
+  list.remove_if([](const std::string& s) { return s.size() == 1; });
+  EXPECT_EQ(30, list.size());
+  EXPECT_EQ("10", list.front());
+
+  // Refilling the list reuses the released nodes.
+  list.clear();
+  for (int i = 0; i < 40; i++) {
+    list.emplace_back(std::to_string(i));
+  }
+  EXPECT_EQ(blocks, pool.blocks());
+}
+
+} // namespace Envoy
@@ -0,0 +1,153 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <cstdint>
+#include <memory>
+
+#include "common/conn_pool/conn_pool_base.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace ConnectionPool {
+namespace {
+
+// A client whose connection is established on request, and which only counts its streams.
+class FakeClient : public ActiveClient {
+public:
+  FakeClient(ConnPoolImplBase& parent, uint64_t concurrent_stream_limit)
+      : ActiveClient(parent, 0, concurrent_stream_limit) {
+    real_host_description_ = parent.host();
+  }
+
+  void close() override { onEvent(Network::ConnectionEvent::LocalClose); }
+  uint64_t id() const override { return 0; }
+  bool closingWithIncompleteRequest() const override { return false; }
+  size_t numActiveRequests() const override { return active_streams_; }
+
+  size_t active_streams_{};
+};
+
+class FakePendingRequest : public PendingRequest {
+public:
+  FakePendingRequest(ConnPoolImplBase& parent) : PendingRequest(parent) {}
+
+  AttachContext& context() override { return context_; }
+
+  AttachContext context_;
+};
+
+// A pool of a single client, with the concurrent stream limit of an HTTP/1 or HTTP/2 pool, which
+// exercises the stream queueing and client tracking of ConnPoolImplBase without any codec.
+class FakePool : public ConnPoolImplBase {
+public:
+  FakePool(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
+           uint64_t concurrent_stream_limit)
+      : ConnPoolImplBase(std::move(host), Upstream::ResourcePriority::Default, dispatcher, nullptr,
+                         nullptr),
+        concurrent_stream_limit_(concurrent_stream_limit) {
+    AttachContext context;
+    newStream(context);
+    ASSERT(connecting_clients_.size() == 1);
+    client_ = static_cast<FakeClient*>(connecting_clients_.front().get());
+    client_->onEvent(Network::ConnectionEvent::Connected);
+    closeStream();
+  }
+  ~FakePool() override { destructAllConnections(); }
+
+  void closeStream() {
+    client_->active_streams_--;
+    onRequestClosed(*client_, false);
+  }
+
+  // ConnPoolImplBase
+  ActiveClientPtr instantiateActiveClient() override {
+    return std::make_unique<FakeClient>(*this, concurrent_stream_limit_);
+  }
+  Cancellable* newPendingRequest(AttachContext&) override {
+    PendingRequest* reused = reusePendingRequest();
+    if (reused != nullptr) {
+      return reused;
+    }
+    LinkedList::moveIntoList(std::make_unique<FakePendingRequest>(*this), pending_streams_);
+    return pending_streams_.front().get();
+  }
+  void onPoolFailure(const Upstream::HostDescriptionConstSharedPtr&, absl::string_view,
+                     PoolFailureReason, AttachContext&) override {}
+  void onPoolReady(ActiveClient& client, AttachContext&) override {
+    static_cast<FakeClient&>(client).active_streams_++;
+  }
+
+  const uint64_t concurrent_stream_limit_;
+  FakeClient* client_{};
+};
+
+class ConnPoolSpeedTest {
+public:
+  ConnPoolSpeedTest(uint64_t concurrent_stream_limit)
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        pool_(*dispatcher_, Upstream::makeTestHost(cluster_, "tcp://127.0.0.1:80"),
+              concurrent_stream_limit) {}
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  std::shared_ptr<Upstream::MockClusterInfo> cluster_{
+      new testing::NiceMock<Upstream::MockClusterInfo>()};
+  FakePool pool_;
+};
+
+// Attaches streams to a ready client and detaches them. With the concurrent stream limit of
+// HTTP/1, each stream moves the client from READY to BUSY and back.
+void BM_AttachDetach(benchmark::State& state) {
+  ConnPoolSpeedTest test(state.range(0));
+  AttachContext context;
+  for (auto _ : state) {
+    test.pool_.newStream(context);
+    test.pool_.closeStream();
+  }
+}
+BENCHMARK(BM_AttachDetach)->Arg(1)->Arg(100);
+
+// Queues streams while the client is BUSY, and attaches each one as a stream of the client
+// completes, which moves the client from BUSY to READY and back.
+void BM_QueueAndAttach(benchmark::State& state) {
+  const uint64_t concurrent_stream_limit = state.range(0);
+  ConnPoolSpeedTest test(concurrent_stream_limit);
+  AttachContext context;
+  for (uint64_t i = 0; i < concurrent_stream_limit; i++) {
+    test.pool_.newStream(context);
+  }
+  for (auto _ : state) {
+    test.pool_.newStream(context);
+    test.pool_.closeStream();
+  }
+  for (uint64_t i = 0; i < concurrent_stream_limit; i++) {
+    test.pool_.closeStream();
+  }
+}
+BENCHMARK(BM_QueueAndAttach)->Arg(1)->Arg(100);
+
+// Queues streams and cancels them before they are attached.
+void BM_QueueAndCancel(benchmark::State& state) {
+  const uint64_t concurrent_stream_limit = state.range(0);
+  ConnPoolSpeedTest test(concurrent_stream_limit);
+  AttachContext context;
+  for (uint64_t i = 0; i < concurrent_stream_limit; i++) {
+    test.pool_.newStream(context);
+  }
+  for (auto _ : state) {
+    test.pool_.newStream(context)->cancel(CancelPolicy::Default);
+  }
+  for (uint64_t i = 0; i < concurrent_stream_limit; i++) {
+    test.pool_.closeStream();
+  }
+}
+BENCHMARK(BM_QueueAndCancel)->Arg(1)->Arg(100);
+
+} // namespace
+} // namespace ConnectionPool
+} // namespace Envoy
@@ -39,9 +39,10 @@ public:
  */
 struct ConnPoolCallbacks : public Http::ConnectionPool::Callbacks {
   void onPoolReady(Http::RequestEncoder& encoder, Upstream::HostDescriptionConstSharedPtr host,
-                   const StreamInfo::StreamInfo&) override {
+                   const StreamInfo::StreamInfo& info) override {
     outer_encoder_ = &encoder;
     host_ = host;
+    stream_info_ = &info;
     pool_ready_.ready();
   }
 
@@ -57,6 +58,7 @@ struct ConnPoolCallbacks : public Http::ConnectionPool::Callbacks {
   ReadyWatcher pool_ready_;
   Http::RequestEncoder* outer_encoder_{};
   Upstream::HostDescriptionConstSharedPtr host_;
+  const StreamInfo::StreamInfo* stream_info_{};
 };
 
 /**
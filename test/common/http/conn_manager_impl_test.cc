@@ -1,5 +1,6 @@
 #include <chrono>
 #include <cstdint>
+#include <limits>
 #include <list>
 #include <memory>
 #include <string>
@@ -6201,6 +6202,114 @@ TEST_F(HttpConnectionManagerImplTest, NewConnection) {
   EXPECT_EQ(1U, stats_.named_.downstream_cx_http3_active_.value());
 }
 
+TEST_F(HttpConnectionManagerImplTest, FilterWrapperArenaHoldsWrappers) {
+  ON_CALL(runtime_.snapshot_, getInteger("http_connection_manager.filter_wrapper_arena_bytes", 0))
+      .WillByDefault(Return(4096));
+  setup(false, "");
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke([&](Buffer::Instance&) -> Http::Status {
+    RequestDecoder* decoder = &conn_manager_->newStream(response_encoder_);
+    RequestHeaderMapPtr headers{
+        new TestRequestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+    return Http::okStatus();
+  }));
+
+  setupFilterChain(2, 2);
+
+  EXPECT_CALL(*decoder_filters_[0], decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  EXPECT_CALL(*decoder_filters_[0], decodeComplete());
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  // The callbacks of each filter are its wrapper.
+  for (MockStreamDecoderFilter* filter : decoder_filters_) {
+    EXPECT_TRUE(ArenaAllocated::inArena(dynamic_cast<const void*>(filter->callbacks_)));
+  }
+  for (MockStreamEncoderFilter* filter : encoder_filters_) {
+    EXPECT_TRUE(ArenaAllocated::inArena(dynamic_cast<const void*>(filter->callbacks_)));
+  }
+
+  expectOnDestroy();
+  filter_callbacks_.connection_.raiseEvent(Network::ConnectionEvent::RemoteClose);
+  filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0U, stats_.named_.downstream_rq_filter_wrapper_arena_overflow_.value());
+}
+
+TEST_F(HttpConnectionManagerImplTest, FilterWrapperArenaOverflowFallsBackToHeap) {
+  // Too small to hold any filter wrapper, so every wrapper overflows to the heap.
+  ON_CALL(runtime_.snapshot_, getInteger("http_connection_manager.filter_wrapper_arena_bytes", 0))
+      .WillByDefault(Return(16));
+  setup(false, "");
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke([&](Buffer::Instance&) -> Http::Status {
+    RequestDecoder* decoder = &conn_manager_->newStream(response_encoder_);
+    RequestHeaderMapPtr headers{
+        new TestRequestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+    return Http::okStatus();
+  }));
+
+  setupFilterChain(2, 2);
+
+  EXPECT_CALL(*decoder_filters_[0], decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  EXPECT_CALL(*decoder_filters_[0], decodeComplete());
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  // The callbacks of each filter are its wrapper.
+  for (MockStreamDecoderFilter* filter : decoder_filters_) {
+    EXPECT_FALSE(ArenaAllocated::inArena(dynamic_cast<const void*>(filter->callbacks_)));
+  }
+  for (MockStreamEncoderFilter* filter : encoder_filters_) {
+    EXPECT_FALSE(ArenaAllocated::inArena(dynamic_cast<const void*>(filter->callbacks_)));
+  }
+
+  expectOnDestroy();
+  filter_callbacks_.connection_.raiseEvent(Network::ConnectionEvent::RemoteClose);
+  filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(4U, stats_.named_.downstream_rq_filter_wrapper_arena_overflow_.value());
+}
+
+TEST_F(HttpConnectionManagerImplTest, FilterWrapperArenaCapacityIsCapped) {
+  // Allocating an arena of this capacity would fail, but it is capped at a size which holds the
+  // filter wrappers.
+  ON_CALL(runtime_.snapshot_, getInteger("http_connection_manager.filter_wrapper_arena_bytes", 0))
+      .WillByDefault(Return(std::numeric_limits<uint64_t>::max()));
+  setup(false, "");
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke([&](Buffer::Instance&) -> Http::Status {
+    RequestDecoder* decoder = &conn_manager_->newStream(response_encoder_);
+    RequestHeaderMapPtr headers{
+        new TestRequestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+    return Http::okStatus();
+  }));
+
+  setupFilterChain(2, 2);
+
+  EXPECT_CALL(*decoder_filters_[0], decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  EXPECT_CALL(*decoder_filters_[0], decodeComplete());
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  // The callbacks of each filter are its wrapper.
+  for (MockStreamDecoderFilter* filter : decoder_filters_) {
+    EXPECT_TRUE(ArenaAllocated::inArena(dynamic_cast<const void*>(filter->callbacks_)));
+  }
+  for (MockStreamEncoderFilter* filter : encoder_filters_) {
+    EXPECT_TRUE(ArenaAllocated::inArena(dynamic_cast<const void*>(filter->callbacks_)));
+  }
+
+  expectOnDestroy();
+  filter_callbacks_.connection_.raiseEvent(Network::ConnectionEvent::RemoteClose);
+  filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0U, stats_.named_.downstream_rq_filter_wrapper_arena_overflow_.value());
+}
+
 TEST_F(HttpConnectionManagerImplTest, TestUpstreamRequestHeadersSize) {
   // Test with Headers only request, No Data, No response.
   setup(false, "");
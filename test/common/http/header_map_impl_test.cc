@@ -354,6 +354,122 @@ TEST(HeaderStringTest, All) {
   }
 }
 
+TEST(HeaderStringTest, Borrowed) {
+  // setBorrowed keeps the storage alive without copying.
+  {
+    auto storage = std::make_shared<const std::string>("hello world  ");
+    HeaderString string;
+    string.setBorrowed(*storage, storage);
+    EXPECT_TRUE(string.isBorrowed());
+    EXPECT_FALSE(string.isReference());
+    EXPECT_EQ(storage->data(), string.getStringView().data());
+    EXPECT_EQ(13U, string.size());
+    EXPECT_EQ(2, storage.use_count());
+
+    string.rtrim();
+    EXPECT_TRUE(string.isBorrowed());
+    EXPECT_EQ("hello world", string.getStringView());
+    EXPECT_EQ(11U, string.size());
+  }
+
+  // Moving transfers the storage.
+  {
+    auto storage = std::make_shared<const std::string>("hello");
+    HeaderString string1;
+    string1.setBorrowed(*storage, storage);
+    HeaderString string2(std::move(string1));
+    EXPECT_TRUE(string2.isBorrowed());
+    EXPECT_EQ("hello", string2.getStringView());
+    EXPECT_FALSE(string1.isBorrowed()); // NOLINT(bugprone-use-after-move)
+    EXPECT_TRUE(string1.empty());
+    EXPECT_EQ(2, storage.use_count());
+  }
+
+  // Modifying the string copies the view and releases the storage.
+  {
+    auto storage = std::make_shared<const std::string>("hello");
+    HeaderString string;
+    string.setBorrowed(*storage, storage);
+    string.append(" world", 6);
+    EXPECT_FALSE(string.isBorrowed());
+    EXPECT_EQ("hello world", string.getStringView());
+    EXPECT_EQ(1, storage.use_count());
+  }
+  {
+    auto storage = std::make_shared<const std::string>("hello world");
+    HeaderString string;
+    string.setBorrowed(*storage, storage);
+    storage.reset();
+    // The copied data may point into the borrowed memory.
+    string.setCopy(string.getStringView().substr(6));
+    EXPECT_FALSE(string.isBorrowed());
+    EXPECT_EQ("world", string.getStringView());
+  }
+  {
+    auto storage = std::make_shared<const std::string>("hello");
+    HeaderString string;
+    string.setBorrowed(*storage, storage);
+    string.setInteger(5);
+    EXPECT_FALSE(string.isBorrowed());
+    EXPECT_EQ("5", string.getStringView());
+    EXPECT_EQ(1, storage.use_count());
+  }
+  {
+    auto storage = std::make_shared<const std::string>("hello");
+    HeaderString string;
+    string.setBorrowed(*storage, storage);
+    string.clear();
+    EXPECT_FALSE(string.isBorrowed());
+    EXPECT_TRUE(string.empty());
+    EXPECT_EQ(1, storage.use_count());
+  }
+}
+
+TEST(HeaderStringTest, BorrowedRawHeader) {
+  auto storage = std::make_shared<const std::string>("x-foo: bar  \r\n");
+  const absl::string_view raw_header(*storage);
+
+  // The raw header is kept until the string is modified.
+  {
+    HeaderString string;
+    EXPECT_TRUE(string.borrowedRawHeader().empty());
+    string.setBorrowed(raw_header.substr(7, 3), storage);
+    EXPECT_TRUE(string.borrowedRawHeader().empty());
+    string.setBorrowedRawHeader(raw_header);
+    EXPECT_EQ(raw_header, string.borrowedRawHeader());
+    EXPECT_EQ(raw_header.data(), string.borrowedRawHeader().data());
+
+    HeaderString moved(std::move(string));
+    EXPECT_EQ(raw_header, moved.borrowedRawHeader());
+    moved.append("z", 1);
+    EXPECT_TRUE(moved.borrowedRawHeader().empty());
+  }
+  {
+    HeaderString string;
+    string.setBorrowed(raw_header.substr(7, 3), storage);
+    string.setBorrowedRawHeader(raw_header);
+    string.setCopy("bar");
+    EXPECT_TRUE(string.borrowedRawHeader().empty());
+  }
+
+  // Trimming the value drops the raw header, which includes the trimmed whitespace.
+  {
+    HeaderString string;
+    string.setBorrowed(raw_header.substr(7, 5), storage);
+    string.setBorrowedRawHeader(raw_header);
+    string.rtrim();
+    EXPECT_EQ("bar", string.getStringView());
+    EXPECT_TRUE(string.borrowedRawHeader().empty());
+  }
+  {
+    HeaderString string;
+    string.setBorrowed(raw_header.substr(7, 3), storage);
+    string.setBorrowedRawHeader(raw_header);
+    string.rtrim();
+    EXPECT_EQ(raw_header, string.borrowedRawHeader());
+  }
+}
+
 Http::RegisterCustomInlineHeader<Http::CustomInlineHeaderRegistry::Type::RequestHeaders>
     custom_header_1(Http::LowerCaseString{"foo_custom_header"});
 Http::RegisterCustomInlineHeader<Http::CustomInlineHeaderRegistry::Type::RequestHeaders>
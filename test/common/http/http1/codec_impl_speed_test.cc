@@ -0,0 +1,139 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "envoy/http/codec.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/http1/codec_impl.h"
+
+#include "test/common/stats/stat_test_utility.h"
+#include "test/mocks/network/mocks.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+// Proxies requests from a downstream to an upstream HTTP/1 connection, adding the headers which
+// the HTTP connection manager adds to requests, and proxies the responses back.
+class Proxy : public ServerConnectionCallbacks, public RequestDecoder, public ResponseDecoder {
+public:
+  Proxy(bool borrow_header_values, bool reuse_raw_header_lines, uint32_t header_count) {
+    settings_.borrow_header_values_ = borrow_header_values;
+    settings_.reuse_raw_header_lines_ = reuse_raw_header_lines;
+    server_ = std::make_unique<ServerConnectionImpl>(
+        downstream_connection_, CodecStats::atomicGet(stats_, store_), *this, settings_,
+        Http::DEFAULT_MAX_REQUEST_HEADERS_KB, header_count + 10,
+        envoy::config::core::v3::HttpProtocolOptions::ALLOW);
+    client_ = std::make_unique<ClientConnectionImpl>(upstream_connection_,
+                                                     CodecStats::atomicGet(stats_, store_), *this,
+                                                     settings_, Http::DEFAULT_MAX_HEADERS_COUNT);
+    for (Network::MockConnection* connection : {&downstream_connection_, &upstream_connection_}) {
+      ON_CALL(*connection, write(_, _))
+          .WillByDefault(Invoke([this](Buffer::Instance& data, bool) -> void {
+            written_bytes_ += data.length();
+            data.drain(data.length());
+          }));
+    }
+
+    request_ = "GET /api/v1/items?page=2 HTTP/1.1\r\nhost: api.example.com\r\n";
+    for (uint32_t i = 1; i < header_count; ++i) {
+      absl::StrAppend(&request_, "x-custom-header-", i, ": value-", i, "-",
+                      std::string(16, 'a' + i % 26), "\r\n");
+    }
+    absl::StrAppend(&request_, "\r\n");
+  }
+
+  void request() {
+    Buffer::OwnedImpl downstream_input(request_);
+    RELEASE_ASSERT(server_->dispatch(downstream_input).ok(), "");
+
+    request_headers_->setForwardedProto("http");
+    request_headers_->setRequestId("4e2bd7ee-1b4d-4f63-9c1a-9ffb6a3e2d15");
+    request_headers_->setEnvoyExpectedRequestTimeoutMs(15000);
+    client_->newStream(*this).encodeHeaders(*request_headers_, true);
+
+    Buffer::OwnedImpl upstream_input(Response);
+    RELEASE_ASSERT(client_->dispatch(upstream_input).ok(), "");
+    downstream_encoder_->encodeHeaders(*response_headers_, true);
+
+    request_headers_.reset();
+    response_headers_.reset();
+  }
+
+  uint64_t written_bytes_{};
+
+  // Http::ConnectionCallbacks
+  void onGoAway(GoAwayErrorCode) override {}
+
+  // Http::ServerConnectionCallbacks
+  RequestDecoder& newStream(ResponseEncoder& response_encoder, bool) override {
+    downstream_encoder_ = &response_encoder;
+    return *this;
+  }
+
+  // Http::StreamDecoder
+  void decodeData(Buffer::Instance&, bool) override {}
+  void decodeMetadata(MetadataMapPtr&&) override {}
+
+  // Http::RequestDecoder
+  void decodeHeaders(RequestHeaderMapPtr&& headers, bool) override {
+    request_headers_ = std::move(headers);
+  }
+  void decodeTrailers(RequestTrailerMapPtr&&) override {}
+  void sendLocalReply(bool, Code, absl::string_view, const std::function<void(ResponseHeaderMap&)>&,
+                      const absl::optional<Grpc::Status::GrpcStatus>, absl::string_view) override {}
+
+  // Http::ResponseDecoder
+  void decode100ContinueHeaders(ResponseHeaderMapPtr&&) override {}
+  void decodeHeaders(ResponseHeaderMapPtr&& headers, bool) override {
+    response_headers_ = std::move(headers);
+  }
+  void decodeTrailers(ResponseTrailerMapPtr&&) override {}
+
+private:
+  static constexpr absl::string_view Response =
+      "HTTP/1.1 200 OK\r\ncontent-type: application/json\r\ncontent-length: 0\r\n\r\n";
+
+  Stats::TestUtil::TestStore store_;
+  CodecStats::AtomicPtr stats_;
+  Http1Settings settings_;
+  NiceMock<Network::MockConnection> downstream_connection_;
+  NiceMock<Network::MockConnection> upstream_connection_;
+  ServerConnectionPtr server_;
+  ClientConnectionPtr client_;
+  std::string request_;
+  ResponseEncoder* downstream_encoder_{};
+  RequestHeaderMapPtr request_headers_;
+  ResponseHeaderMapPtr response_headers_;
+};
+
+// Proxies requests with 50 headers from HTTP/1 to HTTP/1. The argument selects whether header
+// values are copied (0), borrow the input (1), or borrow the input and have the headers which are
+// not modified written out upstream as they were received (2).
+static void http1ProxyRequest(benchmark::State& state) {
+  Proxy proxy(state.range(0) >= 1, state.range(0) == 2, 50);
+  for (auto _ : state) {
+    proxy.request();
+  }
+  benchmark::DoNotOptimize(proxy.written_bytes_);
+}
+BENCHMARK(http1ProxyRequest)->Arg(0)->Arg(1)->Arg(2);
+
+} // namespace
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -53,6 +53,22 @@ Buffer::OwnedImpl createBufferWithNByteSlices(absl::string_view input, size_t ma
   ASSERT(buffer.getRawSlices().size() == (input.size() + max_slice_size - 1) / max_slice_size);
   return buffer;
 }
+
+// The codecs under test: the legacy codec, and the new codec with each of its parsers.
+enum class CodecType { Legacy, New, NewSimdParser };
+
+std::string codecTypeName(const testing::TestParamInfo<CodecType>& param) {
+  switch (param.param) {
+  case CodecType::Legacy:
+    return "Legacy";
+  case CodecType::New:
+    return "New";
+  case CodecType::NewSimdParser:
+    return "NewSimdParser";
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
 } // namespace
 
 class Http1CodecTestBase {
@@ -66,9 +82,15 @@ protected:
 };
 
 class Http1ServerConnectionImplTest : public Http1CodecTestBase,
-                                      public testing::TestWithParam<bool> {
+                                      public testing::TestWithParam<CodecType> {
 public:
-  bool testingNewCodec() { return GetParam(); }
+  Http1ServerConnectionImplTest() {
+    if (GetParam() == CodecType::NewSimdParser) {
+      codec_settings_.parser_type_ = Http1Settings::ParserType::Simd;
+    }
+  }
+
+  bool testingNewCodec() { return GetParam() != CodecType::Legacy; }
 
   void initialize() {
     if (testingNewCodec()) {
@@ -328,10 +350,10 @@ void Http1ServerConnectionImplTest::testRequestHeadersAccepted(std::string heade
   EXPECT_TRUE(status.ok());
 }
 
-INSTANTIATE_TEST_SUITE_P(Codecs, Http1ServerConnectionImplTest, testing::Bool(),
-                         [](const testing::TestParamInfo<bool>& param) {
-                           return param.param ? "New" : "Legacy";
-                         });
+INSTANTIATE_TEST_SUITE_P(Codecs, Http1ServerConnectionImplTest,
+                         testing::Values(CodecType::Legacy, CodecType::New,
+                                         CodecType::NewSimdParser),
+                         codecTypeName);
 
 TEST_P(Http1ServerConnectionImplTest, EmptyHeader) {
   initialize();
@@ -827,6 +849,125 @@ TEST_P(Http1ServerConnectionImplTest, SimpleGet) {
   EXPECT_EQ(0U, buffer.length());
 }
 
+// Verify that header values borrowing the input remain valid once the input is released, and that
+// values split across slices are copied.
+TEST_P(Http1ServerConnectionImplTest, BorrowedHeaderValues) {
+  codec_settings_.borrow_header_values_ = true;
+  initialize();
+
+  MockRequestDecoder decoder;
+  EXPECT_CALL(callbacks_, newStream(_, _)).WillOnce(ReturnRef(decoder));
+  RequestHeaderMapPtr headers;
+  EXPECT_CALL(decoder, decodeHeaders_(_, true))
+      .WillOnce(Invoke([&](RequestHeaderMapPtr& decoded, bool) { headers = std::move(decoded); }));
+
+  {
+    Buffer::OwnedImpl buffer;
+    buffer.appendSliceForTest("GET / HTTP/1.1\r\nx-foo:  bar  \r\nx-line: baz\r\nx-split: ab");
+    buffer.appendSliceForTest("cd\r\n\r\n");
+    auto status = codec_->dispatch(buffer);
+    EXPECT_TRUE(status.ok());
+    EXPECT_EQ(0U, buffer.length());
+  }
+
+  ASSERT_NE(nullptr, headers);
+  const HeaderEntry* foo = headers->get(LowerCaseString("x-foo"));
+  ASSERT_NE(nullptr, foo);
+  EXPECT_EQ("bar", foo->value().getStringView());
+  EXPECT_EQ(testingNewCodec(), foo->value().isBorrowed());
+  // The line of the header is only recorded if reuse_raw_header_lines_ is set.
+  const HeaderEntry* line = headers->get(LowerCaseString("x-line"));
+  ASSERT_NE(nullptr, line);
+  EXPECT_EQ(testingNewCodec(), line->value().isBorrowed());
+  EXPECT_EQ("", line->value().borrowedRawHeader());
+  const HeaderEntry* split = headers->get(LowerCaseString("x-split"));
+  ASSERT_NE(nullptr, split);
+  EXPECT_EQ("abcd", split->value().getStringView());
+  EXPECT_FALSE(split->value().isBorrowed());
+}
+
+// Verify that the lines of the headers which can be written out as they were received are recorded
+// in their borrowed values.
+TEST_P(Http1ServerConnectionImplTest, BorrowedHeaderRawLines) {
+  codec_settings_.borrow_header_values_ = true;
+  codec_settings_.reuse_raw_header_lines_ = true;
+  initialize();
+
+  MockRequestDecoder decoder;
+  EXPECT_CALL(callbacks_, newStream(_, _)).WillOnce(ReturnRef(decoder));
+  RequestHeaderMapPtr headers;
+  EXPECT_CALL(decoder, decodeHeaders_(_, true))
+      .WillOnce(Invoke([&](RequestHeaderMapPtr& decoded, bool) { headers = std::move(decoded); }));
+
+  {
+    Buffer::OwnedImpl buffer;
+    buffer.appendSliceForTest("GET / HTTP/1.1\r\nx-a: 1\r\nx-b: 2\r\nX-Upper: 3\r\n"
+                              "x-spaces:  4\r\nx-tab:\t5\r\nx-trailing: 6 \r\nx-split");
+    buffer.appendSliceForTest(": 8\r\nx-last: 9");
+    buffer.appendSliceForTest("\r\n\r\n");
+    auto status = codec_->dispatch(buffer);
+    EXPECT_TRUE(status.ok());
+  }
+
+  ASSERT_NE(nullptr, headers);
+  const auto raw_line = [&headers](absl::string_view key) -> absl::string_view {
+    const HeaderEntry* entry = headers->get(LowerCaseString(std::string(key)));
+    EXPECT_NE(nullptr, entry);
+    return entry == nullptr ? absl::string_view() : entry->value().borrowedRawHeader();
+  };
+  if (testingNewCodec()) {
+    EXPECT_EQ("x-a: 1\r\n", raw_line("x-a"));
+    EXPECT_EQ("x-b: 2\r\n", raw_line("x-b"));
+    EXPECT_EQ(raw_line("x-a").data() + raw_line("x-a").size(), raw_line("x-b").data());
+  }
+  EXPECT_EQ("", raw_line("x-upper"));
+  EXPECT_EQ("", raw_line("x-spaces"));
+  EXPECT_EQ("", raw_line("x-tab"));
+  EXPECT_EQ("", raw_line("x-trailing"));
+  EXPECT_EQ("", raw_line("x-split"));
+  EXPECT_EQ("", raw_line("x-last"));
+}
+
+// Verify that headers with borrowed values are written out from their raw lines only when the lines
+// match them.
+TEST_P(Http1ServerConnectionImplTest, EncodeBorrowedHeaderRawLines) {
+  initialize();
+
+  NiceMock<MockRequestDecoder> decoder;
+  Http::ResponseEncoder* response_encoder = nullptr;
+  EXPECT_CALL(callbacks_, newStream(_, _))
+      .WillOnce(Invoke([&](ResponseEncoder& encoder, bool) -> RequestDecoder& {
+        response_encoder = &encoder;
+        return decoder;
+      }));
+  Buffer::OwnedImpl buffer("GET / HTTP/1.1\r\n\r\n");
+  auto status = codec_->dispatch(buffer);
+  EXPECT_TRUE(status.ok());
+
+  std::string output;
+  ON_CALL(connection_, write(_, _)).WillByDefault(AddBufferToString(&output));
+
+  auto storage = std::make_shared<const std::string>("x-a: 1\r\nx-b: 2\r\nx-c: 3\r\n");
+  const absl::string_view input(*storage);
+  TestResponseHeaderMapImpl headers{{":status", "200"}};
+  const auto add_borrowed = [&](absl::string_view key, size_t line_offset) {
+    HeaderString value;
+    value.setBorrowed(input.substr(line_offset + 5, 1), storage);
+    value.setBorrowedRawHeader(input.substr(line_offset, 8));
+    headers.addViaMove(HeaderString(key), std::move(value));
+  };
+  add_borrowed("x-a", 0);
+  add_borrowed("x-b", 8);
+  headers.addCopy(LowerCaseString("x-new"), "n");
+  add_borrowed("x-c", 16);
+  // The raw line of x-c does not match this header.
+  add_borrowed("x-d", 16);
+  response_encoder->encodeHeaders(headers, true);
+  EXPECT_EQ("HTTP/1.1 200 OK\r\nx-a: 1\r\nx-b: 2\r\nx-new: n\r\nx-c: 3\r\nx-d: 3\r\n"
+            "content-length: 0\r\n\r\n",
+            output);
+}
+
 TEST_P(Http1ServerConnectionImplTest, BadRequestNoStreamLegacy) {
   TestScopedRuntime scoped_runtime;
   Runtime::LoaderSingleton::getExisting()->mergeValues(
@@ -1841,9 +1982,15 @@ TEST_P(Http1ServerConnectionImplTest, WatermarkTest) {
 }
 
 class Http1ClientConnectionImplTest : public Http1CodecTestBase,
-                                      public testing::TestWithParam<bool> {
+                                      public testing::TestWithParam<CodecType> {
 public:
-  bool testingNewCodec() { return GetParam(); }
+  Http1ClientConnectionImplTest() {
+    if (GetParam() == CodecType::NewSimdParser) {
+      codec_settings_.parser_type_ = Http1Settings::ParserType::Simd;
+    }
+  }
+
+  bool testingNewCodec() { return GetParam() != CodecType::Legacy; }
 
   void initialize() {
     if (testingNewCodec()) {
@@ -1873,10 +2020,10 @@ protected:
   uint32_t max_response_headers_count_{Http::DEFAULT_MAX_HEADERS_COUNT};
 };
 
-INSTANTIATE_TEST_SUITE_P(Codecs, Http1ClientConnectionImplTest, testing::Bool(),
-                         [](const testing::TestParamInfo<bool>& param) {
-                           return param.param ? "New" : "Legacy";
-                         });
+INSTANTIATE_TEST_SUITE_P(Codecs, Http1ClientConnectionImplTest,
+                         testing::Values(CodecType::Legacy, CodecType::New,
+                                         CodecType::NewSimdParser),
+                         codecTypeName);
 
 TEST_P(Http1ClientConnectionImplTest, SimpleGet) {
   initialize();
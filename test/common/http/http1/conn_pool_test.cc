@@ -366,13 +366,17 @@ TEST_F(Http1ConnPoolImplTest, MultipleRequestAndResponse) {
 
   // Request 1 should kick off a new connection.
   ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  EXPECT_EQ(1U, conn_pool_->host()->outstandingRequests());
   r1.startRequest();
   r1.completeResponse(false);
+  EXPECT_EQ(0U, conn_pool_->host()->outstandingRequests());
 
   // Request 2 should not.
   ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Immediate);
+  EXPECT_EQ(1U, conn_pool_->host()->outstandingRequests());
   r2.startRequest();
   r2.completeResponse(true);
+  EXPECT_EQ(0U, conn_pool_->host()->outstandingRequests());
 
   // Cause the connection to go away.
   EXPECT_CALL(*conn_pool_, onClientDestroy());
@@ -380,6 +384,88 @@ TEST_F(Http1ConnPoolImplTest, MultipleRequestAndResponse) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Tests that connections established ahead of streams are counted as hits when they serve a
+ * stream and as wasted when they close before serving one.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchConnections) {
+  InSequence s;
+
+  // Establish a connection ahead of any stream, which serves the first request.
+  conn_pool_->expectClientCreate();
+  conn_pool_->prefetchConnections(1);
+  EXPECT_CALL(*conn_pool_->test_clients_[0].connect_timer_, disableTimer());
+  conn_pool_->test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::Immediate);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_hit_.value());
+  r1.startRequest();
+  r1.completeResponse(false);
+
+  // Establish a connection which closes before serving any stream.
+  conn_pool_->expectClientCreate();
+  conn_pool_->prefetchConnections(1);
+  EXPECT_CALL(*conn_pool_, onClientDestroy());
+  conn_pool_->test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_hit_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_wasted_.value());
+
+  // Cause the connection to go away.
+  EXPECT_CALL(*conn_pool_, onClientDestroy());
+  conn_pool_->test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Tests that a connection is established for the streams predicted to arrive while connecting,
+ * in addition to the connection for a pending stream.
+ */
+TEST_F(Http1ConnPoolImplTest, PredictedConnections) {
+  Event::SimulatedTimeSystem simulated_time;
+  ON_CALL(*cluster_, maxPredictedConnections()).WillByDefault(Return(1));
+
+  InSequence s;
+
+  // Without a measured connect time, only the connection for the stream is established.
+  conn_pool_->expectClientCreate();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::Pending);
+  simulated_time.advanceTimeWait(std::chrono::milliseconds(100));
+  r1.expectNewStream();
+  EXPECT_CALL(*conn_pool_->test_clients_[0].connect_timer_, disableTimer());
+  conn_pool_->test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+
+  // With two streams in the last 100ms and a connect time of 100ms, a stream is predicted while
+  // connecting for the second request, so a second connection is established for it.
+  conn_pool_->expectClientCreate();
+  conn_pool_->expectClientCreate();
+  ActiveTestRequest r2(*this, 2, ActiveTestRequest::Type::Pending);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+
+  // The prefetched connection connects first and serves the second request.
+  r2.expectNewStream();
+  EXPECT_CALL(*conn_pool_->test_clients_[2].connect_timer_, disableTimer());
+  conn_pool_->test_clients_[2].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_hit_.value());
+
+  r1.startRequest();
+  r1.completeResponse(false);
+  r2.startRequest();
+  r2.completeResponse(false);
+
+  // Cause the connections to go away.
+  while (!conn_pool_->test_clients_.empty()) {
+    EXPECT_CALL(*conn_pool_, onClientDestroy());
+    conn_pool_->test_clients_.front().connection_->raiseEvent(
+        Network::ConnectionEvent::RemoteClose);
+    dispatcher_.clearDeferredDeleteList();
+  }
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_prefetch_wasted_.value());
+}
+
 /**
  * Test when we overflow max pending requests.
  */
@@ -538,8 +624,11 @@ TEST_F(Http1ConnPoolImplTest, CancelBeforeBound) {
   conn_pool_->expectClientCreate();
   Http::ConnectionPool::Cancellable* handle = conn_pool_->newStream(outer_decoder, callbacks);
   EXPECT_NE(nullptr, handle);
+  // Pending requests count as outstanding.
+  EXPECT_EQ(1U, conn_pool_->host()->outstandingRequests());
 
   handle->cancel(Envoy::ConnectionPool::CancelPolicy::Default);
+  EXPECT_EQ(0U, conn_pool_->host()->outstandingRequests());
   conn_pool_->test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
 
   // Cause the connection to go away.
@@ -548,6 +637,38 @@ TEST_F(Http1ConnPoolImplTest, CancelBeforeBound) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that a cancelled pending request is reused for the next pending request.
+ */
+TEST_F(Http1ConnPoolImplTest, ReuseCancelledPendingRequest) {
+  InSequence s;
+
+  NiceMock<MockResponseDecoder> outer_decoder;
+  ConnPoolCallbacks callbacks;
+  conn_pool_->expectClientCreate();
+  Http::ConnectionPool::Cancellable* handle = conn_pool_->newStream(outer_decoder, callbacks);
+  EXPECT_NE(nullptr, handle);
+  handle->cancel(Envoy::ConnectionPool::CancelPolicy::Default);
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_pending_active_.value());
+
+  // The connecting client has capacity for the second request, which reuses the first.
+  NiceMock<MockResponseDecoder> outer_decoder2;
+  ConnPoolCallbacks callbacks2;
+  EXPECT_EQ(handle, conn_pool_->newStream(outer_decoder2, callbacks2));
+  EXPECT_EQ(2U, cluster_->stats_.upstream_rq_pending_total_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pending_active_.value());
+  EXPECT_EQ(1U, conn_pool_->host()->outstandingRequests());
+
+  // The connection failure is reported to the callbacks of the second request.
+  EXPECT_CALL(callbacks2.pool_failure_, ready());
+  EXPECT_CALL(*conn_pool_->test_clients_[0].connect_timer_, disableTimer());
+  conn_pool_->test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*conn_pool_, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_pending_active_.value());
+  EXPECT_EQ(0U, conn_pool_->host()->outstandingRequests());
+}
+
 /**
  * Test cancelling with CloseExcess
  */
@@ -0,0 +1,180 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/http/codec.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/http2/codec_impl.h"
+#include "common/runtime/runtime_impl.h"
+
+#include "test/common/http/http2/codec_impl_test_util.h"
+#include "test/common/stats/stat_test_utility.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/test_runtime.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+// Passes the writes of one codec to the other, deferring the writes made while the other codec is
+// already dispatching.
+struct Pipe {
+  void dispatch(Buffer::Instance& data, Connection& connection) {
+    buffer_.move(data);
+    if (dispatching_) {
+      return;
+    }
+    dispatching_ = true;
+    while (buffer_.length() > 0) {
+      RELEASE_ASSERT(connection.dispatch(buffer_).ok(), "");
+    }
+    dispatching_ = false;
+  }
+
+  bool dispatching_{};
+  Buffer::OwnedImpl buffer_;
+};
+
+// A client and a server codec connected back to back, which send a response body of
+// |body_size| bytes in slices of |slice_size| bytes for each request.
+class CodecPair {
+public:
+  CodecPair(uint64_t body_size, uint64_t slice_size)
+      : options_(::Envoy::Http2::Utility::initializeAndValidateOptions(
+            envoy::config::core::v3::Http2ProtocolOptions())),
+        slice_(slice_size, 'a'), slices_per_body_(body_size / slice_size) {
+    client_ = std::make_unique<TestClientConnectionImplNew>(
+        client_connection_, client_callbacks_, client_stats_store_, options_,
+        Http::DEFAULT_MAX_REQUEST_HEADERS_KB, Http::DEFAULT_MAX_HEADERS_COUNT,
+        ProdNghttp2SessionFactoryNew::get());
+    server_ = std::make_unique<TestServerConnectionImplNew>(
+        server_connection_, server_callbacks_, server_stats_store_, options_,
+        Http::DEFAULT_MAX_REQUEST_HEADERS_KB, Http::DEFAULT_MAX_HEADERS_COUNT,
+        envoy::config::core::v3::HttpProtocolOptions::ALLOW);
+
+    ON_CALL(client_connection_, write(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool) -> void {
+          to_server_.dispatch(data, *server_);
+        }));
+    ON_CALL(server_connection_, write(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool) -> void {
+          ++writes_;
+          for (const Buffer::RawSlice& slice : data.getRawSlices()) {
+            if (!isBodyMemory(slice.mem_)) {
+              copied_bytes_ += slice.len_;
+            }
+          }
+          to_client_.dispatch(data, *client_);
+        }));
+    ON_CALL(server_callbacks_, newStream(_, _))
+        .WillByDefault(Invoke([this](ResponseEncoder& encoder, bool) -> RequestDecoder& {
+          response_encoder_ = &encoder;
+          return request_decoder_;
+        }));
+  }
+
+  ~CodecPair() {
+    client_connection_.dispatcher_.clearDeferredDeleteList();
+    server_connection_.dispatcher_.clearDeferredDeleteList();
+  }
+
+  void request() {
+    RequestEncoder& request_encoder = client_->newStream(response_decoder_);
+    request_encoder.encodeHeaders(request_headers_, true);
+
+    Buffer::OwnedImpl body;
+    for (uint64_t i = 0; i < slices_per_body_; ++i) {
+      body.appendSliceForTest(slice_);
+    }
+    body_slices_ = body.getRawSlices();
+    response_encoder_->encodeHeaders(response_headers_, false);
+    response_encoder_->encodeData(body, true);
+    body_slices_.clear();
+
+    client_connection_.dispatcher_.to_delete_.clear();
+    server_connection_.dispatcher_.to_delete_.clear();
+  }
+
+  // Bytes written by the server which are not a reference to the memory of the response body,
+  // i.e. the frame headers, the HEADERS frames and the body bytes which were copied.
+  uint64_t copied_bytes_{};
+  uint64_t writes_{};
+
+private:
+  bool isBodyMemory(const void* mem) const {
+    for (const Buffer::RawSlice& slice : body_slices_) {
+      if (mem >= slice.mem_ && mem < static_cast<const uint8_t*>(slice.mem_) + slice.len_) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const envoy::config::core::v3::Http2ProtocolOptions options_;
+  const std::string slice_;
+  const uint64_t slices_per_body_;
+  const TestRequestHeaderMapImpl request_headers_{
+      {":method", "GET"}, {":path", "/"}, {":scheme", "http"}, {":authority", "host"}};
+  const TestResponseHeaderMapImpl response_headers_{{":status", "200"}};
+  Buffer::RawSliceVector body_slices_;
+  Stats::TestUtil::TestStore client_stats_store_;
+  NiceMock<Network::MockConnection> client_connection_;
+  NiceMock<MockConnectionCallbacks> client_callbacks_;
+  std::unique_ptr<TestClientConnection> client_;
+  Pipe to_client_;
+  Stats::TestUtil::TestStore server_stats_store_;
+  NiceMock<Network::MockConnection> server_connection_;
+  NiceMock<MockServerConnectionCallbacks> server_callbacks_;
+  std::unique_ptr<TestServerConnection> server_;
+  Pipe to_server_;
+  NiceMock<MockResponseDecoder> response_decoder_;
+  NiceMock<MockRequestDecoder> request_decoder_;
+  ResponseEncoder* response_encoder_{};
+};
+
+// Sends 1MiB response bodies in slices which do not line up with the 16KiB DATA frames, so that
+// most frames end in the middle of a slice. The first argument selects whether the frames
+// serialized at once are written to the connection at once, the second whether the parts of slices
+// moved into frames share the memory of the slice.
+static void codecResponseBody(benchmark::State& state) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.http2_batch_frame_writes", state.range(0) ? "true" : "false"},
+       {"envoy.reloadable_features.buffer_share_partial_slices",
+        state.range(1) ? "true" : "false"}});
+  CodecPair codecs(1024 * 1024, 16000);
+
+  for (auto _ : state) {
+    codecs.request();
+  }
+  state.counters["copied_bytes_per_request"] =
+      benchmark::Counter(codecs.copied_bytes_, benchmark::Counter::kAvgIterations);
+  state.counters["writes_per_request"] =
+      benchmark::Counter(codecs.writes_, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(codecResponseBody)
+    ->Args({0, 0})
+    ->Args({0, 1})
+    ->Args({1, 0})
+    ->Args({1, 1})
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -1837,6 +1837,55 @@ TEST_P(Http2CodecImplTestAll, TestCodecHeaderCompression) {
   }
 }
 
+// Verify that the headers with values unique to each stream are not added to the HPACK dynamic
+// table, so that the header fields repeated across streams keep being sent as table indexes.
+TEST_P(Http2CodecImplTest, NeverIndexUniqueHeaderValues) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.http2_never_index_unique_header_values", "true"}});
+  initialize();
+
+  std::vector<uint64_t> response_encoded_bytes;
+  for (uint32_t i = 0; i < 100; ++i) {
+    MockResponseDecoder response_decoder;
+    RequestEncoder* request_encoder = &client_->newStream(response_decoder);
+    TestRequestHeaderMapImpl request_headers;
+    HttpTestUtility::addDefaultHeaders(request_headers);
+    EXPECT_CALL(request_decoder_, decodeHeaders_(_, true));
+    request_encoder->encodeHeaders(request_headers, true);
+
+    // Spell each request ID with characters of the same Huffman code length, so that the encoded
+    // size of the responses does not depend on it.
+    std::string request_id(36, '0');
+    for (uint32_t n = i, digit = 0; n > 0; n /= 3, ++digit) {
+      request_id[digit] = '0' + n % 3;
+    }
+    TestResponseHeaderMapImpl response_headers{{":status", "200"},
+                                               {"server", "envoy"},
+                                               {"content-type", "application/grpc"},
+                                               {"x-request-id", request_id}};
+    const uint64_t raw_bytes = server_stats_store_.counter("http2.tx_headers_raw_bytes").value();
+    const uint64_t encoded_bytes =
+        server_stats_store_.counter("http2.tx_headers_encoded_bytes").value();
+    EXPECT_CALL(response_decoder, decodeHeaders_(_, true));
+    response_encoder_->encodeHeaders(response_headers, true);
+    EXPECT_EQ(response_headers.byteSize(),
+              server_stats_store_.counter("http2.tx_headers_raw_bytes").value() - raw_bytes);
+    response_encoded_bytes.push_back(
+        server_stats_store_.counter("http2.tx_headers_encoded_bytes").value() - encoded_bytes);
+  }
+
+  // Only the server and content-type header fields are in the dynamic table, and every response
+  // after the first one is encoded to the same size.
+  EXPECT_EQ((6u + 5 + 32) + (12 + 16 + 32),
+            nghttp2_session_get_hd_deflate_dynamic_table_size(server_->session()));
+  EXPECT_LT(response_encoded_bytes[1], response_encoded_bytes[0]);
+  for (uint32_t i = 2; i < response_encoded_bytes.size(); ++i) {
+    EXPECT_EQ(response_encoded_bytes[1], response_encoded_bytes[i]);
+  }
+  EXPECT_LT(0, client_stats_store_.counter("http2.tx_headers_encoded_bytes").value());
+}
+
 // Verify that codec detects PING flood
 TEST_P(Http2CodecImplTest, PingFlood) {
   initialize();
@@ -2008,6 +2057,51 @@ TEST_P(Http2CodecImplTest, ResponseDataFlood) {
   EXPECT_EQ(1, server_stats_store_.counter("http2.outbound_flood").value());
 }
 
+// Verify that the frames sent at once are written to the connection at once when frame writes are
+// batched, and that they are still counted one by one against the outbound frame limit.
+TEST_P(Http2CodecImplTest, ResponseDataFloodBatchedFrameWrites) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.http2_batch_frame_writes", "true"}});
+  static const int kMaxOutboundFrames = 100;
+  max_outbound_frames_ = kMaxOutboundFrames;
+  initialize();
+
+  TestRequestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+  request_encoder_->encodeHeaders(request_headers, false);
+
+  int write_count = 0;
+  Buffer::OwnedImpl buffer;
+  ON_CALL(server_connection_, write(_, _))
+      .WillByDefault(Invoke([&buffer, &write_count](Buffer::Instance& frame, bool) {
+        ++write_count;
+        buffer.move(frame);
+      }));
+
+  TestResponseHeaderMapImpl response_headers{{":status", "200"}};
+  response_encoder_->encodeHeaders(response_headers, false);
+  // Account for the single HEADERS frame above. The body is sent in DATA frames of 16KiB.
+  Buffer::OwnedImpl data(std::string((kMaxOutboundFrames - 1) * 16384, 'a'));
+  EXPECT_NO_THROW(response_encoder_->encodeData(data, false));
+  // The legacy codec does not batch frame writes.
+  const int expected_write_count =
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.new_codec_behavior")
+          ? 2
+          : kMaxOutboundFrames;
+  EXPECT_EQ(expected_write_count, write_count);
+
+  // Presently flood mitigation is done only when processing downstream data
+  // So we need to send stream from downstream client to trigger mitigation
+  EXPECT_EQ(0, nghttp2_submit_ping(client_->session(), NGHTTP2_FLAG_NONE, nullptr));
+  EXPECT_THROW_WITH_MESSAGE(client_->sendPendingFrames().IgnoreError(), ServerCodecError,
+                            "Too many frames in the outbound queue.");
+
+  EXPECT_EQ(expected_write_count, write_count);
+  EXPECT_EQ(1, server_stats_store_.counter("http2.outbound_flood").value());
+}
+
 // Verify that codec allows outbound DATA flood when mitigation is disabled
 TEST_P(Http2CodecImplTest, ResponseDataFloodMitigationDisabled) {
   max_outbound_control_frames_ = 2147483647;
@@ -0,0 +1,237 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "envoy/http/codec.h"
+#include "envoy/http/conn_pool.h"
+
+#include "common/common/assert.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/http2/shared_conn_pool.h"
+#include "common/stream_info/stream_info_impl.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+// A pool whose streams are ready at once, and which responds to each request as soon as it is
+// complete, so that the benchmarks measure only the cost of passing streams between workers.
+class ImmediatePool : public ConnectionPool::Instance,
+                      public RequestEncoder,
+                      public Stream {
+public:
+  ImmediatePool(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host)
+      : host_(std::move(host)), stream_info_(Protocol::Http2, dispatcher.timeSource()) {}
+
+  // Http::ConnectionPool::Instance
+  Protocol protocol() const override { return Protocol::Http2; }
+  void addDrainedCallback(DrainedCb cb) override { cb(); }
+  void drainConnections() override {}
+  bool hasActiveConnections() const override { return false; }
+  Upstream::HostDescriptionConstSharedPtr host() const override { return host_; }
+  ConnectionPool::Cancellable* newStream(ResponseDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks) override {
+    response_decoder_ = &response_decoder;
+    callbacks.onPoolReady(*this, host_, stream_info_);
+    return nullptr;
+  }
+  void prefetchConnections(uint32_t) override {}
+
+  // Http::StreamEncoder
+  void encodeData(Buffer::Instance&, bool end_stream) override { onEncode(end_stream); }
+  Stream& getStream() override { return *this; }
+  void encodeMetadata(const MetadataMapVector&) override {}
+  Http1StreamEncoderOptionsOptRef http1StreamEncoderOptions() override { return absl::nullopt; }
+
+  // Http::RequestEncoder
+  void encodeHeaders(const RequestHeaderMap&, bool end_stream) override { onEncode(end_stream); }
+  void encodeTrailers(const RequestTrailerMap&) override { onEncode(true); }
+
+  // Http::Stream
+  void addCallbacks(StreamCallbacks&) override {}
+  void removeCallbacks(StreamCallbacks&) override {}
+  void resetStream(StreamResetReason) override {}
+  void readDisable(bool) override {}
+  uint32_t bufferLimit() override { return 0; }
+  const Network::Address::InstanceConstSharedPtr& connectionLocalAddress() override {
+    return connection_local_address_;
+  }
+  void setFlushTimeout(std::chrono::milliseconds) override {}
+
+private:
+  void onEncode(bool end_stream) {
+    if (end_stream) {
+      auto headers = ResponseHeaderMapImpl::create();
+      headers->setStatus(200);
+      response_decoder_->decodeHeaders(std::move(headers), true);
+    }
+  }
+
+  const Upstream::HostConstSharedPtr host_;
+  StreamInfo::StreamInfoImpl stream_info_;
+  const Network::Address::InstanceConstSharedPtr connection_local_address_;
+  ResponseDecoder* response_decoder_{};
+};
+
+// Sends a request and records when its response is complete.
+class Request : public ResponseDecoder, public ConnectionPool::Callbacks {
+public:
+  Request() { headers_->setMethod("GET"); }
+
+  // Http::StreamDecoder
+  void decodeData(Buffer::Instance&, bool end_stream) override { done_ = end_stream; }
+  void decodeMetadata(MetadataMapPtr&&) override {}
+
+  // Http::ResponseDecoder
+  void decode100ContinueHeaders(ResponseHeaderMapPtr&&) override {}
+  void decodeHeaders(ResponseHeaderMapPtr&&, bool end_stream) override { done_ = end_stream; }
+  void decodeTrailers(ResponseTrailerMapPtr&&) override { done_ = true; }
+
+  // ConnectionPool::Callbacks
+  void onPoolFailure(ConnectionPool::PoolFailureReason, absl::string_view,
+                     Upstream::HostDescriptionConstSharedPtr) override {
+    done_ = true;
+  }
+  void onPoolReady(RequestEncoder& encoder, Upstream::HostDescriptionConstSharedPtr,
+                   const StreamInfo::StreamInfo&) override {
+    encoder.encodeHeaders(*headers_, true);
+  }
+
+  RequestHeaderMapPtr headers_{RequestHeaderMapImpl::create()};
+  bool done_{};
+};
+
+class SharedConnPoolSpeedTest {
+public:
+  SharedConnPoolSpeedTest()
+      : api_(Api::createApiForTest()), owner_dispatcher_(api_->allocateDispatcher("owner")),
+        remote_dispatcher_(api_->allocateDispatcher("remote")),
+        host_(Upstream::makeTestHost(cluster_, "tcp://127.0.0.1:80")) {
+    owner_pool_ = allocate(*owner_dispatcher_);
+    remote_pool_ = allocate(*remote_dispatcher_);
+  }
+
+  ConnectionPool::InstancePtr allocate(Event::Dispatcher& dispatcher) {
+    return registry_->allocateConnPool(
+        dispatcher, host_, Upstream::ResourcePriority::Default, 2,
+        [this]() { return std::make_unique<ImmediatePool>(*owner_dispatcher_, host_); });
+  }
+
+  // Completes a request of the worker owning the shared pool, which does not leave its worker.
+  void ownerRequest() {
+    Request request;
+    owner_pool_->newStream(request, request);
+    RELEASE_ASSERT(request.done_, "");
+  }
+
+  // Completes a request of a remote worker, while the worker owning the shared pool runs on its
+  // own thread.
+  void remoteRequest() {
+    Request request;
+    remote_pool_->newStream(request, request);
+    while (!request.done_) {
+      remote_dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
+  void startOwner() {
+    owner_thread_ = api_->threadFactory().createThread(
+        [this]() { owner_dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit); });
+  }
+
+  void stopOwner() {
+    owner_dispatcher_->exit();
+    owner_thread_->join();
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr owner_dispatcher_;
+  Event::DispatcherPtr remote_dispatcher_;
+  std::shared_ptr<Upstream::MockClusterInfo> cluster_{
+      new testing::NiceMock<Upstream::MockClusterInfo>()};
+  Upstream::HostSharedPtr host_;
+  SharedConnPoolRegistrySharedPtr registry_{std::make_shared<SharedConnPoolRegistry>()};
+  ConnectionPool::InstancePtr owner_pool_;
+  ConnectionPool::InstancePtr remote_pool_;
+  Thread::ThreadPtr owner_thread_;
+};
+
+// The latency of requests of the worker owning the shared pool, which is that of an unshared pool.
+void BM_OwnerRequest(benchmark::State& state) {
+  SharedConnPoolSpeedTest test;
+  for (auto _ : state) {
+    test.ownerRequest();
+  }
+}
+BENCHMARK(BM_OwnerRequest);
+
+// The latency of requests of other workers, which includes two hand-offs between threads.
+void BM_RemoteRequest(benchmark::State& state) {
+  SharedConnPoolSpeedTest test;
+  test.startOwner();
+  for (auto _ : state) {
+    test.remoteRequest();
+  }
+  test.stopOwner();
+}
+BENCHMARK(BM_RemoteRequest)->UseRealTime();
+
+// The number of pools, and so of connections to each host, which workers establish when they are
+// grouped to share pools.
+void BM_PoolCount(benchmark::State& state) {
+  const uint32_t num_workers = state.range(0);
+  const uint32_t num_hosts = state.range(1);
+  const uint32_t group_size = state.range(2);
+
+  Api::ApiPtr api = Api::createApiForTest();
+  std::vector<Event::DispatcherPtr> dispatchers;
+  for (uint32_t i = 0; i < num_workers; i++) {
+    dispatchers.push_back(api->allocateDispatcher(absl::StrCat("worker_", i)));
+  }
+  std::shared_ptr<Upstream::MockClusterInfo> cluster{
+      new testing::NiceMock<Upstream::MockClusterInfo>()};
+  std::vector<Upstream::HostSharedPtr> hosts;
+  for (uint32_t i = 0; i < num_hosts; i++) {
+    hosts.push_back(Upstream::makeTestHost(
+        cluster, absl::StrCat("tcp://10.0.", i / 256, ".", i % 256, ":80")));
+  }
+
+  size_t shared_pools = 0;
+  for (auto _ : state) {
+    auto registry = std::make_shared<SharedConnPoolRegistry>();
+    std::vector<ConnectionPool::InstancePtr> pools;
+    for (const Event::DispatcherPtr& dispatcher : dispatchers) {
+      for (const Upstream::HostSharedPtr& host : hosts) {
+        pools.push_back(registry->allocateConnPool(
+            *dispatcher, host, Upstream::ResourcePriority::Default, group_size,
+            [&dispatcher, &host]() { return std::make_unique<ImmediatePool>(*dispatcher, host); }));
+      }
+    }
+    shared_pools = registry->numSharedPools();
+  }
+  state.counters["unshared_pools"] = num_workers * num_hosts;
+  state.counters["shared_pools"] = shared_pools;
+}
+BENCHMARK(BM_PoolCount)
+    ->Args({8, 100, 1})
+    ->Args({8, 100, 2})
+    ->Args({8, 100, 4})
+    ->Args({8, 100, 8})
+    ->Args({32, 100, 4})
+    ->Args({32, 100, 32})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
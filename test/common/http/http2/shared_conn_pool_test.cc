@@ -0,0 +1,383 @@
+#include <memory>
+
+#include "common/http/http2/shared_conn_pool.h"
+
+#include "test/common/http/common.h"
+#include "test/common/upstream/utility.h"
+#include "test/mocks/common.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+class SharedConnPoolTest : public testing::Test {
+public:
+  SharedConnPoolTest()
+      : api_(Api::createApiForTest()), owner_dispatcher_(api_->allocateDispatcher("owner")),
+        remote_dispatcher_(api_->allocateDispatcher("remote")),
+        third_dispatcher_(api_->allocateDispatcher("third")),
+        registry_(std::make_shared<SharedConnPoolRegistry>()),
+        host_(Upstream::makeTestHost(cluster_, "tcp://127.0.0.1:80")) {
+    owner_pool_ = allocate(*owner_dispatcher_);
+    remote_pool_ = allocate(*remote_dispatcher_);
+  }
+
+  ConnectionPool::InstancePtr allocate(Event::Dispatcher& dispatcher) {
+    return registry_->allocateConnPool(
+        dispatcher, host_, Upstream::ResourcePriority::Default, 2, [this]() {
+          auto pool = std::make_unique<NiceMock<ConnectionPool::MockInstance>>();
+          shared_pool_ = pool.get();
+          return pool;
+        });
+  }
+
+  // Runs the events posted between the workers.
+  void runWorkers() {
+    for (int i = 0; i < 2; i++) {
+      owner_dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+      remote_dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
+  // Starts a stream on the remote pool, which the shared pool serves at once.
+  void startStream() {
+    EXPECT_CALL(*shared_pool_, newStream(_, _))
+        .WillOnce(Invoke([this](ResponseDecoder& decoder, ConnectionPool::Callbacks& callbacks)
+                             -> ConnectionPool::Cancellable* {
+          shared_decoder_ = &decoder;
+          callbacks.onPoolReady(encoder_, host_, stream_info_);
+          return nullptr;
+        }));
+    EXPECT_NE(nullptr, remote_pool_->newStream(decoder_, callbacks_));
+    EXPECT_CALL(callbacks_.pool_ready_, ready());
+    runWorkers();
+    ASSERT_NE(nullptr, callbacks_.outer_encoder_);
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr owner_dispatcher_;
+  Event::DispatcherPtr remote_dispatcher_;
+  Event::DispatcherPtr third_dispatcher_;
+  std::shared_ptr<SharedConnPoolRegistry> registry_;
+  std::shared_ptr<Upstream::MockClusterInfo> cluster_{new NiceMock<Upstream::MockClusterInfo>()};
+  Upstream::HostSharedPtr host_;
+  ConnectionPool::InstancePtr owner_pool_;
+  ConnectionPool::InstancePtr remote_pool_;
+  ConnectionPool::MockInstance* shared_pool_{};
+  NiceMock<MockRequestEncoder> encoder_;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+  ResponseDecoder* shared_decoder_{};
+  NiceMock<MockResponseDecoder> decoder_;
+  ConnPoolCallbacks callbacks_;
+};
+
+// Workers share a pool in groups of the configured size.
+TEST_F(SharedConnPoolTest, Groups) {
+  EXPECT_EQ(1, registry_->numSharedPools());
+  ConnectionPool::MockInstance* first_pool = shared_pool_;
+
+  // The third worker starts a new group.
+  ConnectionPool::InstancePtr third_pool = allocate(*third_dispatcher_);
+  EXPECT_NE(first_pool, shared_pool_);
+  EXPECT_EQ(2, registry_->numSharedPools());
+
+  // Streams of the owner go straight to the shared pool.
+  EXPECT_CALL(*first_pool, newStream(_, _)).WillOnce(Return(nullptr));
+  owner_pool_->newStream(decoder_, callbacks_);
+
+  third_pool.reset();
+  EXPECT_EQ(1, registry_->numSharedPools());
+
+  // A worker stays in its group when it allocates a pool again, whatever the other workers do.
+  third_pool = allocate(*third_dispatcher_);
+  EXPECT_EQ(2, registry_->numSharedPools());
+  remote_pool_.reset();
+  remote_pool_ = allocate(*remote_dispatcher_);
+  EXPECT_EQ(2, registry_->numSharedPools());
+  EXPECT_CALL(*first_pool, newStream(_, _)).WillOnce(Return(nullptr));
+  remote_pool_->newStream(decoder_, callbacks_);
+  runWorkers();
+}
+
+// A group is released once the pools of all of its workers are destroyed, so that its next pool
+// is allocated afresh.
+TEST_F(SharedConnPoolTest, GroupReleased) {
+  ConnectionPool::MockInstance* first_pool = shared_pool_;
+  owner_pool_.reset();
+  remote_pool_.reset();
+  EXPECT_EQ(0, registry_->numSharedPools());
+
+  remote_pool_ = allocate(*remote_dispatcher_);
+  EXPECT_EQ(1, registry_->numSharedPools());
+  EXPECT_NE(first_pool, shared_pool_);
+  // The worker which allocated the pool first owns it.
+  EXPECT_CALL(*shared_pool_, newStream(_, _)).WillOnce(Return(nullptr));
+  remote_pool_->newStream(decoder_, callbacks_);
+}
+
+// A stream of a remote worker is encoded by, and its response decoded on, the worker owning the
+// shared pool.
+TEST_F(SharedConnPoolTest, RemoteStream) {
+  startStream();
+  EXPECT_TRUE(remote_pool_->hasActiveConnections());
+
+  TestRequestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/"}};
+  EXPECT_CALL(encoder_, encodeHeaders(HeaderMapEqualRef(&request_headers), false));
+  callbacks_.outer_encoder_->encodeHeaders(request_headers, false);
+  Buffer::OwnedImpl request_body("hello");
+  callbacks_.outer_encoder_->encodeData(request_body, true);
+  EXPECT_EQ(0, request_body.length());
+  EXPECT_CALL(encoder_, encodeData(BufferStringEqual("hello"), true));
+  runWorkers();
+
+  EXPECT_CALL(decoder_, decodeHeaders_(_, false));
+  shared_decoder_->decodeHeaders(
+      ResponseHeaderMapPtr{new TestResponseHeaderMapImpl{{":status", "200"}}}, false);
+  EXPECT_CALL(decoder_, decodeTrailers_(_));
+  shared_decoder_->decodeTrailers(
+      ResponseTrailerMapPtr{new TestResponseTrailerMapImpl{{"grpc-status", "0"}}});
+  runWorkers();
+
+  EXPECT_FALSE(remote_pool_->hasActiveConnections());
+  ReadyWatcher drained;
+  EXPECT_CALL(drained, ready());
+  remote_pool_->addDrainedCallback([&drained]() -> void { drained.ready(); });
+}
+
+// A reset of the stream in the shared pool resets the stream of the remote worker.
+TEST_F(SharedConnPoolTest, ResetByOwner) {
+  startStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  encoder_.stream_.resetStream(StreamResetReason::RemoteReset);
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::RemoteReset, _));
+  runWorkers();
+  EXPECT_FALSE(remote_pool_->hasActiveConnections());
+}
+
+// A reset by the remote worker resets the stream in the shared pool.
+TEST_F(SharedConnPoolTest, ResetByRemote) {
+  startStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::LocalReset, _));
+  callbacks_.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+  EXPECT_FALSE(remote_pool_->hasActiveConnections());
+
+  EXPECT_CALL(encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  runWorkers();
+}
+
+// Watermark events of the stream in the shared pool reach the stream of the remote worker.
+TEST_F(SharedConnPoolTest, Watermarks) {
+  startStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  encoder_.stream_.runHighWatermarkCallbacks();
+  EXPECT_CALL(stream_callbacks, onAboveWriteBufferHighWatermark());
+  runWorkers();
+  encoder_.stream_.runLowWatermarkCallbacks();
+  EXPECT_CALL(stream_callbacks, onBelowWriteBufferLowWatermark());
+  runWorkers();
+
+  EXPECT_CALL(encoder_.stream_, readDisable(true));
+  callbacks_.outer_encoder_->getStream().readDisable(true);
+  runWorkers();
+
+  callbacks_.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+  runWorkers();
+}
+
+// Request bodies which the worker owning the shared pool has yet to encode count against the
+// buffer limit of the stream.
+TEST_F(SharedConnPoolTest, RequestDataWatermarks) {
+  ON_CALL(encoder_.stream_, bufferLimit()).WillByDefault(Return(10));
+  startStream();
+  EXPECT_EQ(10, callbacks_.outer_encoder_->getStream().bufferLimit());
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  Buffer::OwnedImpl small("hello");
+  callbacks_.outer_encoder_->encodeData(small, false);
+  EXPECT_CALL(stream_callbacks, onAboveWriteBufferHighWatermark());
+  Buffer::OwnedImpl large("hello world");
+  callbacks_.outer_encoder_->encodeData(large, false);
+
+  EXPECT_CALL(encoder_, encodeData(_, false)).Times(2);
+  EXPECT_CALL(stream_callbacks, onBelowWriteBufferLowWatermark());
+  runWorkers();
+
+  callbacks_.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+  runWorkers();
+}
+
+// Response bodies which the remote worker has yet to decode stop reading from the connection once
+// they are above the buffer limit of the stream.
+TEST_F(SharedConnPoolTest, ResponseDataWatermarks) {
+  ON_CALL(encoder_.stream_, bufferLimit()).WillByDefault(Return(10));
+  startStream();
+
+  EXPECT_CALL(decoder_, decodeHeaders_(_, false));
+  shared_decoder_->decodeHeaders(
+      ResponseHeaderMapPtr{new TestResponseHeaderMapImpl{{":status", "200"}}}, false);
+  Buffer::OwnedImpl small("hello");
+  shared_decoder_->decodeData(small, false);
+  EXPECT_CALL(encoder_.stream_, readDisable(true));
+  Buffer::OwnedImpl large("hello world");
+  shared_decoder_->decodeData(large, false);
+
+  EXPECT_CALL(decoder_, decodeData(_, false)).Times(2);
+  EXPECT_CALL(encoder_.stream_, readDisable(false));
+  runWorkers();
+
+  callbacks_.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+  runWorkers();
+}
+
+// Each stream of a remote worker has its own stream info.
+TEST_F(SharedConnPoolTest, StreamInfoPerStream) {
+  startStream();
+  const StreamInfo::StreamInfo* first_info = callbacks_.stream_info_;
+  ASSERT_NE(nullptr, first_info);
+  EXPECT_EQ(Http::Protocol::Http2, first_info->protocol());
+
+  ConnPoolCallbacks second_callbacks;
+  NiceMock<MockResponseDecoder> second_decoder;
+  EXPECT_CALL(*shared_pool_, newStream(_, _))
+      .WillOnce(Invoke([this](ResponseDecoder&, ConnectionPool::Callbacks& callbacks)
+                           -> ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder_, host_, stream_info_);
+        return nullptr;
+      }));
+  remote_pool_->newStream(second_decoder, second_callbacks);
+  EXPECT_CALL(second_callbacks.pool_ready_, ready());
+  runWorkers();
+  EXPECT_NE(first_info, second_callbacks.stream_info_);
+
+  callbacks_.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+  second_callbacks.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+  runWorkers();
+}
+
+// Cancelling a stream which is pending in the shared pool cancels it there.
+TEST_F(SharedConnPoolTest, Cancel) {
+  Envoy::ConnectionPool::MockCancellable cancellable;
+  EXPECT_CALL(*shared_pool_, newStream(_, _)).WillOnce(Return(&cancellable));
+  ConnectionPool::Cancellable* handle = remote_pool_->newStream(decoder_, callbacks_);
+  runWorkers();
+
+  handle->cancel(Envoy::ConnectionPool::CancelPolicy::Default);
+  EXPECT_FALSE(remote_pool_->hasActiveConnections());
+  EXPECT_CALL(cancellable, cancel(Envoy::ConnectionPool::CancelPolicy::Default));
+  runWorkers();
+}
+
+// A stream which is cancelled before its worker learns that it is ready is reset in the shared
+// pool.
+TEST_F(SharedConnPoolTest, CancelBeforeReady) {
+  ConnectionPool::Cancellable* handle = remote_pool_->newStream(decoder_, callbacks_);
+  handle->cancel(Envoy::ConnectionPool::CancelPolicy::Default);
+
+  EXPECT_CALL(*shared_pool_, newStream(_, _))
+      .WillOnce(Invoke([this](ResponseDecoder&, ConnectionPool::Callbacks& callbacks)
+                           -> ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder_, host_, stream_info_);
+        return nullptr;
+      }));
+  EXPECT_CALL(encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  EXPECT_CALL(callbacks_.pool_ready_, ready()).Times(0);
+  runWorkers();
+}
+
+// Failures of the shared pool reach the remote worker.
+TEST_F(SharedConnPoolTest, PoolFailure) {
+  EXPECT_CALL(*shared_pool_, newStream(_, _))
+      .WillOnce(Invoke([this](ResponseDecoder&, ConnectionPool::Callbacks& callbacks)
+                           -> ConnectionPool::Cancellable* {
+        callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::RemoteConnectionFailure,
+                                "connection refused", host_);
+        return nullptr;
+      }));
+  remote_pool_->newStream(decoder_, callbacks_);
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  runWorkers();
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::RemoteConnectionFailure, callbacks_.reason_);
+  EXPECT_FALSE(remote_pool_->hasActiveConnections());
+}
+
+// Once the pool of the owner is destroyed, a remote worker allocates another pool for its next
+// streams, which it owns if it is the first of its group to do so.
+TEST_F(SharedConnPoolTest, OwnerDestroyed) {
+  ConnectionPool::MockInstance* first_pool = shared_pool_;
+  owner_pool_.reset();
+  EXPECT_EQ(0, registry_->numSharedPools());
+
+  EXPECT_CALL(*first_pool, newStream(_, _)).Times(0);
+  remote_pool_->newStream(decoder_, callbacks_);
+  EXPECT_NE(first_pool, shared_pool_);
+  EXPECT_EQ(1, registry_->numSharedPools());
+
+  // The other worker of the group shares the new pool.
+  owner_pool_ = allocate(*owner_dispatcher_);
+  EXPECT_EQ(1, registry_->numSharedPools());
+  ConnPoolCallbacks owner_callbacks;
+  EXPECT_CALL(*shared_pool_, newStream(_, _))
+      .WillOnce(Invoke([this](ResponseDecoder&, ConnectionPool::Callbacks& callbacks)
+                           -> ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder_, host_, stream_info_);
+        return nullptr;
+      }));
+  owner_pool_->newStream(decoder_, owner_callbacks);
+  EXPECT_CALL(owner_callbacks.pool_ready_, ready());
+  runWorkers();
+  owner_callbacks.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+  runWorkers();
+
+  remote_pool_.reset();
+  owner_pool_.reset();
+  EXPECT_EQ(0, registry_->numSharedPools());
+}
+
+// Streams of a remote worker are reset when its pool is destroyed.
+TEST_F(SharedConnPoolTest, RemoteDestroyed) {
+  startStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::ConnectionTermination, _));
+  remote_pool_.reset();
+  EXPECT_CALL(encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  runWorkers();
+}
+
+// The drained callbacks of a remote pool are not run while it is destroyed with streams.
+TEST_F(SharedConnPoolTest, RemoteDestroyedWithDrainedCallback) {
+  startStream();
+  ReadyWatcher drained;
+  remote_pool_->addDrainedCallback([&drained]() -> void { drained.ready(); });
+
+  EXPECT_CALL(drained, ready()).Times(0);
+  remote_pool_.reset();
+  EXPECT_CALL(encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  runWorkers();
+}
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,135 @@
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <vector>
+
+#include "common/io/io_uring_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Io {
+namespace {
+
+struct Completion {
+  uint64_t user_data_;
+  int32_t result_;
+  bool more_;
+};
+
+class IoUringImplTest : public testing::Test {
+protected:
+  void SetUp() override {
+    if (!IoUringImpl::isSupported()) {
+      GTEST_SKIP() << "io_uring is not available";
+    }
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds_));
+  }
+
+  void TearDown() override {
+    if (fds_[0] != INVALID_SOCKET) {
+      ::close(fds_[0]);
+      ::close(fds_[1]);
+    }
+  }
+
+  // Submits the prepared requests and waits for the given number of completions.
+  std::vector<Completion> run(IoUringImpl& ring, uint32_t expected) {
+    EXPECT_GE(ring.submit().rc_, 0);
+    std::vector<Completion> completions;
+    while (completions.size() < expected) {
+      if (ring.forEveryCompletion([&](uint64_t user_data, int32_t result, bool more) {
+            completions.push_back({user_data, result, more});
+          }) == 0) {
+        ring.waitForCompletion();
+      }
+    }
+    return completions;
+  }
+
+  os_fd_t fds_[2]{INVALID_SOCKET, INVALID_SOCKET};
+};
+
+TEST_F(IoUringImplTest, WritevAndReadv) {
+  IoUringImpl ring(8);
+  char out[] = "hello";
+  iovec write_iov{out, 5};
+  ASSERT_TRUE(ring.prepareWritev(fds_[0], &write_iov, 1, 1));
+  EXPECT_EQ(1, ring.pendingSubmissions());
+  std::vector<Completion> completions = run(ring, 1);
+  EXPECT_EQ(0, ring.pendingSubmissions());
+  EXPECT_EQ(1, completions[0].user_data_);
+  EXPECT_EQ(5, completions[0].result_);
+  EXPECT_FALSE(completions[0].more_);
+
+  char in[16];
+  iovec read_iov{in, sizeof(in)};
+  ASSERT_TRUE(ring.prepareReadv(fds_[1], &read_iov, 1, 2));
+  completions = run(ring, 1);
+  EXPECT_EQ(2, completions[0].user_data_);
+  ASSERT_EQ(5, completions[0].result_);
+  EXPECT_EQ("hello", std::string(in, 5));
+}
+
+TEST_F(IoUringImplTest, RegisteredBuffers) {
+  IoUringImpl ring(8);
+  char registered[16];
+  iovec iov{registered, sizeof(registered)};
+  const Api::SysCallIntResult result = ring.registerBuffers(&iov, 1);
+  if (result.rc_ < 0) {
+    GTEST_SKIP() << "unable to register buffers: " << result.errno_;
+  }
+  ASSERT_EQ(3, ::write(fds_[0], "abc", 3));
+  ASSERT_TRUE(ring.prepareReadFixed(fds_[1], registered, sizeof(registered), 0, 1));
+  std::vector<Completion> completions = run(ring, 1);
+  ASSERT_EQ(3, completions[0].result_);
+  EXPECT_EQ("abc", std::string(registered, 3));
+}
+
+// A read of an idle socket stays in flight until it is cancelled.
+TEST_F(IoUringImplTest, CancelRead) {
+  IoUringImpl ring(8);
+  char in[16];
+  iovec read_iov{in, sizeof(in)};
+  ASSERT_TRUE(ring.prepareReadv(fds_[1], &read_iov, 1, 1));
+  EXPECT_GE(ring.submit().rc_, 0);
+  ASSERT_TRUE(ring.prepareCancel(1, 2));
+  std::vector<Completion> completions = run(ring, 2);
+  for (const Completion& completion : completions) {
+    if (completion.user_data_ == 1) {
+      EXPECT_EQ(-ECANCELED, completion.result_);
+    } else {
+      EXPECT_EQ(2, completion.user_data_);
+      EXPECT_EQ(0, completion.result_);
+    }
+  }
+}
+
+TEST_F(IoUringImplTest, EventfdSignalledOnCompletion) {
+  IoUringImpl ring(8);
+  const os_fd_t event_fd = ring.registerEventfd();
+  ASSERT_NE(INVALID_SOCKET, event_fd);
+  char out[] = "x";
+  iovec write_iov{out, 1};
+  ASSERT_TRUE(ring.prepareWritev(fds_[0], &write_iov, 1, 1));
+  run(ring, 1);
+  uint64_t value = 0;
+  EXPECT_EQ(sizeof(value), ::read(event_fd, &value, sizeof(value)));
+  EXPECT_GE(value, 1);
+}
+
+TEST_F(IoUringImplTest, FullSubmissionQueue) {
+  IoUringImpl ring(2);
+  char out[] = "x";
+  iovec write_iov{out, 1};
+  ASSERT_TRUE(ring.prepareWritev(fds_[0], &write_iov, 1, 1));
+  ASSERT_TRUE(ring.prepareWritev(fds_[0], &write_iov, 1, 2));
+  EXPECT_FALSE(ring.prepareWritev(fds_[0], &write_iov, 1, 3));
+  run(ring, 2);
+  EXPECT_TRUE(ring.prepareWritev(fds_[0], &write_iov, 1, 3));
+  run(ring, 1);
+}
+
+} // namespace
+} // namespace Io
+} // namespace Envoy
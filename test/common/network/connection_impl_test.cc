@@ -750,6 +750,147 @@ TEST_P(ConnectionImplTest, HalfCloseNoEarlyCloseDetection) {
   server_connection_->close(ConnectionCloseType::NoFlush);
 }
 
+#if defined(__linux__)
+// Test that spliced connections forward the data received on each to the other without handing
+// it to the read filters, and that the end of stream still reaches them.
+TEST_P(ConnectionImplTest, Splice) {
+  setUpBasicConnection();
+  connect();
+
+  std::shared_ptr<MockReadFilter> client_read_filter(new NiceMock<MockReadFilter>());
+  client_connection_->enableHalfClose(true);
+  client_connection_->addReadFilter(client_read_filter);
+  server_connection_->enableHalfClose(true);
+  NiceMockConnectionStats server_connection_stats;
+  server_connection_->setConnectionStats(server_connection_stats.toBufferStats());
+  uint64_t rx_total = 0;
+  uint64_t tx_total = 0;
+  ON_CALL(server_connection_stats.rx_total_, add(_))
+      .WillByDefault(Invoke([&](uint64_t amount) -> void { rx_total += amount; }));
+  ON_CALL(server_connection_stats.tx_total_, add(_))
+      .WillByDefault(Invoke([&](uint64_t amount) -> void { tx_total += amount; }));
+
+  // Connect a second pair of connections, the client end of which is spliced with the server end
+  // of the first pair.
+  NiceMock<MockConnectionCallbacks> upstream_callbacks;
+  ClientConnectionPtr upstream_connection = dispatcher_->createClientConnection(
+      socket_->localAddress(), source_address_, Network::Test::createRawBufferSocket(), nullptr);
+  upstream_connection->addConnectionCallbacks(upstream_callbacks);
+  upstream_connection->enableHalfClose(true);
+  upstream_connection->addReadFilter(std::make_shared<NiceMock<MockReadFilter>>());
+  ConnectionPtr upstream_server_connection;
+  std::shared_ptr<MockReadFilter> upstream_server_read_filter(new NiceMock<MockReadFilter>());
+  StreamInfo::StreamInfoImpl upstream_server_stream_info(time_system_);
+  int expected_callbacks = 2;
+  EXPECT_CALL(listener_callbacks_, onAccept_(_))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket) -> void {
+        upstream_server_connection = dispatcher_->createServerConnection(
+            std::move(socket), Network::Test::createRawBufferSocket(), upstream_server_stream_info);
+        upstream_server_connection->enableHalfClose(true);
+        upstream_server_connection->addReadFilter(upstream_server_read_filter);
+        if (--expected_callbacks == 0) {
+          dispatcher_->exit();
+        }
+      }));
+  EXPECT_CALL(upstream_callbacks, onEvent(ConnectionEvent::Connected))
+      .WillOnce(InvokeWithoutArgs([&]() -> void {
+        if (--expected_callbacks == 0) {
+          dispatcher_->exit();
+        }
+      }));
+  upstream_connection->connect();
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_FALSE(server_connection_->startSplice(*server_connection_));
+  ASSERT_TRUE(server_connection_->startSplice(*upstream_connection));
+  EXPECT_FALSE(upstream_connection->startSplice(*server_connection_));
+
+  // More data than a pipe holds by default goes from the client to the upstream server.
+  EXPECT_CALL(*read_filter_, onData(_, false)).Times(0);
+  const std::string request(1024 * 1024, 'a');
+  std::string received;
+  EXPECT_CALL(*upstream_server_read_filter, onData(_, false))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) -> FilterStatus {
+        received.append(data.toString());
+        data.drain(data.length());
+        if (received.size() == request.size()) {
+          dispatcher_->exit();
+        }
+        return FilterStatus::StopIteration;
+      }));
+  Buffer::OwnedImpl request_buffer(request);
+  client_connection_->write(request_buffer, false);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(request, received);
+  EXPECT_EQ(request.size(), rx_total);
+  EXPECT_EQ(request.size(), stream_info_.bytesReceived());
+
+  // And data goes from the upstream server to the client.
+  EXPECT_CALL(*client_read_filter, onData(BufferStringEqual("response"), false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> FilterStatus {
+        data.drain(data.length());
+        dispatcher_->exit();
+        return FilterStatus::StopIteration;
+      }));
+  Buffer::OwnedImpl response_buffer("response");
+  upstream_server_connection->write(response_buffer, false);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(8, tx_total);
+  EXPECT_EQ(8, stream_info_.bytesSent());
+
+  // The end of stream reaches the read filters, which forward it.
+  EXPECT_CALL(*read_filter_, onData(BufferStringEqual(""), true))
+      .WillOnce(InvokeWithoutArgs([&]() -> FilterStatus {
+        Buffer::OwnedImpl empty_buffer;
+        upstream_connection->write(empty_buffer, true);
+        return FilterStatus::StopIteration;
+      }));
+  EXPECT_CALL(*upstream_server_read_filter, onData(BufferStringEqual(""), true))
+      .WillOnce(InvokeWithoutArgs([&]() -> FilterStatus {
+        dispatcher_->exit();
+        return FilterStatus::StopIteration;
+      }));
+  Buffer::OwnedImpl empty_buffer;
+  client_connection_->write(empty_buffer, true);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_CALL(server_callbacks_, onEvent(ConnectionEvent::LocalClose));
+  server_connection_->close(ConnectionCloseType::NoFlush);
+  upstream_connection->close(ConnectionCloseType::NoFlush);
+  upstream_server_connection->close(ConnectionCloseType::NoFlush);
+  EXPECT_CALL(client_callbacks_, onEvent(ConnectionEvent::LocalClose));
+  client_connection_->close(ConnectionCloseType::NoFlush);
+}
+
+// Test that a connection with a read filter ahead of the one which would splice it, such as RBAC or
+// external authorization ahead of the TCP proxy, is not spliced, as that filter would be bypassed.
+TEST_P(ConnectionImplTest, SpliceWithMultipleReadFilters) {
+  setUpBasicConnection();
+  connect();
+
+  client_connection_->addReadFilter(std::make_shared<NiceMock<MockReadFilter>>());
+  server_connection_->addReadFilter(std::make_shared<NiceMock<MockReadFilter>>());
+  EXPECT_FALSE(server_connection_->startSplice(*client_connection_));
+  EXPECT_FALSE(client_connection_->startSplice(*server_connection_));
+
+  // The data still reaches the read filters.
+  EXPECT_CALL(*read_filter_, onData(BufferStringEqual("hello"), false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> FilterStatus {
+        data.drain(data.length());
+        dispatcher_->exit();
+        return FilterStatus::StopIteration;
+      }));
+  Buffer::OwnedImpl buffer("hello");
+  client_connection_->write(buffer, false);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_CALL(server_callbacks_, onEvent(ConnectionEvent::LocalClose));
+  server_connection_->close(ConnectionCloseType::NoFlush);
+  EXPECT_CALL(client_callbacks_, onEvent(ConnectionEvent::LocalClose));
+  client_connection_->close(ConnectionCloseType::NoFlush);
+}
+#endif
+
 // Test that as watermark levels are changed, the appropriate callbacks are triggered.
 TEST_P(ConnectionImplTest, WriteWatermarks) {
   useMockBuffer();
@@ -0,0 +1,386 @@
+#include <sys/socket.h>
+
+#include <chrono>
+#include <string>
+
+#include "envoy/event/dispatcher.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/io/io_uring_impl.h"
+#include "common/network/address_impl.h"
+#include "common/network/io_uring_socket_handle_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class IoUringSocketHandleImplTest : public testing::TestWithParam<bool> {
+protected:
+  IoUringSocketHandleImplTest() : api_(Api::createApiForTest()) {}
+
+  void SetUp() override {
+    if (!Io::IoUringImpl::isSupported()) {
+      GTEST_SKIP() << "io_uring is not available";
+    }
+    dispatcher_ = api_->allocateDispatcher("test_thread");
+    options_.enable_multishot_accept_ = GetParam();
+  }
+
+  std::unique_ptr<IoUringSocketHandleImpl> makeHandle() {
+    return std::make_unique<IoUringSocketHandleImpl>(
+        options_, ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0));
+  }
+
+  // Creates a listening io_uring handle on a loopback address.
+  std::unique_ptr<IoUringSocketHandleImpl> makeListener() {
+    std::unique_ptr<IoUringSocketHandleImpl> listener = makeHandle();
+    EXPECT_EQ(0, listener->bind(std::make_shared<Address::Ipv4Instance>("127.0.0.1", 0)).rc_);
+    EXPECT_EQ(0, listener->listen(128).rc_);
+    return listener;
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  Io::IoUringOptions options_;
+};
+
+INSTANTIATE_TEST_SUITE_P(MultishotAccept, IoUringSocketHandleImplTest, testing::Bool());
+
+// Without a file event the handle performs I/O directly on the socket.
+TEST_P(IoUringSocketHandleImplTest, DirectIoWithoutFileEvent) {
+  os_fd_t fds[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+  IoUringSocketHandleImpl writer(options_, fds[0]);
+  IoUringSocketHandleImpl reader(options_, fds[1]);
+
+  char buf[16];
+  Buffer::RawSlice read_slice{buf, sizeof(buf)};
+  Api::IoCallUint64Result result = reader.readv(sizeof(buf), &read_slice, 1);
+  EXPECT_EQ(Api::IoError::IoErrorCode::Again, result.err_->getErrorCode());
+
+  char out[] = "hello";
+  Buffer::RawSlice write_slice{out, 5};
+  EXPECT_EQ(5, writer.writev(&write_slice, 1).rc_);
+  result = reader.readv(sizeof(buf), &read_slice, 1);
+  ASSERT_EQ(5, result.rc_);
+  EXPECT_EQ("hello", std::string(buf, 5));
+}
+
+// Streams data from a client to a server which echoes it back, exercising accept, connect, reads,
+// writes bounded by the write buffer limit and half close. The server reads and writes buffers,
+// the client raw slices.
+TEST_P(IoUringSocketHandleImplTest, Echo) {
+  constexpr uint64_t Total = 1024 * 1024;
+  options_.write_buffer_limit_ = 64 * 1024;
+  std::unique_ptr<IoUringSocketHandleImpl> listener = makeListener();
+
+  IoHandlePtr server;
+  Event::FileEventPtr server_event;
+  Buffer::OwnedImpl echo_buffer;
+  Event::FileEventPtr listener_event = listener->createFileEvent(
+      *dispatcher_,
+      [&](uint32_t) {
+        sockaddr_storage address;
+        socklen_t address_len = sizeof(address);
+        IoHandlePtr accepted =
+            listener->accept(reinterpret_cast<sockaddr*>(&address), &address_len);
+        if (accepted == nullptr) {
+          return;
+        }
+        EXPECT_EQ(AF_INET, address.ss_family);
+        server = std::move(accepted);
+        server_event = server->createFileEvent(
+            *dispatcher_,
+            [&](uint32_t events) {
+              if (events & Event::FileReadyType::Read) {
+                while (true) {
+                  Api::IoCallUint64Result result = server->read(echo_buffer, 16384);
+                  if (!result.ok()) {
+                    break;
+                  }
+                  if (result.rc_ == 0) {
+                    EXPECT_EQ(0, server->shutdown(ENVOY_SHUT_WR).rc_);
+                    break;
+                  }
+                }
+              }
+              while (echo_buffer.length() > 0 && server->write(echo_buffer).ok()) {
+              }
+            },
+            Event::FileTriggerType::Edge, Event::FileReadyType::Read | Event::FileReadyType::Write);
+      },
+      Event::FileTriggerType::Level, Event::FileReadyType::Read);
+
+  std::unique_ptr<IoUringSocketHandleImpl> client = makeHandle();
+  std::string sent_data;
+  for (uint64_t i = 0; i < Total; ++i) {
+    sent_data.push_back('a' + i % 26);
+  }
+  Buffer::OwnedImpl send_buffer(sent_data);
+  Buffer::OwnedImpl received;
+  bool connected = false;
+  Event::FileEventPtr client_event = client->createFileEvent(
+      *dispatcher_,
+      [&](uint32_t events) {
+        if (!connected && (events & Event::FileReadyType::Write)) {
+          int error = -1;
+          socklen_t error_len = sizeof(error);
+          EXPECT_EQ(0, client->getOption(SOL_SOCKET, SO_ERROR, &error, &error_len).rc_);
+          EXPECT_EQ(0, error);
+          connected = true;
+        }
+        if (events & Event::FileReadyType::Read) {
+          while (true) {
+            Api::IoCallUint64Result result = received.read(*client, 16384);
+            if (!result.ok()) {
+              break;
+            }
+            if (result.rc_ == 0) {
+              dispatcher_->exit();
+              return;
+            }
+          }
+        }
+        while (connected && send_buffer.length() > 0 && send_buffer.write(*client).ok()) {
+          if (send_buffer.length() == 0) {
+            EXPECT_EQ(0, client->shutdown(ENVOY_SHUT_WR).rc_);
+          }
+        }
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read | Event::FileReadyType::Write);
+  const Api::SysCallIntResult result = client->connect(listener->localAddress());
+  EXPECT_TRUE(result.rc_ == 0 || result.errno_ == SOCKET_ERROR_IN_PROGRESS);
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(sent_data, received.toString());
+
+  client_event.reset();
+  client->close();
+  server_event.reset();
+  server->close();
+  listener_event.reset();
+  listener->close();
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+// Writes beyond the write buffer limit are rejected with EAGAIN until the data has been written.
+TEST_P(IoUringSocketHandleImplTest, WriteBufferLimit) {
+  options_.write_buffer_limit_ = 1024;
+  os_fd_t fds[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+  IoUringSocketHandleImpl writer(options_, fds[0]);
+  IoUringSocketHandleImpl reader(options_, fds[1]);
+  uint32_t writer_events = 0;
+  Event::FileEventPtr writer_event = writer.createFileEvent(
+      *dispatcher_, [&](uint32_t events) { writer_events |= events; },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Write);
+
+  std::string data(4096, 'x');
+  Buffer::RawSlice slice{data.data(), data.size()};
+  Api::IoCallUint64Result result = writer.writev(&slice, 1);
+  EXPECT_EQ(1024, result.rc_);
+  result = writer.writev(&slice, 1);
+  EXPECT_EQ(Api::IoError::IoErrorCode::Again, result.err_->getErrorCode());
+
+  // Once the queued data has been written the handle becomes writable again.
+  while (!(writer_events & Event::FileReadyType::Write)) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  EXPECT_EQ(1024, writer.writev(&slice, 1).rc_);
+
+  writer_event.reset();
+  writer.close();
+  reader.close();
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+// Reads from a non-blocking socket until it is empty.
+// @return whether the end of stream has been reached.
+bool drainSocket(os_fd_t fd, uint64_t& received) {
+  char buf[65536];
+  while (true) {
+    const ssize_t rc = ::read(fd, buf, sizeof(buf));
+    if (rc <= 0) {
+      return rc == 0;
+    }
+    received += rc;
+  }
+}
+
+// write() takes the slices of the buffer over, up to the write buffer limit.
+TEST_P(IoUringSocketHandleImplTest, WriteTakesOverSlices) {
+  options_.write_buffer_limit_ = 1024;
+  os_fd_t fds[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+  IoUringSocketHandleImpl writer(options_, fds[0]);
+  Event::FileEventPtr writer_event = writer.createFileEvent(
+      *dispatcher_, [](uint32_t) {}, Event::FileTriggerType::Edge, Event::FileReadyType::Write);
+
+  Buffer::OwnedImpl buffer(std::string(4096, 'x'));
+  EXPECT_EQ(1024, writer.write(buffer).rc_);
+  EXPECT_EQ(3072, buffer.length());
+  EXPECT_EQ(Api::IoError::IoErrorCode::Again, writer.write(buffer).err_->getErrorCode());
+
+  uint64_t received = 0;
+  while (received < 1024) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    drainSocket(fds[1], received);
+  }
+  EXPECT_EQ(1024, received);
+
+  writer_event.reset();
+  writer.close();
+  ::close(fds[1]);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+// The memory large reads completed into is handed over by read() and stays valid after the handle
+// and its ring have gone away. The handle does not let TLS read the descriptor behind its back.
+TEST_P(IoUringSocketHandleImplTest, ReadHandsOverBuffers) {
+  os_fd_t fds[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+  auto reader = std::make_unique<IoUringSocketHandleImpl>(options_, fds[1]);
+  EXPECT_FALSE(reader->allowsDescriptorIo());
+  Buffer::OwnedImpl received;
+  Event::FileEventPtr reader_event = reader->createFileEvent(
+      *dispatcher_,
+      [&](uint32_t) {
+        while (reader->read(received, options_.read_buffer_size_).ok()) {
+        }
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read);
+
+  // Small enough to fit in the socket buffer in one go.
+  const std::string data(options_.read_buffer_size_ / 2, 'x');
+  ASSERT_EQ(static_cast<ssize_t>(data.size()), ::write(fds[0], data.data(), data.size()));
+  while (received.length() < data.size()) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  reader_event.reset();
+  reader->close();
+  reader.reset();
+  ::close(fds[0]);
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  dispatcher_.reset();
+  EXPECT_EQ(data, received.toString());
+}
+
+// Data accepted by writev() is still delivered if the handle is closed right away.
+TEST_P(IoUringSocketHandleImplTest, CloseFlushesQueuedData) {
+  constexpr uint64_t Total = 4 * 1024 * 1024;
+  options_.write_buffer_limit_ = Total;
+  os_fd_t fds[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+  auto writer = std::make_unique<IoUringSocketHandleImpl>(options_, fds[0]);
+  Event::FileEventPtr writer_event = writer->createFileEvent(
+      *dispatcher_, [](uint32_t) {}, Event::FileTriggerType::Edge, Event::FileReadyType::Write);
+  std::string data(Total, 'x');
+  Buffer::RawSlice slice{data.data(), data.size()};
+  EXPECT_EQ(Total, writer->writev(&slice, 1).rc_);
+  writer_event.reset();
+  writer->close();
+  writer.reset();
+
+  uint64_t received = 0;
+  Event::FileEventPtr reader_event = dispatcher_->createFileEvent(
+      fds[1],
+      [&](uint32_t) {
+        char buf[65536];
+        while (true) {
+          const ssize_t rc = ::read(fds[1], buf, sizeof(buf));
+          if (rc > 0) {
+            received += rc;
+          } else {
+            if (rc == 0) {
+              dispatcher_->exit();
+            }
+            break;
+          }
+        }
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(Total, received);
+  reader_event.reset();
+  ::close(fds[1]);
+}
+
+// The data of a closed handle which cannot be flushed, as the peer does not read it, is dropped
+// once the close flush timeout expires.
+TEST_P(IoUringSocketHandleImplTest, CloseFlushTimeout) {
+  constexpr uint64_t Total = 16 * 1024 * 1024;
+  options_.write_buffer_limit_ = Total;
+  options_.close_flush_timeout_ = std::chrono::milliseconds(10);
+  os_fd_t fds[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+  auto writer = std::make_unique<IoUringSocketHandleImpl>(options_, fds[0]);
+  Event::FileEventPtr writer_event = writer->createFileEvent(
+      *dispatcher_, [](uint32_t) {}, Event::FileTriggerType::Edge, Event::FileReadyType::Write);
+  std::string data(Total, 'x');
+  Buffer::RawSlice slice{data.data(), data.size()};
+  EXPECT_EQ(Total, writer->writev(&slice, 1).rc_);
+  writer_event.reset();
+  writer->close();
+  writer.reset();
+
+  Event::TimerPtr timer = dispatcher_->createTimer([this]() -> void { dispatcher_->exit(); });
+  timer->enableTimer(std::chrono::milliseconds(100));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  uint64_t received = 0;
+  EXPECT_TRUE(drainSocket(fds[1], received));
+  EXPECT_LT(received, Total);
+  ::close(fds[1]);
+}
+
+// Sockets still being flushed are closed when the dispatcher is destroyed.
+TEST_P(IoUringSocketHandleImplTest, DispatcherDestroyedWhileFlushing) {
+  constexpr uint64_t Total = 16 * 1024 * 1024;
+  options_.write_buffer_limit_ = Total;
+  os_fd_t fds[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+  auto writer = std::make_unique<IoUringSocketHandleImpl>(options_, fds[0]);
+  Event::FileEventPtr writer_event = writer->createFileEvent(
+      *dispatcher_, [](uint32_t) {}, Event::FileTriggerType::Edge, Event::FileReadyType::Write);
+  std::string data(Total, 'x');
+  Buffer::RawSlice slice{data.data(), data.size()};
+  EXPECT_EQ(Total, writer->writev(&slice, 1).rc_);
+  writer_event.reset();
+  writer->close();
+  writer.reset();
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  dispatcher_.reset();
+
+  uint64_t received = 0;
+  EXPECT_TRUE(drainSocket(fds[1], received));
+  EXPECT_LT(received, Total);
+  ::close(fds[1]);
+
+  // A new dispatcher gets a worker of its own, even at the address of the destroyed one.
+  dispatcher_ = api_->allocateDispatcher("test_thread");
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+  IoUringSocketHandleImpl reader(options_, fds[0]);
+  bool readable = false;
+  Event::FileEventPtr reader_event = reader.createFileEvent(
+      *dispatcher_,
+      [&](uint32_t) -> void {
+        readable = true;
+        dispatcher_->exit();
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read);
+  ASSERT_EQ(5, ::write(fds[1], "hello", 5));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_TRUE(readable);
+  reader_event.reset();
+  reader.close();
+  ::close(fds[1]);
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,125 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Compares the throughput of the default and the io_uring backed IoHandle over a loopback TCP
+// connection, with both ends driven by the file events of their handles.
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <string>
+
+#include "envoy/event/dispatcher.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/event/libevent.h"
+#include "common/io/io_uring_impl.h"
+#include "common/network/io_socket_handle_impl.h"
+#include "common/network/io_uring_socket_handle_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+// Creates a connected pair of non-blocking loopback TCP sockets.
+void connectedPair(os_fd_t fds[2]) {
+  const os_fd_t listener = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t address_len = sizeof(address);
+  RELEASE_ASSERT(::bind(listener, reinterpret_cast<sockaddr*>(&address), address_len) == 0, "");
+  RELEASE_ASSERT(::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &address_len) == 0,
+                 "");
+  RELEASE_ASSERT(::listen(listener, 1) == 0, "");
+  fds[0] = ::socket(AF_INET, SOCK_STREAM, 0);
+  RELEASE_ASSERT(::connect(fds[0], reinterpret_cast<sockaddr*>(&address), address_len) == 0, "");
+  fds[1] = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK);
+  RELEASE_ASSERT(fds[1] >= 0, "");
+  RELEASE_ASSERT(::fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0, "");
+  ::close(listener);
+}
+
+// Streams state.range(0) bytes per iteration from one end of the connection to the other.
+template <class HandleFactory> void streamLoopback(benchmark::State& state, HandleFactory factory) {
+  if (!Event::Libevent::Global::initialized()) {
+    Event::Libevent::Global::initialize();
+  }
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+  os_fd_t fds[2];
+  connectedPair(fds);
+  IoHandlePtr writer = factory(fds[0]);
+  IoHandlePtr reader = factory(fds[1]);
+
+  const std::string chunk(state.range(0), 'a');
+  Buffer::OwnedImpl pending;
+  uint64_t remaining = 0;
+  Event::FileEventPtr writer_event = writer->createFileEvent(
+      *dispatcher,
+      [&](uint32_t) {
+        while (pending.length() > 0 && pending.write(*writer).ok()) {
+        }
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Write);
+  Buffer::OwnedImpl received;
+  Event::FileEventPtr reader_event = reader->createFileEvent(
+      *dispatcher,
+      [&](uint32_t) {
+        while (true) {
+          const Api::IoCallUint64Result result = received.read(*reader, 65536);
+          if (!result.ok() || result.rc_ == 0) {
+            break;
+          }
+          received.drain(result.rc_);
+          remaining -= result.rc_;
+        }
+        if (remaining == 0) {
+          dispatcher->exit();
+        }
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read);
+
+  for (auto _ : state) {
+    remaining = chunk.size();
+    pending.add(chunk);
+    writer_event->activate(Event::FileReadyType::Write);
+    dispatcher->run(Event::Dispatcher::RunType::Block);
+  }
+  state.SetBytesProcessed(state.iterations() * chunk.size());
+
+  writer_event.reset();
+  reader_event.reset();
+  writer->close();
+  reader->close();
+  dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void BM_DefaultSocketHandle(benchmark::State& state) {
+  streamLoopback(state, [](os_fd_t fd) { return std::make_unique<IoSocketHandleImpl>(fd); });
+}
+BENCHMARK(BM_DefaultSocketHandle)->Arg(4096)->Arg(65536)->Arg(1024 * 1024);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void BM_IoUringSocketHandle(benchmark::State& state) {
+  if (!Io::IoUringImpl::isSupported()) {
+    state.SkipWithError("io_uring is not available");
+    return;
+  }
+  const Io::IoUringOptions options;
+  streamLoopback(state, [&options](os_fd_t fd) {
+    return std::make_unique<IoUringSocketHandleImpl>(options, fd);
+  });
+}
+BENCHMARK(BM_IoUringSocketHandle)->Arg(4096)->Arg(65536)->Arg(1024 * 1024);
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
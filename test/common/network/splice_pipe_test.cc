@@ -0,0 +1,87 @@
+#include <sys/socket.h>
+
+#include <string>
+
+#include "common/network/splice_pipe.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class SplicePipeTest : public testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, source_));
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, destination_));
+  }
+
+  void TearDown() override {
+    for (os_fd_t fd : {source_[0], source_[1], destination_[0], destination_[1]}) {
+      ::close(fd);
+    }
+  }
+
+  std::string readDestination() {
+    char buf[1024];
+    const ssize_t rc = ::read(destination_[1], buf, sizeof(buf));
+    return rc > 0 ? std::string(buf, rc) : "";
+  }
+
+  // Data written to source_[0] is spliced from source_[1] to destination_[0], and read from
+  // destination_[1].
+  os_fd_t source_[2];
+  os_fd_t destination_[2];
+};
+
+// Data moves from one socket to the other through the pipe.
+TEST_F(SplicePipeTest, FillAndDrain) {
+  SplicePipePtr pipe = SplicePipe::create(0);
+  ASSERT_NE(nullptr, pipe);
+  EXPECT_GT(pipe->capacity(), 0);
+
+  // Nothing to read yet.
+  Api::SysCallSizeResult result = pipe->fill(source_[1]);
+  EXPECT_EQ(-1, result.rc_);
+  EXPECT_EQ(EAGAIN, result.errno_);
+
+  ASSERT_EQ(5, ::write(source_[0], "hello", 5));
+  result = pipe->fill(source_[1]);
+  EXPECT_EQ(5, result.rc_);
+  EXPECT_EQ(5, pipe->length());
+
+  result = pipe->drain(destination_[0]);
+  EXPECT_EQ(5, result.rc_);
+  EXPECT_EQ(0, pipe->length());
+  EXPECT_EQ("hello", readDestination());
+
+  // The end of stream reads as zero bytes.
+  ::shutdown(source_[0], SHUT_WR);
+  EXPECT_EQ(0, pipe->fill(source_[1]).rc_);
+}
+
+// A pipe never takes in more than its capacity, and keeps what the destination has no room for.
+TEST_F(SplicePipeTest, Capacity) {
+  SplicePipePtr pipe = SplicePipe::create(4096);
+  ASSERT_NE(nullptr, pipe);
+  EXPECT_EQ(4096, pipe->capacity());
+
+  const std::string data(3 * 4096, 'a');
+  ASSERT_EQ(static_cast<ssize_t>(data.size()), ::write(source_[0], data.data(), data.size()));
+  EXPECT_EQ(4096, pipe->fill(source_[1]).rc_);
+  EXPECT_EQ(4096, pipe->length());
+
+  // Fill up the destination, so that the data stays in the pipe.
+  const std::string filler(65536, 'b');
+  while (::write(destination_[0], filler.data(), filler.size()) > 0) {
+  }
+  const Api::SysCallSizeResult result = pipe->drain(destination_[0]);
+  EXPECT_EQ(-1, result.rc_);
+  EXPECT_EQ(EAGAIN, result.errno_);
+  EXPECT_EQ(4096, pipe->length());
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
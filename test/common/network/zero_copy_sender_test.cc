@@ -0,0 +1,234 @@
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <string>
+
+#include "envoy/event/dispatcher.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/network/io_socket_handle_impl.h"
+#include "common/network/zero_copy_sender.h"
+
+#include "test/mocks/stats/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::NiceMock;
+using testing::Property;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class ZeroCopySenderTest : public testing::Test {
+protected:
+  ZeroCopySenderTest() : api_(Api::createApiForTest()) {}
+
+  void SetUp() override {
+    dispatcher_ = api_->allocateDispatcher("test_thread");
+    config_ = std::make_shared<const ZeroCopyConfig>(4096, close_timeout_, store_,
+                                                     api_->timeSource());
+
+    // Connect a client socket to a server over loopback.
+    const os_fd_t listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_TRUE(SOCKET_VALID(listener));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_len = sizeof(address);
+    ASSERT_EQ(0, ::bind(listener, reinterpret_cast<sockaddr*>(&address), address_len));
+    ASSERT_EQ(0, ::listen(listener, 1));
+    ASSERT_EQ(0, ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &address_len));
+    client_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    ::connect(client_fd_, reinterpret_cast<sockaddr*>(&address), address_len);
+    server_fd_ = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK);
+    ::close(listener);
+    ASSERT_TRUE(SOCKET_VALID(server_fd_));
+
+    if (!ZeroCopySender::enable(client_fd_)) {
+      ::close(client_fd_);
+      GTEST_SKIP() << "MSG_ZEROCOPY is not available";
+    }
+    client_ = std::make_unique<IoSocketHandleImpl>(client_fd_, false, config_);
+  }
+
+  void TearDown() override {
+    client_.reset();
+    if (SOCKET_VALID(server_fd_)) {
+      ::close(server_fd_);
+    }
+  }
+
+  // Reads everything the server has received so far.
+  void readServer() {
+    char buf[65536];
+    ssize_t rc;
+    while ((rc = ::read(server_fd_, buf, sizeof(buf))) > 0) {
+      received_.append(buf, rc);
+    }
+    server_eof_ = rc == 0;
+  }
+
+  // Reads from the server until the connection is closed.
+  // @return whether it was reset.
+  bool readServerUntilClosed() {
+    char buf[65536];
+    while (true) {
+      const ssize_t rc = ::read(server_fd_, buf, sizeof(buf));
+      if (rc == 0) {
+        return false;
+      }
+      if (rc < 0 && errno != EAGAIN) {
+        return errno == ECONNRESET;
+      }
+    }
+  }
+
+  // Writes to the client until the socket buffers are full, as the server does not read.
+  // @return the data written.
+  std::string fillSocket() {
+    std::string sent;
+    char first = 'a';
+    while (true) {
+      const std::string data = pattern(65536, first++);
+      Buffer::OwnedImpl buffer(data);
+      const Api::IoCallUint64Result result = client_->write(buffer);
+      if (!result.ok()) {
+        EXPECT_EQ(Api::IoError::IoErrorCode::Again, result.err_->getErrorCode());
+        return sent;
+      }
+      sent += data.substr(0, result.rc_);
+    }
+  }
+
+  static std::string pattern(uint64_t length, char first) {
+    std::string data(length, 0);
+    for (uint64_t i = 0; i < length; i++) {
+      data[i] = first + i % 26;
+    }
+    return data;
+  }
+
+  NiceMock<Stats::MockIsolatedStatsStore> store_;
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  std::chrono::milliseconds close_timeout_{10000};
+  ZeroCopyConfigSharedPtr config_;
+  os_fd_t client_fd_{INVALID_SOCKET};
+  os_fd_t server_fd_{INVALID_SOCKET};
+  std::unique_ptr<IoSocketHandleImpl> client_;
+  std::string received_;
+  bool server_eof_{};
+};
+
+// Small writes are copied, large ones are sent from the memory of the buffer, which is released
+// once the kernel reports the send complete.
+TEST_F(ZeroCopySenderTest, WriteAboveMinimumSize) {
+  Buffer::OwnedImpl small(pattern(100, 'a'));
+  Api::IoCallUint64Result result = client_->write(small);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(100, result.rc_);
+  EXPECT_EQ(0, small.length());
+  EXPECT_EQ(0, store_.counter("zero_copy.bytes").value());
+
+  const std::string data = pattern(65536, 'A');
+  Buffer::OwnedImpl large(data);
+  result = client_->write(large);
+  ASSERT_TRUE(result.ok());
+  EXPECT_GT(result.rc_, 0);
+  EXPECT_EQ(result.rc_, store_.counter("zero_copy.bytes").value());
+  EXPECT_EQ(65536 - result.rc_, large.length());
+  const uint64_t sent = 100 + result.rc_;
+  large.drain(large.length());
+
+  // Loopback copies the data when delivering it, and completes the send.
+  EXPECT_CALL(store_, deliverHistogramToSinks(
+                          Property(&Stats::Metric::name, "zero_copy.completion_latency"), _))
+      .Times(AnyNumber());
+  while (received_.size() < sent || store_.counter("zero_copy.fallback_copies").value() == 0) {
+    readServer();
+    Buffer::OwnedImpl empty;
+    EXPECT_TRUE(client_->write(empty).ok());
+  }
+  EXPECT_EQ(pattern(100, 'a') + data.substr(0, sent - 100), received_);
+}
+
+// Closing the handle while sends are waiting for their completion keeps the socket open until the
+// data has been transmitted.
+TEST_F(ZeroCopySenderTest, CloseWaitsForCompletions) {
+  Event::FileEventPtr file_event = client_->createFileEvent(
+      *dispatcher_, [](uint32_t) {}, Event::FileTriggerType::Edge, 0);
+
+  const std::string sent = fillSocket();
+  EXPECT_EQ(sent.size(), store_.counter("zero_copy.bytes").value());
+  file_event.reset();
+  EXPECT_TRUE(client_->close().ok());
+
+  // The buffers written from are gone, but the data still arrives intact followed by the close.
+  while (!server_eof_) {
+    readServer();
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  EXPECT_EQ(sent.size(), received_.size());
+  EXPECT_EQ(sent, received_);
+}
+
+// Completions of a socket which is not written to anymore are reaped by its file events.
+TEST_F(ZeroCopySenderTest, ReapOnFileEvent) {
+  Event::FileEventPtr file_event = client_->createFileEvent(
+      *dispatcher_, [](uint32_t) {}, Event::FileTriggerType::Edge, Event::FileReadyType::Read);
+
+  Buffer::OwnedImpl large(pattern(65536, 'A'));
+  const Api::IoCallUint64Result result = client_->write(large);
+  ASSERT_TRUE(result.ok());
+  EXPECT_GT(result.rc_, 0);
+
+  EXPECT_CALL(store_, deliverHistogramToSinks(
+                          Property(&Stats::Metric::name, "zero_copy.completion_latency"), _));
+  while (store_.counter("zero_copy.fallback_copies").value() == 0) {
+    readServer();
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  readServer();
+  EXPECT_EQ(result.rc_, received_.size());
+}
+
+class ZeroCopySenderCloseTimeoutTest : public ZeroCopySenderTest {
+protected:
+  ZeroCopySenderCloseTimeoutTest() { close_timeout_ = std::chrono::milliseconds(1); }
+};
+
+// A closed socket whose sends do not complete in time is reset.
+TEST_F(ZeroCopySenderCloseTimeoutTest, CloseTimeout) {
+  Event::FileEventPtr file_event = client_->createFileEvent(
+      *dispatcher_, [](uint32_t) {}, Event::FileTriggerType::Edge, 0);
+
+  fillSocket();
+  file_event.reset();
+  EXPECT_TRUE(client_->close().ok());
+  while (store_.counter("zero_copy.close_timeouts").value() == 0) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  EXPECT_TRUE(readServerUntilClosed());
+}
+
+// A closed socket waiting for its completions is reset when the dispatcher is destroyed.
+TEST_F(ZeroCopySenderTest, DispatcherDestroyed) {
+  Event::FileEventPtr file_event = client_->createFileEvent(
+      *dispatcher_, [](uint32_t) {}, Event::FileTriggerType::Edge, 0);
+
+  fillSocket();
+  file_event.reset();
+  EXPECT_TRUE(client_->close().ok());
+  dispatcher_.reset();
+  EXPECT_TRUE(readServerUntilClosed());
+  EXPECT_EQ(0, store_.counter("zero_copy.close_timeouts").value());
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
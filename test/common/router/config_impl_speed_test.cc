@@ -0,0 +1,108 @@
+#include "envoy/config/route/v3/route.pb.h"
+#include "envoy/config/route/v3/route_components.pb.h"
+
+#include "common/router/config_impl.h"
+
+#include "test/mocks/server/instance.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+using envoy::config::route::v3::RouteConfiguration;
+using envoy::config::route::v3::RouteMatch;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+/**
+ * Generates a route config with a single virtual host of state.range(0) routes of the given match
+ * type. Route i matches the path "/shelves/shelf_<i>/route" (or the corresponding prefix/regex).
+ */
+static RouteConfiguration genRouteConfig(benchmark::State& state,
+                                         RouteMatch::PathSpecifierCase match_type) {
+  RouteConfiguration route_config;
+  auto* v_host = route_config.add_virtual_hosts();
+  v_host->set_name("default");
+  v_host->add_domains("*");
+  for (int i = 0; i < state.range(0); ++i) {
+    auto* route = v_host->add_routes();
+    const std::string path = absl::StrCat("/shelves/shelf_", i, "/route");
+    switch (match_type) {
+    case RouteMatch::PathSpecifierCase::kPrefix:
+      route->mutable_match()->set_prefix(path);
+      break;
+    case RouteMatch::PathSpecifierCase::kPath:
+      route->mutable_match()->set_path(path);
+      break;
+    case RouteMatch::PathSpecifierCase::kSafeRegex: {
+      auto* regex = route->mutable_match()->mutable_safe_regex();
+      regex->mutable_google_re2();
+      regex->set_regex(absl::StrCat("/shelves/shelf_", i, "/route(/[a-z]+)?"));
+      break;
+    }
+    default:
+      NOT_REACHED_GCOVR_EXCL_LINE;
+    }
+    route->mutable_route()->set_cluster(absl::StrCat("cluster_", i));
+  }
+  return route_config;
+}
+
+/**
+ * Measures the time to route a request to the last route of a virtual host, the worst case for a
+ * linear scan, with and without the route match index (state.range(1)).
+ */
+static void bmRouteTableSize(benchmark::State& state, RouteMatch::PathSpecifierCase match_type) {
+  Api::ApiPtr api = Api::createApiForTest();
+  NiceMock<Server::Configuration::MockServerFactoryContext> factory_context;
+  NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+  ON_CALL(factory_context, api()).WillByDefault(ReturnRef(*api));
+  ON_CALL(factory_context.runtime_loader_.snapshot_,
+          getInteger("router.route_match_index_min_routes", 0))
+      .WillByDefault(Return(state.range(1)));
+
+  const ConfigImpl config(genRouteConfig(state, match_type), factory_context,
+                          ProtobufMessage::getNullValidationVisitor(), false);
+  const Http::TestRequestHeaderMapImpl headers{
+      {":authority", "www.example.com"},
+      {":path", absl::StrCat("/shelves/shelf_", state.range(0) - 1, "/route")},
+      {":method", "GET"},
+      {"x-forwarded-proto", "http"}};
+
+  for (auto _ : state) { // NOLINT
+    RouteConstSharedPtr route = config.route(headers, stream_info, 0);
+    benchmark::DoNotOptimize(route);
+  }
+}
+
+static void bmPrefixRouteTableSize(benchmark::State& state) {
+  bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kPrefix);
+}
+static void bmPathRouteTableSize(benchmark::State& state) {
+  bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kPath);
+}
+static void bmRegexRouteTableSize(benchmark::State& state) {
+  bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kSafeRegex);
+}
+
+// Args are {number of routes, route match index minimum routes (0 disables the index)}.
+static void routeTableSizeArgs(benchmark::internal::Benchmark* b) {
+  for (const int routes : {10, 100, 1000, 5000}) {
+    for (const int index_min_routes : {0, 1}) {
+      b->Args({routes, index_min_routes});
+    }
+  }
+}
+
+BENCHMARK(bmPrefixRouteTableSize)->Apply(routeTableSizeArgs);
+BENCHMARK(bmPathRouteTableSize)->Apply(routeTableSizeArgs);
+BENCHMARK(bmRegexRouteTableSize)->Apply(routeTableSizeArgs);
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
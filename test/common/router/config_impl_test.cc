@@ -35,6 +35,7 @@
 
 using testing::_;
 using testing::ContainerEq;
+using testing::ElementsAre;
 using testing::Eq;
 using testing::Matcher;
 using testing::MockFunction;
@@ -474,6 +475,155 @@ virtual_hosts:
   }
 }
 
+// Verifies that the path index over a virtual host's routes selects the same route as a linear
+// scan, including routes that are not indexed and routes with additional match criteria.
+TEST_F(RouteMatcherTest, RouteMatchIndex) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+- name: www
+  domains:
+  - www.lyft.com
+  routes:
+  - match:
+      prefix: "/foo"
+      headers:
+      - name: x-foo
+        exact_match: bar
+    route:
+      cluster: foo_header
+  - match:
+      path: "/foo/bar"
+    route:
+      cluster: foo_bar_exact
+  - match:
+      prefix: "/FOO/baz"
+      case_sensitive: false
+    route:
+      cluster: foo_baz_insensitive
+  - match:
+      safe_regex:
+        google_re2: {}
+        regex: "/foo/b[a-z]+"
+    route:
+      cluster: foo_regex
+  - match:
+      prefix: "/foo/"
+    route:
+      cluster: foo_prefix
+  - match:
+      path: "/foo/bar"
+    route:
+      cluster: foo_bar_shadowed
+  - match:
+      prefix: "/"
+    route:
+      cluster: default
+  )EOF";
+
+  const std::vector<std::pair<std::string, std::string>> expectations = {
+      {"/foo/bar", "foo_bar_exact"},
+      {"/foo/bar?x=y", "foo_bar_exact"},
+      {"/foo/baz", "foo_baz_insensitive"},
+      {"/foo/BAZ", "foo_baz_insensitive"},
+      {"/foo/bob", "foo_regex"},
+      {"/foo/bob#frag", "foo_regex"},
+      {"/foo/123", "foo_prefix"},
+      {"/foo", "default"},
+      {"/bar", "default"},
+  };
+
+  for (const uint64_t min_routes : {0, 1}) {
+    SCOPED_TRACE(min_routes);
+    ON_CALL(factory_context_.runtime_loader_.snapshot_,
+            getInteger("router.route_match_index_min_routes", 0))
+        .WillByDefault(Return(min_routes));
+    TestConfigImpl config(parseRouteConfigurationFromYaml(yaml), factory_context_, true);
+
+    for (const auto& expectation : expectations) {
+      EXPECT_EQ(expectation.second,
+                config.route(genHeaders("www.lyft.com", expectation.first, "GET"), 0)
+                    ->routeEntry()
+                    ->clusterName())
+          << expectation.first;
+    }
+
+    Http::TestRequestHeaderMapImpl headers = genHeaders("www.lyft.com", "/foo/bar", "GET");
+    headers.addCopy("x-foo", "bar");
+    EXPECT_EQ("foo_header", config.route(headers, 0)->routeEntry()->clusterName());
+
+    // Declining each match walks the remaining matching routes in order.
+    std::vector<std::string> visited;
+    EXPECT_EQ(nullptr, config.route(
+                           [&visited](RouteConstSharedPtr route,
+                                      RouteEvalStatus) -> RouteMatchStatus {
+                             visited.push_back(route->routeEntry()->clusterName());
+                             return RouteMatchStatus::Continue;
+                           },
+                           genHeaders("www.lyft.com", "/foo/bar", "GET")));
+    EXPECT_THAT(visited, ElementsAre("foo_bar_exact", "foo_regex", "foo_prefix",
+                                     "foo_bar_shadowed", "default"));
+  }
+}
+
+// Verifies that virtual hosts are carried over from the previous config only when both they and
+// the common part of the route configuration are unchanged, and never when clusters are validated.
+TEST_F(RouteMatcherTest, ReuseVirtualHosts) {
+  const std::string yaml = R"EOF(
+name: foo
+virtual_hosts:
+- name: www
+  domains: ["www.lyft.com"]
+  routes:
+  - match: { prefix: "/" }
+    route: { cluster: www }
+- name: api
+  domains: ["api.lyft.com"]
+  routes:
+  - match: { prefix: "/" }
+    route: { cluster: api }
+  )EOF";
+
+  NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+  auto route_config = parseRouteConfigurationFromYaml(yaml);
+  ConfigImpl first(route_config, factory_context_, ProtobufMessage::getNullValidationVisitor(),
+                   false, true);
+  EXPECT_EQ(0, first.virtualHostsReused());
+  EXPECT_EQ(2, first.virtualHostsBuilt());
+
+  route_config.mutable_virtual_hosts(1)->mutable_routes(0)->mutable_route()->set_cluster("api2");
+  ConfigImpl second(route_config, factory_context_, ProtobufMessage::getNullValidationVisitor(),
+                    false, true, &first);
+  EXPECT_EQ(1, second.virtualHostsReused());
+  EXPECT_EQ(1, second.virtualHostsBuilt());
+  const auto www_headers = genHeaders("www.lyft.com", "/", "GET");
+  EXPECT_EQ(first.route(www_headers, stream_info, 0), second.route(www_headers, stream_info, 0));
+  EXPECT_EQ(&second.route(www_headers, stream_info, 0)->routeEntry()->virtualHost().routeConfig(),
+            &first.route(www_headers, stream_info, 0)->routeEntry()->virtualHost().routeConfig());
+  EXPECT_EQ("api2", second.route(genHeaders("api.lyft.com", "/", "GET"), stream_info, 0)
+                        ->routeEntry()
+                        ->clusterName());
+
+  // Virtual hosts refer to the common configuration, so changing it rebuilds all of them.
+  route_config.add_internal_only_headers("x-internal");
+  ConfigImpl third(route_config, factory_context_, ProtobufMessage::getNullValidationVisitor(),
+                   false, true, &second);
+  EXPECT_EQ(0, third.virtualHostsReused());
+  EXPECT_EQ(2, third.virtualHostsBuilt());
+  EXPECT_EQ(1, third.route(www_headers, stream_info, 0)
+                   ->routeEntry()
+                   ->virtualHost()
+                   .routeConfig()
+                   .internalOnlyHeaders()
+                   .size());
+
+  // A reused virtual host would not be validated against the current clusters.
+  route_config.mutable_validate_clusters()->set_value(true);
+  ConfigImpl fourth(route_config, factory_context_, ProtobufMessage::getNullValidationVisitor(),
+                    false, true, &third);
+  EXPECT_EQ(0, fourth.virtualHostsReused());
+  EXPECT_EQ(2, fourth.virtualHostsBuilt());
+}
+
 TEST_F(RouteMatcherTest, TestConnectRoutes) {
   const std::string yaml = R"EOF(
 virtual_hosts:
@@ -23,6 +23,7 @@
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
 #include "test/test_common/simulated_time_system.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -279,6 +280,104 @@ TEST_F(RdsImplTest, FailureSubscription) {
   rds_callbacks_->onConfigUpdateFailed(Envoy::Config::ConfigUpdateFailureReason::FetchTimedout, {});
 }
 
+// Validate that an update only rebuilds the virtual hosts that changed.
+TEST_F(RdsImplTest, ReuseUnchangedVirtualHosts) {
+  setup();
+
+  const std::string response_yaml = R"EOF(
+version_info: "{}"
+resources:
+- "@type": type.googleapis.com/envoy.config.route.v3.RouteConfiguration
+  name: foo_route_config
+  virtual_hosts:
+  - name: foo
+    domains: ["foo"]
+    routes:
+    - match: {{ prefix: "/" }}
+      route: {{ cluster: foo }}
+  - name: bar
+    domains: ["bar"]
+    routes:
+    - match: {{ prefix: "/" }}
+      route: {{ cluster: {} }}
+)EOF";
+
+  auto response1 = TestUtility::parseYaml<envoy::service::discovery::v3::DiscoveryResponse>(
+      fmt::format(response_yaml, "1", "bar"));
+  const auto decoded_resources_1 =
+      TestUtility::decodeResources<envoy::config::route::v3::RouteConfiguration>(response1);
+  EXPECT_CALL(init_watcher_, ready());
+  rds_callbacks_->onConfigUpdate(decoded_resources_1.refvec_, response1.version_info());
+  EXPECT_EQ(2UL, scope_.counter("foo.rds.foo_route_config.virtual_host_rebuilt").value());
+  EXPECT_EQ(0UL, scope_.counter("foo.rds.foo_route_config.virtual_host_reused").value());
+
+  RouteConstSharedPtr foo_route =
+      route(Http::TestRequestHeaderMapImpl{{":authority", "foo"}, {":path", "/"}});
+  RouteConstSharedPtr bar_route =
+      route(Http::TestRequestHeaderMapImpl{{":authority", "bar"}, {":path", "/"}});
+
+  auto response2 = TestUtility::parseYaml<envoy::service::discovery::v3::DiscoveryResponse>(
+      fmt::format(response_yaml, "2", "baz"));
+  const auto decoded_resources_2 =
+      TestUtility::decodeResources<envoy::config::route::v3::RouteConfiguration>(response2);
+  rds_callbacks_->onConfigUpdate(decoded_resources_2.refvec_, response2.version_info());
+  EXPECT_EQ(3UL, scope_.counter("foo.rds.foo_route_config.virtual_host_rebuilt").value());
+  EXPECT_EQ(1UL, scope_.counter("foo.rds.foo_route_config.virtual_host_reused").value());
+
+  // The unchanged virtual host, and so its routes, are shared with the previous config.
+  EXPECT_EQ(foo_route,
+            route(Http::TestRequestHeaderMapImpl{{":authority", "foo"}, {":path", "/"}}));
+  RouteConstSharedPtr new_bar_route =
+      route(Http::TestRequestHeaderMapImpl{{":authority", "bar"}, {":path", "/"}});
+  EXPECT_NE(bar_route, new_bar_route);
+  EXPECT_EQ("baz", new_bar_route->routeEntry()->clusterName());
+}
+
+// Validate that every virtual host is rebuilt when reuse is disabled by runtime.
+TEST_F(RdsImplTest, ReuseVirtualHostsDisabledByRuntime) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.rds_reuse_virtual_hosts", "false"}});
+  setup();
+
+  const std::string response_yaml = R"EOF(
+version_info: "{}"
+resources:
+- "@type": type.googleapis.com/envoy.config.route.v3.RouteConfiguration
+  name: foo_route_config
+  virtual_hosts:
+  - name: foo
+    domains: ["foo"]
+    routes:
+    - match: {{ prefix: "/" }}
+      route: {{ cluster: foo }}
+  - name: bar
+    domains: ["bar"]
+    routes:
+    - match: {{ prefix: "/" }}
+      route: {{ cluster: {} }}
+)EOF";
+
+  auto response1 = TestUtility::parseYaml<envoy::service::discovery::v3::DiscoveryResponse>(
+      fmt::format(response_yaml, "1", "bar"));
+  const auto decoded_resources_1 =
+      TestUtility::decodeResources<envoy::config::route::v3::RouteConfiguration>(response1);
+  EXPECT_CALL(init_watcher_, ready());
+  rds_callbacks_->onConfigUpdate(decoded_resources_1.refvec_, response1.version_info());
+  RouteConstSharedPtr foo_route =
+      route(Http::TestRequestHeaderMapImpl{{":authority", "foo"}, {":path", "/"}});
+
+  auto response2 = TestUtility::parseYaml<envoy::service::discovery::v3::DiscoveryResponse>(
+      fmt::format(response_yaml, "2", "baz"));
+  const auto decoded_resources_2 =
+      TestUtility::decodeResources<envoy::config::route::v3::RouteConfiguration>(response2);
+  rds_callbacks_->onConfigUpdate(decoded_resources_2.refvec_, response2.version_info());
+  EXPECT_EQ(4UL, scope_.counter("foo.rds.foo_route_config.virtual_host_rebuilt").value());
+  EXPECT_EQ(0UL, scope_.counter("foo.rds.foo_route_config.virtual_host_reused").value());
+  EXPECT_NE(foo_route,
+            route(Http::TestRequestHeaderMapImpl{{":authority", "foo"}, {":path", "/"}}));
+}
+
 // Verifies that a queued up request for a virtual host update doesn't crash if
 // RdsRouteConfigProvider is deallocated
 TEST_F(RdsImplTest, VirtualHostUpdateWhenProviderHasBeenDeallocated) {
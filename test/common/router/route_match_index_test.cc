@@ -0,0 +1,87 @@
+#include <vector>
+
+#include "common/router/route_match_index.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+std::vector<uint32_t> candidates(const RouteMatchIndex& index, absl::string_view path) {
+  std::vector<uint32_t> result;
+  index.findCandidates(path, result);
+  return result;
+}
+
+TEST(RouteMatchIndexTest, Empty) {
+  RouteMatchIndex index;
+  index.finalize();
+  EXPECT_THAT(candidates(index, "/foo"), IsEmpty());
+}
+
+TEST(RouteMatchIndexTest, Prefixes) {
+  RouteMatchIndex index;
+  index.addPrefix(0, "/foo/bar");
+  index.addPrefix(1, "/foo");
+  index.addPrefix(2, "/fob");
+  index.addPrefix(3, "/");
+  index.addPrefix(4, "/foo");
+  index.finalize();
+
+  EXPECT_THAT(candidates(index, "/foo/bar/baz"), ElementsAre(0, 1, 3, 4));
+  EXPECT_THAT(candidates(index, "/foo/ba"), ElementsAre(1, 3, 4));
+  EXPECT_THAT(candidates(index, "/fob"), ElementsAre(2, 3));
+  EXPECT_THAT(candidates(index, "/bar"), ElementsAre(3));
+  // The query string and fragment are not part of the path.
+  EXPECT_THAT(candidates(index, "/fo?o/bar"), ElementsAre(3));
+  EXPECT_THAT(candidates(index, "/fo#o/bar"), ElementsAre(3));
+}
+
+TEST(RouteMatchIndexTest, ExactPaths) {
+  RouteMatchIndex index;
+  index.addExact(0, "/foo");
+  index.addExact(1, "/foo/bar");
+  index.addExact(2, "/foo");
+  index.finalize();
+
+  EXPECT_THAT(candidates(index, "/foo"), ElementsAre(0, 2));
+  EXPECT_THAT(candidates(index, "/foo?bar=baz"), ElementsAre(0, 2));
+  EXPECT_THAT(candidates(index, "/foo/bar"), ElementsAre(1));
+  EXPECT_THAT(candidates(index, "/foo/"), IsEmpty());
+}
+
+TEST(RouteMatchIndexTest, Regexes) {
+  RouteMatchIndex index;
+  index.addRegex(0, "/foo/[0-9]+");
+  index.addRegex(1, "/foo/.*");
+  index.addRegex(2, "[0-9]+");
+  index.finalize();
+
+  EXPECT_THAT(candidates(index, "/foo/123"), ElementsAre(0, 1));
+  EXPECT_THAT(candidates(index, "/foo/abc?x=1"), ElementsAre(1));
+  // Regexes must match the entire path.
+  EXPECT_THAT(candidates(index, "/bar/123"), IsEmpty());
+}
+
+TEST(RouteMatchIndexTest, CandidatesInRouteOrder) {
+  RouteMatchIndex index;
+  index.addRegex(0, "/foo.*");
+  index.addUnindexed(1);
+  index.addExact(2, "/foo");
+  index.addPrefix(3, "/f");
+  index.addUnindexed(4);
+  index.addPrefix(5, "/bar");
+  index.finalize();
+
+  EXPECT_THAT(candidates(index, "/foo"), ElementsAre(0, 1, 2, 3, 4));
+  EXPECT_THAT(candidates(index, "/bar"), ElementsAre(1, 4, 5));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
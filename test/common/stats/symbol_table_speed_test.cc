@@ -12,6 +12,7 @@
 #include "test/common/stats/make_elements_helper.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "benchmark/benchmark.h"
 
@@ -58,6 +59,53 @@ static void BM_CreateRace(benchmark::State& state) {
 }
 BENCHMARK(BM_CreateRace);
 
+// Measures encode, decode and free throughput when several threads concurrently
+// create stat names from a shared vocabulary of already-interned tokens, as
+// workers do when instantiating scoped stats. state.range(0) is the number of
+// threads.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_EncodeDecodeContention(benchmark::State& state) {
+  Envoy::Thread::ThreadFactory& thread_factory = Envoy::Thread::threadFactoryForTest();
+  const int num_threads = state.range(0);
+  constexpr int num_names = 1000;
+  constexpr int ops_per_thread = 10000;
+
+  Envoy::Stats::SymbolTableImpl table;
+  std::vector<std::string> names;
+  names.reserve(num_names);
+  Envoy::Stats::StatNamePool interned(table);
+  for (int i = 0; i < num_names; ++i) {
+    names.push_back(absl::StrCat("cluster.cluster_", i % 100, ".upstream_rq_", i / 100));
+    interned.add(names.back());
+  }
+
+  for (auto _ : state) {
+    std::vector<Envoy::Thread::ThreadPtr> threads;
+    threads.reserve(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      threads.push_back(thread_factory.createThread([&table, &names, t]() {
+        for (int i = 0; i < ops_per_thread; ++i) {
+          Envoy::Stats::StatNameStorage storage(names[(i * 7 + t * 131) % num_names], table);
+          benchmark::DoNotOptimize(table.toString(storage.statName()));
+          storage.free(table);
+        }
+      }));
+    }
+    for (auto& thread : threads) {
+      thread->join();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_threads * ops_per_thread);
+}
+BENCHMARK(BM_EncodeDecodeContention)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Arg(16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void BM_JoinStatNames(benchmark::State& state) {
   Envoy::Stats::SymbolTableImpl symbol_table;
@@ -1,6 +1,8 @@
 // Note: this should be run with --compilation_mode=opt, and would benefit from a
 // quiescent system with disabled cstate power management.
 
+#include <atomic>
+
 #include "envoy/config/metrics/v3/stats.pb.h"
 
 #include "common/common/logger.h"
@@ -17,6 +19,7 @@
 #include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "benchmark/benchmark.h"
 
 namespace Envoy {
@@ -75,6 +78,95 @@ private:
   std::vector<std::unique_ptr<Stats::StatNameStorage>> stat_names_;
 };
 
+// Records values into a set of histograms from worker threads, while the main thread flushes them.
+class HistogramFlushPerf {
+public:
+  static constexpr uint32_t NumHistograms = 100;
+
+  explicit HistogramFlushPerf(uint32_t num_workers)
+      : symbol_table_(Stats::SymbolTableCreator::makeSymbolTable()), heap_alloc_(*symbol_table_),
+        store_(heap_alloc_), api_(Api::createApiForTest(store_, time_system_)),
+        pool_(*symbol_table_) {
+    if (!Envoy::Event::Libevent::Global::initialized()) {
+      Envoy::Event::Libevent::Global::initialize();
+    }
+    main_dispatcher_ = api_->allocateDispatcher("main_thread");
+    tls_ = std::make_unique<ThreadLocal::InstanceImpl>();
+    tls_->registerThread(*main_dispatcher_, true);
+    for (uint32_t i = 0; i < num_workers; ++i) {
+      worker_dispatchers_.push_back(api_->allocateDispatcher(absl::StrCat("worker_", i)));
+      tls_->registerThread(*worker_dispatchers_.back(), false);
+    }
+    store_.initializeThreading(*main_dispatcher_, *tls_);
+
+    for (uint32_t i = 0; i < NumHistograms; ++i) {
+      histograms_.push_back(&store_.histogramFromStatName(pool_.add(absl::StrCat("histogram_", i)),
+                                                         Stats::Histogram::Unit::Unspecified));
+    }
+
+    for (Event::DispatcherPtr& dispatcher : worker_dispatchers_) {
+      Event::Dispatcher& worker = *dispatcher;
+      worker.post([this, &worker]() { recordBatch(worker); });
+      threads_.push_back(api_->threadFactory().createThread(
+          [&worker]() { worker.run(Event::Dispatcher::RunType::RunUntilExit); }));
+    }
+  }
+
+  ~HistogramFlushPerf() {
+    done_ = true;
+    for (Event::DispatcherPtr& dispatcher : worker_dispatchers_) {
+      Event::Dispatcher& worker = *dispatcher;
+      worker.post([&worker]() { worker.exit(); });
+    }
+    for (Thread::ThreadPtr& thread : threads_) {
+      thread->join();
+    }
+    store_.shutdownThreading();
+    tls_->shutdownGlobalThreading();
+    tls_->shutdownThread();
+    main_dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  // Merges the histograms of all threads, running the main dispatcher until the merge completes.
+  void flush() {
+    bool merged = false;
+    store_.mergeHistograms([&merged]() { merged = true; });
+    while (!merged) {
+      main_dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
+  uint64_t records() const { return records_; }
+
+private:
+  // Records a value into each histogram, then yields to the worker's event loop so that the
+  // flush can swap the thread's histograms between batches.
+  void recordBatch(Event::Dispatcher& worker) {
+    if (done_) {
+      return;
+    }
+    for (uint32_t i = 0; i < NumHistograms; ++i) {
+      histograms_[i]->recordValue(i);
+    }
+    records_ += NumHistograms;
+    worker.post([this, &worker]() { recordBatch(worker); });
+  }
+
+  Stats::SymbolTablePtr symbol_table_;
+  Event::SimulatedTimeSystem time_system_;
+  Stats::AllocatorImpl heap_alloc_;
+  Event::DispatcherPtr main_dispatcher_;
+  std::vector<Event::DispatcherPtr> worker_dispatchers_;
+  ThreadLocal::InstanceImplPtr tls_;
+  Stats::ThreadLocalStoreImpl store_;
+  Api::ApiPtr api_;
+  Stats::StatNamePool pool_;
+  std::vector<Thread::ThreadPtr> threads_;
+  std::vector<Stats::Histogram*> histograms_;
+  std::atomic<bool> done_{false};
+  std::atomic<uint64_t> records_{0};
+};
+
 } // namespace Envoy
 
 // Tests the single-threaded performance of the thread-local-store stats caches
@@ -103,3 +195,21 @@ BENCHMARK(BM_StatsWithTls);
 
 // TODO(jmarantz): add multi-threaded variant of this test, that aggressively
 // looks up stats in multiple threads to try to trigger contention issues.
+
+// Measures the latency of a histogram flush while the given number of worker threads record
+// into 100 histograms. The records counter shows the rate at which the workers recorded values
+// meanwhile, which drops if the flush stalls them.
+static void BM_HistogramRecordWithFlush(benchmark::State& state) {
+  Envoy::HistogramFlushPerf context(state.range(0));
+
+  for (auto _ : state) {
+    context.flush();
+  }
+  state.counters["records"] = benchmark::Counter(context.records(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_HistogramRecordWithFlush)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
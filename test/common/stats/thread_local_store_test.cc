@@ -1735,6 +1735,38 @@ TEST_F(HistogramThreadTest, MakeHistogramsAndRecordValues) {
               HasSubstr(absl::StrCat(" B25(0,0) B50(", NumThreads, ",", NumThreads, ") ")));
 }
 
+// All the TLS histograms of a thread are swapped together on merge, including histograms that
+// were first recorded into after an earlier merge.
+TEST_F(HistogramThreadTest, RecordAcrossMerges) {
+  foreachThread([this]() {
+    store_->histogramFromString("first", Histogram::Unit::Unspecified).recordValue(42);
+  });
+  mergeHistograms();
+
+  foreachThread([this]() {
+    store_->histogramFromString("first", Histogram::Unit::Unspecified).recordValue(42);
+    store_->histogramFromString("second", Histogram::Unit::Unspecified).recordValue(42);
+  });
+  mergeHistograms();
+
+  std::vector<ParentHistogramSharedPtr> histograms = store_->histograms();
+  ASSERT_EQ(2, histograms.size());
+  for (const ParentHistogramSharedPtr& histogram : histograms) {
+    const uint32_t cumulative = histogram->name() == "first" ? 2 * NumThreads : NumThreads;
+    EXPECT_THAT(histogram->bucketSummary(),
+                HasSubstr(absl::StrCat(" B50(", NumThreads, ",", cumulative, ") ")))
+        << histogram->name();
+  }
+
+  // Nothing was recorded in the last interval.
+  mergeHistograms();
+  for (const ParentHistogramSharedPtr& histogram : histograms) {
+    const uint32_t cumulative = histogram->name() == "first" ? 2 * NumThreads : NumThreads;
+    EXPECT_THAT(histogram->bucketSummary(), HasSubstr(absl::StrCat(" B50(0,", cumulative, ") ")))
+        << histogram->name();
+  }
+}
+
 TEST_F(HistogramThreadTest, ScopeOverlap) {
   // Creating two scopes with the same name gets you two distinct scope objects.
   ScopePtr scope1 = store_->createScope("scope.");
@@ -47,6 +47,7 @@ using ::testing::DoAll;
 using ::testing::Invoke;
 using ::testing::InvokeWithoutArgs;
 using ::testing::NiceMock;
+using ::testing::Ref;
 using ::testing::Return;
 using ::testing::ReturnPointee;
 using ::testing::ReturnRef;
@@ -1470,6 +1471,43 @@ TEST_F(TcpProxyTest, DEPRECATED_FEATURE_TEST(IdleTimerDisabledUpstreamClose)) {
   upstream_callbacks_->onEvent(Network::ConnectionEvent::RemoteClose);
 }
 
+// Tests that the connections are spliced once the upstream is connected, if configured.
+TEST_F(TcpProxyTest, DEPRECATED_FEATURE_TEST(SpliceForwarding)) {
+  envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy config = defaultConfig();
+  config.set_splice_forwarding(true);
+  setup(1, config);
+
+  EXPECT_CALL(*upstream_connections_.at(0), startSplice(Ref(filter_callbacks_.connection_)))
+      .WillOnce(Return(true));
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(1U, config_->stats().downstream_cx_spliced_total_.value());
+}
+
+// Tests that data is proxied as usual if the connections cannot be spliced.
+TEST_F(TcpProxyTest, DEPRECATED_FEATURE_TEST(SpliceForwardingUnsupported)) {
+  envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy config = defaultConfig();
+  config.set_splice_forwarding(true);
+  setup(1, config);
+
+  EXPECT_CALL(*upstream_connections_.at(0), startSplice(Ref(filter_callbacks_.connection_)))
+      .WillOnce(Return(false));
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(0U, config_->stats().downstream_cx_spliced_total_.value());
+
+  Buffer::OwnedImpl buffer("hello");
+  EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), false));
+  filter_->onData(buffer, false);
+}
+
+// Tests that the connections are not spliced unless configured.
+TEST_F(TcpProxyTest, DEPRECATED_FEATURE_TEST(SpliceForwardingDisabled)) {
+  setup(1);
+
+  EXPECT_CALL(*upstream_connections_.at(0), startSplice(_)).Times(0);
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(0U, config_->stats().downstream_cx_spliced_total_.value());
+}
+
 // Tests that flushing data during an idle timeout doesn't cause problems.
 TEST_F(TcpProxyTest, DEPRECATED_FEATURE_TEST(IdleTimeoutWithOutstandingDataFlushed)) {
   envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy config = defaultConfig();
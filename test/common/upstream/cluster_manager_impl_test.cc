@@ -1761,6 +1761,62 @@ TEST_F(ClusterManagerImplTest, DoNotCloseTcpConnectionsOnHealthFailure) {
   EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
 }
 
+// Connections are established to hosts added to a cluster which already has hosts, but not to its
+// initial hosts.
+TEST_F(ClusterManagerImplTest, WarmUpAddedHosts) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: cluster_1
+      connect_timeout: 0.250s
+      type: STRICT_DNS
+      lb_policy: ROUND_ROBIN
+      dns_resolvers:
+        - socket_address:
+            address: 1.2.3.4
+            port_value: 80
+      prefetch_policy:
+        warm_up_connections: 2
+      load_assignment:
+        cluster_name: cluster_1
+        endpoints:
+          - lb_endpoints:
+            - endpoint:
+                address:
+                  socket_address:
+                    address: 127.0.0.1
+                    port_value: 11001
+  )EOF";
+
+  std::shared_ptr<Network::MockDnsResolver> dns_resolver(new Network::MockDnsResolver());
+  EXPECT_CALL(factory_.dispatcher_, createDnsResolver(_, _)).WillOnce(Return(dns_resolver));
+
+  Network::DnsResolver::ResolveCb dns_callback;
+  Event::MockTimer* dns_timer_ = new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  Network::MockActiveDnsQuery active_dns_query;
+  EXPECT_CALL(*dns_resolver, resolve(_, _, _))
+      .WillRepeatedly(DoAll(SaveArg<2>(&dns_callback), Return(&active_dns_query)));
+  create(parseBootstrapFromV3Yaml(yaml));
+
+  EXPECT_CALL(factory_, allocateConnPool_(_, _, _)).Times(0);
+  dns_callback(Network::DnsResolver::ResolutionStatus::Success,
+               TestUtility::makeDnsResponse({"127.0.0.1"}));
+
+  // Only the added host is warmed up.
+  Http::ConnectionPool::MockInstance* cp = new NiceMock<Http::ConnectionPool::MockInstance>();
+  EXPECT_CALL(*cp, prefetchConnections(2));
+  EXPECT_CALL(factory_, allocateConnPool_(_, _, _))
+      .WillOnce(Invoke([cp](HostConstSharedPtr host, Network::ConnectionSocket::OptionsSharedPtr,
+                            Network::TransportSocketOptionsSharedPtr) {
+        EXPECT_EQ("127.0.0.2:11001", host->address()->asString());
+        return cp;
+      }));
+  dns_timer_->invokeCallback();
+  dns_callback(Network::DnsResolver::ResolutionStatus::Success,
+               TestUtility::makeDnsResponse({"127.0.0.1", "127.0.0.2"}));
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cp));
+}
+
 TEST_F(ClusterManagerImplTest, DynamicHostRemove) {
   const std::string yaml = R"EOF(
   static_resources:
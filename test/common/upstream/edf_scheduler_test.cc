@@ -71,6 +71,163 @@ TEST(EdfSchedulerTest, Expired) {
   EXPECT_EQ(nullptr, sched.pick());
 }
 
+// Validate that pickAndAdd() gives the same schedule as pick() followed by add().
+TEST(EdfSchedulerTest, PickAndAdd) {
+  EdfScheduler<uint32_t> sched;
+  EdfScheduler<uint32_t> reference;
+  constexpr uint32_t num_entries = 16;
+  std::shared_ptr<uint32_t> entries[num_entries];
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(i % 3 + 1, entries[i]);
+    reference.add(i % 3 + 1, entries[i]);
+  }
+
+  for (uint32_t i = 0; i < 1000; ++i) {
+    auto p = sched.pickAndAdd([](const uint32_t& entry) { return entry % 3 + 1; });
+    auto q = reference.pick();
+    reference.add(*q % 3 + 1, q);
+    EXPECT_EQ(*q, *p);
+  }
+  EXPECT_EQ(num_entries, sched.size());
+}
+
+// Validate that indexed schedulers give the same schedule as plain ones and skip expired entries.
+TEST(EdfSchedulerTest, IndexedMatchesPlain) {
+  EdfScheduler<uint32_t> plain;
+  EdfScheduler<uint32_t> indexed(true);
+  constexpr uint32_t num_entries = 16;
+  std::shared_ptr<uint32_t> entries[num_entries];
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    plain.add(i % 3 + 1, entries[i]);
+    indexed.add(i % 3 + 1, entries[i]);
+  }
+  entries[5].reset();
+
+  const auto calculate_weight = [](const uint32_t& entry) { return entry % 3 + 1; };
+  for (uint32_t i = 0; i < 1000; ++i) {
+    auto p = plain.pickAndAdd(calculate_weight);
+    auto q = indexed.pickAndAdd(calculate_weight);
+    EXPECT_EQ(*p, *q);
+    EXPECT_NE(5, *q);
+  }
+  EXPECT_EQ(num_entries - 1, plain.size());
+  EXPECT_EQ(num_entries - 1, indexed.size());
+}
+
+// Validate that adding an entry which is already scheduled reschedules it.
+TEST(EdfSchedulerTest, AddScheduled) {
+  EdfScheduler<uint32_t> sched(true);
+  auto first_entry = std::make_shared<uint32_t>(37);
+  auto second_entry = std::make_shared<uint32_t>(42);
+  sched.add(1, first_entry);
+  sched.add(2, second_entry);
+  sched.add(4, first_entry);
+  EXPECT_EQ(2, sched.size());
+
+  EXPECT_EQ(*first_entry, *sched.pick());
+  EXPECT_EQ(*second_entry, *sched.pick());
+  EXPECT_EQ(nullptr, sched.pick());
+}
+
+// Validate that a weight change moves the deadline of an entry relative to when it was scheduled.
+TEST(EdfSchedulerTest, Update) {
+  EdfScheduler<uint32_t> sched(true);
+  auto first_entry = std::make_shared<uint32_t>(37);
+  auto second_entry = std::make_shared<uint32_t>(42);
+  auto third_entry = std::make_shared<uint32_t>(7);
+  sched.add(1, first_entry);
+  sched.add(2, second_entry);
+
+  // The deadline of first_entry moves from 1 to 0.25.
+  EXPECT_TRUE(sched.update(4, *first_entry));
+  EXPECT_EQ(*first_entry, *sched.pick());
+
+  // The deadline of second_entry would move from 0.5 to 0.1, but not before the current time.
+  EXPECT_TRUE(sched.update(10, *second_entry));
+  sched.add(1, first_entry);
+  EXPECT_EQ(*second_entry, *sched.pick());
+  EXPECT_EQ(*first_entry, *sched.pick());
+
+  EXPECT_FALSE(sched.update(1, *second_entry));
+  EXPECT_FALSE(sched.update(1, *third_entry));
+}
+
+// Validate that removed entries are not picked.
+TEST(EdfSchedulerTest, Remove) {
+  EdfScheduler<uint32_t> sched(true);
+  constexpr uint32_t num_entries = 64;
+  std::shared_ptr<uint32_t> entries[num_entries];
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(i + 1, entries[i]);
+  }
+  for (uint32_t i = 0; i < num_entries; i += 2) {
+    EXPECT_TRUE(sched.remove(*entries[i]));
+  }
+  EXPECT_FALSE(sched.remove(*entries[0]));
+  EXPECT_EQ(num_entries / 2, sched.size());
+
+  for (uint32_t i = 0; i < 1000; ++i) {
+    auto p = sched.pickAndAdd([](const uint32_t& entry) { return entry + 1; });
+    EXPECT_EQ(1, *p % 2);
+  }
+}
+
+// Validate that refresh() adds, removes and reweights entries, keeping the schedule of the rest.
+TEST(EdfSchedulerTest, Refresh) {
+  EdfScheduler<uint32_t> sched(true);
+  constexpr uint32_t num_entries = 32;
+  std::vector<std::shared_ptr<uint32_t>> entries;
+  uint32_t weights[2 * num_entries];
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries.push_back(std::make_shared<uint32_t>(i));
+    weights[i] = 1;
+  }
+  const auto calculate_weight = [&weights](const uint32_t& entry) { return weights[entry]; };
+  sched.refresh(entries, calculate_weight);
+  EXPECT_EQ(num_entries, sched.size());
+  for (uint32_t i = 0; i < num_entries / 2; ++i) {
+    EXPECT_EQ(i, *sched.pickAndAdd(calculate_weight));
+  }
+
+  // Replace the first half of the entries and reweight the second half.
+  std::vector<std::shared_ptr<uint32_t>> new_entries(entries.begin() + num_entries / 2,
+                                                     entries.end());
+  for (uint32_t i = num_entries; i < num_entries + num_entries / 2; ++i) {
+    new_entries.push_back(std::make_shared<uint32_t>(i));
+    weights[i] = 1;
+  }
+  for (uint32_t i = num_entries / 2; i < num_entries; ++i) {
+    weights[i] = 2;
+  }
+  sched.refresh(new_entries, calculate_weight);
+  EXPECT_EQ(num_entries, sched.size());
+
+  // The reweighted entries were due before the new ones, and are picked twice as often.
+  for (uint32_t i = num_entries / 2; i < num_entries; ++i) {
+    EXPECT_EQ(i, *sched.pickAndAdd(calculate_weight));
+  }
+  uint32_t pick_count[2 * num_entries] = {};
+  for (uint32_t i = 0; i < 300 * num_entries; ++i) {
+    ++pick_count[*sched.pickAndAdd(calculate_weight)];
+  }
+  for (uint32_t i = 0; i < num_entries / 2; ++i) {
+    EXPECT_EQ(0, pick_count[i]);
+  }
+  for (uint32_t i = num_entries / 2; i < num_entries; ++i) {
+    EXPECT_NEAR(400, pick_count[i], 1);
+  }
+  for (uint32_t i = num_entries; i < num_entries + num_entries / 2; ++i) {
+    EXPECT_NEAR(200, pick_count[i], 1);
+  }
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
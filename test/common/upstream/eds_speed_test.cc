@@ -13,6 +13,7 @@
 #include "common/config/utility.h"
 #include "common/singleton/manager_impl.h"
 #include "common/upstream/eds.h"
+#include "common/upstream/load_balancer_impl.h"
 
 #include "server/transport_socket_config_impl.h"
 
@@ -92,7 +93,16 @@ public:
   void priorityAndLocalityWeightedHelper(bool ignore_unknown_dynamic_fields, size_t num_hosts,
                                          bool healthy) {
     state_.PauseTiming();
+    // this is what we're actually testing:
+    validation_visitor_.setSkipValidation(ignore_unknown_dynamic_fields);
+    auto response = makeResponse(num_hosts, 0, healthy);
+    state_.ResumeTiming();
+    sendResponse(std::move(response), num_hosts);
+  }
 
+  // Builds an assignment of num_hosts hosts in a single locality, numbered from first_host.
+  std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>
+  makeResponse(size_t num_hosts, size_t first_host, bool healthy) {
     envoy::config::endpoint::v3::ClusterLoadAssignment cluster_load_assignment;
     cluster_load_assignment.set_cluster_name("fare");
 
@@ -105,8 +115,7 @@ public:
     locality->set_sub_zone("sub_zone");
     endpoints->mutable_load_balancing_weight()->set_value(1);
 
-    uint32_t port = 1000;
-    for (size_t i = 0; i < num_hosts; ++i) {
+    for (size_t i = first_host; i < first_host + num_hosts; ++i) {
       auto* lb_endpoint = endpoints->add_lb_endpoints();
       if (healthy) {
         lb_endpoint->set_health_status(envoy::config::core::v3::HEALTHY);
@@ -115,13 +124,10 @@ public:
       }
       auto* socket_address =
           lb_endpoint->mutable_endpoint()->mutable_address()->mutable_socket_address();
-      socket_address->set_address("10.0.1." + std::to_string(i / 60000));
-      socket_address->set_port_value((port + i) % 60000);
+      socket_address->set_address("10.0.1." + std::to_string(i / 60000 % 256));
+      socket_address->set_port_value((1000 + i) % 60000);
     }
 
-    // this is what we're actually testing:
-    validation_visitor_.setSkipValidation(ignore_unknown_dynamic_fields);
-
     auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
     response->set_type_url(type_url_);
     auto* resource = response->mutable_resources()->Add();
@@ -132,12 +138,57 @@ public:
                      "");
       resource->set_type_url("type.googleapis.com/envoy.api.v2.ClusterLoadAssignment");
     }
-    state_.ResumeTiming();
+    return response;
+  }
+
+  void sendResponse(std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse> response,
+                    size_t num_hosts) {
     grpc_mux_->grpcStreamForTest().onReceiveMessage(std::move(response));
     ASSERT(cluster_->prioritySet().hostSetsPerPriority()[1]->hostsPerLocality().get()[0].size() ==
            num_hosts);
   }
 
+  // The copy of the cluster held by a worker, with its own load balancer.
+  struct WorkerCluster {
+    WorkerCluster(EdsSpeedTest& parent) {
+      priority_set_.getOrCreateHostSet(0);
+      lb_ = std::make_unique<RoundRobinLoadBalancer>(
+          priority_set_, nullptr, parent.cluster_->info()->stats(), parent.runtime_,
+          parent.random_, parent.cluster_->info()->lbConfig());
+    }
+
+    PrioritySetImpl priority_set_;
+    std::unique_ptr<RoundRobinLoadBalancer> lb_;
+  };
+
+  // Propagates the membership updates of the cluster to num_workers worker clusters, as
+  // ClusterManagerImpl::postThreadLocalClusterUpdate() does: the callback is copied for every
+  // worker, and applied to the priority set and load balancer of the worker.
+  void addWorkers(uint32_t num_workers) {
+    for (uint32_t i = 0; i < num_workers; ++i) {
+      workers_.push_back(std::make_unique<WorkerCluster>(*this));
+    }
+    cluster_->prioritySet().addPriorityUpdateCb(
+        [this](uint32_t priority, const HostVector& hosts_added, const HostVector& hosts_removed) {
+          const auto& host_set = cluster_->prioritySet().hostSetsPerPriority()[priority];
+          const std::function<void()> update =
+              [this, priority, update_params = HostSetImpl::updateHostsParams(*host_set),
+               locality_weights = host_set->localityWeights(),
+               hosts_added = std::make_shared<const HostVector>(hosts_added),
+               hosts_removed = std::make_shared<const HostVector>(hosts_removed),
+               overprovisioning_factor = host_set->overprovisioningFactor()]() {
+                current_worker_->priority_set_.updateHosts(
+                    priority, PrioritySet::UpdateHostsParams(update_params), locality_weights,
+                    *hosts_added, *hosts_removed, overprovisioning_factor);
+              };
+          for (auto& worker : workers_) {
+            current_worker_ = worker.get();
+            std::function<void()> posted = update;
+            posted();
+          }
+        });
+  }
+
   State& state_;
   const bool v2_config_;
   const std::string type_url_;
@@ -164,6 +215,8 @@ public:
   NiceMock<Grpc::MockAsyncStream> async_stream_;
   Config::GrpcMuxImplSharedPtr grpc_mux_;
   Config::GrpcSubscriptionImplPtr subscription_;
+  std::vector<std::unique_ptr<WorkerCluster>> workers_;
+  WorkerCluster* current_worker_{};
 };
 
 } // namespace Upstream
@@ -216,3 +269,37 @@ static void healthOnlyUpdate(State& state) {
 }
 
 BENCHMARK(healthOnlyUpdate)->Range(1, 100000)->Unit(benchmark::kMillisecond);
+
+// Measures the cost of propagating an EDS update to the workers, for clusters of state.range(0)
+// hosts, of which state.range(1) percent are replaced by each update, and state.range(2) workers.
+static void membershipPropagation(State& state) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_state(spdlog::level::warn,
+                                       Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock, false);
+  const uint32_t endpoints = skipExpensiveBenchmarks() ? 1 : state.range(0);
+  const uint32_t churn = std::max<uint32_t>(1, endpoints * state.range(1) / 100);
+
+  Envoy::Upstream::EdsSpeedTest speed_test(state, false);
+  speed_test.addWorkers(state.range(2));
+  speed_test.sendResponse(speed_test.makeResponse(endpoints, 0, true), endpoints);
+  size_t first_host = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    first_host += churn;
+    auto response = speed_test.makeResponse(endpoints, first_host, true);
+    state.ResumeTiming();
+    speed_test.sendResponse(std::move(response), endpoints);
+  }
+}
+
+BENCHMARK(membershipPropagation)
+    ->Apply([](benchmark::internal::Benchmark* benchmark) {
+      for (int64_t endpoints : {1000, 10000}) {
+        for (int64_t churn_percent : {1, 10, 100}) {
+          for (int64_t workers : {1, 16}) {
+            benchmark->Args({endpoints, churn_percent, workers});
+          }
+        }
+      }
+    })
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#include "common/upstream/hash_search_tree.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+// The position of the first hash >= hash, wrapping around to 0.
+uint64_t expectedLowerBound(const std::vector<uint64_t>& hashes, uint64_t hash) {
+  const uint64_t position = std::lower_bound(hashes.begin(), hashes.end(), hash) - hashes.begin();
+  return position == hashes.size() ? 0 : position;
+}
+
+void expectMatchesBinarySearch(const std::vector<uint64_t>& hashes,
+                               const std::vector<uint64_t>& lookups) {
+  HashSearchTree tree(hashes);
+  ASSERT_EQ(hashes.size(), tree.size());
+  for (uint64_t position = 0; position < hashes.size(); ++position) {
+    EXPECT_EQ(hashes[position], tree.hash(position));
+  }
+  for (const uint64_t hash : lookups) {
+    EXPECT_EQ(expectedLowerBound(hashes, hash), tree.lowerBound(hash)) << "hash " << hash;
+  }
+}
+
+TEST(HashSearchTreeTest, Empty) {
+  HashSearchTree tree(std::vector<uint64_t>{});
+  EXPECT_TRUE(tree.empty());
+  EXPECT_EQ(0, tree.memoryUsage());
+}
+
+TEST(HashSearchTreeTest, SingleNode) {
+  const std::vector<uint64_t> hashes{10, 20, 30};
+  HashSearchTree tree(hashes);
+  EXPECT_EQ(0, tree.lowerBound(0));
+  EXPECT_EQ(0, tree.lowerBound(10));
+  EXPECT_EQ(1, tree.lowerBound(11));
+  EXPECT_EQ(2, tree.lowerBound(30));
+  EXPECT_EQ(0, tree.lowerBound(31));
+  EXPECT_EQ(0, tree.lowerBound(std::numeric_limits<uint64_t>::max()));
+  EXPECT_EQ(64, tree.memoryUsage());
+}
+
+// The greatest hash is also the value the nodes are padded with.
+TEST(HashSearchTreeTest, MaxHash) {
+  const uint64_t max = std::numeric_limits<uint64_t>::max();
+  expectMatchesBinarySearch({1, max}, {0, 1, 2, max - 1, max});
+  expectMatchesBinarySearch({1, 2, 3, 4, 5, 6, 7, 8, max, max}, {0, 8, 9, max - 1, max});
+}
+
+// Sizes around multiples of the node size, with few enough distinct hashes for duplicates and
+// every lookup to be covered.
+TEST(HashSearchTreeTest, SmallRings) {
+  std::mt19937_64 random(0);
+  std::vector<uint64_t> lookups;
+  for (uint64_t hash = 0; hash <= 64; ++hash) {
+    lookups.push_back(hash);
+  }
+  for (size_t size = 1; size <= 2 * HashSearchTree::NodeSize * HashSearchTree::NodeSize + 1;
+       ++size) {
+    std::vector<uint64_t> hashes(size);
+    for (uint64_t& hash : hashes) {
+      hash = random() % 64;
+    }
+    std::sort(hashes.begin(), hashes.end());
+    expectMatchesBinarySearch(hashes, lookups);
+  }
+}
+
+// Hashes above the greatest hash of rings whose last leaf and last internal nodes are full, so that
+// the greatest hash is a separator while the rest of the node above it is padding.
+TEST(HashSearchTreeTest, AboveGreatestHashOfFullNodes) {
+  const uint64_t max = std::numeric_limits<uint64_t>::max();
+  for (const size_t size : {8, 16, 64, 128, 512, 1024, 4096}) {
+    std::vector<uint64_t> hashes(size);
+    for (size_t i = 0; i < size; ++i) {
+      hashes[i] = (i + 1) * 1000;
+    }
+    const uint64_t greatest = hashes.back();
+    expectMatchesBinarySearch(hashes, {0, greatest - 1, greatest, greatest + 1, max - 1, max});
+  }
+}
+
+TEST(HashSearchTreeTest, LargeRing) {
+  std::mt19937_64 random(0);
+  std::vector<uint64_t> hashes(100000);
+  for (uint64_t& hash : hashes) {
+    hash = random();
+  }
+  std::sort(hashes.begin(), hashes.end());
+
+  std::vector<uint64_t> lookups{0, std::numeric_limits<uint64_t>::max()};
+  for (size_t i = 0; i < 10000; ++i) {
+    lookups.push_back(random());
+    lookups.push_back(hashes[random() % hashes.size()]);
+  }
+  expectMatchesBinarySearch(hashes, lookups);
+
+  // 12500 leaves, then levels of 1563, 196, 25 and 4 nodes, and the root.
+  EXPECT_EQ((12500 + 1563 + 196 + 25 + 4 + 1) * 64, HashSearchTree(hashes).memoryUsage());
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
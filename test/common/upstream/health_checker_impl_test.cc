@@ -72,7 +72,7 @@ TEST(HealthCheckerFactoryTest, GrpcHealthCheckHTTP2NotConfiguredException) {
 
   EXPECT_THROW_WITH_MESSAGE(
       HealthCheckerFactory::create(createGrpcHealthCheckConfig(), cluster, runtime, random,
-                                   dispatcher, log_manager, validation_visitor, api),
+                                   dispatcher, log_manager, validation_visitor, api, nullptr),
       EnvoyException, "fake_cluster cluster must support HTTP/2 for gRPC healthchecking");
 }
 
@@ -92,7 +92,7 @@ TEST(HealthCheckerFactoryTest, CreateGrpc) {
   EXPECT_NE(nullptr, dynamic_cast<GrpcHealthCheckerImpl*>(
                          HealthCheckerFactory::create(createGrpcHealthCheckConfig(), cluster,
                                                       runtime, random, dispatcher, log_manager,
-                                                      validation_visitor, api)
+                                                      validation_visitor, api, nullptr)
                              .get()));
 }
 
@@ -3510,6 +3510,114 @@ TEST_F(TcpHealthCheckerImplTest, ConnectionLocalFailure) {
   EXPECT_EQ(0UL, cluster_->info_->stats_store_.counter("health_check.passive_failure").value());
 }
 
+// Tests that health checkers of clusters with identical config share the probe of an endpoint,
+// and that another one takes over probing when the probing one goes away.
+TEST_F(TcpHealthCheckerImplTest, SharedProbe) {
+  InSequence s;
+
+  const std::string yaml = R"EOF(
+    timeout: 1s
+    interval: 1s
+    unhealthy_threshold: 2
+    healthy_threshold: 2
+    tcp_health_check:
+      send:
+        text: "01"
+      receive:
+      - text: "02"
+    )EOF";
+
+  auto registry = std::make_shared<HealthCheckProbeRegistry>();
+  allocHealthChecker(yaml);
+  health_checker_->shareProbes(registry);
+  auto cluster2 = std::make_shared<NiceMock<MockClusterMockPrioritySet>>();
+  auto health_checker2 = std::make_shared<TcpHealthCheckerImpl>(
+      *cluster2, parseHealthCheckFromV3Yaml(yaml), dispatcher_, runtime_, random_, nullptr);
+  health_checker2->shareProbes(registry);
+
+  cluster_->prioritySet().getMockHostSet(0)->hosts_ = {
+      makeTestHost(cluster_->info_, "tcp://127.0.0.1:80")};
+  cluster2->prioritySet().getMockHostSet(0)->hosts_ = {
+      makeTestHost(cluster2->info_, "tcp://127.0.0.1:80")};
+  const HostSharedPtr host2 = cluster2->prioritySet().getMockHostSet(0)->hosts_[0];
+  cluster_->prioritySet().getMockHostSet(0)->hosts_[0]->healthFlagSet(
+      Host::HealthFlag::FAILED_ACTIVE_HC);
+  host2->healthFlagSet(Host::HealthFlag::FAILED_ACTIVE_HC);
+
+  expectSessionCreate();
+  expectClientCreate();
+  EXPECT_CALL(*connection_, write(_, _));
+  EXPECT_CALL(*timeout_timer_, enableTimer(_, _));
+  health_checker_->start();
+
+  // The second health checker only catches up with results of the probe of the first one.
+  Event::MockTimer* interval_timer2 = new Event::MockTimer(&dispatcher_);
+  Event::MockTimer* timeout_timer2 = new Event::MockTimer(&dispatcher_);
+  EXPECT_CALL(*interval_timer2, enableTimer(std::chrono::milliseconds(0), _));
+  health_checker2->start();
+  EXPECT_EQ(1UL, registry->numProbes());
+  interval_timer2->invokeCallback();
+
+  connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  EXPECT_CALL(event_logger_, logAddHealthy(_, _, true));
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_, _));
+  Buffer::OwnedImpl response;
+  add_uint8(response, 2);
+  read_filter_->onData(response, false);
+
+  EXPECT_FALSE(cluster_->prioritySet().getMockHostSet(0)->hosts_[0]->healthFlagGet(
+      Host::HealthFlag::FAILED_ACTIVE_HC));
+  EXPECT_FALSE(host2->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC));
+  EXPECT_EQ(1UL, cluster_->info_->stats_store_.counter("health_check.attempt").value());
+  EXPECT_EQ(1UL, cluster_->info_->stats_store_.counter("health_check.success").value());
+  EXPECT_EQ(0UL, cluster2->info_->stats_store_.counter("health_check.attempt").value());
+  EXPECT_EQ(1UL, cluster2->info_->stats_store_.counter("health_check.success").value());
+
+  // Removing the probing host hands the probe over to the second health checker.
+  HostVector removed{cluster_->prioritySet().getMockHostSet(0)->hosts_.back()};
+  cluster_->prioritySet().getMockHostSet(0)->hosts_.clear();
+  EXPECT_CALL(*interval_timer2, enableTimer(_, _));
+  EXPECT_CALL(*connection_, close(_));
+  cluster_->prioritySet().getMockHostSet(0)->runCallbacks({}, removed);
+
+  expectClientCreate();
+  EXPECT_CALL(*connection_, write(_, _));
+  EXPECT_CALL(*timeout_timer2, enableTimer(_, _));
+  interval_timer2->invokeCallback();
+  EXPECT_EQ(1UL, cluster2->info_->stats_store_.counter("health_check.attempt").value());
+  EXPECT_EQ(1UL, registry->numProbes());
+}
+
+// Tests that health checkers of clusters with different config do not share probes.
+TEST_F(TcpHealthCheckerImplTest, SharedProbeDifferentConfig) {
+  auto registry = std::make_shared<HealthCheckProbeRegistry>();
+  setupData();
+  health_checker_->shareProbes(registry);
+  auto cluster2 = std::make_shared<NiceMock<MockClusterMockPrioritySet>>();
+  auto health_checker2 = std::make_shared<TcpHealthCheckerImpl>(
+      *cluster2, parseHealthCheckFromV3Yaml(R"EOF(
+    timeout: 1s
+    interval: 1s
+    unhealthy_threshold: 2
+    healthy_threshold: 2
+    tcp_health_check: {}
+    )EOF"),
+      dispatcher_, runtime_, random_, nullptr);
+  health_checker2->shareProbes(registry);
+
+  cluster_->prioritySet().getMockHostSet(0)->hosts_ = {
+      makeTestHost(cluster_->info_, "tcp://127.0.0.1:80")};
+  cluster2->prioritySet().getMockHostSet(0)->hosts_ = {
+      makeTestHost(cluster2->info_, "tcp://127.0.0.1:80")};
+  EXPECT_CALL(dispatcher_, createClientConnection_(_, _, _, _))
+      .WillOnce(Return(new NiceMock<Network::MockClientConnection>()))
+      .WillOnce(Return(new NiceMock<Network::MockClientConnection>()));
+  health_checker_->start();
+  health_checker2->start();
+  EXPECT_EQ(2UL, registry->numProbes());
+}
+
 class TestGrpcHealthCheckerImpl : public GrpcHealthCheckerImpl {
 public:
   using GrpcHealthCheckerImpl::GrpcHealthCheckerImpl;
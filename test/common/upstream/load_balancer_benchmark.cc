@@ -1,17 +1,26 @@
 // Usage: bazel run //test/common/upstream:load_balancer_benchmark
 
+#include <algorithm>
+#include <deque>
 #include <memory>
 
 #include "envoy/config/cluster/v3/cluster.pb.h"
 
 #include "common/common/random_generator.h"
 #include "common/memory/stats.h"
+#include "common/upstream/hash_search_tree.h"
 #include "common/upstream/maglev_lb.h"
 #include "common/upstream/ring_hash_lb.h"
+#include "common/upstream/thread_aware_lb_impl.h"
 #include "common/upstream/upstream_impl.h"
 
 #include "test/common/upstream/utility.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/test_runtime.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "absl/synchronization/notification.h"
 
 #include "benchmark/benchmark.h"
 
@@ -124,6 +133,49 @@ BENCHMARK(BM_RoundRobinLoadBalancerBuild)
     ->Args({50000, 100, 50})
     ->Unit(benchmark::kMillisecond);
 
+void BM_RoundRobinLoadBalancerUpdate(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const bool incremental = state.range(1) != 0;
+  const uint64_t changed_percent = state.range(2);
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.edf_lb_incremental_refresh", incremental ? "true" : "false"}});
+  // Half of the hosts are weighted, so that the LB schedules the hosts with EDF.
+  RoundRobinTester tester(num_hosts, 50, 50);
+  tester.initialize();
+  const HostVector& hosts = tester.priority_set_.hostSetsPerPriority()[0]->hosts();
+  const HostVectorConstSharedPtr updated_hosts = std::make_shared<HostVector>(hosts);
+  const HostsPerLocalityConstSharedPtr hosts_per_locality = makeHostsPerLocality({hosts});
+  const uint64_t changed_hosts = num_hosts * changed_percent / 100;
+
+  uint32_t weight = 2;
+  for (auto _ : state) {
+    state.PauseTiming();
+    // Change the weight of some hosts, as a load report would.
+    weight = weight == 2 ? 4 : 2;
+    for (uint64_t i = 0; i < changed_hosts; ++i) {
+      (*updated_hosts)[i]->weight(weight + i % 2);
+    }
+    auto update_hosts_params = HostSetImpl::partitionHosts(updated_hosts, hosts_per_locality);
+    state.ResumeTiming();
+
+    // Times the update of the schedulers, along with that of the host set.
+    tester.priority_set_.updateHosts(0, std::move(update_hosts_params), {}, {}, {},
+                                     absl::nullopt);
+  }
+}
+BENCHMARK(BM_RoundRobinLoadBalancerUpdate)
+    ->Apply([](benchmark::internal::Benchmark* benchmark) {
+      for (const int64_t num_hosts : {1000, 10000, 50000}) {
+        for (const int64_t incremental : {0, 1}) {
+          for (const int64_t changed_percent : {0, 1, 10, 100}) {
+            benchmark->Args({num_hosts, incremental, changed_percent});
+          }
+        }
+      }
+    })
+    ->Unit(benchmark::kMillisecond);
+
 class RingHashTester : public BaseTester {
 public:
   RingHashTester(uint64_t num_hosts, uint64_t min_ring_size) : BaseTester(num_hosts) {
@@ -263,6 +315,103 @@ BENCHMARK(BM_LeastRequestLoadBalancerChooseHost)
     ->Args({100, 100, 1000000})
     ->Unit(benchmark::kMillisecond);
 
+// Simulates workers which send requests to a cluster through their own least request load
+// balancers, as a connection pool would: each request is queued for connect_delay picks of its
+// worker while a connection is established, and is then active for request_duration picks. The
+// load balancers only see queued requests with least_request_outstanding_requests, as rq_active
+// counts requests once they are attached to a connection. Reports by how much the outstanding
+// requests of the busiest host exceed the mean over the run.
+void BM_LeastRequestLoadBalancerWorkerImbalance(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint32_t num_workers = state.range(1);
+  const bool outstanding_requests = state.range(2) != 0;
+  const uint64_t connect_delay = 64;
+  const uint64_t request_duration = 128;
+  const uint64_t requests_per_worker = 100000;
+  const uint64_t sample_interval = 64;
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.least_request_outstanding_requests",
+        outstanding_requests ? "true" : "false"}});
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    BaseTester tester(num_hosts);
+    const HostVector& hosts = tester.priority_set_.hostSetsPerPriority()[0]->hosts();
+    std::vector<std::unique_ptr<LeastRequestLoadBalancer>> lbs;
+    for (uint32_t i = 0; i < num_workers; ++i) {
+      lbs.push_back(std::make_unique<LeastRequestLoadBalancer>(
+          tester.priority_set_, nullptr, tester.stats_, tester.runtime_, tester.random_,
+          tester.common_config_, absl::nullopt));
+    }
+    // Written by the first worker.
+    double max_over_mean_sum = 0;
+    uint64_t samples = 0;
+    state.ResumeTiming();
+
+    std::vector<Thread::ThreadPtr> workers;
+    for (uint32_t worker = 0; worker < num_workers; ++worker) {
+      workers.push_back(Thread::threadFactoryForTest().createThread([&, worker]() {
+        LeastRequestLoadBalancer& lb = *lbs[worker];
+        std::deque<std::pair<uint64_t, HostConstSharedPtr>> queued;
+        std::deque<std::pair<uint64_t, HostConstSharedPtr>> active;
+        for (uint64_t i = 0; i < requests_per_worker; ++i) {
+          while (!queued.empty() && queued.front().first <= i) {
+            queued.front().second->stats().rq_active_.inc();
+            active.emplace_back(i + request_duration, std::move(queued.front().second));
+            queued.pop_front();
+          }
+          while (!active.empty() && active.front().first <= i) {
+            active.front().second->stats().rq_active_.dec();
+            active.front().second->addOutstandingRequests(-1);
+            active.pop_front();
+          }
+
+          HostConstSharedPtr host = lb.chooseHost(nullptr);
+          host->addOutstandingRequests(1);
+          queued.emplace_back(i + connect_delay, std::move(host));
+
+          if (worker == 0 && i % sample_interval == 0) {
+            uint64_t max = 0;
+            uint64_t total = 0;
+            for (const auto& sampled : hosts) {
+              max = std::max(max, sampled->outstandingRequests());
+              total += sampled->outstandingRequests();
+            }
+            if (total > 0) {
+              max_over_mean_sum += static_cast<double>(max) * num_hosts / total;
+              ++samples;
+            }
+          }
+        }
+      }));
+    }
+    for (auto& worker : workers) {
+      worker->join();
+    }
+
+    state.PauseTiming();
+    state.counters["max_over_mean"] = max_over_mean_sum / samples;
+    if (outstanding_requests) {
+      state.counters["above_mean_percent"] =
+          100.0 * tester.stats_.lb_least_request_above_mean_.value() /
+          (num_workers * requests_per_worker);
+    }
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_LeastRequestLoadBalancerWorkerImbalance)
+    ->Apply([](benchmark::internal::Benchmark* benchmark) {
+      for (const int64_t num_hosts : {10, 100}) {
+        for (const int64_t num_workers : {4, 16}) {
+          for (const int64_t outstanding_requests : {0, 1}) {
+            benchmark->Args({num_hosts, num_workers, outstanding_requests});
+          }
+        }
+      }
+    })
+    ->Unit(benchmark::kMillisecond);
+
 void BM_RingHashLoadBalancerChooseHost(benchmark::State& state) {
   for (auto _ : state) {
     // Do not time the creation of the ring.
@@ -302,6 +451,109 @@ BENCHMARK(BM_RingHashLoadBalancerChooseHost)
     ->Args({500, 256000, 100000})
     ->Unit(benchmark::kMillisecond);
 
+// The layout of the ring before it was split into a HashSearchTree and an array of host indices,
+// searched as it was.
+class LegacyRing {
+public:
+  LegacyRing(const std::vector<std::pair<uint64_t, uint32_t>>& ring, const HostVector& hosts) {
+    ring_.reserve(ring.size());
+    for (const auto& entry : ring) {
+      ring_.push_back({entry.first, hosts[entry.second]});
+    }
+  }
+
+  const HostConstSharedPtr& chooseHost(uint64_t h) const {
+    int64_t lowp = 0;
+    int64_t highp = ring_.size();
+    int64_t midp = 0;
+    while (true) {
+      midp = (lowp + highp) / 2;
+      if (midp == static_cast<int64_t>(ring_.size())) {
+        midp = 0;
+        break;
+      }
+      uint64_t midval = ring_[midp].hash_;
+      uint64_t midval1 = midp == 0 ? 0 : ring_[midp - 1].hash_;
+      if (h <= midval && h > midval1) {
+        break;
+      }
+      if (midval < h) {
+        lowp = midp + 1;
+      } else {
+        highp = midp - 1;
+      }
+      if (lowp > highp) {
+        midp = 0;
+        break;
+      }
+    }
+    return ring_[midp].host_;
+  }
+
+  size_t memoryUsage() const { return ring_.capacity() * sizeof(RingEntry); }
+
+private:
+  struct RingEntry {
+    uint64_t hash_;
+    HostConstSharedPtr host_;
+  };
+
+  std::vector<RingEntry> ring_;
+};
+
+// Compares lookups in rings of the old and new layouts, without the rest of the load balancer.
+// Lookups of random hashes miss the cache in large rings, as they do with many distinct keys.
+void BM_RingHashLayoutLookup(benchmark::State& state) {
+  const uint64_t num_hosts = 100;
+  const uint64_t ring_size = state.range(0);
+  const bool search_tree = state.range(1);
+  BaseTester tester(num_hosts);
+  const HostVector& hosts = tester.priority_set_.hostSetsPerPriority()[0]->hosts();
+
+  std::vector<std::pair<uint64_t, uint32_t>> ring;
+  for (uint64_t i = 0; i < ring_size; i++) {
+    ring.emplace_back(hashInt(i), i % num_hosts);
+  }
+  std::sort(ring.begin(), ring.end());
+  std::vector<uint64_t> hashes;
+  std::vector<uint32_t> host_indices;
+  for (const auto& entry : ring) {
+    hashes.push_back(entry.first);
+    host_indices.push_back(entry.second);
+  }
+  const LegacyRing legacy_ring(ring, hosts);
+  const HashSearchTree tree(hashes);
+
+  std::vector<uint64_t> keys(4096);
+  Random::RandomGeneratorImpl random;
+  for (uint64_t& key : keys) {
+    key = random.random();
+  }
+
+  uint64_t i = 0;
+  for (auto _ : state) {
+    const uint64_t key = keys[i++ % keys.size()];
+    if (search_tree) {
+      benchmark::DoNotOptimize(hosts[host_indices[tree.lowerBound(key)]]);
+    } else {
+      benchmark::DoNotOptimize(legacy_ring.chooseHost(key));
+    }
+  }
+
+  const size_t memory = search_tree
+                            ? tree.memoryUsage() + host_indices.capacity() * sizeof(uint32_t)
+                            : legacy_ring.memoryUsage();
+  state.counters["memory"] = memory;
+  state.counters["memory_per_entry"] = static_cast<double>(memory) / ring_size;
+}
+BENCHMARK(BM_RingHashLayoutLookup)
+    ->Args({65536, 0})
+    ->Args({65536, 1})
+    ->Args({1048576, 0})
+    ->Args({1048576, 1})
+    ->Args({8388608, 0})
+    ->Args({8388608, 1});
+
 void BM_MaglevLoadBalancerChooseHost(benchmark::State& state) {
   for (auto _ : state) {
     // Do not time the creation of the table.
@@ -335,6 +587,133 @@ BENCHMARK(BM_MaglevLoadBalancerChooseHost)
     ->Args({500, 100000})
     ->Unit(benchmark::kMillisecond);
 
+// Alternates the host set of priority 0 between all of the hosts and all but the last one.
+class HostSetToggler {
+public:
+  explicit HostSetToggler(PrioritySetImpl& priority_set) : priority_set_(priority_set) {
+    const HostVector& hosts = priority_set_.hostSetsPerPriority()[0]->hosts();
+    all_hosts_ = std::make_shared<HostVector>(hosts);
+    fewer_hosts_ = std::make_shared<HostVector>(hosts.begin(), hosts.end() - 1);
+  }
+
+  // @return the params for the next update, which are computed separately so as not to be timed.
+  PrioritySet::UpdateHostsParams nextParams() {
+    toggled_ = !toggled_;
+    const HostVectorConstSharedPtr& hosts = toggled_ ? fewer_hosts_ : all_hosts_;
+    return HostSetImpl::partitionHosts(hosts, makeHostsPerLocality({*hosts}));
+  }
+
+  void update(PrioritySet::UpdateHostsParams&& params) {
+    priority_set_.updateHosts(0, std::move(params), {}, {}, {}, absl::nullopt);
+  }
+
+private:
+  PrioritySetImpl& priority_set_;
+  HostVectorConstSharedPtr all_hosts_;
+  HostVectorConstSharedPtr fewer_hosts_;
+  bool toggled_{};
+};
+
+// Times how long a host set update holds up the main thread, with the table built on the main
+// thread or by a table builder.
+void BM_MaglevLoadBalancerHostUpdate(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const bool background = state.range(1) != 0;
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+  MaglevTester tester(num_hosts);
+  if (background) {
+    tester.maglev_lb_->setTableBuilder(
+        std::make_shared<LbTableBuilder>(Thread::threadFactoryForTest(), *dispatcher, 1),
+        tester.stats_store_);
+  }
+  tester.maglev_lb_->initialize();
+  HostSetToggler toggler(tester.priority_set_);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    // Complete the builds which have finished, so that the next update starts a build.
+    dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    auto params = toggler.nextParams();
+    state.ResumeTiming();
+    toggler.update(std::move(params));
+  }
+}
+BENCHMARK(BM_MaglevLoadBalancerHostUpdate)
+    ->Args({100, 0})
+    ->Args({100, 1})
+    ->Args({1000, 0})
+    ->Args({1000, 1})
+    ->Args({10000, 0})
+    ->Args({10000, 1})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_RingHashLoadBalancerHostUpdate(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t min_ring_size = state.range(1);
+  const bool background = state.range(2) != 0;
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+  RingHashTester tester(num_hosts, min_ring_size);
+  if (background) {
+    tester.ring_hash_lb_->setTableBuilder(
+        std::make_shared<LbTableBuilder>(Thread::threadFactoryForTest(), *dispatcher, 1),
+        tester.stats_store_);
+  }
+  tester.ring_hash_lb_->initialize();
+  HostSetToggler toggler(tester.priority_set_);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    // Complete the builds which have finished, so that the next update starts a build.
+    dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    auto params = toggler.nextParams();
+    state.ResumeTiming();
+    toggler.update(std::move(params));
+  }
+}
+BENCHMARK(BM_RingHashLoadBalancerHostUpdate)
+    ->Args({100, 256000, 0})
+    ->Args({100, 256000, 1})
+    ->Args({1000, 1024 * 1024, 0})
+    ->Args({1000, 1024 * 1024, 1})
+    ->Unit(benchmark::kMillisecond);
+
+// Times picks by a worker LB which picks up the tables built in the background after each update.
+void BM_MaglevLoadBalancerChooseHostBackgroundBuilds(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t keys_to_simulate = state.range(1);
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+  auto builder = std::make_shared<LbTableBuilder>(Thread::threadFactoryForTest(), *dispatcher, 1);
+  MaglevTester tester(num_hosts);
+  tester.maglev_lb_->setTableBuilder(builder, tester.stats_store_);
+  tester.maglev_lb_->initialize();
+  LoadBalancerPtr lb = tester.maglev_lb_->factory()->create();
+  HostSetToggler toggler(tester.priority_set_);
+  TestLoadBalancerContext context;
+
+  for (auto _ : state) {
+    // Do not time the build of the table.
+    state.PauseTiming();
+    toggler.update(toggler.nextParams());
+    absl::Notification built;
+    builder->post([&built]() { built.Notify(); });
+    built.WaitForNotification();
+    dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    state.ResumeTiming();
+
+    for (uint64_t i = 0; i < keys_to_simulate; i++) {
+      context.hash_key_ = hashInt(i);
+      benchmark::DoNotOptimize(lb->chooseHost(&context));
+    }
+  }
+}
+BENCHMARK(BM_MaglevLoadBalancerChooseHostBackgroundBuilds)
+    ->Args({100, 100000})
+    ->Args({500, 100000})
+    ->Unit(benchmark::kMillisecond);
+
 void BM_RingHashLoadBalancerHostLoss(benchmark::State& state) {
   for (auto _ : state) {
     const uint64_t num_hosts = state.range(0);
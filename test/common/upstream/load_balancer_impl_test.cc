@@ -1,3 +1,4 @@
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -901,6 +902,53 @@ TEST_P(RoundRobinLoadBalancerTest, Weighted) {
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
 }
 
+// Validate that host updates are applied to the existing schedule when incremental refresh is
+// enabled.
+TEST_P(RoundRobinLoadBalancerTest, WeightedIncrementalRefresh) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.edf_lb_incremental_refresh", "true"}});
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", 2)};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  init(false);
+  const auto pick_counts = [this](uint32_t picks) {
+    std::map<HostConstSharedPtr, uint32_t> counts;
+    for (uint32_t i = 0; i < picks; ++i) {
+      ++counts[lb_->chooseHost(nullptr)];
+    }
+    return counts;
+  };
+  auto counts = pick_counts(300);
+  EXPECT_EQ(100, counts[hostSet().healthy_hosts_[0]]);
+  EXPECT_EQ(200, counts[hostSet().healthy_hosts_[1]]);
+
+  // Add a host and change the weight of an existing one.
+  hostSet().healthy_hosts_.push_back(makeTestHost(info_, "tcp://127.0.0.1:82", 3));
+  hostSet().hosts_.push_back(hostSet().healthy_hosts_.back());
+  hostSet().healthy_hosts_[0]->weight(3);
+  hostSet().runCallbacks({hostSet().healthy_hosts_.back()}, {});
+  counts = pick_counts(800);
+  EXPECT_NEAR(300, counts[hostSet().healthy_hosts_[0]], 1);
+  EXPECT_NEAR(200, counts[hostSet().healthy_hosts_[1]], 1);
+  EXPECT_NEAR(300, counts[hostSet().healthy_hosts_[2]], 1);
+
+  // Remove a host.
+  HostVector removed_hosts = {hostSet().hosts_[0]};
+  hostSet().healthy_hosts_.erase(hostSet().healthy_hosts_.begin());
+  hostSet().hosts_.erase(hostSet().hosts_.begin());
+  hostSet().runCallbacks({}, removed_hosts);
+  counts = pick_counts(500);
+  EXPECT_EQ(0, counts[removed_hosts[0]]);
+  EXPECT_NEAR(200, counts[hostSet().healthy_hosts_[0]], 1);
+  EXPECT_NEAR(300, counts[hostSet().healthy_hosts_[1]], 1);
+
+  // Once the weights are equal, hosts are picked in turn.
+  hostSet().healthy_hosts_[0]->weight(3);
+  hostSet().runCallbacks({}, {});
+  EXPECT_NE(lb_->chooseHost(nullptr), lb_->chooseHost(nullptr));
+}
+
 // Validate that the RNG seed influences pick order when weighted RR.
 TEST_P(RoundRobinLoadBalancerTest, WeightedSeed) {
   hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
@@ -1444,6 +1492,38 @@ TEST_P(LeastRequestLoadBalancerTest, Normal) {
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
 }
 
+// With least_request_outstanding_requests, the requests queued in connection pools are counted
+// and the choices are reported in lb_least_request_above_mean.
+TEST_P(LeastRequestLoadBalancerTest, OutstandingRequests) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.least_request_outstanding_requests", "true"}});
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
+                              makeTestHost(info_, "tcp://127.0.0.1:81")};
+  stats_.max_host_weight_.set(1UL);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+
+  // Host 0 has fewer active requests, but more requests waiting for connections.
+  hostSet().healthy_hosts_[0]->stats().rq_active_.set(1);
+  hostSet().healthy_hosts_[0]->addOutstandingRequests(3);
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(2);
+  hostSet().healthy_hosts_[1]->addOutstandingRequests(2);
+  stats_.upstream_rq_active_.set(3);
+  stats_.upstream_rq_pending_active_.set(2);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+  EXPECT_EQ(0U, stats_.lb_least_request_above_mean_.value());
+
+  // Both hosts have more outstanding requests than the mean of the cluster.
+  hostSet().healthy_hosts_[1]->addOutstandingRequests(1);
+  stats_.upstream_rq_active_.set(1);
+  stats_.upstream_rq_pending_active_.set(1);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+  EXPECT_EQ(1U, stats_.lb_least_request_above_mean_.value());
+}
+
 TEST_P(LeastRequestLoadBalancerTest, PNC) {
   hostSet().healthy_hosts_ = {
       makeTestHost(info_, "tcp://127.0.0.1:80"), makeTestHost(info_, "tcp://127.0.0.1:81"),
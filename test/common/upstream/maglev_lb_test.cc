@@ -6,6 +6,10 @@
 
 #include "test/common/upstream/utility.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "absl/synchronization/notification.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -398,6 +402,102 @@ TEST_F(MaglevLoadBalancerTest, LocalityWeightedLopsided) {
   EXPECT_EQ(MaglevTable::DefaultTableSize - 1023, counts[0]);
 }
 
+class MaglevLoadBalancerTableBuilderTest : public MaglevLoadBalancerTest {
+public:
+  MaglevLoadBalancerTableBuilderTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        builder_(std::make_shared<LbTableBuilder>(Thread::threadFactoryForTest(), *dispatcher_,
+                                                  1)) {}
+
+  void init() {
+    host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90")};
+    host_set_.healthy_hosts_ = host_set_.hosts_;
+    host_set_.runCallbacks({}, {});
+    lb_ = std::make_unique<MaglevLoadBalancer>(priority_set_, stats_, stats_store_, runtime_,
+                                               random_, common_config_, 7);
+    lb_->setTableBuilder(builder_, stats_store_);
+    lb_->initialize();
+  }
+
+  HostSharedPtr updateHosts(const std::string& url) {
+    host_set_.hosts_ = {makeTestHost(info_, url)};
+    host_set_.healthy_hosts_ = host_set_.hosts_;
+    host_set_.runCallbacks({}, {});
+    return host_set_.hosts_[0];
+  }
+
+  // Holds up the builder until the returned notification is notified.
+  std::unique_ptr<absl::Notification> blockBuilder() {
+    auto unblock = std::make_unique<absl::Notification>();
+    absl::Notification blocked;
+    builder_->post([&blocked, unblock = unblock.get()]() {
+      blocked.Notify();
+      unblock->WaitForNotification();
+    });
+    blocked.WaitForNotification();
+    return unblock;
+  }
+
+  // Waits for the builds posted so far to run, and then for their completions.
+  void waitForBuilds() {
+    absl::Notification built;
+    builder_->post([&built]() { built.Notify(); });
+    built.WaitForNotification();
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  LbTableBuilderSharedPtr builder_;
+};
+
+// Tables for host set updates after initialization are built by the table builder, and picked up
+// by the worker LBs which already exist.
+TEST_F(MaglevLoadBalancerTableBuilderTest, TableBuilder) {
+  init();
+  LoadBalancerPtr lb = lb_->factory()->create();
+  TestLoadBalancerContext context(0);
+  const HostSharedPtr initial_host = host_set_.hosts_[0];
+  EXPECT_EQ(initial_host, lb->chooseHost(&context));
+
+  // Hold up the builder, so that the two updates after the first one are collapsed into one build.
+  std::unique_ptr<absl::Notification> unblock = blockBuilder();
+  const HostSharedPtr first_update_host = updateHosts("tcp://127.0.0.1:91");
+  updateHosts("tcp://127.0.0.1:92");
+  const HostSharedPtr last_update_host = updateHosts("tcp://127.0.0.1:93");
+
+  // Workers keep using the previous table until the new one is built.
+  EXPECT_EQ(initial_host, lb->chooseHost(&context));
+  EXPECT_EQ(initial_host, lb_->factory()->create()->chooseHost(&context));
+  unblock->Notify();
+
+  // The completion of the first build starts the build of the latest update.
+  waitForBuilds();
+  EXPECT_EQ(first_update_host, lb->chooseHost(&context));
+  waitForBuilds();
+  EXPECT_EQ(last_update_host, lb->chooseHost(&context));
+  EXPECT_EQ(2, stats_store_.counterFromString("lb_table_builds").value());
+  EXPECT_EQ(1, stats_store_.counterFromString("lb_table_builds_collapsed").value());
+}
+
+// Destroying the load balancer does not wait for its running build, which drops its tables.
+TEST_F(MaglevLoadBalancerTableBuilderTest, DestroyedWhileBuilding) {
+  init();
+  LoadBalancerPtr lb = lb_->factory()->create();
+  TestLoadBalancerContext context(0);
+  const HostSharedPtr initial_host = host_set_.hosts_[0];
+
+  std::unique_ptr<absl::Notification> unblock = blockBuilder();
+  updateHosts("tcp://127.0.0.1:91");
+  updateHosts("tcp://127.0.0.1:92");
+  lb_.reset();
+  unblock->Notify();
+  waitForBuilds();
+
+  EXPECT_EQ(initial_host, lb->chooseHost(&context));
+  EXPECT_EQ(0, stats_store_.counterFromString("lb_table_builds").value());
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
@@ -0,0 +1,83 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <memory>
+#include <string>
+
+#include "envoy/config/cluster/v3/outlier_detection.pb.h"
+
+#include "common/upstream/outlier_detection_impl.h"
+#include "common/upstream/upstream_impl.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace Outlier {
+namespace {
+
+class OutlierDetectionSpeedTest {
+public:
+  OutlierDetectionSpeedTest(uint64_t num_hosts) {
+    HostVector& hosts = cluster_.prioritySet().getMockHostSet(0)->hosts_;
+    for (uint64_t i = 0; i < num_hosts; i++) {
+      hosts.emplace_back(makeTestHost(cluster_.info_, absl::StrCat("tcp://10.0.", i / 256, ".",
+                                                                   i % 256, ":80")));
+    }
+    detector_ = DetectorImpl::create(cluster_, config_, dispatcher_, runtime_, time_system_,
+                                     nullptr);
+  }
+
+  // Fills the success rate buckets of all hosts for the next interval. One host in ten fails a
+  // fifth of its requests, so that the success rate and failure percentage thresholds are
+  // computed over a non-trivial distribution.
+  void loadRequests() {
+    const HostVector& hosts = cluster_.prioritySet().getMockHostSet(0)->hosts_;
+    for (uint64_t i = 0; i < hosts.size(); i++) {
+      for (uint64_t j = 0; j < 100; j++) {
+        hosts[i]->outlierDetector().putHttpResponseCode(i % 10 == 0 && j % 5 == 0 ? 503 : 200);
+      }
+    }
+  }
+
+  void evaluate() { interval_timer_->callback_(); }
+
+  testing::NiceMock<MockClusterMockPrioritySet> cluster_;
+  testing::NiceMock<Event::MockDispatcher> dispatcher_;
+  testing::NiceMock<Runtime::MockLoader> runtime_;
+  testing::NiceMock<Event::MockTimer>* interval_timer_ =
+      new testing::NiceMock<Event::MockTimer>(&dispatcher_);
+  Event::SimulatedTimeSystem time_system_;
+  envoy::config::cluster::v3::OutlierDetection config_;
+  std::shared_ptr<DetectorImpl> detector_;
+};
+
+// Measures one evaluation interval of the success rate and failure percentage detectors as a
+// function of the number of hosts in the cluster. Ejections are not enforced (the runtime mock
+// disables them), so every iteration evaluates the same set of hosts.
+void BM_ProcessSuccessRateEjections(benchmark::State& state) {
+  OutlierDetectionSpeedTest test(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    test.loadRequests();
+    state.ResumeTiming();
+    test.evaluate();
+  }
+}
+BENCHMARK(BM_ProcessSuccessRateEjections)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000)
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
+} // namespace Outlier
+} // namespace Upstream
+} // namespace Envoy
@@ -131,6 +131,50 @@ typed_config:
   EXPECT_EQ(0U, test_server_->counter("tcp.rbac.shadow_denied")->value());
 }
 
+// Tests that the TCP proxy does not splice connections whose data RBAC inspects.
+TEST_P(RoleBasedAccessControlNetworkFilterIntegrationTest, NoSpliceForwarding) {
+  config_helper_.addConfigModifier([](envoy::config::bootstrap::v3::Bootstrap& bootstrap) {
+    envoy::config::listener::v3::Filter filter;
+    TestUtility::loadFromYaml(R"EOF(
+name: envoy.filters.network.tcp_proxy
+typed_config:
+  "@type": type.googleapis.com/envoy.extensions.filters.network.tcp_proxy.v3.TcpProxy
+  stat_prefix: tcp_stats
+  cluster: cluster_0
+  splice_forwarding: true
+)EOF",
+                              filter);
+    auto l = bootstrap.mutable_static_resources()->mutable_listeners(0);
+    ASSERT_GT(l->filter_chains(0).filters_size(), 1);
+    l->mutable_filter_chains(0)->mutable_filters(1)->Swap(&filter);
+  });
+  initializeFilter(R"EOF(
+name: rbac
+typed_config:
+  "@type": type.googleapis.com/envoy.config.filter.network.rbac.v2.RBAC
+  stat_prefix: tcp.
+  rules:
+    policies:
+      "allow_all":
+        permissions:
+          - any: true
+        principals:
+          - any: true
+)EOF");
+  IntegrationTcpClientPtr tcp_client = makeTcpConnection(lookupPort("listener_0"));
+  ASSERT_TRUE(tcp_client->write("hello"));
+  FakeRawConnectionPtr fake_upstream_connection;
+  ASSERT_TRUE(fake_upstreams_[0]->waitForRawConnection(fake_upstream_connection));
+  ASSERT_TRUE(fake_upstream_connection->waitForData(5));
+  ASSERT_TRUE(tcp_client->write("world"));
+  ASSERT_TRUE(fake_upstream_connection->waitForData(10));
+  tcp_client->close();
+  ASSERT_TRUE(fake_upstream_connection->waitForDisconnect());
+
+  test_server_->waitForCounterGe("tcp.rbac.allowed", 1);
+  EXPECT_EQ(0U, test_server_->counter("tcp.tcp_stats.downstream_cx_spliced_total")->value());
+}
+
 } // namespace RBAC
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -167,7 +167,8 @@ TEST(HealthCheckerFactoryTest, CreateRedisViaUpstreamHealthCheckerFactory) {
             dynamic_cast<CustomRedisHealthChecker*>(
                 Upstream::HealthCheckerFactory::create(
                     Upstream::parseHealthCheckFromV3Yaml(yaml), cluster, runtime, random,
-                    dispatcher, log_manager, ProtobufMessage::getStrictValidationVisitor(), api)
+                    dispatcher, log_manager, ProtobufMessage::getStrictValidationVisitor(), api,
+                    nullptr)
                     .get()));
 }
 } // namespace
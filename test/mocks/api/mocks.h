@@ -102,6 +102,9 @@ class MockLinuxOsSysCalls : public LinuxOsSysCallsImpl {
 public:
   // Api::LinuxOsSysCalls
   MOCK_METHOD(SysCallIntResult, sched_getaffinity, (pid_t pid, size_t cpusetsize, cpu_set_t* mask));
+  MOCK_METHOD(SysCallIntResult, pipe2, (int pipefd[2], int flags));
+  MOCK_METHOD(SysCallIntResult, fcntl, (int fd, int cmd, int arg));
+  MOCK_METHOD(SysCallSizeResult, splice, (int fd_in, int fd_out, size_t len, unsigned int flags));
 };
 #endif
 
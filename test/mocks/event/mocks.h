@@ -122,6 +122,7 @@ public:
   MOCK_METHOD(Timer*, createTimer_, (Event::TimerCb cb));
   MOCK_METHOD(SchedulableCallback*, createSchedulableCallback_, (std::function<void()> cb));
   MOCK_METHOD(void, deferredDelete_, (DeferredDeletable * to_delete));
+  MOCK_METHOD(Common::CallbackHandle*, addOnDestroyCallback, (std::function<void()> callback));
   MOCK_METHOD(void, exit, ());
   MOCK_METHOD(SignalEvent*, listenForSignal_, (int signal_num, SignalCb cb));
   MOCK_METHOD(void, post, (std::function<void()> callback));
@@ -85,6 +85,7 @@ public:
   MOCK_METHOD(const StreamInfo::StreamInfo&, streamInfo, (), (const));
   MOCK_METHOD(void, setDelayedCloseTimeout, (std::chrono::milliseconds));
   MOCK_METHOD(absl::string_view, transportFailureReason, (), (const));
+  MOCK_METHOD(bool, startSplice, (Connection & peer));
 };
 
 /**
@@ -131,6 +132,7 @@ public:
   MOCK_METHOD(const StreamInfo::StreamInfo&, streamInfo, (), (const));
   MOCK_METHOD(void, setDelayedCloseTimeout, (std::chrono::milliseconds));
   MOCK_METHOD(absl::string_view, transportFailureReason, (), (const));
+  MOCK_METHOD(bool, startSplice, (Connection & peer));
 
   // Network::ClientConnection
   MOCK_METHOD(void, connect, ());
@@ -180,6 +182,7 @@ public:
   MOCK_METHOD(const StreamInfo::StreamInfo&, streamInfo, (), (const));
   MOCK_METHOD(void, setDelayedCloseTimeout, (std::chrono::milliseconds));
   MOCK_METHOD(absl::string_view, transportFailureReason, (), (const));
+  MOCK_METHOD(bool, startSplice, (Connection & peer));
 
   // Network::FilterManagerConnection
   MOCK_METHOD(StreamBuffer, getReadBuffer, ());
@@ -2,10 +2,23 @@
 
 #include "envoy/network/address.h"
 
+using testing::_;
+using testing::Invoke;
+using testing::Return;
+
 namespace Envoy {
 namespace Network {
 
-MockIoHandle::MockIoHandle() = default;
+MockIoHandle::MockIoHandle() {
+  ON_CALL(*this, write(_)).WillByDefault(Invoke([this](Buffer::Instance& buffer) {
+    return buffer.write(*this);
+  }));
+  ON_CALL(*this, read(_, _))
+      .WillByDefault(Invoke([this](Buffer::Instance& buffer, uint64_t max_length) {
+        return buffer.read(*this, max_length);
+      }));
+  ON_CALL(*this, allowsDescriptorIo()).WillByDefault(Return(true));
+}
 MockIoHandle::~MockIoHandle() = default;
 
 } // namespace Network
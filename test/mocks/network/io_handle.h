@@ -1,6 +1,7 @@
 #pragma once
 
 #include "envoy/buffer/buffer.h"
+#include "envoy/event/dispatcher.h"
 #include "envoy/network/io_handle.h"
 
 #include "gmock/gmock.h"
@@ -18,8 +19,10 @@ public:
   MOCK_METHOD(bool, isOpen, (), (const));
   MOCK_METHOD(Api::IoCallUint64Result, readv,
               (uint64_t max_length, Buffer::RawSlice* slices, uint64_t num_slice));
+  MOCK_METHOD(Api::IoCallUint64Result, read, (Buffer::Instance & buffer, uint64_t max_length));
   MOCK_METHOD(Api::IoCallUint64Result, writev,
               (const Buffer::RawSlice* slices, uint64_t num_slice));
+  MOCK_METHOD(Api::IoCallUint64Result, write, (Buffer::Instance & buffer));
   MOCK_METHOD(Api::IoCallUint64Result, sendmsg,
               (const Buffer::RawSlice* slices, uint64_t num_slice, int flags,
                const Address::Ip* self_ip, const Address::Instance& peer_address));
@@ -42,6 +45,11 @@ public:
   MOCK_METHOD(absl::optional<int>, domain, ());
   MOCK_METHOD(Address::InstanceConstSharedPtr, localAddress, ());
   MOCK_METHOD(Address::InstanceConstSharedPtr, peerAddress, ());
+  MOCK_METHOD(Api::SysCallIntResult, shutdown, (int how));
+  MOCK_METHOD(Event::FileEventPtr, createFileEvent,
+              (Event::Dispatcher & dispatcher, Event::FileReadyCb cb,
+               Event::FileTriggerType trigger, uint32_t events));
+  MOCK_METHOD(bool, allowsDescriptorIo, (), (const));
 };
 
 } // namespace Network
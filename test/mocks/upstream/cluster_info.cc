@@ -54,6 +54,10 @@ MockClusterInfo::MockClusterInfo()
   ON_CALL(*this, connectTimeout()).WillByDefault(Return(std::chrono::milliseconds(1)));
   ON_CALL(*this, idleTimeout()).WillByDefault(Return(absl::optional<std::chrono::milliseconds>()));
   ON_CALL(*this, prefetchRatio()).WillByDefault(Return(1.0));
+  ON_CALL(*this, maxPredictedConnections()).WillByDefault(Return(0));
+  ON_CALL(*this, predictedRateHalfLife()).WillByDefault(Return(std::chrono::milliseconds(1000)));
+  ON_CALL(*this, warmUpConnections()).WillByDefault(Return(0));
+  ON_CALL(*this, http2PoolSharingWorkers()).WillByDefault(Return(0));
   ON_CALL(*this, name()).WillByDefault(ReturnRef(name_));
   ON_CALL(*this, edsServiceName()).WillByDefault(ReturnPointee(&eds_service_name_));
   ON_CALL(*this, http1Settings()).WillByDefault(ReturnRef(http1_settings_));
@@ -90,6 +90,10 @@ public:
   MOCK_METHOD(std::chrono::milliseconds, connectTimeout, (), (const));
   MOCK_METHOD(const absl::optional<std::chrono::milliseconds>, idleTimeout, (), (const));
   MOCK_METHOD(float, prefetchRatio, (), (const));
+  MOCK_METHOD(uint32_t, maxPredictedConnections, (), (const));
+  MOCK_METHOD(std::chrono::milliseconds, predictedRateHalfLife, (), (const));
+  MOCK_METHOD(uint32_t, warmUpConnections, (), (const));
+  MOCK_METHOD(uint32_t, http2PoolSharingWorkers, (), (const));
   MOCK_METHOD(uint32_t, perConnectionBufferLimitBytes, (), (const));
   MOCK_METHOD(uint64_t, features, (), (const));
   MOCK_METHOD(const Http::Http1Settings&, http1Settings, (), (const));
@@ -188,6 +188,8 @@ public:
   MOCK_METHOD(void, weight, (uint32_t new_weight));
   MOCK_METHOD(bool, used, (), (const));
   MOCK_METHOD(void, used, (bool new_used));
+  MOCK_METHOD(uint64_t, outstandingRequests, (), (const));
+  MOCK_METHOD(void, addOutstandingRequests, (int64_t delta), (const));
   MOCK_METHOD(const envoy::config::core::v3::Locality&, locality, (), (const));
   MOCK_METHOD(uint32_t, priority, (), (const));
   MOCK_METHOD(void, priority, (uint32_t));